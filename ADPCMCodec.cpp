@@ -4,6 +4,7 @@
  */
 
 #include "ADPCMCodec.h"
+#include "Config.h"
 
 // ============================================================================
 // IMA ADPCM TABLES
@@ -28,23 +29,70 @@ const int8_t ADPCMCodec::indexTable[16] = {
     -1, -1, -1, -1, 2, 4, 6, 8
 };
 
+// Derived tables for the table-driven encoder
+int16_t ADPCMCodec::quantTable[89][3];
+uint16_t ADPCMCodec::deltaTable[89][8];
+uint8_t ADPCMCodec::nextIndexTable[89][8];
+bool ADPCMCodec::tablesBuilt = false;
+
+void ADPCMCodec::buildTables() {
+  if (tablesBuilt) return;
+
+  for (int index = 0; index < 89; index++) {
+    int16_t stepSize = stepSizeTable[index];
+    quantTable[index][0] = stepSize;
+    quantTable[index][1] = stepSize >> 1;
+    quantTable[index][2] = stepSize >> 2;
+
+    for (int magnitude = 0; magnitude < 8; magnitude++) {
+      // Same reconstruction as encodeSample()
+      int32_t delta = stepSize >> 3;
+      if (magnitude & 4) delta += stepSize;
+      if (magnitude & 2) delta += stepSize >> 1;
+      if (magnitude & 1) delta += stepSize >> 2;
+      deltaTable[index][magnitude] = (uint16_t)delta;  // Up to 1.875 x 32767
+
+      int next = index + indexTable[magnitude];
+      if (next < 0) next = 0;
+      if (next > 88) next = 88;
+      nextIndexTable[index][magnitude] = (uint8_t)next;
+    }
+  }
+
+  tablesBuilt = true;
+}
+
 // ============================================================================
 // CONSTRUCTOR
 // ============================================================================
 
 ADPCMCodec::ADPCMCodec() {
+  encoderEngine = AUDIO_ADPCM_ENCODER_ENGINE;
+  buildTables();
   resetEncoder();
+  resetDecoder();
 }
 
 void ADPCMCodec::resetEncoder() {
   encoderState.reset();
 }
 
+void ADPCMCodec::resetDecoder() {
+  decoderState.reset();
+}
+
 // ============================================================================
 // ENCODER FUNCTIONS
 // ============================================================================
 
 size_t ADPCMCodec::encode(const int16_t* pcmSamples, size_t numSamples, uint8_t* adpcmOutput) {
+  if (encoderEngine == ADPCM_ENCODER_TABLE) {
+    return encodeTable(pcmSamples, numSamples, adpcmOutput);
+  }
+  return encodeReference(pcmSamples, numSamples, adpcmOutput);
+}
+
+size_t ADPCMCodec::encodeReference(const int16_t* pcmSamples, size_t numSamples, uint8_t* adpcmOutput) {
   size_t outputIndex = 0;
   uint8_t packedByte = 0;
 
@@ -71,8 +119,115 @@ size_t ADPCMCodec::encode(const int16_t* pcmSamples, size_t numSamples, uint8_t*
   return outputIndex;
 }
 
+// Quantize one sample with the derived tables. State lives in registers;
+// the only data-dependent branch left is the (rare) prediction clamp.
+inline uint32_t ADPCMCodec::encodeSampleTable(int32_t sample, int32_t& predicted, int32_t& index) {
+  const int16_t* thresholds = quantTable[index];
+  int32_t diff = sample - predicted;
+  int32_t sign = diff >> 31;                // 0 or -1
+  int32_t magnitude = (diff ^ sign) - sign;  // |diff|
+
+  // Successive approximation with masks instead of branches
+  int32_t mask = -(int32_t)(magnitude >= thresholds[0]);
+  uint32_t code = mask & 4;
+  magnitude -= mask & thresholds[0];
+  mask = -(int32_t)(magnitude >= thresholds[1]);
+  code |= mask & 2;
+  magnitude -= mask & thresholds[1];
+  code |= (uint32_t)(magnitude >= thresholds[2]);
+
+  // Apply signed delta: (delta ^ sign) - sign == sign ? -delta : delta
+  int32_t delta = deltaTable[index][code];
+  predicted += (delta ^ sign) - sign;
+  if ((uint32_t)(predicted + 32768) > 65535u) {
+    predicted = (predicted < 0) ? -32768 : 32767;
+  }
+
+  index = nextIndexTable[index][code];
+  return code | (sign & 8);
+}
+
+size_t ADPCMCodec::encodeTable(const int16_t* pcmSamples, size_t numSamples, uint8_t* adpcmOutput) {
+  int32_t predicted = encoderState.predictedSample;
+  int32_t index = encoderState.stepIndex;
+  size_t numPairs = numSamples >> 1;
+
+  // Two nibbles per iteration: no per-sample packing branch
+  for (size_t i = 0; i < numPairs; i++) {
+    uint32_t low = encodeSampleTable(pcmSamples[2 * i], predicted, index);
+    uint32_t high = encodeSampleTable(pcmSamples[2 * i + 1], predicted, index);
+    adpcmOutput[i] = (uint8_t)(low | (high << 4));
+  }
+
+  // Handle odd number of samples
+  if (numSamples & 1) {
+    adpcmOutput[numPairs] = (uint8_t)encodeSampleTable(pcmSamples[numSamples - 1], predicted, index);
+  }
+
+  encoderState.predictedSample = (int16_t)predicted;
+  encoderState.stepIndex = (int16_t)index;
+
+  return (numSamples + 1) >> 1;
+}
+
+size_t ADPCMCodec::encodeWithStats(const int16_t* pcmSamples, size_t numSamples, uint8_t* adpcmOutput,
+                                   AudioBlockStats& stats) {
+  int32_t predicted = encoderState.predictedSample;
+  int32_t index = encoderState.stepIndex;
+  size_t numPairs = numSamples >> 1;
+
+  uint64_t energy = 0;
+  uint32_t peak = 0;
+  uint32_t zeroCrossings = 0;
+  int32_t previous = (numSamples > 0) ? pcmSamples[0] : 0;
+
+  for (size_t i = 0; i < numPairs; i++) {
+    int32_t first = pcmSamples[2 * i];
+    int32_t second = pcmSamples[2 * i + 1];
+
+    // Two squares fit in 32 bits (2 * 2^30); widen once per pair
+    energy += (uint32_t)(first * first) + (uint32_t)(second * second);
+
+    uint32_t magnitude = (uint32_t)((first ^ (first >> 31)) - (first >> 31));
+    if (magnitude > peak) peak = magnitude;
+    magnitude = (uint32_t)((second ^ (second >> 31)) - (second >> 31));
+    if (magnitude > peak) peak = magnitude;
+
+    // Sign bit of (a ^ b) is set when a and b have opposite signs
+    zeroCrossings += ((uint32_t)(previous ^ first) >> 31) + ((uint32_t)(first ^ second) >> 31);
+    previous = second;
+
+    uint32_t low = encodeSampleTable(first, predicted, index);
+    uint32_t high = encodeSampleTable(second, predicted, index);
+    adpcmOutput[i] = (uint8_t)(low | (high << 4));
+  }
+
+  // Handle odd number of samples
+  if (numSamples & 1) {
+    int32_t last = pcmSamples[numSamples - 1];
+    energy += (uint32_t)(last * last);
+    uint32_t magnitude = (uint32_t)((last ^ (last >> 31)) - (last >> 31));
+    if (magnitude > peak) peak = magnitude;
+    zeroCrossings += (uint32_t)(previous ^ last) >> 31;
+    adpcmOutput[numPairs] = (uint8_t)encodeSampleTable(last, predicted, index);
+  }
+
+  encoderState.predictedSample = (int16_t)predicted;
+  encoderState.stepIndex = (int16_t)index;
+
+  stats.energy = energy;
+  stats.peak = (uint16_t)peak;
+  stats.zeroCrossings = (uint16_t)zeroCrossings;
+  stats.count = numSamples;
+  stats.rms = rmsFromEnergy(energy, numSamples);
+
+  return (numSamples + 1) >> 1;
+}
+
 uint8_t ADPCMCodec::encodeSample(int16_t sample) {
-  int16_t diff = sample - encoderState.predictedSample;
+  // 32-bit intermediates: the difference and the new prediction can both
+  // exceed the int16_t range before clamping
+  int32_t diff = (int32_t)sample - encoderState.predictedSample;
   uint8_t code = 0;
 
   // Store sign bit
@@ -82,8 +237,8 @@ uint8_t ADPCMCodec::encodeSample(int16_t sample) {
   }
 
   // Quantize the difference using current step size
-  int16_t stepSize = stepSizeTable[encoderState.stepIndex];
-  int16_t delta = stepSize >> 3;  // Initialize with stepSize/8
+  int32_t stepSize = stepSizeTable[encoderState.stepIndex];
+  int32_t delta;
 
   // Bit 2
   if (diff >= stepSize) {
@@ -113,18 +268,20 @@ uint8_t ADPCMCodec::encodeSample(int16_t sample) {
   if (code & 1) delta += stepSize >> 2;
 
   // Update predicted sample
+  int32_t predicted = encoderState.predictedSample;
   if (code & 8) {
-    encoderState.predictedSample -= delta;
+    predicted -= delta;
   } else {
-    encoderState.predictedSample += delta;
+    predicted += delta;
   }
 
   // Clamp predicted sample to 16-bit range
-  if (encoderState.predictedSample > 32767) {
-    encoderState.predictedSample = 32767;
-  } else if (encoderState.predictedSample < -32768) {
-    encoderState.predictedSample = -32768;
+  if (predicted > 32767) {
+    predicted = 32767;
+  } else if (predicted < -32768) {
+    predicted = -32768;
   }
+  encoderState.predictedSample = (int16_t)predicted;
 
   // Update step index
   encoderState.stepIndex += indexTable[code];
@@ -149,6 +306,69 @@ void ADPCMCodec::setState(int16_t predictedSample, int16_t stepIndex) {
   encoderState.stepIndex = stepIndex;
 }
 
+// ============================================================================
+// DECODER FUNCTIONS
+// ============================================================================
+
+size_t ADPCMCodec::decode(const uint8_t* adpcmInput, size_t numSamples, int16_t* pcmOutput) {
+  for (size_t i = 0; i < numSamples; i++) {
+    uint8_t packedByte = adpcmInput[i >> 1];
+
+    // Lower nibble holds the first sample of each byte
+    uint8_t adpcmCode = (i & 1) ? (packedByte >> 4) : (packedByte & 0x0F);
+    pcmOutput[i] = decodeSample(adpcmCode);
+  }
+
+  return numSamples;
+}
+
+int16_t ADPCMCodec::decodeSample(uint8_t code) {
+  int32_t stepSize = stepSizeTable[decoderState.stepIndex];
+
+  // Reconstruct the quantized difference (same as encoder)
+  int32_t delta = stepSize >> 3;
+  if (code & 4) delta += stepSize;
+  if (code & 2) delta += stepSize >> 1;
+  if (code & 1) delta += stepSize >> 2;
+
+  int32_t predicted = decoderState.predictedSample;
+  if (code & 8) {
+    predicted -= delta;
+  } else {
+    predicted += delta;
+  }
+
+  // Clamp predicted sample to 16-bit range
+  if (predicted > 32767) {
+    predicted = 32767;
+  } else if (predicted < -32768) {
+    predicted = -32768;
+  }
+  decoderState.predictedSample = (int16_t)predicted;
+
+  // Update step index
+  decoderState.stepIndex += indexTable[code];
+
+  // Clamp step index to valid range (0-88)
+  if (decoderState.stepIndex < 0) {
+    decoderState.stepIndex = 0;
+  } else if (decoderState.stepIndex > 88) {
+    decoderState.stepIndex = 88;
+  }
+
+  return decoderState.predictedSample;
+}
+
+void ADPCMCodec::getDecoderState(int16_t& predictedSample, int16_t& stepIndex) {
+  predictedSample = decoderState.predictedSample;
+  stepIndex = decoderState.stepIndex;
+}
+
+void ADPCMCodec::setDecoderState(int16_t predictedSample, int16_t stepIndex) {
+  decoderState.predictedSample = predictedSample;
+  decoderState.stepIndex = stepIndex;
+}
+
 // ============================================================================
 // HELPER FUNCTIONS
 // ============================================================================
@@ -159,15 +379,21 @@ bool detectVoiceActivity(const int16_t* samples, size_t count, int16_t threshold
 }
 
 int16_t calculateRMS(const int16_t* samples, size_t count) {
-  if (count == 0) return 0;
-
-  int32_t sum = 0;
+  // 64-bit sum: 256 full-scale samples are 2^38, far beyond int32
+  uint64_t sum = 0;
   for (size_t i = 0; i < count; i++) {
     int32_t sample = samples[i];
-    sum += (sample * sample);
+    sum += (uint32_t)(sample * sample);
   }
 
-  // Calculate RMS: sqrt(mean(squares))
-  int32_t mean = sum / count;
-  return (int16_t)sqrt(mean);
+  return rmsFromEnergy(sum, count);
+}
+
+int16_t rmsFromEnergy(uint64_t energy, size_t count) {
+  if (count == 0) return 0;
+
+  // Calculate RMS: sqrt(mean(squares)); the mean fits in 32 bits (<= 2^30)
+  uint32_t mean = (uint32_t)(energy / count);
+  uint32_t rms = (uint32_t)sqrt((double)mean);
+  return (int16_t)min(rms, (uint32_t)32767);
 }
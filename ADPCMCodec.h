@@ -1,6 +1,7 @@
 /*
  * IMA ADPCM Codec for ESP32-C3
  * Provides 4:1 compression for 16-bit PCM audio
+ * Decoder matches the iOS app's ADPCMDecoder (used for host benchmarks/tests)
  *
  * IMA ADPCM reduces 16-bit samples to 4-bit codes
  * Bandwidth reduction: 256 kbps -> 64 kbps (16 kHz mono)
@@ -15,7 +16,7 @@
 #include <Arduino.h>
 
 // ============================================================================
-// ADPCM ENCODER STATE
+// ADPCM CODEC STATE
 // ============================================================================
 
 struct ADPCMState {
@@ -30,6 +31,29 @@ struct ADPCMState {
   }
 };
 
+// ============================================================================
+// BLOCK STATISTICS (fused encode kernel)
+// ============================================================================
+
+struct AudioBlockStats {
+  uint64_t energy;         // Sum of squares (64-bit: a loud block overflows int32)
+  uint16_t peak;           // Max |sample| (0-32768)
+  uint16_t zeroCrossings;  // Sign changes between consecutive samples
+  int16_t rms;             // sqrt(energy / count), saturated to 32767
+  size_t count;
+
+  AudioBlockStats() : energy(0), peak(0), zeroCrossings(0), rms(0), count(0) {}
+};
+
+// ============================================================================
+// ADPCM ENCODER ENGINES
+// ============================================================================
+
+enum ADPCMEncoderEngine {
+  ADPCM_ENCODER_REFERENCE,  // Straight IMA reference loop (compare/subtract per bit)
+  ADPCM_ENCODER_TABLE       // Table-driven, branch-free quantizer (bit-exact with reference)
+};
+
 // ============================================================================
 // ADPCM CODEC CLASS
 // ============================================================================
@@ -50,6 +74,23 @@ public:
    */
   size_t encode(const int16_t* pcmSamples, size_t numSamples, uint8_t* adpcmOutput);
 
+  /**
+   * Fused streaming kernel: encode like encode() (table engine, bit-exact)
+   * and gather energy, peak and zero crossings in the same pass, so each
+   * block is read from memory once
+   * @param stats Filled with the statistics of pcmSamples
+   * @return Number of bytes written to adpcmOutput
+   */
+  size_t encodeWithStats(const int16_t* pcmSamples, size_t numSamples, uint8_t* adpcmOutput,
+                         AudioBlockStats& stats);
+
+  /**
+   * Select the encode() implementation (default: AUDIO_ADPCM_ENCODER_ENGINE)
+   * Both engines produce identical output and state.
+   */
+  void setEncoderEngine(ADPCMEncoderEngine engine) { encoderEngine = engine; }
+  ADPCMEncoderEngine getEncoderEngine() const { return encoderEngine; }
+
   /**
    * Get current encoder state (for header transmission)
    */
@@ -60,11 +101,54 @@ public:
    */
   void setState(int16_t predictedSample, int16_t stepIndex);
 
+  // Decoder functions
+  void resetDecoder();
+
+  /**
+   * Decode packed 4-bit ADPCM codes to 16-bit PCM samples
+   * @param adpcmInput Input ADPCM codes (low nibble first, as produced by encode())
+   * @param numSamples Number of samples to decode ((numSamples+1)/2 input bytes)
+   * @param pcmOutput Output buffer for PCM samples
+   * @return Number of samples written to pcmOutput
+   */
+  size_t decode(const uint8_t* adpcmInput, size_t numSamples, int16_t* pcmOutput);
+
+  /**
+   * Get/set decoder state (e.g. to resync from a transmitted header)
+   */
+  void getDecoderState(int16_t& predictedSample, int16_t& stepIndex);
+  void setDecoderState(int16_t predictedSample, int16_t stepIndex);
+
+  /**
+   * Shared IMA tables (for decoders outside this class, e.g. the gateway's
+   * multi-stream decoder, so every implementation uses the same values)
+   */
+  static const int16_t* getStepSizeTable() { return stepSizeTable; }
+  static const int8_t* getIndexTable() { return indexTable; }
+
 private:
   ADPCMState encoderState;
+  ADPCMState decoderState;
+  ADPCMEncoderEngine encoderEngine;
 
-  // Core ADPCM encoding algorithm
+  // Core ADPCM algorithms
   uint8_t encodeSample(int16_t sample);
+  int16_t decodeSample(uint8_t code);
+
+  // Encoder engines
+  size_t encodeReference(const int16_t* pcmSamples, size_t numSamples, uint8_t* adpcmOutput);
+  size_t encodeTable(const int16_t* pcmSamples, size_t numSamples, uint8_t* adpcmOutput);
+  static uint32_t encodeSampleTable(int32_t sample, int32_t& predicted, int32_t& index);
+
+  // Per-step-index tables for the table engine (built once, kept in DRAM)
+  // quantTable[i]  = {step, step >> 1, step >> 2} comparison thresholds
+  // deltaTable[i]  = reconstructed |difference| for each 3-bit magnitude
+  // nextIndexTable[i] = clamped step index after each 3-bit magnitude
+  static int16_t quantTable[89][3];
+  static uint16_t deltaTable[89][8];
+  static uint8_t nextIndexTable[89][8];
+  static bool tablesBuilt;
+  static void buildTables();
 
   // IMA ADPCM step size table (89 entries, index 0-88)
   static const int16_t stepSizeTable[89];
@@ -84,8 +168,13 @@ private:
 bool detectVoiceActivity(const int16_t* samples, size_t count, int16_t threshold = 1500);
 
 /**
- * Calculate RMS amplitude of audio samples
+ * Calculate RMS amplitude of audio samples (64-bit accumulation, saturates at 32767)
  */
 int16_t calculateRMS(const int16_t* samples, size_t count);
 
+/**
+ * RMS from a sum of squares over count samples (saturates at 32767)
+ */
+int16_t rmsFromEnergy(uint64_t energy, size_t count);
+
 #endif // ADPCM_CODEC_H
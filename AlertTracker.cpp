@@ -0,0 +1,235 @@
+/*
+ * Alert Tracker Implementation
+ */
+
+#include "AlertTracker.h"
+#include "Hal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+AlertTracker::AlertTracker()
+  : sender(nullptr),
+    senderContext(nullptr),
+    bootId(0),
+    count(0),
+    tracked(0),
+    acknowledged(0),
+    retransmissions(0),
+    unknownAcks(0),
+    givenUp(0) {
+  memset(pending, 0, sizeof(pending));
+  latency.reset();
+}
+
+bool AlertTracker::begin(uint16_t bootId) {
+  // Without the flash log every boot would restart at #1 under the same
+  // id: a random epoch instead (the receiver only needs it to change)
+  while (bootId == 0) bootId = (uint16_t)hal::random32();
+  this->bootId = bootId;
+  return acks.create(ALERT_ACK_QUEUE, sizeof(uint32_t));
+}
+
+void AlertTracker::setSender(AlertSender sender, void* context) {
+  this->sender = sender;
+  senderContext = context;
+}
+
+// ============================================================================
+// SENDING
+// ============================================================================
+
+bool AlertTracker::send(const uint8_t* alert, size_t length, uint32_t enqueuedMs) {
+  // A free slot, or the oldest alert (given up: newer alerts matter more)
+  PendingAlert* slot = &pending[0];
+  for (size_t i = 0; i < ALERT_ACK_SLOTS; i++) {
+    if (pending[i].sequence == 0) {
+      slot = &pending[i];
+      break;
+    }
+    if ((int32_t)(pending[i].enqueuedMs - slot->enqueuedMs) < 0) slot = &pending[i];
+  }
+  if (slot->sequence != 0) {
+    givenUp++;
+    Serial.print(F("[AlertTracker] WARNING: No ACK slot - giving up alert #"));
+    Serial.println(slot->sequence);
+  }
+
+  if (++count == 0) count = 1;
+  slot->sequence = ((uint32_t)bootId << 16) | count;
+  slot->enqueuedMs = enqueuedMs;
+  slot->attempts = 1;
+  length = min(length, (size_t)(MAX_ALERT_SIZE - 1));
+  memcpy(slot->record, alert, length);
+  int suffix = snprintf((char*)slot->record + length, ALERT_RECORD_MAX_SIZE - length, "#%lu",
+                        (unsigned long)slot->sequence);
+  slot->length = (uint8_t)(length + suffix);
+  slot->sentMs = millis();
+  tracked++;
+
+  return sender && sender(senderContext, slot->record, slot->length);
+}
+
+bool AlertTracker::queueAck(uint32_t sequence) {
+  return acks.send(&sequence);
+}
+
+size_t AlertTracker::poll(bool retransmit) {
+  uint32_t now = millis();
+
+  uint32_t sequence;
+  while (acks.receive(&sequence)) {
+    bool known = false;
+    for (size_t i = 0; i < ALERT_ACK_SLOTS; i++) {
+      if (sequence != 0 && pending[i].sequence == sequence) {
+        latency.record(now - pending[i].enqueuedMs);
+        pending[i].sequence = 0;
+        acknowledged++;
+        known = true;
+        break;
+      }
+    }
+    if (!known) unknownAcks++;  // ACK of a retransmission, or of an alert given up
+  }
+  if (!retransmit || !sender) return 0;
+
+  size_t bytes = 0;
+  for (size_t i = 0; i < ALERT_ACK_SLOTS; i++) {
+    PendingAlert& alert = pending[i];
+    if (alert.sequence == 0 || now - alert.sentMs < backoffMs(alert.attempts)) continue;
+    if (alert.attempts >= ALERT_ACK_MAX_ATTEMPTS) {
+      givenUp++;
+      Serial.print(F("[AlertTracker] WARNING: No ACK after "));
+      Serial.print(alert.attempts);
+      Serial.print(F(" sends - giving up alert #"));
+      Serial.println(alert.sequence);
+      alert.sequence = 0;
+      continue;
+    }
+    alert.attempts++;
+    alert.sentMs = now;
+    retransmissions++;
+    sender(senderContext, alert.record, alert.length);
+    bytes += alert.length;
+  }
+  return bytes;
+}
+
+void AlertTracker::restart() {
+  // The first retry after the reconnect goes at the first timeout
+  uint32_t now = millis();
+  for (size_t i = 0; i < ALERT_ACK_SLOTS; i++) {
+    if (pending[i].sequence == 0) continue;
+    pending[i].attempts = 1;
+    pending[i].sentMs = now;
+  }
+}
+
+uint32_t AlertTracker::backoffMs(uint8_t attempts) const {
+  uint32_t backoff = ALERT_ACK_TIMEOUT_MS;
+  for (uint8_t i = 1; i < attempts && backoff < ALERT_ACK_MAX_BACKOFF_MS; i++) backoff *= 2;
+  return min(backoff, (uint32_t)ALERT_ACK_MAX_BACKOFF_MS);
+}
+
+size_t AlertTracker::getPendingCount() const {
+  size_t count = 0;
+  for (size_t i = 0; i < ALERT_ACK_SLOTS; i++) {
+    if (pending[i].sequence != 0) count++;
+  }
+  return count;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void AlertTracker::printStatistics() {
+  Serial.print(F("  Alert ACKs: "));
+  Serial.print(acknowledged);
+  Serial.print(F("/"));
+  Serial.print(tracked);
+  Serial.print(F(" acknowledged, "));
+  Serial.print(getPendingCount());
+  Serial.print(F(" pending, "));
+  Serial.print(retransmissions);
+  Serial.print(F(" retransmissions, "));
+  Serial.print(givenUp);
+  Serial.print(F(" given up, "));
+  Serial.print(unknownAcks);
+  Serial.println(F(" unknown ACKs"));
+  if (latency.total > 0) {
+    Serial.print(F("  Alert latency (enqueue -> ACK) p50 / p95 / p99 / max: "));
+    Serial.print(latency.percentile(50));
+    Serial.print(F(" / "));
+    Serial.print(latency.percentile(95));
+    Serial.print(F(" / "));
+    Serial.print(latency.percentile(99));
+    Serial.print(F(" / "));
+    Serial.print(latency.maxAgeMs);
+    Serial.println(F(" ms"));
+  }
+}
+
+// ============================================================================
+// ALERT RECEIVER
+// ============================================================================
+
+AlertReceiver::AlertReceiver()
+  : highest(0),
+    seen(0),
+    previousBoot(0),
+    duplicates(0) {
+}
+
+bool AlertReceiver::receive(const uint8_t* data, size_t length, uint32_t& sequence, size_t& alertLength) {
+  // "<alert>#<sequence>": the last '#' followed by digits only
+  sequence = 0;
+  alertLength = length;
+  size_t mark = length;
+  while (mark > 0 && data[mark - 1] >= '0' && data[mark - 1] <= '9') mark--;
+  if (mark == 0 || mark == length || data[mark - 1] != '#') return true;  // Plain alert
+  for (size_t i = mark; i < length; i++) sequence = sequence * 10 + (data[i] - '0');
+  alertLength = mark - 1;
+
+  uint16_t boot = (uint16_t)(sequence >> 16);
+  if (highest == 0 || boot != (uint16_t)(highest >> 16)) {
+    if (highest != 0 && boot == previousBoot) {
+      // Late retransmission from the boot before: ACKed, not delivered
+      duplicates++;
+      return false;
+    }
+    // Device restarted (boot ids are not ordered without the flash log,
+    // AlertTracker::begin()): a new window
+    if (highest != 0) previousBoot = (uint16_t)(highest >> 16);
+    highest = sequence;
+    seen = 1;
+    return true;
+  }
+  if (sequence > highest) {
+    uint32_t shift = sequence - highest;
+    seen = (shift >= 32) ? 1 : (seen << shift) | 1;
+    highest = sequence;
+    return true;
+  }
+  if (highest - sequence >= 32) {
+    // Older than the window: a late retransmission, ACKed but not delivered
+    duplicates++;
+    return false;
+  }
+  uint32_t bit = 1UL << (highest - sequence);
+  if (seen & bit) {
+    duplicates++;
+    return false;
+  }
+  seen |= bit;
+  return true;
+}
+
+size_t AlertReceiver::formatAck(uint32_t sequence, char* command, size_t size) {
+  int length = snprintf(command, size, "ACK:%lu", (unsigned long)sequence);
+  return (length > 0) ? min((size_t)length, size - 1) : 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * Alert Tracker for ESP32-C3 BEACON
+ * Acknowledged delivery of alerts: sequence numbers, ACKs from the client,
+ * retransmission with backoff
+ *
+ * A notification that the stack accepted may still never reach the app
+ * (phone backgrounded, link lost before the air, app busy). With
+ * "ALERT_ACK:ON" on the control characteristic, BLEManager sends every
+ * alert as a record
+ *   "<alert>#<sequence>"      e.g. "FALL_DETECTED#65538"
+ * on the alert characteristic (or as the TLV_TYPE_ALERT value in TLV mode)
+ * and keeps it here until the client writes "ACK:<sequence>". An alert
+ * without an ACK is sent again after ALERT_ACK_TIMEOUT_MS, doubling up to
+ * ALERT_ACK_MAX_BACKOFF_MS, at most ALERT_ACK_MAX_ATTEMPTS times. ACK mode
+ * lasts until "ALERT_ACK:OFF" (disconnects included): alerts still
+ * unacknowledged at a disconnect are sent again after the reconnect.
+ * Without the command alerts stay plain strings (apps that match on the
+ * exact text).
+ *
+ * Sequence: boot id (high 16 bits, FlashLog::getBootId(): a boot record is
+ * written at every mount, so it grows across reboots; a random non-zero
+ * epoch without the flash log) and a per-boot count (low 16 bits), so a
+ * receiver can drop retransmissions it has already seen (AlertReceiver)
+ * without a restart looking like a replay: a new boot id starts a new
+ * window.
+ *
+ * ACKs arrive in the NimBLE host task (queueAck()) and are applied in
+ * loop() (poll()) through a lock-free ring; everything else runs in loop().
+ */
+
+#ifndef ALERT_TRACKER_H
+#define ALERT_TRACKER_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "DataScheduler.h"
+#include "SpscRing.h"
+
+#define ALERT_ACK_SLOTS 8          // Alerts awaiting an ACK (the oldest is given up beyond)
+#define ALERT_ACK_QUEUE 16         // ACKs between the NimBLE task and loop()
+#define ALERT_RECORD_MAX_SIZE (MAX_ALERT_SIZE + 12)  // "<alert>#<sequence>"
+
+/**
+ * Notify one alert record
+ * @return false if the notification failed
+ */
+typedef bool (*AlertSender)(void* context, const uint8_t* record, size_t length);
+
+// ============================================================================
+// ALERT TRACKER CLASS (sender)
+// ============================================================================
+
+class AlertTracker {
+public:
+  AlertTracker();
+
+  /**
+   * Allocate the ACK ring; boot id from the flash log (0 without a data
+   * partition: a random epoch is used)
+   */
+  bool begin(uint16_t bootId);
+  void setSender(AlertSender sender, void* context);
+
+  /**
+   * Number, send and keep one dequeued alert
+   * @param enqueuedMs millis() of enqueueAlert() (latency to the ACK)
+   * @return false if the first notification failed (retransmitted later)
+   */
+  bool send(const uint8_t* alert, size_t length, uint32_t enqueuedMs);
+
+  /**
+   * Client ACK (NimBLE task)
+   * @return false if the ACK ring is full (the alert is sent again and
+   *         ACKed again)
+   */
+  bool queueAck(uint32_t sequence);
+
+  /**
+   * loop(): apply queued ACKs, then retransmit alerts that are due
+   * @param retransmit false = apply ACKs only (link not ready)
+   * @return Bytes retransmitted (for the link budget)
+   */
+  size_t poll(bool retransmit);
+
+  /**
+   * Link back (or ACK mode just enabled): alerts in flight are sent again
+   * from the first attempt
+   */
+  void restart();
+
+  size_t getPendingCount() const;
+
+  // Statistics
+  uint32_t getTracked() const { return tracked; }
+  uint32_t getAcknowledged() const { return acknowledged; }
+  uint32_t getRetransmissions() const { return retransmissions; }
+  uint32_t getUnknownAcks() const { return unknownAcks; }  // Duplicate or stale
+  uint32_t getGivenUp() const { return givenUp; }
+  const QueueAgeHistogram& getLatency() const { return latency; }  // enqueueAlert() -> ACK, ms
+  void printStatistics();
+
+private:
+  struct PendingAlert {
+    uint32_t sequence;     // 0 = free slot
+    uint32_t enqueuedMs;
+    uint32_t sentMs;       // Last send
+    uint8_t attempts;
+    uint8_t length;        // Record bytes
+    uint8_t record[ALERT_RECORD_MAX_SIZE];
+  };
+
+  AlertSender sender;
+  void* senderContext;
+  SpscRing acks;           // uint32_t sequences, NimBLE task -> loop()
+  PendingAlert pending[ALERT_ACK_SLOTS];
+  uint16_t bootId;
+  uint16_t count;          // Low half of the next sequence
+
+  uint32_t tracked;
+  uint32_t acknowledged;
+  uint32_t retransmissions;
+  uint32_t unknownAcks;
+  uint32_t givenUp;         // Max attempts reached, or pushed out by newer alerts
+  QueueAgeHistogram latency;
+
+  uint32_t backoffMs(uint8_t attempts) const;
+};
+
+// ============================================================================
+// ALERT RECEIVER CLASS (reference receiver)
+// ============================================================================
+
+/**
+ * Client side of the protocol (host tools; mirrors what the phone app
+ * needs): splits a record, suppresses retransmissions already delivered
+ * and builds the ACK. Every record is ACKed, duplicates too (the first ACK
+ * may be the one that was lost).
+ */
+class AlertReceiver {
+public:
+  AlertReceiver();
+
+  /**
+   * Parse one alert record
+   * @param sequence Output: the record's sequence (0 for a plain alert)
+   * @param alertLength Output: length of the alert text (data[0..])
+   * @return true to deliver it (new, or a plain alert without sequence),
+   *         false for a duplicate, one older than the 32-sequence window
+   *         or one from the boot before the current one
+   */
+  bool receive(const uint8_t* data, size_t length, uint32_t& sequence, size_t& alertLength);
+
+  /**
+   * "ACK:<sequence>" for the control characteristic
+   * @return Command length (written with a terminator)
+   */
+  static size_t formatAck(uint32_t sequence, char* command, size_t size);
+
+  uint32_t getDuplicates() const { return duplicates; }  // Duplicate or stale
+
+private:
+  uint32_t highest;  // Newest sequence delivered (0 = none)
+  uint32_t seen;     // Bit n: highest - n delivered
+  uint16_t previousBoot;  // Boot id before highest's (0 = none)
+  uint32_t duplicates;
+};
+
+#endif // ALERT_TRACKER_H
@@ -0,0 +1,514 @@
+/*
+ * Audio Codec Modes Implementation
+ * N-bit IMA ADPCM, half-band decimation and G.722-style sub-band coding
+ */
+
+#include "AudioCodec.h"
+
+// QMF coefficients (G.722); the two polyphase branches use them forward
+// and reversed, giving the 24-tap prototype
+static const int16_t QMF_COEFFS[12] = {
+    3, -11, 12, 32, -210, 951, 3876, -805, 362, -156, 53, -11
+};
+static const size_t QMF_TAPS = 24;  // Delay line: 22 history + current pair
+static const size_t QMF_HISTORY = QMF_TAPS - 2;
+static const size_t NARROW_CHUNK = 64;  // IMA4_8K decimation scratch (even: whole bytes per chunk)
+
+// Half-band odd taps (Q15, centre tap 16384): 2 * sum = 16384, unity DC gain
+const int16_t HalfbandDecimator::COEFFS[HalfbandDecimator::PHASE_LENGTH / 2] = {
+    10345, -3210, 1665, -947, 532, -278, 125, -40
+};
+
+// Reduced IMA index tables, indexed by code magnitude (sign bit stripped)
+static const int8_t INDEX_TABLE_2BIT[2] = {-1, 2};
+static const int8_t INDEX_TABLE_3BIT[4] = {-1, -1, 2, 4};
+static const int8_t INDEX_TABLE_4BIT[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+// ============================================================================
+// MODE HELPERS
+// ============================================================================
+
+bool audioCodecModeValid(uint8_t mode) {
+  return mode >= AUDIO_CODEC_IMA4_16K && mode <= AUDIO_CODEC_SUBBAND_16K;
+}
+
+uint8_t audioCodecDecimation(AudioCodecMode mode) {
+  return (mode == AUDIO_CODEC_IMA4_8K || mode == AUDIO_CODEC_IMA2_8K) ? 2 : 1;
+}
+
+static uint8_t codeBits(AudioCodecMode mode) {
+  switch (mode) {
+    case AUDIO_CODEC_IMA3_16K: return 3;
+    case AUDIO_CODEC_IMA2_16K:
+    case AUDIO_CODEC_IMA2_8K: return 2;
+    default: return 4;
+  }
+}
+
+static const int8_t* indexTableFor(uint8_t bits) {
+  if (bits == 2) return INDEX_TABLE_2BIT;
+  if (bits == 3) return INDEX_TABLE_3BIT;
+  return INDEX_TABLE_4BIT;
+}
+
+uint32_t audioCodecBitrate(AudioCodecMode mode) {
+  if (mode == AUDIO_CODEC_SUBBAND_16K) return 8000UL * (4 + 2);
+  return (16000UL / audioCodecDecimation(mode)) * codeBits(mode);
+}
+
+size_t audioCodecPayloadBytes(AudioCodecMode mode, size_t codedSamples) {
+  if (mode == AUDIO_CODEC_SUBBAND_16K) {
+    // Upper-band state (3 bytes), then 4-bit low-band and 2-bit high-band codes
+    size_t pairs = codedSamples / 2;
+    return 3 + (pairs * 4 + 7) / 8 + (pairs * 2 + 7) / 8;
+  }
+  return (codedSamples * codeBits(mode) + 7) / 8;
+}
+
+static const char* const MODE_NAMES[] = {
+    "IMA4_16K", "IMA3_16K", "IMA2_16K", "IMA4_8K", "IMA2_8K", "SUBBAND_16K"
+};
+
+const char* audioCodecName(AudioCodecMode mode) {
+  if (!audioCodecModeValid(mode)) return "UNKNOWN";
+  return MODE_NAMES[mode - AUDIO_CODEC_IMA4_16K];
+}
+
+AudioCodecMode audioCodecReducedRateMode(AudioCodecMode mode) {
+  switch (mode) {
+    case AUDIO_CODEC_IMA4_16K:
+    case AUDIO_CODEC_SUBBAND_16K: return AUDIO_CODEC_IMA4_8K;
+    case AUDIO_CODEC_IMA3_16K:
+    case AUDIO_CODEC_IMA2_16K: return AUDIO_CODEC_IMA2_8K;
+    default: return mode;
+  }
+}
+
+bool audioCodecModeFromName(const char* name, AudioCodecMode& mode) {
+  for (uint8_t i = 0; i < sizeof(MODE_NAMES) / sizeof(MODE_NAMES[0]); i++) {
+    if (strcmp(name, MODE_NAMES[i]) == 0) {
+      mode = (AudioCodecMode)(AUDIO_CODEC_IMA4_16K + i);
+      return true;
+    }
+  }
+  return false;
+}
+
+// ============================================================================
+// N-BIT IMA CORE
+// ============================================================================
+
+static inline void imaUpdate(ADPCMState& state, int32_t delta, int8_t indexAdjust) {
+  int32_t predicted = state.predictedSample + delta;
+  if (predicted > 32767) predicted = 32767;
+  if (predicted < -32768) predicted = -32768;
+  state.predictedSample = (int16_t)predicted;
+
+  int32_t index = state.stepIndex + indexAdjust;
+  if (index < 0) index = 0;
+  if (index > 88) index = 88;
+  state.stepIndex = (int16_t)index;
+}
+
+// Same successive approximation as ADPCMCodec::encodeSample() with
+// (bits - 1) magnitude bits; bits == 4 is bit-exact with standard IMA
+static inline uint32_t imaEncodeSample(int32_t sample, ADPCMState& state, uint8_t bits, const int8_t* indexTable) {
+  int32_t stepSize = ADPCMCodec::getStepSizeTable()[state.stepIndex];
+  int32_t diff = sample - state.predictedSample;
+  uint32_t sign = 0;
+  if (diff < 0) {
+    sign = 1u << (bits - 1);
+    diff = -diff;
+  }
+
+  uint32_t magnitude = 0;
+  int32_t delta = stepSize >> (bits - 1);
+  for (int bit = bits - 2; bit >= 0; bit--) {
+    int32_t threshold = stepSize >> (bits - 2 - bit);
+    if (diff >= threshold) {
+      magnitude |= 1u << bit;
+      diff -= threshold;
+      delta += threshold;
+    }
+  }
+
+  imaUpdate(state, sign ? -delta : delta, indexTable[magnitude]);
+  return sign | magnitude;
+}
+
+static inline int16_t imaDecodeSample(uint32_t code, ADPCMState& state, uint8_t bits, const int8_t* indexTable) {
+  int32_t stepSize = ADPCMCodec::getStepSizeTable()[state.stepIndex];
+  uint32_t signBit = 1u << (bits - 1);
+  uint32_t magnitude = code & (signBit - 1);
+
+  int32_t delta = stepSize >> (bits - 1);
+  for (int bit = bits - 2; bit >= 0; bit--) {
+    if (magnitude & (1u << bit)) delta += stepSize >> (bits - 2 - bit);
+  }
+
+  imaUpdate(state, (code & signBit) ? -delta : delta, indexTable[magnitude]);
+  return state.predictedSample;
+}
+
+// LSB-first code packing (4-bit codes land low nibble first, as in ADPCMCodec)
+struct BitWriter {
+  uint8_t* output;
+  size_t bytes;
+  uint32_t accumulator;
+  uint8_t pending;
+
+  explicit BitWriter(uint8_t* out) : output(out), bytes(0), accumulator(0), pending(0) {}
+
+  inline void put(uint32_t code, uint8_t bits) {
+    accumulator |= code << pending;
+    pending += bits;
+    while (pending >= 8) {
+      output[bytes++] = (uint8_t)accumulator;
+      accumulator >>= 8;
+      pending -= 8;
+    }
+  }
+
+  size_t flush() {
+    if (pending > 0) output[bytes++] = (uint8_t)accumulator;
+    accumulator = 0;
+    pending = 0;
+    return bytes;
+  }
+};
+
+struct BitReader {
+  const uint8_t* input;
+  uint32_t accumulator;
+  uint8_t available;
+
+  explicit BitReader(const uint8_t* in) : input(in), accumulator(0), available(0) {}
+
+  inline uint32_t get(uint8_t bits) {
+    if (available < bits) {
+      accumulator |= (uint32_t)(*input++) << available;
+      available += 8;
+    }
+    uint32_t code = accumulator & ((1u << bits) - 1);
+    accumulator >>= bits;
+    available -= bits;
+    return code;
+  }
+};
+
+// Energy / peak / zero crossings of the 16 kHz input, gathered in the encode loops
+struct BlockStatsAccumulator {
+  uint64_t energy;
+  uint32_t peak;
+  uint32_t zeroCrossings;
+  int32_t previous;
+
+  explicit BlockStatsAccumulator(int32_t first) : energy(0), peak(0), zeroCrossings(0), previous(first) {}
+
+  inline void add(int32_t sample) {
+    energy += (uint32_t)(sample * sample);
+    uint32_t magnitude = (uint32_t)((sample ^ (sample >> 31)) - (sample >> 31));
+    if (magnitude > peak) peak = magnitude;
+    zeroCrossings += (uint32_t)(previous ^ sample) >> 31;
+    previous = sample;
+  }
+
+  void finish(AudioBlockStats& stats, size_t count) {
+    stats.energy = energy;
+    stats.peak = (uint16_t)peak;
+    stats.zeroCrossings = (uint16_t)zeroCrossings;
+    stats.count = count;
+    stats.rms = rmsFromEnergy(energy, count);
+  }
+};
+
+static inline int16_t clamp16(int32_t value) {
+  if (value > 32767) return 32767;
+  if (value < -32768) return -32768;
+  return (int16_t)value;
+}
+
+// ============================================================================
+// HALF-BAND DECIMATOR
+// ============================================================================
+
+HalfbandDecimator::HalfbandDecimator() {
+  reset();
+}
+
+void HalfbandDecimator::reset() {
+  memset(oddPhase, 0, sizeof(oddPhase));
+  memset(centrePhase, 0, sizeof(centrePhase));
+  position = 0;
+  centrePosition = 0;
+}
+
+void HalfbandDecimator::prime(const int16_t* recent, size_t numSamples) {
+  reset();
+  size_t count = min(numSamples, (size_t)HALFBAND_HISTORY) & ~(size_t)1;
+  const int16_t* input = recent + numSamples - count;
+  for (size_t i = 0; i < count; i += 2) {
+    push(input[i], input[i + 1]);
+  }
+}
+
+size_t HalfbandDecimator::process(const int16_t* input, size_t numSamples, int16_t* output) {
+  size_t pairs = numSamples / 2;
+  for (size_t i = 0; i < pairs; i++) {
+    output[i] = push(input[2 * i], input[2 * i + 1]);
+  }
+  return pairs;
+}
+
+// ============================================================================
+// AUDIO CODEC
+// ============================================================================
+
+AudioCodec::AudioCodec() : mode(AUDIO_CODEC_IMA4_16K), reducedRate(false), lastDecodeMode(AUDIO_CODEC_IMA4_16K) {
+  resetEncoder();
+  resetDecoder();
+}
+
+void AudioCodec::setMode(AudioCodecMode newMode) {
+  if (!audioCodecModeValid(newMode) || newMode == mode) return;
+  mode = newMode;
+  resetEncoder();
+}
+
+void AudioCodec::resetEncoder() {
+  encoderLow.reset();
+  encoderHigh.reset();
+  decimator.reset();
+  memset(analysisHistory, 0, sizeof(analysisHistory));
+  memset(inputHistory, 0, sizeof(inputHistory));
+}
+
+void AudioCodec::setReducedRate(bool reduced) {
+  if (reduced == reducedRate) return;
+  AudioCodecMode from = getFrameMode();
+  reducedRate = reduced;
+  AudioCodecMode to = getFrameMode();
+  if (to == from) return;
+
+  // The QMF low band runs at half scale: rescale the shared predictor and
+  // step (7 step-table entries ~ x2) so the primary band stays in tune
+  if (from == AUDIO_CODEC_SUBBAND_16K || to == AUDIO_CODEC_SUBBAND_16K) {
+    bool toSubband = (to == AUDIO_CODEC_SUBBAND_16K);
+    int32_t index = encoderLow.stepIndex + (toSubband ? -7 : 7);
+    encoderLow.predictedSample = toSubband ? (int16_t)(encoderLow.predictedSample / 2)
+                                           : clamp16(2 * (int32_t)encoderLow.predictedSample);
+    encoderLow.stepIndex = (int16_t)max((int32_t)0, min((int32_t)88, index));
+  }
+
+  // Filters restart from the last input rather than from silence
+  if (audioCodecDecimation(to) == 2) {
+    decimator.prime(inputHistory, HALFBAND_HISTORY);
+  } else if (to == AUDIO_CODEC_SUBBAND_16K) {
+    memcpy(analysisHistory, inputHistory + HALFBAND_HISTORY - QMF_HISTORY, sizeof(analysisHistory));
+    encoderHigh.reset();  // Upper band idle at 8 kHz; its state is in the payload
+  }
+}
+
+void AudioCodec::rememberInput(const int16_t* pcmSamples, size_t numSamples) {
+  if (numSamples >= HALFBAND_HISTORY) {
+    memcpy(inputHistory, pcmSamples + numSamples - HALFBAND_HISTORY, sizeof(inputHistory));
+  } else {
+    memmove(inputHistory, inputHistory + numSamples, (HALFBAND_HISTORY - numSamples) * sizeof(int16_t));
+    memcpy(inputHistory + HALFBAND_HISTORY - numSamples, pcmSamples, numSamples * sizeof(int16_t));
+  }
+}
+
+void AudioCodec::resetDecoder() {
+  decoderHigh.reset();
+  memset(synthesisHistory, 0, sizeof(synthesisHistory));
+}
+
+void AudioCodec::getEncoderState(int16_t& predictedSample, int16_t& stepIndex) {
+  predictedSample = encoderLow.predictedSample;
+  stepIndex = encoderLow.stepIndex;
+}
+
+size_t AudioCodec::encode(const int16_t* pcmSamples, size_t numSamples, uint8_t* payload,
+                          size_t& codedSamples, AudioBlockStats& stats) {
+  AudioCodecMode frameMode = getFrameMode();
+  size_t bytes;
+
+  if (frameMode == AUDIO_CODEC_IMA4_16K) {
+    // Standard IMA: table-driven fused kernel
+    ima4.setState(encoderLow.predictedSample, encoderLow.stepIndex);
+    bytes = ima4.encodeWithStats(pcmSamples, numSamples, payload, stats);
+    ima4.getState(encoderLow.predictedSample, encoderLow.stepIndex);
+    codedSamples = numSamples;
+  } else if (frameMode == AUDIO_CODEC_IMA4_8K) {
+    // Decimate into a small scratch (stats from the 16 kHz input), then the
+    // table-driven kernel codes half as many samples as IMA4_16K
+    size_t pairs = numSamples / 2;
+    int16_t narrow[NARROW_CHUNK];
+    BlockStatsAccumulator accumulator(numSamples > 0 ? pcmSamples[0] : 0);
+    ima4.setState(encoderLow.predictedSample, encoderLow.stepIndex);
+    bytes = 0;
+    for (size_t done = 0; done < pairs; done += NARROW_CHUNK) {
+      size_t count = min(pairs - done, NARROW_CHUNK);
+      for (size_t i = 0; i < count; i++) {
+        int16_t first = pcmSamples[2 * (done + i)];
+        int16_t second = pcmSamples[2 * (done + i) + 1];
+        accumulator.add(first);
+        accumulator.add(second);
+        narrow[i] = decimator.push(first, second);
+      }
+      bytes += ima4.encode(narrow, count, payload + bytes);
+    }
+    ima4.getState(encoderLow.predictedSample, encoderLow.stepIndex);
+    codedSamples = pairs;
+    accumulator.finish(stats, pairs * 2);
+  } else if (frameMode == AUDIO_CODEC_SUBBAND_16K) {
+    codedSamples = numSamples & ~(size_t)1;
+    bytes = encodeSubband(pcmSamples, codedSamples, payload, stats);
+  } else {
+    uint8_t bits = codeBits(frameMode);
+    const int8_t* indexTable = indexTableFor(bits);
+    BlockStatsAccumulator accumulator(numSamples > 0 ? pcmSamples[0] : 0);
+    BitWriter writer(payload);
+
+    if (audioCodecDecimation(frameMode) == 2) {
+      // Narrowband (2-bit): decimate each pair and encode in the same pass
+      size_t pairs = numSamples / 2;
+      for (size_t i = 0; i < pairs; i++) {
+        int16_t first = pcmSamples[2 * i];
+        int16_t second = pcmSamples[2 * i + 1];
+        accumulator.add(first);
+        accumulator.add(second);
+        writer.put(imaEncodeSample(decimator.push(first, second), encoderLow, bits, indexTable), bits);
+      }
+      codedSamples = pairs;
+      accumulator.finish(stats, pairs * 2);
+    } else {
+      for (size_t i = 0; i < numSamples; i++) {
+        accumulator.add(pcmSamples[i]);
+        writer.put(imaEncodeSample(pcmSamples[i], encoderLow, bits, indexTable), bits);
+      }
+      codedSamples = numSamples;
+      accumulator.finish(stats, numSamples);
+    }
+    bytes = writer.flush();
+  }
+
+  rememberInput(pcmSamples, numSamples);
+  return bytes;
+}
+
+size_t AudioCodec::encodeSubband(const int16_t* pcmSamples, size_t numSamples, uint8_t* payload,
+                                 AudioBlockStats& stats) {
+  size_t pairs = numSamples / 2;
+  size_t lowBytes = (pairs * 4 + 7) / 8;
+
+  // Upper-band state before this block (the header carries the lower band)
+  payload[0] = (uint16_t)encoderHigh.predictedSample & 0xFF;
+  payload[1] = (uint16_t)encoderHigh.predictedSample >> 8;
+  payload[2] = (uint8_t)encoderHigh.stepIndex;
+
+  BitWriter lowWriter(payload + 3);
+  BitWriter highWriter(payload + 3 + lowBytes);
+  BlockStatsAccumulator accumulator(numSamples > 0 ? pcmSamples[0] : 0);
+
+  // Delay line: 22 history samples + the current pair
+  int16_t window[QMF_TAPS];
+  memcpy(window, analysisHistory, sizeof(analysisHistory));
+
+  for (size_t i = 0; i < pairs; i++) {
+    int16_t first = pcmSamples[2 * i];
+    int16_t second = pcmSamples[2 * i + 1];
+    accumulator.add(first);
+    accumulator.add(second);
+    window[QMF_TAPS - 2] = first;
+    window[QMF_TAPS - 1] = second;
+
+    // Polyphase QMF analysis (as G.722 transmit QMF)
+    int32_t sumEven = 0;
+    int32_t sumOdd = 0;
+    for (size_t k = 0; k < 12; k++) {
+      sumOdd += window[2 * k] * QMF_COEFFS[k];
+      sumEven += window[2 * k + 1] * QMF_COEFFS[11 - k];
+    }
+    int16_t low = clamp16((sumEven + sumOdd) >> 14);
+    int16_t high = clamp16((sumEven - sumOdd) >> 14);
+
+    lowWriter.put(imaEncodeSample(low, encoderLow, 4, INDEX_TABLE_4BIT), 4);
+    highWriter.put(imaEncodeSample(high, encoderHigh, 2, INDEX_TABLE_2BIT), 2);
+
+    memmove(window, window + 2, (QMF_TAPS - 2) * sizeof(int16_t));
+  }
+
+  memcpy(analysisHistory, window, sizeof(analysisHistory));
+  accumulator.finish(stats, numSamples);
+  return 3 + lowWriter.flush() + highWriter.flush();
+}
+
+size_t AudioCodec::decode(AudioCodecMode frameMode, int16_t predictedSample, int16_t stepIndex,
+                          const uint8_t* payload, size_t codedSamples, int16_t* pcmOutput) {
+  if (!audioCodecModeValid(frameMode)) return 0;
+  if (stepIndex < 0 || stepIndex > 88) return 0;
+
+  // Filter memory from another mode would only add a transient
+  if (frameMode != lastDecodeMode) {
+    resetDecoder();
+    lastDecodeMode = frameMode;
+  }
+
+  if (frameMode == AUDIO_CODEC_IMA4_16K) {
+    ima4Decoder.setDecoderState(predictedSample, stepIndex);
+    return ima4Decoder.decode(payload, codedSamples, pcmOutput);
+  }
+
+  ADPCMState low;
+  low.predictedSample = predictedSample;
+  low.stepIndex = stepIndex;
+
+  if (frameMode == AUDIO_CODEC_SUBBAND_16K) {
+    return decodeSubband(payload, codedSamples, pcmOutput, low);
+  }
+
+  uint8_t bits = codeBits(frameMode);
+  const int8_t* indexTable = indexTableFor(bits);
+  BitReader reader(payload);
+  for (size_t i = 0; i < codedSamples; i++) {
+    pcmOutput[i] = imaDecodeSample(reader.get(bits), low, bits, indexTable);
+  }
+  return codedSamples;
+}
+
+size_t AudioCodec::decodeSubband(const uint8_t* payload, size_t codedSamples, int16_t* pcmOutput, ADPCMState& low) {
+  size_t pairs = codedSamples / 2;
+  size_t lowBytes = (pairs * 4 + 7) / 8;
+
+  decoderHigh.predictedSample = (int16_t)(payload[0] | (payload[1] << 8));
+  decoderHigh.stepIndex = min((int16_t)payload[2], (int16_t)88);
+
+  BitReader lowReader(payload + 3);
+  BitReader highReader(payload + 3 + lowBytes);
+
+  int32_t window[QMF_TAPS];
+  memcpy(window, synthesisHistory, sizeof(synthesisHistory));
+
+  for (size_t i = 0; i < pairs; i++) {
+    int32_t lowSample = imaDecodeSample(lowReader.get(4), low, 4, INDEX_TABLE_4BIT);
+    int32_t highSample = imaDecodeSample(highReader.get(2), decoderHigh, 2, INDEX_TABLE_2BIT);
+    window[QMF_TAPS - 2] = lowSample + highSample;
+    window[QMF_TAPS - 1] = lowSample - highSample;
+
+    // Polyphase QMF synthesis (as G.722 receive QMF)
+    int32_t first = 0;
+    int32_t second = 0;
+    for (size_t k = 0; k < 12; k++) {
+      second += window[2 * k] * QMF_COEFFS[k];
+      first += window[2 * k + 1] * QMF_COEFFS[11 - k];
+    }
+    pcmOutput[2 * i] = clamp16(first >> 11);
+    pcmOutput[2 * i + 1] = clamp16(second >> 11);
+
+    memmove(window, window + 2, (QMF_TAPS - 2) * sizeof(int32_t));
+  }
+
+  memcpy(synthesisHistory, window, sizeof(synthesisHistory));
+  return pairs * 2;
+}
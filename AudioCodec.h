@@ -0,0 +1,218 @@
+/*
+ * Audio Codec Modes for ESP32-C3 BEACON
+ * Runtime-selectable bitrate ladder on top of IMA ADPCM
+ *
+ * Mode               Rate    Bits  Bitrate   Notes
+ * IMA4_16K (0x01)    16 kHz  4     64 kbps   Standard IMA (ADPCMCodec, iOS-compatible)
+ * SUBBAND_16K (0x06) 16 kHz  4+2   48 kbps   G.722-style QMF: 0-4 kHz 4-bit, 4-8 kHz 2-bit
+ * IMA3_16K (0x02)    16 kHz  3     48 kbps
+ * IMA2_16K (0x03)    16 kHz  2     32 kbps
+ * IMA4_8K (0x04)     8 kHz   4     32 kbps   Narrowband (polyphase half-band decimator)
+ * IMA2_8K (0x05)     8 kHz   2     16 kbps
+ *
+ * The mode value is the AudioFrame format tag, so each packet tells the
+ * receiver how to decode it and at which rate. 2/3-bit IMA uses the standard step table with
+ * the usual reduced index tables; 4-bit codes are bit-exact with ADPCMCodec.
+ * Codes are packed LSB-first (for 4-bit: low nibble first).
+ */
+
+#ifndef AUDIO_CODEC_H
+#define AUDIO_CODEC_H
+
+#include <Arduino.h>
+#include "ADPCMCodec.h"
+
+// ============================================================================
+// CODEC MODES
+// ============================================================================
+
+enum AudioCodecMode {
+  AUDIO_CODEC_IMA4_16K = 0x01,
+  AUDIO_CODEC_IMA3_16K = 0x02,
+  AUDIO_CODEC_IMA2_16K = 0x03,
+  AUDIO_CODEC_IMA4_8K = 0x04,
+  AUDIO_CODEC_IMA2_8K = 0x05,
+  AUDIO_CODEC_SUBBAND_16K = 0x06
+};
+
+bool audioCodecModeValid(uint8_t mode);
+
+/**
+ * Input (16 kHz) samples per coded sample: 2 for the 8 kHz modes, else 1
+ */
+uint8_t audioCodecDecimation(AudioCodecMode mode);
+
+/**
+ * Nominal payload bitrate in bits per second (excluding frame header)
+ */
+uint32_t audioCodecBitrate(AudioCodecMode mode);
+
+/**
+ * Payload bytes for a frame of codedSamples (as carried in the header)
+ */
+size_t audioCodecPayloadBytes(AudioCodecMode mode, size_t codedSamples);
+
+/**
+ * Short mode name ("IMA4_16K", ...) and its inverse for control commands
+ * @return false if name is unknown
+ */
+const char* audioCodecName(AudioCodecMode mode);
+bool audioCodecModeFromName(const char* name, AudioCodecMode& mode);
+
+/**
+ * 8 kHz counterpart used by adaptive rate during silence:
+ * IMA4_16K / SUBBAND_16K -> IMA4_8K, IMA3_16K / IMA2_16K -> IMA2_8K
+ * (8 kHz modes map to themselves)
+ */
+AudioCodecMode audioCodecReducedRateMode(AudioCodecMode mode);
+
+// ============================================================================
+// HALF-BAND DECIMATOR (16 kHz -> 8 kHz)
+// ============================================================================
+
+#define HALFBAND_TAPS 31
+#define HALFBAND_HISTORY (HALFBAND_TAPS - 1)  // Input samples that fill the delay line
+
+/**
+ * Fixed-point polyphase half-band FIR, 31 taps (Kaiser, beta 4.5, Q15):
+ * flat to 3.2 kHz (+/-0.03 dB), >= 50 dB rejection from 4.8 kHz.
+ * Every second tap of a half-band filter is zero and the centre tap is 0.5,
+ * so one output costs 8 multiplies: the odd taps only ever see the second
+ * sample of each input pair, the centre tap only the first.
+ */
+class HalfbandDecimator {
+public:
+  HalfbandDecimator();
+  void reset();
+
+  /**
+   * Reset and run the filter over the most recent input, so the next
+   * output continues the signal instead of rising from zero
+   * @param recent Last input samples, oldest first (up to HALFBAND_HISTORY used)
+   */
+  void prime(const int16_t* recent, size_t numSamples);
+
+  /**
+   * Low-pass and keep every second sample (numSamples must be even)
+   * @return Samples written (numSamples / 2)
+   */
+  size_t process(const int16_t* input, size_t numSamples, int16_t* output);
+
+  /**
+   * Feed one input pair, return one output sample (delay: 15 input samples)
+   */
+  inline int16_t push(int16_t first, int16_t second) {
+    // Odd-tap delay line, written twice so the taps never wrap
+    position = (position == 0) ? PHASE_LENGTH - 1 : position - 1;
+    oddPhase[position] = second;
+    oddPhase[position + PHASE_LENGTH] = second;
+    const int16_t* line = &oddPhase[position];  // Newest first
+
+    // Centre tap: first sample of the pair 7 pairs back
+    int32_t sum = (int32_t)centrePhase[centrePosition] << 14;
+    centrePhase[centrePosition] = first;
+    if (++centrePosition == CENTRE_DELAY) centrePosition = 0;
+
+    for (uint8_t j = 0; j < PHASE_LENGTH / 2; j++) {
+      sum += COEFFS[j] * (line[PHASE_LENGTH / 2 - 1 - j] + line[PHASE_LENGTH / 2 + j]);
+    }
+
+    sum = (sum + 16384) >> 15;
+    if (sum > 32767) sum = 32767;
+    if (sum < -32768) sum = -32768;
+    return (int16_t)sum;
+  }
+
+private:
+  static const uint8_t PHASE_LENGTH = (HALFBAND_TAPS + 1) / 2;  // 16 odd taps
+  static const uint8_t CENTRE_DELAY = (HALFBAND_TAPS - 3) / 4;  // 7 pairs
+  static const int16_t COEFFS[PHASE_LENGTH / 2];  // Odd taps from the centre out (symmetric)
+
+  int16_t oddPhase[2 * PHASE_LENGTH];
+  int16_t centrePhase[CENTRE_DELAY];
+  uint8_t position;
+  uint8_t centrePosition;
+};
+
+// ============================================================================
+// AUDIO CODEC CLASS
+// ============================================================================
+
+class AudioCodec {
+public:
+  AudioCodec();
+
+  /**
+   * Select the encoder mode; takes effect at the next encode() and resets
+   * the encoder (every frame header carries fresh state anyway)
+   */
+  void setMode(AudioCodecMode mode);
+  AudioCodecMode getMode() const { return mode; }
+
+  /**
+   * Adaptive rate: encode at audioCodecReducedRateMode(mode) while reduced.
+   * Unlike setMode() the switch keeps the encoder running: the ADPCM state
+   * carries over and the decimator / QMF delay lines are primed from the
+   * last input, so neither direction adds a transient.
+   * Call between encode() calls; persists across setMode().
+   */
+  void setReducedRate(bool reduced);
+  bool isReducedRate() const { return reducedRate; }
+
+  /**
+   * Mode of the next encoded frame (its AudioFrame format tag)
+   */
+  AudioCodecMode getFrameMode() const { return reducedRate ? audioCodecReducedRateMode(mode) : mode; }
+
+  void resetEncoder();
+  void resetDecoder();
+
+  /**
+   * Encode one block of 16 kHz PCM in getFrameMode()
+   * @param numSamples Input samples (even)
+   * @param payload Output buffer (audioCodecPayloadBytes(mode, codedSamples) bytes)
+   * @param codedSamples Set to the sample count for the frame header
+   * @param stats Block statistics of the 16 kHz input (same pass as encoding)
+   * @return Payload bytes written
+   */
+  size_t encode(const int16_t* pcmSamples, size_t numSamples, uint8_t* payload,
+                size_t& codedSamples, AudioBlockStats& stats);
+
+  /**
+   * Primary (low-band) encoder state before the next encode(), for the frame header
+   */
+  void getEncoderState(int16_t& predictedSample, int16_t& stepIndex);
+
+  /**
+   * Decode one payload; the decoder follows the frame's mode tag, not setMode()
+   * @param predictedSample / stepIndex Primary state from the frame header
+   * @param pcmOutput codedSamples samples at the mode's rate (16 kHz for SUBBAND)
+   * @return Samples written
+   */
+  size_t decode(AudioCodecMode frameMode, int16_t predictedSample, int16_t stepIndex,
+                const uint8_t* payload, size_t codedSamples, int16_t* pcmOutput);
+
+private:
+  AudioCodecMode mode;
+  bool reducedRate;
+
+  // Encoder
+  ADPCMCodec ima4;             // 16 kHz 4-bit fast path (fused table kernel)
+  ADPCMState encoderLow;       // Primary band state (all modes)
+  ADPCMState encoderHigh;      // SUBBAND upper band
+  HalfbandDecimator decimator;
+  int16_t analysisHistory[22];  // QMF analysis delay line
+  int16_t inputHistory[HALFBAND_HISTORY];  // Last 16 kHz input, oldest first (primes rate switches)
+
+  // Decoder
+  ADPCMCodec ima4Decoder;
+  ADPCMState decoderHigh;
+  int32_t synthesisHistory[22];  // QMF synthesis delay line
+  AudioCodecMode lastDecodeMode;
+
+  void rememberInput(const int16_t* pcmSamples, size_t numSamples);
+  size_t encodeSubband(const int16_t* pcmSamples, size_t numSamples, uint8_t* payload, AudioBlockStats& stats);
+  size_t decodeSubband(const uint8_t* payload, size_t codedSamples, int16_t* pcmOutput, ADPCMState& low);
+};
+
+#endif // AUDIO_CODEC_H
@@ -6,6 +6,17 @@
 #include "AudioDetector.h"
 #include "Config.h"
 
+static const char* triggerReasonName(uint8_t reason) {
+  switch (reason) {
+    case AUDIO_TRIGGER_FALL: return "fall";
+    case AUDIO_TRIGGER_MANUAL_ALERT: return "manual alert";
+    case AUDIO_TRIGGER_VAD_SPIKE: return "loud sound";
+    case AUDIO_TRIGGER_SOUND_EVENT: return "sound event";
+    case AUDIO_TRIGGER_COMMAND: return "command";
+    default: return "none";
+  }
+}
+
 // ============================================================================
 // CONSTRUCTOR
 // ============================================================================
@@ -13,23 +24,89 @@
 AudioDetector::AudioDetector() {
   initialized = false;
   lastUpdateTime = 0;
-  audioBufferIndex = 0;
   currentAmplitude = 0;
   lastEvent = AUDIO_NONE;
   lastEventTime = 0;
+  lastThudTime = 0;
+  lastDistressTime = 0;
+  lastSosTime = 0;
+  keywordEnabled = AUDIO_SOS_KEYWORD;
+  previousThudRms = 0;
+  distressWindows = 0;
+  thudsDetected = 0;
+  distressDetected = 0;
+  sosDetected = 0;
+  thudsHandled = 0;
+  distressHandled = 0;
+  sosHandled = 0;
   thudCallback = nullptr;
   distressCallback = nullptr;
+  sosCallback = nullptr;
   dataScheduler = nullptr;
+  audioSource = nullptr;
+  sourceExhausted = false;
   streamingEnabled = false;
   adaptiveRateEnabled = AUDIO_ADAPTIVE_RATE;
   voiceActive = false;
-  streamBufferIndex = 0;
-  lastVADCheck = 0;
-  voiceActiveStartTime = 0;
-
-  memset(audioBuffer, 0, sizeof(audioBuffer));
-  memset(streamBuffer, 0, sizeof(streamBuffer));
-  memset(compressedBuffer, 0, sizeof(compressedBuffer));
+  reducedRateBlocks = 0;
+  reducedRateBytesSaved = 0;
+  ringHead = 0;
+  ringTail = 0;
+  ringFill = 0;
+  pendingGapSamples = 0;
+  taskRunning = false;
+  taskStopRequested = false;
+  blocksCaptured = 0;
+  dmaOverruns = 0;
+  ringOverruns = 0;
+  samplesLost = 0;
+  ringHighWater = 0;
+  frameSequence = 0;
+  frameSampleIndex = 0;
+  pendingCodecMode = 0;
+  requestedCodecMode = AUDIO_CODEC_DEFAULT_MODE;
+  linkAdaptEnabled = AUDIO_LINK_ADAPTIVE;
+  linkCheckBlocks = 0;
+  linkGoodChecks = 0;
+  linkUpshiftChecks = AUDIO_LINK_UPSHIFT_CHECKS;
+  linkCongestedSeen = 0;
+  linkRefusedSeen = 0;
+  linkDownshifts = 0;
+  linkUpshifts = 0;
+  dtxEnabled = AUDIO_DTX_ENABLED;
+  pendingDTX = -1;
+  dtxActive = false;
+  dtxSpanStart = 0;
+  dtxSpanSamples = 0;
+  dtxSpanEnergy = 0;
+  dtxSpanZeroCrossings = 0;
+  streamMode = AUDIO_STREAM_CODEC;
+  pendingStreamMode = -1;
+  featureSlot = PACKET_POOL_NONE;
+  featureFrame = nullptr;
+  featureVectors = 0;
+  featureFrameIndex = 0;
+  featureHopIndex = 0;
+  preTriggerEnabled = AUDIO_PRETRIGGER_ENABLED;
+  pendingTrigger = AUDIO_TRIGGER_NONE;
+  triggerHoldBlocks = 0;
+  triggersStarted = 0;
+  triggersReported = 0;
+  lastTriggerReason = AUDIO_TRIGGER_NONE;
+  streamBlocks = 0;
+  liveBlocks = 0;
+  historyFramesFlushed = 0;
+  historyBytesFlushed = 0;
+
+  // Sound event bands (resonators are built in begin())
+  thudBand = bandAnalyzer.addBand(THUD_FREQ_LOW, THUD_FREQ_HIGH);
+  distressBand = bandAnalyzer.addBand(DISTRESS_FREQ_LOW, DISTRESS_FREQ_HIGH);
+
+  memset(ring, 0, sizeof(ring));
+  memset(ringGapBefore, 0, sizeof(ringGapBefore));
+  memset(frameBuffer, 0, sizeof(frameBuffer));
+  memset(featureBuffer, 0, sizeof(featureBuffer));
+  memset(triggerCounts, 0, sizeof(triggerCounts));
 }
 
 // ============================================================================
@@ -37,31 +114,115 @@ AudioDetector::AudioDetector() {
 // ============================================================================
 
 bool AudioDetector::begin() {
-  Serial.println(F("[Audio] Initializing I2S microphone..."));
+  if (audioSource) {
+    Serial.print(F("[Audio] Replaying from "));
+    Serial.println(audioSource->name);
+  } else {
+    Serial.println(F("[Audio] Initializing I2S microphone..."));
 
-  if (!initI2S()) {
-    Serial.println(F("[Audio] ERROR: I2S init failed"));
-    return false;
+    if (!initI2S()) {
+      Serial.println(F("[Audio] ERROR: I2S init failed"));
+      return false;
+    }
   }
 
   initialized = true;
+  sourceExhausted = false;
   lastUpdateTime = millis();
 
   // Initialize ADPCM encoder
-  adpcmCodec.resetEncoder();
-
-  Serial.println(F("[Audio] I2S microphone ready"));
-  Serial.println(F("[Audio] ADPCM compression enabled (4:1 ratio)"));
+  audioCodec.setMode(AUDIO_CODEC_DEFAULT_MODE);
+  audioCodec.resetEncoder();
+  requestedCodecMode = AUDIO_CODEC_DEFAULT_MODE;
+
+  if (!audioSource) Serial.println(F("[Audio] I2S microphone ready"));
+  Serial.print(F("[Audio] ADPCM compression enabled ("));
+  Serial.print(audioCodecName(audioCodec.getMode()));
+  Serial.print(F(", "));
+  Serial.print(audioCodecBitrate(audioCodec.getMode()) / 1000);
+  Serial.println(F(" kbps)"));
+  inputPipeline.begin(I2S_SAMPLE_RATE, AUDIO_INPUT_STAGES);
+  streamPipeline.begin(I2S_SAMPLE_RATE, AUDIO_STREAM_STAGES);
+  if (inputPipeline.getStages() || streamPipeline.getStages()) {
+    Serial.print(F("[Audio] DSP stages:"));
+    const char* separator = " ";
+    for (uint8_t i = 0; i < AUDIO_STAGES; i++) {
+      if (inputPipeline.hasStage((AudioStage)i) || streamPipeline.hasStage((AudioStage)i)) {
+        Serial.print(separator);
+        separator = ", ";
+        Serial.print(audioStageName((AudioStage)i));
+        if (streamPipeline.hasStage((AudioStage)i)) Serial.print(F(" (stream)"));
+      }
+    }
+    Serial.println();
+  }
   if (adaptiveRateEnabled) {
     Serial.println(F("[Audio] Adaptive sample rate enabled (8-16 kHz)"));
   }
+  if (dtxEnabled) {
+    Serial.println(F("[Audio] DTX enabled (comfort noise during silence)"));
+  }
+  if (bandAnalyzer.begin(I2S_SAMPLE_RATE)) {
+    Serial.println(F("[Audio] Sound event detection enabled (Goertzel bands)"));
+  } else {
+    Serial.println(F("[Audio] WARNING: band analyzer not started - no sound events"));
+  }
+  vad.begin(I2S_SAMPLE_RATE);
+  melExtractor.begin();
+  if (keywordEnabled) {
+    if (keywordSpotter.begin()) {
+      Serial.print(F("[Audio] SOS keyword spotting enabled ("));
+      Serial.print(keywordSpotter.getMacsPerInference());
+      Serial.print(F(" MACs/inference, "));
+      Serial.print((uint32_t)keywordSpotter.getStaticRam());
+      Serial.println(F(" bytes RAM)"));
+    } else {
+      keywordEnabled = false;
+      Serial.println(F("[Audio] WARNING: SOS model does not fit the arena - keyword spotting off"));
+    }
+  }
+  if (preTriggerEnabled) {
+    size_t historyBytes = (size_t)AUDIO_PRETRIGGER_SECONDS * AUDIO_HISTORY_BYTES_PER_SECOND;
+    if (history.begin(historyBytes)) {
+      Serial.print(F("[Audio] Pre-trigger history: "));
+      Serial.print(AUDIO_PRETRIGGER_SECONDS);
+      Serial.print(F(" s ("));
+      Serial.print((uint32_t)historyBytes);
+      Serial.println(F(" bytes RAM), streaming on trigger only"));
+    } else {
+      preTriggerEnabled = false;
+      Serial.println(F("[Audio] WARNING: no RAM for the pre-trigger history - streaming continuously"));
+    }
+  }
+
+  // Capture task drains the DMA buffers; otherwise update() polls them.
+  // A replay source is always polled, so runs are repeatable
+  taskStopRequested = false;
+  if (AUDIO_CAPTURE_TASK && !audioSource) {
+    taskRunning = true;
+    if (!hal::taskStart(captureTaskEntry, "audio", AUDIO_TASK_STACK_SIZE, AUDIO_TASK_PRIORITY, this)) {
+      taskRunning = false;
+      Serial.println(F("[Audio] WARNING: capture task not started - polling from loop()"));
+    } else {
+      Serial.println(F("[Audio] Capture task started (I2S event driven)"));
+    }
+  }
   return true;
 }
 
 void AudioDetector::end() {
   if (!initialized) return;
 
-  deinitI2S();
+  // Let the capture task finish its current block before the driver goes away
+  if (taskRunning) {
+    taskStopRequested = true;
+    uint32_t start = millis();
+    while (taskRunning && millis() - start < AUDIO_TASK_EVENT_TIMEOUT_MS * 2) {
+      hal::delayMs(1);
+    }
+  }
+
+  if (!audioSource) deinitI2S();
   initialized = false;
 
   Serial.println(F("[Audio] Stopped"));
@@ -72,52 +233,41 @@ void AudioDetector::end() {
 // ============================================================================
 
 bool AudioDetector::initI2S() {
-  i2s_config_t i2s_config = {
-    .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
-    .sample_rate = I2S_SAMPLE_RATE,
-    .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
-    .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
-    .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-    .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-    .dma_buf_count = I2S_DMA_BUF_COUNT,
-    .dma_buf_len = I2S_DMA_BUF_LEN,
-    .use_apll = false,
-    .tx_desc_auto_clear = false,
-    .fixed_mclk = 0
-  };
-
-  i2s_pin_config_t pin_config = {
-    .bck_io_num = I2S_SCK_PIN,
-    .ws_io_num = I2S_WS_PIN,
-    .data_out_num = I2S_PIN_NO_CHANGE,
-    .data_in_num = I2S_SD_PIN
-  };
-
-  esp_err_t err = i2s_driver_install(I2S_PORT, &i2s_config, 0, NULL);
-  if (err != ESP_OK) {
-    Serial.print(F("[Audio] Driver install failed: "));
-    Serial.println(err);
+  hal::I2SConfig config;
+  config.sampleRate = I2S_SAMPLE_RATE;
+  config.dmaBufCount = I2S_DMA_BUF_COUNT;
+  config.dmaBufLen = I2S_DMA_BUF_LEN;
+  config.bckPin = I2S_SCK_PIN;
+  config.wsPin = I2S_WS_PIN;
+  config.dataInPin = I2S_SD_PIN;
+  config.eventQueueSize = I2S_EVENT_QUEUE_SIZE;
+
+  return hal::i2sBegin(config);
+}
+
+void AudioDetector::deinitI2S() {
+  hal::i2sEnd();
+}
+
+void AudioDetector::setAudioSource(const AudioSource* source) {
+  if (initialized) return;  // The source is fixed while running
+  audioSource = source;
+}
+
+bool AudioDetector::readAudioSamples(int16_t* samples, size_t maxSamples, size_t& samplesRead) {
+  if (!audioSource) return hal::i2sRead(samples, maxSamples, samplesRead, 0);
+
+  if (sourceExhausted) {
+    samplesRead = 0;
     return false;
   }
-
-  err = i2s_set_pin(I2S_PORT, &pin_config);
-  if (err != ESP_OK) {
-    Serial.print(F("[Audio] Pin config failed: "));
-    Serial.println(err);
-    i2s_driver_uninstall(I2S_PORT);
+  if (!audioSource->read(audioSource->context, samples, maxSamples, samplesRead)) {
+    sourceExhausted = true;
     return false;
   }
-
-  // Start I2S
-  i2s_zero_dma_buffer(I2S_PORT);
-
   return true;
 }
 
-void AudioDetector::deinitI2S() {
-  i2s_driver_uninstall(I2S_PORT);
-}
-
 // ============================================================================
 // MAIN UPDATE LOOP
 // ============================================================================
@@ -125,85 +275,598 @@ void AudioDetector::deinitI2S() {
 void AudioDetector::update() {
   if (!initialized) return;
 
-  // Only read and stream audio - no local processing
-  // All ML inference happens on iPhone via TensorFlow Lite
-  readAudioSamples();
+  // Fallback when the capture task is not running: drain whatever the DMA
+  // has without waiting, so loop() is never stalled by audio
+  if (!taskRunning) {
+    // Collect overrun reports from the driver event queue (bounded by its depth)
+    for (uint8_t i = 0; i < I2S_EVENT_QUEUE_SIZE && !audioSource; i++) {
+      hal::I2SEvent event = hal::i2sWaitEvent(0);
+      if (event == hal::I2S_RX_TIMEOUT) break;
+      if (event == hal::I2S_RX_OVERRUN) recordDmaOverrun();
+    }
+    captureAvailable();
+    processRing();
+  }
 
-  // Note: Local audio processing (processAudio) is disabled to prevent
-  // I2S DMA from blocking I2C transactions. Audio is streamed to iPhone
-  // for SOS detection via TensorFlow Lite model.
+  dispatchEvents();
 }
 
 // ============================================================================
-// AUDIO SAMPLE READING
+// CAPTURE TASK
 // ============================================================================
 
-void AudioDetector::readAudioSamples() {
-  size_t bytesRead = 0;
-  int16_t samples[32];  // Read in small chunks
+void AudioDetector::captureTaskEntry(void* context) {
+  ((AudioDetector*)context)->captureTask();
+}
 
-  // Read samples from I2S DMA
-  esp_err_t err = i2s_read(I2S_PORT, samples, sizeof(samples), &bytesRead, pdMS_TO_TICKS(10));
+void AudioDetector::captureTask() {
+  while (!taskStopRequested) {
+    hal::I2SEvent event = hal::i2sWaitEvent(AUDIO_TASK_EVENT_TIMEOUT_MS);
+    if (event == hal::I2S_RX_TIMEOUT) continue;
+    if (event == hal::I2S_RX_OVERRUN) recordDmaOverrun();
 
-  if (err != ESP_OK || bytesRead == 0) {
-    return;
+    captureAvailable();
+    processRing();
   }
+  taskRunning = false;
+}
+
+void AudioDetector::recordDmaOverrun() {
+  // The driver dropped one DMA buffer. Events are drained after the data, so
+  // the gap lands on the next block to complete (within the DMA depth)
+  dmaOverruns++;
+  samplesLost += I2S_DMA_BUF_LEN;
+  pendingGapSamples += I2S_DMA_BUF_LEN;
+}
 
-  size_t samplesRead = bytesRead / sizeof(int16_t);
-
-  // Copy to audio buffer for local analysis
-  for (size_t i = 0; i < samplesRead && audioBufferIndex < FFT_SIZE; i++) {
-    audioBuffer[audioBufferIndex++] = samples[i];
-  }
-
-  // Stream to BLE with ADPCM compression if enabled
-  if (streamingEnabled && dataScheduler) {
-    for (size_t i = 0; i < samplesRead; i++) {
-      streamBuffer[streamBufferIndex++] = samples[i];
-
-      // When stream buffer is full, compress and send via DataScheduler
-      if (streamBufferIndex >= STREAM_BUFFER_SIZE) {
-        // Perform Voice Activity Detection
-        uint32_t currentTime = millis();
-        if (currentTime - lastVADCheck >= VAD_CHECK_INTERVAL) {
-          lastVADCheck = currentTime;
-          voiceActive = detectVoiceActivity(streamBuffer, STREAM_BUFFER_SIZE, AUDIO_VAD_THRESHOLD);
-
-          // Adjust audio packet rate based on voice activity (only on state change)
-          if (voiceActive) {
-            if (voiceActiveStartTime == 0) {  // STATE CHANGE: inactive → active
-              voiceActiveStartTime = currentTime;
-              dataScheduler->setAudioRateLimit(AUDIO_MAX_PACKETS_PER_SEC_HIGH);
-              Serial.println(F("[Audio] Voice activity detected - increasing rate to 30 pkt/s"));
-            }
-          } else {
-            if (voiceActiveStartTime != 0) {  // STATE CHANGE: active → inactive
-              voiceActiveStartTime = 0;
-              dataScheduler->setAudioRateLimit(AUDIO_MAX_PACKETS_PER_SEC_LOW);
-              Serial.println(F("[Audio] Voice inactive - reducing rate to 15 pkt/s"));
-            }
-          }
-        }
-
-        // Compress audio with ADPCM (4:1 compression)
-        size_t compressedSize = adpcmCodec.encode(streamBuffer, STREAM_BUFFER_SIZE, compressedBuffer);
-
-        // Send compressed audio via DataScheduler (priority-based)
-        dataScheduler->enqueueAudio(compressedBuffer, compressedSize);
-
-        streamBufferIndex = 0;
+// ============================================================================
+// AUDIO SAMPLE CAPTURE
+// ============================================================================
+
+void AudioDetector::captureAvailable() {
+  // At most what the DMA can hold, so a scripted host source cannot spin here
+  size_t budget = (size_t)I2S_DMA_BUF_COUNT * I2S_DMA_BUF_LEN;
+
+  while (budget > 0) {
+    if (ringFill == 0 && ringHead - ringTail >= RING_BLOCKS) {
+      // Encoder a full ring behind: drop the oldest block, keep capturing
+      uint32_t dropped = ringTail % RING_BLOCKS;
+      ringGapBefore[(ringTail + 1) % RING_BLOCKS] += ringGapBefore[dropped] + STREAM_BUFFER_SIZE;
+      ringTail++;
+      ringOverruns++;
+      samplesLost += STREAM_BUFFER_SIZE;
+    }
+
+    // DMA data lands directly in the ring block (no intermediate chunk)
+    int16_t* block = ring[ringHead % RING_BLOCKS];
+    size_t request = min(budget, STREAM_BUFFER_SIZE - ringFill);
+    size_t samplesRead = 0;
+    if (!readAudioSamples(&block[ringFill], request, samplesRead) || samplesRead == 0) {
+      break;
+    }
+    budget -= samplesRead;
+
+    ringFill += samplesRead;
+    if (ringFill >= STREAM_BUFFER_SIZE) {
+      ringGapBefore[ringHead % RING_BLOCKS] = pendingGapSamples;
+      pendingGapSamples = 0;
+      ringFill = 0;
+      ringHead++;
+      blocksCaptured++;
+      if (ringHead - ringTail > ringHighWater) ringHighWater = (uint8_t)(ringHead - ringTail);
+    }
+  }
+}
+
+void AudioDetector::processRing() {
+  while (ringHead != ringTail) {
+    uint32_t index = ringTail % RING_BLOCKS;
+
+    // DC and rumble removed once, for the analysis and the stream alike
+    inputPipeline.process(ring[index], STREAM_BUFFER_SIZE);
+
+    // Sound events are detected on the watch, streaming or not
+    analyzeBlock(ring[index], ringGapBefore[index]);
+
+    // Stream to BLE with ADPCM compression (or as log-mel features) if enabled
+    if (streamingEnabled && dataScheduler) {
+      if (pendingStreamMode >= 0) applyStreamMode();
+      if (pendingTrigger != AUDIO_TRIGGER_NONE) {
+        AudioTriggerReason reason = (AudioTriggerReason)pendingTrigger;
+        pendingTrigger = AUDIO_TRIGGER_NONE;
+        startTrigger(reason);
       }
+      streamPipeline.process(ring[index], STREAM_BUFFER_SIZE);
+      if (streamMode == AUDIO_STREAM_FEATURES) {
+        streamFeatures(ring[index], ringGapBefore[index]);
+      } else {
+        streamBlock(ring[index], ringGapBefore[index]);
+      }
+
+      // Triggered: history goes out first, as fast as the pool frees up
+      if (streamLive() && !history.isEmpty()) flushHistory();
+      streamBlocks++;
+      if (streamLive()) liveBlocks++;
+      if (triggerHoldBlocks > 0) triggerHoldBlocks--;
+    }
+    ringTail++;
+
+    // Empty the DMA again before the next (possibly slow) block
+    captureAvailable();
+  }
+}
+
+void AudioDetector::printStatistics() {
+  Serial.println(F("========================================"));
+  Serial.println(F("[Audio] Capture Statistics"));
+  Serial.println(F("========================================"));
+  Serial.print(F("  Mode: "));
+  Serial.println(taskRunning ? F("capture task (I2S events)") : F("polled from loop()"));
+  Serial.print(F("  Blocks captured: "));
+  Serial.print(blocksCaptured);
+  Serial.print(F(" (ring high-water "));
+  Serial.print(ringHighWater);
+  Serial.print(F(" / "));
+  Serial.print(RING_BLOCKS);
+  Serial.println(F(")"));
+  Serial.print(F("  Overruns - DMA: "));
+  Serial.print(dmaOverruns);
+  Serial.print(F(", Ring: "));
+  Serial.print(ringOverruns);
+  Serial.print(F(" ("));
+  Serial.print(samplesLost);
+  Serial.println(F(" samples lost)"));
+  Serial.print(F("  Adaptive rate: "));
+  Serial.print(reducedRateBlocks);
+  Serial.print(F(" / "));
+  Serial.print(blocksCaptured);
+  Serial.print(F(" blocks at 8 kHz ("));
+  Serial.print(reducedRateBytesSaved);
+  Serial.println(F(" payload bytes saved)"));
+  if (linkAdaptEnabled) {
+    Serial.print(F("  Link adaptation: codec "));
+    Serial.print(audioCodecName(audioCodec.getMode()));
+    Serial.print(F(" (requested "));
+    Serial.print(audioCodecName(requestedCodecMode));
+    Serial.print(F("), "));
+    Serial.print(linkDownshifts);
+    Serial.print(F(" down / "));
+    Serial.print(linkUpshifts);
+    Serial.print(F(" up, step-up after "));
+    Serial.print(linkUpshiftChecks);
+    Serial.println(F(" checks"));
+  }
+  Serial.print(F("  DSP cycles/block:"));
+  const char* separator = " ";
+  for (uint8_t i = 0; i < AUDIO_STAGES; i++) {
+    AudioStage stage = (AudioStage)i;
+    const AudioPipeline& pipeline = inputPipeline.hasStage(stage) ? inputPipeline : streamPipeline;
+    if (!pipeline.hasStage(stage)) continue;
+    Serial.print(separator);
+    separator = ", ";
+    Serial.print(audioStageName(stage));
+    Serial.print(' ');
+    Serial.print(pipeline.getStageCycles(stage));
+    Serial.print(F(" (max "));
+    Serial.print(pipeline.getMaxStageCycles(stage));
+    Serial.print(')');
+  }
+  if (streamPipeline.hasStage(AUDIO_STAGE_AGC)) {
+    Serial.print(F(", AGC gain x"));
+    Serial.print(streamPipeline.getAgcGain() / (float)AGC_GAIN_ONE, 2);
+  }
+  Serial.println();
+  Serial.print(F("  VAD: "));
+  Serial.print(vad.getActiveBlocks());
+  Serial.print(F(" / "));
+  Serial.print(vad.getBlocks());
+  Serial.print(F(" blocks active, "));
+  Serial.print(vad.getTransitions());
+  Serial.print(F(" switches, noise floor "));
+  Serial.print(vad.getNoiseFloorRms());
+  Serial.print(F(" RMS, "));
+  Serial.print(vad.getBlockCycles());
+  Serial.print(F(" cycles/block (max "));
+  Serial.print(vad.getMaxBlockCycles());
+  Serial.println(F(")"));
+  Serial.print(F("  Sound events: "));
+  Serial.print(thudsDetected);
+  Serial.print(F(" thud, "));
+  Serial.print(distressDetected);
+  Serial.print(F(" distress, "));
+  Serial.print(sosDetected);
+  Serial.println(F(" SOS keyword"));
+  Serial.print(F("  Band analysis: "));
+  Serial.print(bandAnalyzer.getWindowCycles());
+  Serial.print(F(" cycles/window (max "));
+  Serial.print(bandAnalyzer.getMaxWindowCycles());
+  Serial.print(F(", budget "));
+  Serial.print((uint32_t)BAND_CYCLE_BUDGET);
+  Serial.print(F(", "));
+  Serial.print(bandAnalyzer.getOverBudgetWindows());
+  Serial.print(F(" / "));
+  Serial.print(bandAnalyzer.getWindows());
+  Serial.println(F(" over)"));
+  if (keywordEnabled) {
+    Serial.print(F("  SOS keyword: "));
+    Serial.print(keywordSpotter.getInferences());
+    Serial.print(F(" inferences, "));
+    Serial.print(keywordSpotter.getInferenceCycles());
+    Serial.print(F(" cycles each (max "));
+    Serial.print(keywordSpotter.getMaxInferenceCycles());
+    Serial.println(F(")"));
+    Serial.print(F("  SOS keyword RAM: arena peak "));
+    Serial.print((uint32_t)keywordSpotter.getArenaPeak());
+    Serial.print(F(" / "));
+    Serial.print((uint32_t)keywordSpotter.getArenaSize());
+    Serial.print(F(" bytes, "));
+    Serial.print((uint32_t)keywordSpotter.getStaticRam());
+    Serial.println(F(" bytes total"));
+  }
+  if (melExtractor.getFrames() > 0) {
+    Serial.print(F("  Log-mel features: "));
+    Serial.print(melExtractor.getFrames());
+    Serial.print(F(" vectors, "));
+    Serial.print(melExtractor.getFrameCycles());
+    Serial.print(F(" cycles/hop (max "));
+    Serial.print(melExtractor.getMaxFrameCycles());
+    Serial.println(F(")"));
+  }
+  if (preTriggerEnabled) {
+    Serial.print(F("  Pre-trigger: live "));
+    Serial.print(liveBlocks);
+    Serial.print(F(" / "));
+    Serial.print(streamBlocks);
+    Serial.print(F(" blocks (duty "));
+    Serial.print(streamBlocks ? 100.0f * liveBlocks / streamBlocks : 0.0f, 1);
+    Serial.print(F("%), "));
+    Serial.print(triggersStarted);
+    Serial.println(F(" triggers"));
+    Serial.print(F("  Triggers: "));
+    for (uint8_t reason = AUDIO_TRIGGER_FALL; reason < AUDIO_TRIGGER_REASONS; reason++) {
+      if (reason > AUDIO_TRIGGER_FALL) Serial.print(F(", "));
+      Serial.print(triggerReasonName(reason));
+      Serial.print(F(" "));
+      Serial.print(triggerCounts[reason]);
+    }
+    Serial.println();
+    Serial.print(F("  History: "));
+    Serial.print((uint32_t)history.getUsed());
+    Serial.print(F(" / "));
+    Serial.print((uint32_t)history.getCapacity());
+    Serial.print(F(" bytes ("));
+    Serial.print(history.getFrameCount());
+    Serial.print(F(" frames, "));
+    Serial.print(history.getOverwrittenFrames());
+    Serial.print(F(" overwritten), flushed "));
+    Serial.print(historyFramesFlushed);
+    Serial.print(F(" frames ("));
+    Serial.print(historyBytesFlushed);
+    Serial.println(F(" bytes)"));
+  }
+  Serial.println(F("========================================"));
+}
+
+void AudioDetector::streamBlock(const int16_t* block, uint32_t gapBefore) {
+  uint32_t startCycles = hal::cycleCount();
+  dataScheduler->recordAudioCopy(STREAM_BUFFER_SIZE * sizeof(int16_t));  // DMA -> ring
+
+  // Mode and DTX changes only between frames, so every frame is one mode
+  if (pendingCodecMode != 0) {
+    requestedCodecMode = (AudioCodecMode)pendingCodecMode;
+    pendingCodecMode = 0;
+    audioCodec.setMode(requestedCodecMode);
+    linkGoodChecks = 0;
+    linkUpshiftChecks = AUDIO_LINK_UPSHIFT_CHECKS;
+  }
+  if (linkAdaptEnabled && ++linkCheckBlocks >= (uint32_t)AUDIO_LINK_CHECK_MS * I2S_SAMPLE_RATE / 1000 / STREAM_BUFFER_SIZE) {
+    linkCheckBlocks = 0;
+    adaptCodecToLink();
+  }
+  if (pendingDTX >= 0) {
+    dtxEnabled = (pendingDTX != 0);
+    pendingDTX = -1;
+    if (!dtxEnabled && dtxSpanSamples > 0) sendComfortNoise();
+    dtxActive = false;
+  }
+
+  // Samples lost to an overrun advance the stream position, so the
+  // receiver sees the gap and conceals it
+  frameSampleIndex += gapBefore;
+
+  // Adaptive rate: silence is coded at 8 kHz. The codec switches without a
+  // reset, so the change is seamless; speech returns to 16 kHz at the next
+  // frame and the VAD hangover keeps trailing syllables at full bandwidth
+  audioCodec.setReducedRate(adaptiveRateEnabled && !voiceActive);
+
+  // Frame header carries the mode tag and the encoder state before
+  // this block, so the receiver can resync after any dropped frame
+  AudioFrameHeader header;
+  int16_t predicted, stepIndex;
+  audioCodec.getEncoderState(predicted, stepIndex);
+  header.format = audioCodec.getFrameMode();  // Also the frame's rate tag
+  header.stepIndex = (uint8_t)stepIndex;
+  header.predictor = predicted;
+  header.sampleIndex = frameSampleIndex;
+  frameSampleIndex += STREAM_BUFFER_SIZE;
+
+  // Encode straight into a pooled transmit buffer. While a silent span is
+  // pending, its comfort-noise frame may have to go out first, so encode into
+  // scratch instead (copied only if speech resumes). Scratch is also used if
+  // the pool is exhausted (BLE backlog) so encoder state and VAD stay current,
+  // and while the frame is bound for the pre-trigger history
+  uint8_t slot = PACKET_POOL_NONE;
+  uint8_t* frame = (dtxSpanSamples == 0 && streamDirect()) ? dataScheduler->acquireAudioBuffer(slot) : nullptr;
+  if (!frame) frame = frameBuffer;
+
+  // Compress audio with ADPCM; the same pass measures block energy
+  // for voice activity detection
+  AudioBlockStats stats;
+  size_t codedSamples = 0;
+  size_t compressedSize = audioCodec.encode(block, STREAM_BUFFER_SIZE,
+                                            frame + AUDIO_FRAME_HEADER_SIZE, codedSamples, stats);
+  header.sampleCount = (uint16_t)codedSamples;
+
+  bool reducedRate = (header.format != audioCodec.getMode());
+  if (reducedRate) reducedRateBlocks++;
+
+  // Voice activity (attack / hangover applied) drives the adaptive rate
+  // and DTX from the next block
+  voiceActive = vad.process(block, STREAM_BUFFER_SIZE, stats);
+
+  if (dtxShouldSuppress()) {
+    // Silent: the block is described by the next comfort-noise frame
+    if (dtxSpanSamples == 0) dtxSpanStart = header.sampleIndex;
+    dtxSpanSamples += STREAM_BUFFER_SIZE;
+    dtxSpanEnergy += stats.energy;
+    dtxSpanZeroCrossings += stats.zeroCrossings;
+    dataScheduler->recordDtxSavings(AUDIO_FRAME_HEADER_SIZE + compressedSize, 0);
+
+    // First silent block goes out at once, then at the CN cadence
+    uint32_t intervalSamples = (uint32_t)AUDIO_DTX_CN_INTERVAL_MS * I2S_SAMPLE_RATE / 1000;
+    if (!dtxActive || dtxSpanSamples >= intervalSamples) {
+      dtxActive = true;
+      sendComfortNoise();
+    }
+  } else {
+    // Describe any pending silence first so the stream stays contiguous
+    if (dtxSpanSamples > 0) sendComfortNoise();
+    dtxActive = false;
+
+    // Hand the pooled frame to DataScheduler (priority-based; may drop).
+    // A frame encoded into scratch is copied into the pool
+    header.sequence = frameSequence++;
+    writeAudioFrameHeader(header, frame);
+    if (reducedRate) {
+      reducedRateBytesSaved += audioCodecPayloadBytes(audioCodec.getMode(), STREAM_BUFFER_SIZE) - compressedSize;
+    }
+    sendFrame(slot, frame, AUDIO_FRAME_HEADER_SIZE + compressedSize);
+  }
+
+  dataScheduler->recordAudioBlock(hal::cycleCount() - startCycles);
+}
+
+// ============================================================================
+// LINK ADAPTATION
+// ============================================================================
+
+// Rungs below a requested mode, best quality per bit first
+static const AudioCodecMode LINK_LADDER[] = {
+  AUDIO_CODEC_IMA4_16K, AUDIO_CODEC_SUBBAND_16K, AUDIO_CODEC_IMA4_8K, AUDIO_CODEC_IMA2_8K
+};
+static const uint8_t LINK_LADDER_MAX = 1 + sizeof(LINK_LADDER) / sizeof(LINK_LADDER[0]);
+
+// The requested mode, then every ladder mode with a lower bitrate
+static uint8_t buildLinkLadder(AudioCodecMode requested, AudioCodecMode* ladder) {
+  uint8_t rungs = 0;
+  ladder[rungs++] = requested;
+  for (AudioCodecMode mode : LINK_LADDER) {
+    if (audioCodecBitrate(mode) < audioCodecBitrate(requested)) ladder[rungs++] = mode;
+  }
+  return rungs;
+}
+
+// Link bytes/s of a speech stream in this mode (frame header, payload and
+// ATT header, one frame per block)
+static uint32_t linkBytesPerSecond(AudioCodecMode mode, size_t blockSamples) {
+  size_t frame = AUDIO_FRAME_HEADER_SIZE + audioCodecPayloadBytes(mode, blockSamples / audioCodecDecimation(mode));
+  return (uint32_t)((frame + GOVERNOR_ATT_OVERHEAD) * I2S_SAMPLE_RATE / blockSamples);
+}
+
+void AudioDetector::adaptCodecToLink() {
+  const BandwidthGovernor& governor = dataScheduler->getGovernor();
+  uint32_t usable = (uint32_t)((uint64_t)dataScheduler->getAudioBudget() * AUDIO_LINK_HEADROOM_PCT / 100);
+
+  // Failed notifications, or live frames dropped because the queue no
+  // longer drains in time (refused at the queue or expired in it), mean the
+  // link carries less than the stream needs (a history flush only delays
+  // live frames, it does not drop them)
+  uint32_t refused = dataScheduler->getRateLimitedAudioPackets() + dataScheduler->getExpiredAudioPackets();
+  bool congested = governor.getCongestedWindows() != linkCongestedSeen;
+  bool starved = refused != linkRefusedSeen;
+  linkCongestedSeen = governor.getCongestedWindows();
+  linkRefusedSeen = refused;
+
+  AudioCodecMode ladder[LINK_LADDER_MAX];
+  uint8_t rungs = buildLinkLadder(requestedCodecMode, ladder);
+  uint8_t rung = 0;
+  while (rung < rungs && ladder[rung] != audioCodec.getMode()) rung++;
+  if (rung == rungs) rung = 0;
+
+  uint8_t target = rung;
+  if (congested || starved || linkBytesPerSecond(ladder[rung], STREAM_BUFFER_SIZE) > usable) {
+    // Down at once: at least one rung when short, to the first that fits
+    linkGoodChecks = 0;
+    if (target + 1 < rungs) target++;
+    while (target + 1 < rungs && linkBytesPerSecond(ladder[target], STREAM_BUFFER_SIZE) > usable) target++;
+    if (congested && target != rung) {
+      linkUpshiftChecks = (uint8_t)min(linkUpshiftChecks * 2, AUDIO_LINK_UPSHIFT_MAX_CHECKS);
+    }
+  } else if (rung > 0) {
+    // Up one rung after linkUpshiftChecks checks with 25% room for it
+    uint32_t needed = linkBytesPerSecond(ladder[rung - 1], STREAM_BUFFER_SIZE);
+    linkGoodChecks = (needed + needed / 4 <= usable) ? linkGoodChecks + 1 : 0;
+    if (linkGoodChecks >= linkUpshiftChecks) {
+      linkGoodChecks = 0;
+      target = rung - 1;
+    }
+  }
+  if (target == rung) return;
+
+  // Same-frame switch as setCodecMode(); the frame tag tells the receiver
+  audioCodec.setMode(ladder[target]);
+  if (target > rung) {
+    linkDownshifts++;
+  } else {
+    linkUpshifts++;
+  }
+  Serial.print(F("[Audio] Link budget "));
+  Serial.print(dataScheduler->getAudioBudget());
+  Serial.print(F(" B/s"));
+  if (congested) Serial.print(F(" (congested)"));
+  Serial.print(F(" -> codec "));
+  Serial.print(audioCodecName(ladder[target]));
+  Serial.print(F(" ("));
+  Serial.print(audioCodecBitrate(ladder[target]) / 1000);
+  Serial.println(F(" kbps)"));
+}
+
+// ============================================================================
+// FEATURE STREAM
+// ============================================================================
+
+void AudioDetector::applyStreamMode() {
+  AudioStreamMode mode = (AudioStreamMode)pendingStreamMode;
+  pendingStreamMode = -1;
+  if (mode == streamMode) return;
+
+  if (mode == AUDIO_STREAM_FEATURES) {
+    // Close the audio stream: describe any pending silence first
+    if (dtxSpanSamples > 0) sendComfortNoise();
+    dtxActive = false;
+    melExtractor.reset();
+    featureHopIndex = frameSampleIndex;
+  } else {
+    flushFeatures();
+    audioCodec.resetEncoder();
+    vad.reset();
+    voiceActive = false;
+  }
+  streamMode = mode;
+}
+
+void AudioDetector::streamFeatures(const int16_t* block, uint32_t gapBefore) {
+  uint32_t startCycles = hal::cycleCount();
+  dataScheduler->recordAudioCopy(STREAM_BUFFER_SIZE * sizeof(int16_t));  // DMA -> ring
+
+  // A gap breaks the analysis window: send what we have and restart, so
+  // no vector straddles lost samples
+  frameSampleIndex += gapBefore;
+  if (gapBefore > 0) {
+    flushFeatures();
+    melExtractor.reset();
+    featureHopIndex = frameSampleIndex;
+  }
+  frameSampleIndex += STREAM_BUFFER_SIZE;
+
+  size_t offset = 0;
+  while (offset < STREAM_BUFFER_SIZE) {
+    offset += melExtractor.process(block + offset, STREAM_BUFFER_SIZE - offset);
+    if (!melExtractor.frameReady()) continue;
+
+    // First vector opens a pooled frame (scratch if the pool is exhausted
+    // or the frame is bound for the pre-trigger history)
+    if (!featureFrame) {
+      if (streamDirect()) featureFrame = dataScheduler->acquireAudioBuffer(featureSlot);
+      if (!featureFrame) featureFrame = featureBuffer;
+      featureFrameIndex = featureHopIndex;
     }
+    memcpy(featureFrame + AUDIO_FRAME_HEADER_SIZE + featureVectors * MEL_BINS, melExtractor.getFrame(), MEL_BINS);
+    featureVectors++;
+    featureHopIndex += MEL_HOP_SIZE;
+    if (featureVectors >= AUDIO_FEATURE_VECTORS_PER_FRAME) flushFeatures();
   }
+
+  dataScheduler->recordAudioBlock(hal::cycleCount() - startCycles);
+}
+
+void AudioDetector::flushFeatures() {
+  if (!featureFrame) return;
+
+  AudioFrameHeader header;
+  header.format = AUDIO_FRAME_LOG_MEL;
+  header.stepIndex = MEL_BINS;
+  header.predictor = MEL_HOP_SIZE;
+  header.sequence = frameSequence++;
+  header.sampleIndex = featureFrameIndex;
+  header.sampleCount = (uint16_t)(featureVectors * MEL_HOP_SIZE);
+  writeAudioFrameHeader(header, featureFrame);
+
+  sendFrame(featureSlot, featureFrame, AUDIO_FRAME_HEADER_SIZE + featureVectors * MEL_BINS);
+
+  featureFrame = nullptr;
+  featureSlot = PACKET_POOL_NONE;
+  featureVectors = 0;
+}
+
+void AudioDetector::setStreamMode(AudioStreamMode mode) {
+  pendingStreamMode = (int8_t)mode;
+
+  Serial.print(F("[Audio] Stream mode -> "));
+  Serial.println(mode == AUDIO_STREAM_FEATURES ? F("log-mel features (~4.3 kB/s)") : F("audio"));
 }
 
 // ============================================================================
 // AUDIO PROCESSING
 // ============================================================================
 
+void AudioDetector::analyzeBlock(const int16_t* block, uint32_t gapBefore) {
+  size_t offset = 0;
+  while (offset < STREAM_BUFFER_SIZE) {
+    offset += bandAnalyzer.process(block + offset, STREAM_BUFFER_SIZE - offset);
+    if (!bandAnalyzer.windowReady()) continue;
+    processAudio();
+
+    // A loud window starts (or extends) the live stream by itself
+    if (currentAmplitude > AUDIO_TRIGGER_SPIKE_RMS) startTrigger(AUDIO_TRIGGER_VAD_SPIKE);
+  }
+
+  if (!keywordEnabled) return;
+
+  // A keyword cannot be spotted across lost samples
+  if (gapBefore > 0) keywordSpotter.reset();
+  offset = 0;
+  while (offset < STREAM_BUFFER_SIZE) {
+    offset += keywordSpotter.process(block + offset, STREAM_BUFFER_SIZE - offset);
+    if (keywordSpotter.detected()) processKeyword();
+  }
+}
+
+void AudioDetector::processKeyword() {
+  uint32_t now = millis();
+  if (sosDetected != 0 && now - lastSosTime < AUDIO_EVENT_COOLDOWN_MS) return;
+
+  lastEvent = AUDIO_SOS_VOICE;
+  lastEventTime = now;
+  lastSosTime = now;
+  sosDetected++;
+  startTrigger(AUDIO_TRIGGER_SOUND_EVENT);
+}
+
 void AudioDetector::processAudio() {
-  // Calculate overall amplitude (RMS)
-  currentAmplitude = calculateAmplitude(audioBuffer, FFT_SIZE);
+  // Overall amplitude (RMS) and band energies of the window just completed
+  currentAmplitude = bandAnalyzer.getRms();
+  int16_t thudRms = bandAnalyzer.getBandRms(thudBand);
+  int16_t distressRms = bandAnalyzer.getBandRms(distressBand);
+
+  bool thudOnset = thudRms > (int32_t)previousThudRms * THUD_ONSET_RATIO;
+  previousThudRms = thudRms;
+
+  if (distressRms > DISTRESS_AMPLITUDE_THRESHOLD) {
+    if (distressWindows < UINT16_MAX) distressWindows++;
+  } else {
+    distressWindows = 0;
+  }
 
   // Ignore very quiet sounds (noise floor)
   if (currentAmplitude < NOISE_FLOOR) {
@@ -211,115 +874,221 @@ void AudioDetector::processAudio() {
     return;
   }
 
-  // Detect thud (low-frequency impact)
-  if (detectThud(audioBuffer, FFT_SIZE)) {
+  // One event of each kind per cooldown, so a single fall does not raise
+  // a burst (a thud followed by a scream still raises both)
+  uint32_t now = millis();
+  bool thudAllowed = (thudsDetected == 0 || now - lastThudTime >= AUDIO_EVENT_COOLDOWN_MS);
+  bool distressAllowed = (distressDetected == 0 || now - lastDistressTime >= AUDIO_EVENT_COOLDOWN_MS);
+
+  // Thud: sudden low-frequency impact that outweighs the voice band
+  if (thudAllowed && thudRms > THUD_AMPLITUDE_THRESHOLD && thudRms > distressRms && thudOnset) {
     lastEvent = AUDIO_LOUD_THUD;
-    lastEventTime = millis();
+    lastEventTime = now;
+    lastThudTime = now;
+    thudsDetected++;
+    startTrigger(AUDIO_TRIGGER_SOUND_EVENT);
+    return;
+  }
+
+  // Distress: voice-band energy sustained over DISTRESS_SUSTAIN_MS
+  uint32_t sustainWindows = (uint32_t)DISTRESS_SUSTAIN_MS * I2S_SAMPLE_RATE / 1000 / BAND_WINDOW_SIZE;
+  if (distressAllowed && distressWindows >= sustainWindows) {
+    lastEvent = AUDIO_DISTRESS_SOUND;
+    lastEventTime = now;
+    lastDistressTime = now;
+    distressDetected++;
+    distressWindows = 0;
+    startTrigger(AUDIO_TRIGGER_SOUND_EVENT);
+    return;
+  }
 
+  lastEvent = AUDIO_NONE;
+}
+
+void AudioDetector::dispatchEvents() {
+  // Detected in the capture task; callbacks run here, in loop() context
+  while (thudsHandled != thudsDetected) {
+    thudsHandled++;
     Serial.print(F("[Audio] THUD detected - amplitude: "));
     Serial.println(currentAmplitude);
-
     if (thudCallback) {
       thudCallback();
     }
-    return;
   }
 
-  // Detect distress sounds (mid-frequency sustained)
-  if (detectDistress(audioBuffer, FFT_SIZE)) {
-    lastEvent = AUDIO_DISTRESS_SOUND;
-    lastEventTime = millis();
-
+  while (distressHandled != distressDetected) {
+    distressHandled++;
     Serial.print(F("[Audio] Distress sound - amplitude: "));
     Serial.println(currentAmplitude);
-
     if (distressCallback) {
       distressCallback();
     }
-    return;
   }
 
-  lastEvent = AUDIO_NONE;
+  while (sosHandled != sosDetected) {
+    sosHandled++;
+    Serial.print(F("[Audio] SOS keyword - score: "));
+    Serial.print(keywordSpotter.getLastScore());
+    Serial.println(F("%"));
+    if (sosCallback) {
+      sosCallback();
+    }
+  }
+
+  while (triggersReported != triggersStarted) {
+    triggersReported++;
+    Serial.print(F("[Audio] Streaming triggered ("));
+    Serial.print(triggerReasonName(lastTriggerReason));
+    Serial.println(F(") - flushing pre-trigger history"));
+  }
 }
 
 // ============================================================================
-// AUDIO ANALYSIS FUNCTIONS
+// BLE STREAMING CONFIGURATION
 // ============================================================================
 
-int16_t AudioDetector::calculateAmplitude(int16_t* samples, size_t count) {
-  int32_t sum = 0;
+void AudioDetector::setDataScheduler(DataScheduler* scheduler) {
+  dataScheduler = scheduler;
+}
 
-  for (size_t i = 0; i < count; i++) {
-    int32_t sample = samples[i];
-    sum += (sample * sample);
+void AudioDetector::enableStreaming(bool enable) {
+  streamingEnabled = enable;
+  if (enable) {
+    Serial.println(F("[Audio] BLE streaming enabled with ADPCM compression"));
+  } else {
+    Serial.println(F("[Audio] BLE streaming disabled"));
   }
-
-  // RMS amplitude
-  return (int16_t)sqrt(sum / count);
 }
 
-bool AudioDetector::detectThud(int16_t* samples, size_t count) {
-  // Get energy in low-frequency band (50-500 Hz)
-  int16_t lowFreqEnergy = getFrequencyBandEnergy(samples, count, THUD_FREQ_LOW, THUD_FREQ_HIGH);
+// ============================================================================
+// DISCONTINUOUS TRANSMISSION
+// ============================================================================
 
-  // Thud: high energy in low frequencies, sudden spike
-  return (lowFreqEnergy > THUD_AMPLITUDE_THRESHOLD);
+bool AudioDetector::dtxShouldSuppress() {
+  // Speech resumes full frames at once; the VAD hangover keeps trailing
+  // syllables and breath noise
+  return dtxEnabled && !voiceActive;
 }
 
-bool AudioDetector::detectDistress(int16_t* samples, size_t count) {
-  // Get energy in voice frequency band (300-3000 Hz)
-  int16_t voiceEnergy = getFrequencyBandEnergy(samples, count, DISTRESS_FREQ_LOW, DISTRESS_FREQ_HIGH);
-
-  // Distress: sustained energy in voice range
-  return (voiceEnergy > DISTRESS_AMPLITUDE_THRESHOLD);
+void AudioDetector::sendComfortNoise() {
+  AudioFrameHeader header;
+  header.sequence = frameSequence++;
+  header.sampleIndex = dtxSpanStart;
+  header.sampleCount = (uint16_t)dtxSpanSamples;
+
+  uint8_t slot = PACKET_POOL_NONE;
+  uint8_t* frame = streamDirect() ? dataScheduler->acquireAudioBuffer(slot) : nullptr;
+  if (!frame) frame = comfortNoiseFrame;  // Pool exhausted (sequence shows the loss) or history
+
+  uint8_t zeroCrossingRate = (uint8_t)min((uint32_t)255, dtxSpanZeroCrossings * 255 / dtxSpanSamples);
+  size_t size = writeComfortNoiseFrame(header, rmsFromEnergy(dtxSpanEnergy, dtxSpanSamples),
+                                       zeroCrossingRate, frame);
+  sendFrame(slot, frame, size);
+  dataScheduler->recordDtxSavings(0, size);
+
+  dtxSpanSamples = 0;
+  dtxSpanEnergy = 0;
+  dtxSpanZeroCrossings = 0;
 }
 
-int16_t AudioDetector::getFrequencyBandEnergy(int16_t* samples, size_t count, int freqLow, int freqHigh) {
-  // Simplified frequency band analysis without full FFT
-  // Uses time-domain autocorrelation to estimate dominant frequency
-
-  int32_t energy = 0;
-  int lagMin = I2S_SAMPLE_RATE / freqHigh;  // Lag for high freq
-  int lagMax = I2S_SAMPLE_RATE / freqLow;   // Lag for low freq
-
-  // Autocorrelation to detect periodicity in target frequency range
-  for (int lag = lagMin; lag < lagMax && lag < (int)count / 2; lag++) {
-    int32_t correlation = 0;
+// ============================================================================
+// PRE-TRIGGER HISTORY
+// ============================================================================
 
-    for (size_t i = 0; i < count - lag; i++) {
-      correlation += (int32_t)samples[i] * samples[i + lag];
-    }
+void AudioDetector::sendFrame(uint8_t slot, uint8_t* frame, size_t size) {
+  if (!streamDirect()) {
+    // Gated, or older frames still flushing: park behind them (a pooled
+    // buffer that is not committed simply stays free)
+    history.push(frame, size);
+    dataScheduler->recordAudioCopy(size);
+    return;
+  }
 
-    if (correlation > energy) {
-      energy = correlation;
-    }
+  if (slot != PACKET_POOL_NONE) {
+    dataScheduler->commitAudio(slot, size);
+  } else {
+    dataScheduler->enqueueAudio(frame, size);
   }
+}
 
-  // Normalize by sample count
-  return (int16_t)(energy / (count * 100));
+void AudioDetector::flushHistory() {
+  // An open feature frame holds the next pool slot; flush after it is sent
+  if (featureSlot != PACKET_POOL_NONE) return;
+
+  // Oldest first, while the pool and queue have room; the rest waits for
+  // the next block (BLE frees slots as it sends). Live frames keep joining
+  // the back of the history until it is empty, so nothing overtakes it
+  while (!history.isEmpty() && dataScheduler->hasAudioRoom()) {
+    uint8_t slot;
+    uint8_t* buffer = dataScheduler->acquireAudioBuffer(slot);
+    if (!buffer) break;
+    size_t size = history.pop(buffer, MAX_AUDIO_SIZE);
+    if (size == 0) continue;
+
+    dataScheduler->recordAudioCopy(size);
+    if (!dataScheduler->commitAudio(slot, size, true)) break;
+    historyFramesFlushed++;
+    historyBytesFlushed += size;
+  }
 }
 
-// ============================================================================
-// BLE STREAMING CONFIGURATION
-// ============================================================================
+void AudioDetector::startTrigger(AudioTriggerReason reason) {
+  if (!preTriggerEnabled || !streamingEnabled) return;
 
-void AudioDetector::setDataScheduler(DataScheduler* scheduler) {
-  dataScheduler = scheduler;
-  if (scheduler) {
-    // Initialize with low packet rate (will adjust based on VAD)
-    scheduler->setAudioRateLimit(AUDIO_MAX_PACKETS_PER_SEC_LOW);
+  // Counted once per stream; a trigger while live only re-arms the hold
+  if (triggerHoldBlocks == 0) {
+    triggerCounts[reason]++;
+    lastTriggerReason = reason;
+    triggersStarted++;
   }
+  triggerHoldBlocks = (uint32_t)AUDIO_TRIGGER_HOLD_MS * I2S_SAMPLE_RATE / 1000 / STREAM_BUFFER_SIZE;
 }
 
-void AudioDetector::enableStreaming(bool enable) {
-  streamingEnabled = enable;
+void AudioDetector::triggerStreaming(AudioTriggerReason reason) {
+  if (reason == AUDIO_TRIGGER_NONE || reason >= AUDIO_TRIGGER_REASONS) return;
+  pendingTrigger = (uint8_t)reason;
+}
+
+void AudioDetector::setPreTrigger(bool enable) {
+  // The history is only allocated if pre-trigger was enabled at begin()
+  if (enable && history.getCapacity() == 0) {
+    Serial.println(F("[Audio] WARNING: no pre-trigger history allocated"));
+    return;
+  }
+  preTriggerEnabled = enable;
   if (enable) {
-    Serial.println(F("[Audio] BLE streaming enabled with ADPCM compression"));
+    Serial.println(F("[Audio] Pre-trigger streaming enabled (streams on trigger only)"));
   } else {
-    Serial.println(F("[Audio] BLE streaming disabled"));
+    Serial.println(F("[Audio] Pre-trigger streaming disabled (continuous)"));
   }
 }
 
+void AudioDetector::setDTX(bool enable) {
+  pendingDTX = enable ? 1 : 0;
+
+  Serial.print(F("[Audio] DTX (comfort noise during silence) "));
+  Serial.println(enable ? F("enabled") : F("disabled"));
+}
+
+void AudioDetector::setCodecMode(AudioCodecMode mode) {
+  if (!audioCodecModeValid(mode)) return;
+  pendingCodecMode = (uint8_t)mode;
+
+  Serial.print(F("[Audio] Codec mode -> "));
+  Serial.print(audioCodecName(mode));
+  Serial.print(F(" ("));
+  Serial.print(audioCodecBitrate(mode) / 1000);
+  Serial.println(F(" kbps)"));
+}
+
+void AudioDetector::setLinkAdaptation(bool enable) {
+  linkAdaptEnabled = enable;
+  if (!enable) pendingCodecMode = (uint8_t)requestedCodecMode;  // Back to the requested mode
+
+  Serial.print(F("[Audio] Codec adaptation to the BLE link "));
+  Serial.println(enable ? F("enabled") : F("disabled"));
+}
+
 void AudioDetector::setAdaptiveRate(bool enable) {
   adaptiveRateEnabled = enable;
   if (enable) {
@@ -340,3 +1109,7 @@ void AudioDetector::setThudCallback(void (*callback)()) {
 void AudioDetector::setDistressCallback(void (*callback)()) {
   distressCallback = callback;
 }
+
+void AudioDetector::setSosCallback(void (*callback)()) {
+  sosCallback = callback;
+}
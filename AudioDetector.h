@@ -4,9 +4,18 @@
  *
  * Features:
  * - I2S MEMS microphone input (16kHz, 16-bit)
- * - DMA-based continuous sampling
- * - FFT frequency analysis (128 samples)
- * - Sound event detection (fall thud, distress sounds)
+ * - DMA-based continuous sampling, drained by a dedicated capture task
+ * - Goertzel band analysis (128-sample windows, BandEnergy.h)
+ * - Sound event detection (fall thud, distress sounds), on the watch
+ *   whether or not the phone is connected
+ * - Feature-stream mode: log-mel vectors instead of audio (MelFeatures.h)
+ * - SOS keyword spotting on the watch (int8 model, KeywordSpotter.h)
+ * - Pre-trigger history: frames stay in RAM until a trigger, then the
+ *   history is flushed ahead of the live stream (AudioHistory.h)
+ * - Fixed-point conditioning (DC block, high-pass) of every block and AGC
+ *   ahead of the encoder (AudioPipeline.h)
+ * - Voice activity (noise floor, ZCR, flatness; VoiceActivity.h) drives the
+ *   packet rate limit, adaptive sample rate and DTX
  * - Low-latency callback system
  *
  * Hardware:
@@ -22,41 +31,75 @@
 #define AUDIO_DETECTOR_H
 
 #include <Arduino.h>
-#include <driver/i2s.h>
-#include "ADPCMCodec.h"     // ADPCM compression
+#include "Hal.h"             // I2S / clock abstraction
+#include "AudioCodec.h"     // ADPCM codec modes (bitrate ladder)
+#include "AudioFrame.h"     // Self-describing frame header
+#include "BandEnergy.h"     // Goertzel band energies for event detection
+#include "MelFeatures.h"    // Log-mel front-end for the feature stream
+#include "KeywordSpotter.h"  // On-device SOS keyword model
+#include "AudioHistory.h"   // Pre-trigger frame ring
+#include "VoiceActivity.h"  // Multi-feature VAD
+#include "AudioPipeline.h"  // DC block / high-pass / AGC stages
+#include "AudioSource.h"    // I2S microphone or replay
 #include "DataScheduler.h"  // Priority-based BLE transmission
 
 // ============================================================================
 // I2S CONFIGURATION
 // ============================================================================
 
-#define I2S_PORT I2S_NUM_0
 #define I2S_SAMPLE_RATE 16000  // 16kHz sample rate
 #define I2S_BITS_PER_SAMPLE 16
 #define I2S_CHANNELS 1  // Mono
 #define I2S_DMA_BUF_COUNT 4
 #define I2S_DMA_BUF_LEN 256  // 256 samples per buffer
+#define I2S_EVENT_QUEUE_SIZE 8  // Driver events (RX done / RX overrun)
 
 // I2S Pin Configuration (ESP32-C3 CodeCell) - Match Config.h
 // Note: Config.h defines these pins, using them here for consistency
 
+// ============================================================================
+// CAPTURE TASK CONFIGURATION
+// ============================================================================
+
+// The capture task wakes on I2S driver events, drains every full DMA buffer
+// into the capture ring and encodes there, so loop() never waits on audio
+// and a slow loop() never costs samples. If the task cannot be started,
+// update() polls the same ring without blocking.
+#define AUDIO_CAPTURE_TASK true
+#define AUDIO_TASK_STACK_SIZE 4096     // bytes
+#define AUDIO_TASK_PRIORITY 5          // Above loop() (1), below the BLE host
+#define AUDIO_TASK_EVENT_TIMEOUT_MS 100
+#define AUDIO_RING_BLOCKS 8            // 256-sample blocks (128 ms at 16 kHz)
+
 // ============================================================================
 // AUDIO PROCESSING CONFIGURATION
 // ============================================================================
 
-#define FFT_SIZE 128  // FFT window size (not used - streaming only)
 #define AUDIO_UPDATE_INTERVAL 100  // ms - not used (continuous streaming)
 
-// Sound event detection thresholds
+// Sound event detection thresholds (band RMS per 8 ms window, same units
+// as sample amplitude)
 #define THUD_FREQ_LOW 50        // Hz - low frequency for impact sounds
 #define THUD_FREQ_HIGH 500      // Hz - high frequency for impact sounds
 #define THUD_AMPLITUDE_THRESHOLD 8000  // Amplitude threshold for fall detection
+#define THUD_ONSET_RATIO 2      // Thud band must jump this much over the previous window
 
 #define DISTRESS_FREQ_LOW 300   // Hz - human voice low range
 #define DISTRESS_FREQ_HIGH 3000 // Hz - human voice high range
 #define DISTRESS_AMPLITUDE_THRESHOLD 5000  // Amplitude for distress sounds
+#define DISTRESS_SUSTAIN_MS 400 // Voice-band energy must persist this long
 
 #define NOISE_FLOOR 1000  // Minimum amplitude to consider (ignore background noise)
+#define AUDIO_EVENT_COOLDOWN_MS 3000  // Quiet time after an event before the next
+
+// Feature stream: 4 x 40 bins + header = 172 bytes every 40 ms (~4.3 kB/s,
+// 25 pkt/s)
+#define AUDIO_FEATURE_VECTORS_PER_FRAME 4
+
+// Pre-trigger history: IMA4_16K frames (12 + 128 bytes + 2-byte length) at
+// 62.5 frames/s. Silence under DTX takes far less, so on a quiet day the
+// history reaches back much further than AUDIO_PRETRIGGER_SECONDS
+#define AUDIO_HISTORY_BYTES_PER_SECOND 8875
 
 // ============================================================================
 // AUDIO EVENT TYPES
@@ -66,7 +109,19 @@ enum AudioEventType {
   AUDIO_NONE,
   AUDIO_LOUD_THUD,      // Sudden impact (fall-related)
   AUDIO_DISTRESS_SOUND, // Cry, scream, distress vocalization
-  AUDIO_SUSTAINED_LOUD  // Continuous loud sound
+  AUDIO_SUSTAINED_LOUD, // Continuous loud sound
+  AUDIO_SOS_VOICE       // Spoken "SOS" keyword
+};
+
+// What started a triggered stream
+enum AudioTriggerReason {
+  AUDIO_TRIGGER_NONE,
+  AUDIO_TRIGGER_FALL,          // IMU fall detection
+  AUDIO_TRIGGER_MANUAL_ALERT,  // Button
+  AUDIO_TRIGGER_VAD_SPIKE,     // Window RMS above AUDIO_TRIGGER_SPIKE_RMS
+  AUDIO_TRIGGER_SOUND_EVENT,   // Thud, distress sound or SOS keyword
+  AUDIO_TRIGGER_COMMAND,       // "AUDIO_TRIGGER" from the phone
+  AUDIO_TRIGGER_REASONS
 };
 
 // ============================================================================
@@ -81,7 +136,13 @@ public:
   bool begin();
   void end();
 
-  // Audio processing
+  // Read samples from a replay source instead of the I2S microphone (call
+  // before begin(); nullptr = microphone). update() then captures in loop()
+  void setAudioSource(const AudioSource* source);
+  bool isSourceExhausted() { return sourceExhausted; }
+
+  // Audio processing (captures only if the capture task is not running)
+  // and sound event callbacks
   void update();
 
   // BLE audio streaming
@@ -89,67 +150,231 @@ public:
   void enableStreaming(bool enable);
   bool isStreaming() { return streamingEnabled; }
 
-  // Adaptive sample rate based on voice activity
+  // Codec mode (applied at the next frame boundary; safe from BLE callbacks).
+  // With link adaptation the requested mode is the top of the ladder the
+  // stream steps down (and back up) as the BLE link budget changes
+  void setCodecMode(AudioCodecMode mode);
+  AudioCodecMode getCodecMode() { return audioCodec.getMode(); }
+  AudioCodecMode getRequestedCodecMode() { return requestedCodecMode; }
+  void setLinkAdaptation(bool enable);
+
+  // Discontinuous transmission: comfort noise instead of silent frames
+  // (applied at the next frame boundary)
+  void setDTX(bool enable);
+  bool isDTXActive() { return dtxActive; }
+
+  // Adaptive rate: silence coded at 8 kHz, speech at the codec mode's rate
+  // (applied at the next frame boundary)
   void setAdaptiveRate(bool enable);
   bool isVoiceActive() { return voiceActive; }
 
-  // Event callbacks
+  // Audio frames or log-mel feature frames on the audio characteristic
+  // (applied at the next block boundary)
+  void setStreamMode(AudioStreamMode mode);
+  AudioStreamMode getStreamMode() { return streamMode; }
+
+  // Pre-trigger streaming: frames go to the RAM history until a trigger,
+  // which flushes the history and streams live for AUDIO_TRIGGER_HOLD_MS
+  // (re-armed by every trigger; applied at the next block boundary).
+  // Disabled = continuous streaming
+  void setPreTrigger(bool enable);
+  void triggerStreaming(AudioTriggerReason reason);
+  bool isTriggered() { return triggerHoldBlocks > 0; }
+
+  // Event callbacks (called from update(), in loop() context)
   void setThudCallback(void (*callback)());
   void setDistressCallback(void (*callback)());
+  void setSosCallback(void (*callback)());
 
   // Status
   bool isInitialized() { return initialized; }
   int16_t getCurrentAmplitude() { return currentAmplitude; }
   AudioEventType getLastEvent() { return lastEvent; }
 
+  // Capture statistics
+  bool isCaptureTaskRunning() { return taskRunning; }
+  uint32_t getDmaOverruns() { return dmaOverruns; }    // I2S driver dropped a DMA buffer
+  uint32_t getRingOverruns() { return ringOverruns; }  // Encoder fell a full ring behind
+  uint32_t getSamplesLost() { return samplesLost; }
+  uint32_t getThudCount() { return thudsDetected; }
+  uint32_t getDistressCount() { return distressDetected; }
+  uint32_t getSosCount() { return sosDetected; }
+  uint32_t getTriggerCount() { return triggersStarted; }
+  void printStatistics();
+
 private:
   bool initialized;
   unsigned long lastUpdateTime;
 
-  // Audio buffers
-  int16_t audioBuffer[FFT_SIZE];
-  size_t audioBufferIndex;
+  // Sound event detection (capture side): bands of the last window
+  BandEnergyAnalyzer bandAnalyzer;
+  int8_t thudBand;
+  int8_t distressBand;
+  int16_t previousThudRms;
+  uint16_t distressWindows;  // Consecutive windows above the distress threshold
 
   // Audio analysis results
-  int16_t currentAmplitude;
-  AudioEventType lastEvent;
+  volatile int16_t currentAmplitude;
+  volatile AudioEventType lastEvent;
   unsigned long lastEventTime;
+  uint32_t lastThudTime;      // Per-kind cooldown
+  uint32_t lastDistressTime;
+  uint32_t lastSosTime;
+
+  // SOS keyword spotting (capture side)
+  bool keywordEnabled;
+  KeywordSpotter keywordSpotter;
+
+  // Events raised by the capture side, dispatched by update()
+  volatile uint32_t thudsDetected;
+  volatile uint32_t distressDetected;
+  volatile uint32_t sosDetected;
+  uint32_t thudsHandled;
+  uint32_t distressHandled;
+  uint32_t sosHandled;
 
   // BLE streaming with compression
   DataScheduler* dataScheduler;
   bool streamingEnabled;
   bool adaptiveRateEnabled;
-  bool voiceActive;
+  bool voiceActive;               // VAD output (attack / hangover applied)
+  uint32_t reducedRateBlocks;      // Blocks encoded at 8 kHz
+  uint32_t reducedRateBytesSaved;  // Payload bytes of sent frames vs. full rate
 
-  // ADPCM compression
-  ADPCMCodec adpcmCodec;
+  // Capture ring: DMA data is read straight into 256-sample blocks, which
+  // are encoded in place. Gaps (overruns) are carried into the frame
+  // sampleIndex so the receiver conceals them.
   static const size_t STREAM_BUFFER_SIZE = 256;  // 256 samples for compression
-  int16_t streamBuffer[STREAM_BUFFER_SIZE];
-  size_t streamBufferIndex;
-  uint8_t compressedBuffer[128];  // ADPCM output (4:1 compression)
+  static const size_t RING_BLOCKS = AUDIO_RING_BLOCKS;
+  int16_t ring[RING_BLOCKS][STREAM_BUFFER_SIZE];
+  uint32_t ringGapBefore[RING_BLOCKS];  // Samples lost just before each block
+  uint32_t ringHead;                    // Blocks completed
+  uint32_t ringTail;                    // Blocks encoded (or discarded)
+  size_t ringFill;                      // Samples in the block being filled
+  uint32_t pendingGapSamples;           // Lost samples not yet assigned to a block
+
+  // Capture task
+  volatile bool taskRunning;
+  volatile bool taskStopRequested;
+
+  // Capture statistics
+  volatile uint32_t blocksCaptured;
+  volatile uint32_t dmaOverruns;
+  volatile uint32_t ringOverruns;
+  volatile uint32_t samplesLost;
+  volatile uint8_t ringHighWater;  // Most blocks waiting to be encoded
+
+  // DSP: input stages run on every block in the ring (before event
+  // detection), stream stages only on blocks going to the encoder
+  AudioPipeline inputPipeline;
+  AudioPipeline streamPipeline;
+
+  // ADPCM compression
+  AudioCodec audioCodec;
+  volatile uint8_t pendingCodecMode;  // 0 = no change requested
+
+  // Codec adaptation to the link budget (DataScheduler's governor), checked
+  // every AUDIO_LINK_CHECK_MS of stream
+  AudioCodecMode requestedCodecMode;
+  bool linkAdaptEnabled;
+  uint32_t linkCheckBlocks;      // Blocks since the last check
+  uint8_t linkGoodChecks;        // Consecutive checks with room for the next mode up
+  uint8_t linkUpshiftChecks;     // ... needed to step up (doubles after congestion)
+  uint32_t linkCongestedSeen;    // Governor congested windows at the last check
+  uint32_t linkRefusedSeen;      // Frames refused over the link budget or expired, ditto
+  uint32_t linkDownshifts;
+  uint32_t linkUpshifts;
+  uint8_t frameBuffer[AUDIO_FRAME_HEADER_SIZE + STREAM_BUFFER_SIZE / 2];  // Scratch frame (after silence / pool exhausted)
+  uint16_t frameSequence;     // +1 per frame handed to DataScheduler, sent or not
+  uint32_t frameSampleIndex;  // Stream position of the next frame
+
+  // Discontinuous transmission (DTX)
+  bool dtxEnabled;
+  volatile int8_t pendingDTX;     // -1 = no change requested, else 0/1
+  bool dtxActive;                 // Currently replacing frames with comfort noise
+  uint32_t dtxSpanStart;          // sampleIndex of the first suppressed block
+  uint32_t dtxSpanSamples;        // Suppressed samples not yet described
+  uint64_t dtxSpanEnergy;
+  uint32_t dtxSpanZeroCrossings;
+  uint8_t comfortNoiseFrame[AUDIO_FRAME_HEADER_SIZE + AUDIO_FRAME_CN_PAYLOAD_SIZE];  // Scratch, as above
 
-  // Voice activity detection
-  uint32_t lastVADCheck;
-  uint32_t voiceActiveStartTime;
-  static const uint32_t VAD_CHECK_INTERVAL = 100;  // Check every 100ms
+  // Feature stream: vectors are written straight into a pooled frame that
+  // is held until AUDIO_FEATURE_VECTORS_PER_FRAME are in it
+  AudioStreamMode streamMode;
+  volatile int8_t pendingStreamMode;  // -1 = no change requested
+  MelFeatureExtractor melExtractor;
+  uint8_t featureSlot;
+  uint8_t* featureFrame;              // nullptr = no frame open
+  uint8_t featureVectors;             // Vectors in the open frame
+  uint32_t featureFrameIndex;         // Hop start of the open frame's first vector
+  uint32_t featureHopIndex;           // Hop start of the vector being computed
+  uint8_t featureBuffer[AUDIO_FRAME_HEADER_SIZE + AUDIO_FEATURE_VECTORS_PER_FRAME * MEL_BINS];  // Scratch
+
+  // Pre-trigger history. Frames are encoded into scratch while they cannot
+  // go straight to the pool (gated, or history still flushing) and parked
+  // in the history, so order is kept: history first, then live
+  bool preTriggerEnabled;
+  AudioHistory history;
+  volatile uint8_t pendingTrigger;     // AudioTriggerReason from loop(), NONE = none
+  uint32_t triggerHoldBlocks;          // Blocks left in the live stream (0 = gated)
+  uint32_t triggerCounts[AUDIO_TRIGGER_REASONS];  // Streams started, by reason
+  volatile uint32_t triggersStarted;
+  uint32_t triggersReported;
+  uint8_t lastTriggerReason;
+  uint32_t streamBlocks;               // Blocks encoded for the stream
+  uint32_t liveBlocks;                 // ... of which while triggered (duty cycle)
+  uint32_t historyFramesFlushed;
+  uint32_t historyBytesFlushed;
+
+  // Voice activity detection (capture task)
+  VoiceActivityDetector vad;
 
   // Callbacks
   void (*thudCallback)();
   void (*distressCallback)();
+  void (*sosCallback)();
+
+  // Sample source (nullptr = I2S through the HAL)
+  const AudioSource* audioSource;
+  bool sourceExhausted;
 
   // I2S functions
   bool initI2S();
   void deinitI2S();
+  bool readAudioSamples(int16_t* samples, size_t maxSamples, size_t& samplesRead);
+
+  // Capture
+  static void captureTaskEntry(void* context);
+  void captureTask();
+  void captureAvailable();  // Drain DMA into the ring (never blocks)
+  void processRing();       // Encode complete blocks, draining DMA between them
+  void recordDmaOverrun();
+
+  // Link adaptation
+  void adaptCodecToLink();
+
+  // DTX
+  bool dtxShouldSuppress();
+  void sendComfortNoise();
+
+  // Feature stream
+  void applyStreamMode();
+  void streamFeatures(const int16_t* block, uint32_t gapBefore);  // Log-mel vectors into a pooled frame
+  void flushFeatures();
+
+  // Pre-trigger history
+  bool streamLive() { return !preTriggerEnabled || triggerHoldBlocks > 0; }
+  bool streamDirect() { return streamLive() && history.isEmpty(); }  // Frames may use the pool
+  void startTrigger(AudioTriggerReason reason);  // Capture side
+  void sendFrame(uint8_t slot, uint8_t* frame, size_t size);  // Queue, or park in the history
+  void flushHistory();
 
   // Audio processing
-  void readAudioSamples();
-  void processAudio();
-  int16_t calculateAmplitude(int16_t* samples, size_t count);
-  bool detectThud(int16_t* samples, size_t count);
-  bool detectDistress(int16_t* samples, size_t count);
-
-  // Simple frequency analysis (peak detection in frequency bands)
-  int16_t getFrequencyBandEnergy(int16_t* samples, size_t count, int freqLow, int freqHigh);
+  void streamBlock(const int16_t* block, uint32_t gapBefore);  // Encode into a pooled frame and queue it
+  void analyzeBlock(const int16_t* block, uint32_t gapBefore);  // Feed the band analyzer and keyword spotter
+  void processAudio();                      // Event decision per completed window
+  void processKeyword();                    // Cooldown for a spotted keyword
+  void dispatchEvents();
 };
 
 #endif // AUDIO_DETECTOR_H
@@ -0,0 +1,180 @@
+/*
+ * Audio Frame Implementation
+ * Header (de)serialization and the reference framed-ADPCM receiver
+ */
+
+#include "AudioFrame.h"
+
+// Concealment fades to silence over this many samples (2 ms @ 16 kHz)
+static const size_t CONCEAL_FADE_SAMPLES = 32;
+
+// ============================================================================
+// HEADER SERIALIZATION
+// ============================================================================
+
+void writeAudioFrameHeader(const AudioFrameHeader& header, uint8_t* frame) {
+  frame[0] = header.format;
+  frame[1] = header.stepIndex;
+  frame[2] = header.sequence & 0xFF;
+  frame[3] = header.sequence >> 8;
+  frame[4] = header.sampleIndex & 0xFF;
+  frame[5] = (header.sampleIndex >> 8) & 0xFF;
+  frame[6] = (header.sampleIndex >> 16) & 0xFF;
+  frame[7] = header.sampleIndex >> 24;
+  frame[8] = (uint16_t)header.predictor & 0xFF;
+  frame[9] = (uint16_t)header.predictor >> 8;
+  frame[10] = header.sampleCount & 0xFF;
+  frame[11] = header.sampleCount >> 8;
+}
+
+size_t writeComfortNoiseFrame(AudioFrameHeader header, int16_t rmsLevel, uint8_t zeroCrossingRate, uint8_t* frame) {
+  header.format = AUDIO_FRAME_COMFORT_NOISE;
+  writeAudioFrameHeader(header, frame);
+  frame[AUDIO_FRAME_HEADER_SIZE] = (uint16_t)rmsLevel & 0xFF;
+  frame[AUDIO_FRAME_HEADER_SIZE + 1] = (uint16_t)rmsLevel >> 8;
+  frame[AUDIO_FRAME_HEADER_SIZE + 2] = zeroCrossingRate;
+  return AUDIO_FRAME_HEADER_SIZE + AUDIO_FRAME_CN_PAYLOAD_SIZE;
+}
+
+bool parseAudioFrameHeader(const uint8_t* frame, size_t length, AudioFrameHeader& header) {
+  if (length < AUDIO_FRAME_HEADER_SIZE) return false;
+
+  header.format = frame[0];
+  header.stepIndex = frame[1];
+  header.sequence = frame[2] | (frame[3] << 8);
+  header.sampleIndex = frame[4] | (frame[5] << 8) | (frame[6] << 16) | ((uint32_t)frame[7] << 24);
+  header.predictor = (int16_t)(frame[8] | (frame[9] << 8));
+  header.sampleCount = frame[10] | (frame[11] << 8);
+
+  if (header.format == AUDIO_FRAME_COMFORT_NOISE) {
+    return (length - AUDIO_FRAME_HEADER_SIZE) >= AUDIO_FRAME_CN_PAYLOAD_SIZE;
+  }
+  if (header.format == AUDIO_FRAME_LOG_MEL) {
+    if (header.stepIndex == 0 || header.predictor <= 0) return false;
+    return (length - AUDIO_FRAME_HEADER_SIZE) >=
+           (size_t)(header.sampleCount / header.predictor) * header.stepIndex;
+  }
+  if (!audioCodecModeValid(header.format)) return false;
+  if (header.stepIndex > 88) return false;
+  return (length - AUDIO_FRAME_HEADER_SIZE) >=
+         audioCodecPayloadBytes((AudioCodecMode)header.format, header.sampleCount);
+}
+
+// ============================================================================
+// RECEIVER-SIDE DECODER
+// ============================================================================
+
+AudioFrameDecoder::AudioFrameDecoder() {
+  reset();
+}
+
+void AudioFrameDecoder::reset() {
+  codec.resetDecoder();
+  synced = false;
+  expectedSequence = 0;
+  expectedSampleIndex = 0;
+  lastSample = 0;
+  concealFrom = 0;
+  lastGapSamples = 0;
+  comfortNoiseSamples = 0;
+  noiseGain = 0;
+  noiseSmoothing = 32767;
+  noiseFiltered = 0;
+  noiseState = 0x2545F491;
+  featureVectors = 0;
+  featureBins = 0;
+  features = nullptr;
+  framesDecoded = 0;
+  framesLost = 0;
+  samplesLost = 0;
+  bursts = 0;
+}
+
+size_t AudioFrameDecoder::decodeFrame(const uint8_t* frame, size_t length, int16_t* pcmOutput, size_t maxSamples) {
+  AudioFrameHeader header;
+  if (!parseAudioFrameHeader(frame, length, header)) return 0;
+
+  // Comfort-noise and feature spans are counted in 16 kHz ticks like the
+  // stream position
+  bool comfortNoise = (header.format == AUDIO_FRAME_COMFORT_NOISE);
+  bool featureFrame = (header.format == AUDIO_FRAME_LOG_MEL);
+  if (!comfortNoise && !featureFrame && header.sampleCount > maxSamples) return 0;
+  AudioCodecMode mode = (AudioCodecMode)header.format;
+  uint8_t decimation = (comfortNoise || featureFrame) ? 1 : audioCodecDecimation(mode);
+
+  // Gap detection: sample counter (16 kHz ticks) gives the exact loss,
+  // sequence the frame count
+  lastGapSamples = 0;
+  if (!synced) {
+    bursts++;
+  } else {
+    uint32_t gap = header.sampleIndex - expectedSampleIndex;
+    if (gap > AUDIO_FRAME_BURST_GAP && gap < 0x80000000UL) {
+      bursts++;  // Untransmitted time between triggered streams
+    } else if (gap != 0 && gap < 0x80000000UL) {  // Ignore duplicates / reordering
+      lastGapSamples = gap / decimation;
+      concealFrom = lastSample;
+      samplesLost += gap;
+      framesLost += (uint16_t)(header.sequence - expectedSequence);
+    }
+  }
+
+  synced = true;
+  expectedSequence = header.sequence + 1;
+  expectedSampleIndex = header.sampleIndex + (uint32_t)header.sampleCount * decimation;
+  framesDecoded++;
+
+  comfortNoiseSamples = 0;
+  featureVectors = 0;
+  if (featureFrame) {
+    featureVectors = (uint8_t)(header.sampleCount / header.predictor);
+    featureBins = header.stepIndex;
+    features = (const int8_t*)(frame + AUDIO_FRAME_HEADER_SIZE);
+    lastSample = 0;
+    return 0;
+  }
+  if (comfortNoise) {
+    const uint8_t* payload = frame + AUDIO_FRAME_HEADER_SIZE;
+    int32_t level = (int16_t)(payload[0] | (payload[1] << 8));
+    float zeroCrossingRate = payload[2] / 255.0f;
+
+    // White noise crosses zero at ~0.5 per sample; fewer crossings = darker
+    // noise, modelled with a one-pole low-pass and gain compensation
+    float smoothing = min(1.0f, max(0.05f, 2.0f * zeroCrossingRate));
+    float whiteRms = 32768.0f / sqrtf(3.0f);
+    float filterGain = sqrtf((2.0f - smoothing) / smoothing);
+    noiseSmoothing = (int32_t)(smoothing * 32767.0f);
+    noiseGain = (int32_t)(level * filterGain / whiteRms * 4096.0f);
+    comfortNoiseSamples = header.sampleCount;
+    return 0;
+  }
+
+  // Resync predictor from the header every frame (no drift after drops);
+  // the mode tag selects the decoder
+  size_t decoded = codec.decode(mode, header.predictor, header.stepIndex,
+                                frame + AUDIO_FRAME_HEADER_SIZE, header.sampleCount, pcmOutput);
+  if (decoded > 0) lastSample = pcmOutput[decoded - 1];
+
+  return decoded;
+}
+
+void AudioFrameDecoder::conceal(int16_t* pcmOutput, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    if (i < CONCEAL_FADE_SAMPLES) {
+      pcmOutput[i] = (int16_t)((int32_t)concealFrom * (int32_t)(CONCEAL_FADE_SAMPLES - 1 - i) / (int32_t)CONCEAL_FADE_SAMPLES);
+    } else {
+      pcmOutput[i] = 0;
+    }
+  }
+}
+
+void AudioFrameDecoder::generateComfortNoise(int16_t* pcmOutput, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    noiseState = noiseState * 1664525u + 1013904223u;
+    int32_t white = (int16_t)(noiseState >> 16);
+    noiseFiltered += ((white - noiseFiltered) * noiseSmoothing) >> 15;
+    int32_t sample = (noiseFiltered * noiseGain) >> 12;
+    pcmOutput[i] = (int16_t)max((int32_t)-32768, min((int32_t)32767, sample));
+  }
+  lastSample = 0;
+}
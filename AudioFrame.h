@@ -0,0 +1,180 @@
+/*
+ * Self-describing audio frames for BLE streaming
+ * Every audio notification carries enough state to decode on its own
+ *
+ * Frame layout (little-endian, AUDIO_FRAME_HEADER_SIZE = 12 bytes + payload):
+ *   [0]     format       AudioCodecMode tag (AUDIO_CODEC_IMA4_16K, ...)
+ *   [1]     stepIndex    ADPCM step index before the first sample (0-88)
+ *   [2..3]  sequence     Frame counter, +1 per encoded frame (wraps)
+ *   [4..7]  sampleIndex  Stream position of the first sample, in 16 kHz
+ *                        ticks whatever the mode (wraps)
+ *   [8..9]  predictor    ADPCM predicted sample before the first sample
+ *   [10..11] sampleCount Coded samples in the payload (at the mode's rate)
+ *   [12..]  payload      Mode-specific codes (see AudioCodec.h)
+ *
+ * Comfort-noise frames (format AUDIO_FRAME_COMFORT_NOISE, sent during DTX)
+ * describe a silent span instead of coding it: sampleCount is the span in
+ * 16 kHz ticks and the payload is [0..1] RMS level, [2] zero-crossing rate
+ * (crossings per sample x 255, i.e. noise colour). Suppressed blocks do not
+ * consume sequence numbers, so DTX never looks like loss.
+ *
+ * Log-mel feature frames (format AUDIO_FRAME_LOG_MEL, feature-stream mode)
+ * carry int8 log-mel vectors instead of audio (see MelFeatures.h):
+ * stepIndex is the bins per vector, predictor the hop in 16 kHz ticks,
+ * sampleIndex the start of the first vector's hop and sampleCount the span
+ * covered (vectors x hop). The payload is the vectors back to back.
+ *
+ * Frames that are rate-limited or dropped by DataScheduler still consume a
+ * sequence number, so the receiver sees the gap, conceals the lost samples
+ * and resyncs its predictor from the next header instead of drifting.
+ *
+ * With pre-trigger streaming the watch only sends bursts around incidents,
+ * each starting with buffered history. A jump of more than
+ * AUDIO_FRAME_BURST_GAP ticks is the time between bursts, not loss: it is
+ * not concealed and starts a new burst at the receiver.
+ */
+
+#ifndef AUDIO_FRAME_H
+#define AUDIO_FRAME_H
+
+#include <Arduino.h>
+#include "AudioCodec.h"
+
+// ============================================================================
+// FRAME FORMAT
+// ============================================================================
+
+#define AUDIO_FRAME_HEADER_SIZE 12
+#define AUDIO_FRAME_COMFORT_NOISE 0x80   // DTX descriptor (not a codec mode)
+#define AUDIO_FRAME_CN_PAYLOAD_SIZE 3
+#define AUDIO_FRAME_LOG_MEL 0x81         // Feature vectors (not a codec mode)
+#define AUDIO_FRAME_BURST_GAP 16000      // 16 kHz ticks (1 s): longer jumps start a new burst
+
+// What the audio characteristic carries
+enum AudioStreamMode {
+  AUDIO_STREAM_CODEC,     // ADPCM audio frames (+ comfort noise)
+  AUDIO_STREAM_FEATURES   // Log-mel feature frames
+};
+
+struct AudioFrameHeader {
+  uint8_t format;
+  uint8_t stepIndex;
+  uint16_t sequence;
+  uint32_t sampleIndex;
+  int16_t predictor;
+  uint16_t sampleCount;
+
+  AudioFrameHeader()
+    : format(AUDIO_CODEC_IMA4_16K), stepIndex(0), sequence(0),
+      sampleIndex(0), predictor(0), sampleCount(0) {}
+};
+
+/**
+ * Serialize header into the first AUDIO_FRAME_HEADER_SIZE bytes of frame
+ */
+void writeAudioFrameHeader(const AudioFrameHeader& header, uint8_t* frame);
+
+/**
+ * Build a comfort-noise frame (header.format is overridden)
+ * @return Frame size (AUDIO_FRAME_HEADER_SIZE + AUDIO_FRAME_CN_PAYLOAD_SIZE)
+ */
+size_t writeComfortNoiseFrame(AudioFrameHeader header, int16_t rmsLevel, uint8_t zeroCrossingRate, uint8_t* frame);
+
+/**
+ * Parse header from a received frame
+ * @return false if the frame is too short for its payload or the mode is unknown
+ */
+bool parseAudioFrameHeader(const uint8_t* frame, size_t length, AudioFrameHeader& header);
+
+// ============================================================================
+// RECEIVER-SIDE DECODER
+// ============================================================================
+
+/**
+ * Reference receiver for framed ADPCM (host tools, gateway; mirrors the
+ * logic the phone app needs). Detects lost frames from the sample counter,
+ * resyncs the predictor from every header, and can synthesize a short
+ * fade-out to conceal the gap.
+ */
+class AudioFrameDecoder {
+public:
+  AudioFrameDecoder();
+
+  void reset();
+
+  /**
+   * Decode one frame into pcmOutput
+   * @param maxSamples Capacity of pcmOutput
+   * @return Samples decoded (0 if the frame is invalid or too large, or a
+   *         comfort-noise or feature frame: see getComfortNoiseSamples(),
+   *         getFeatureVectors())
+   */
+  size_t decodeFrame(const uint8_t* frame, size_t length, int16_t* pcmOutput, size_t maxSamples);
+
+  /**
+   * Samples missing between the previous frame and the last decoded one,
+   * at the last frame's coded rate (0 if contiguous). Insert conceal()
+   * output of this length ahead of the samples returned by decodeFrame().
+   */
+  uint32_t getLastGapSamples() const { return lastGapSamples; }
+
+  /**
+   * Fill count samples of concealment for the last gap: fade from the
+   * final sample before the gap to silence (avoids a click)
+   */
+  void conceal(int16_t* pcmOutput, size_t count);
+
+  /**
+   * Span (16 kHz ticks) described by the last frame if it was comfort
+   * noise, else 0. Render it with generateComfortNoise().
+   */
+  uint32_t getComfortNoiseSamples() const { return comfortNoiseSamples; }
+
+  /**
+   * Fill count samples of noise at the last descriptor's level and colour
+   */
+  void generateComfortNoise(int16_t* pcmOutput, size_t count);
+
+  /**
+   * Vectors in the last frame if it was a log-mel feature frame, else 0.
+   * getFeatures() points into the frame passed to decodeFrame(), vector
+   * after vector, getFeatureBins() int8 values each.
+   */
+  uint8_t getFeatureVectors() const { return featureVectors; }
+  uint8_t getFeatureBins() const { return featureBins; }
+  const int8_t* getFeatures() const { return features; }
+
+  // Statistics (samples lost counted in 16 kHz ticks)
+  uint32_t getFramesDecoded() const { return framesDecoded; }
+  uint32_t getFramesLost() const { return framesLost; }
+  uint32_t getSamplesLost() const { return samplesLost; }
+  uint32_t getBursts() const { return bursts; }  // Triggered streams received
+
+private:
+  AudioCodec codec;
+  bool synced;
+  uint16_t expectedSequence;
+  uint32_t expectedSampleIndex;
+  int16_t lastSample;
+  int16_t concealFrom;
+  uint32_t lastGapSamples;
+
+  // Comfort noise
+  uint32_t comfortNoiseSamples;
+  int32_t noiseGain;        // Q12, white-noise scale for the target level
+  int32_t noiseSmoothing;   // Q15 one-pole low-pass coefficient (colour)
+  int32_t noiseFiltered;
+  uint32_t noiseState;
+
+  // Feature frames
+  uint8_t featureVectors;
+  uint8_t featureBins;
+  const int8_t* features;
+
+  uint32_t framesDecoded;
+  uint32_t framesLost;
+  uint32_t samplesLost;
+  uint32_t bursts;
+};
+
+#endif // AUDIO_FRAME_H
@@ -0,0 +1,114 @@
+/*
+ * Pre-Trigger Audio History Implementation
+ */
+
+#include "AudioHistory.h"
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+AudioHistory::AudioHistory()
+  : storage(nullptr),
+    capacity(0),
+    start(0),
+    used(0),
+    frameCount(0),
+    overwrittenFrames(0) {
+}
+
+AudioHistory::~AudioHistory() {
+  free(storage);
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+bool AudioHistory::begin(size_t capacityBytes) {
+  if (capacityBytes <= AUDIO_HISTORY_LENGTH_SIZE) return false;
+
+  // Allocated once at boot, like the packet pool
+  storage = (uint8_t*)malloc(capacityBytes);
+  if (!storage) return false;
+
+  capacity = capacityBytes;
+  clear();
+  return true;
+}
+
+void AudioHistory::clear() {
+  start = 0;
+  used = 0;
+  frameCount = 0;
+}
+
+// ============================================================================
+// FRAMES
+// ============================================================================
+
+bool AudioHistory::push(const uint8_t* frame, size_t size) {
+  size_t needed = size + AUDIO_HISTORY_LENGTH_SIZE;
+  if (!storage || size == 0 || size > 0xFFFF || needed > capacity) return false;
+
+  while (capacity - getUsed() < needed) {
+    dropOldest();
+    overwrittenFrames++;
+  }
+
+  uint8_t length[AUDIO_HISTORY_LENGTH_SIZE] = { (uint8_t)(size & 0xFF), (uint8_t)(size >> 8) };
+  copyIn(start + used, length, AUDIO_HISTORY_LENGTH_SIZE);
+  copyIn(start + used + AUDIO_HISTORY_LENGTH_SIZE, frame, size);
+  used += needed;
+  frameCount++;
+  return true;
+}
+
+size_t AudioHistory::peekSize() const {
+  if (isEmpty()) return 0;
+  uint8_t length[AUDIO_HISTORY_LENGTH_SIZE];
+  copyOut(start, length, AUDIO_HISTORY_LENGTH_SIZE);
+  return length[0] | (length[1] << 8);
+}
+
+size_t AudioHistory::pop(uint8_t* output, size_t maxSize) {
+  size_t size = peekSize();
+  if (size == 0) return 0;
+
+  if (size > maxSize) {
+    dropOldest();
+    return 0;
+  }
+  copyOut(start + AUDIO_HISTORY_LENGTH_SIZE, output, size);
+  remove(size + AUDIO_HISTORY_LENGTH_SIZE);
+  return size;
+}
+
+void AudioHistory::dropOldest() {
+  remove(peekSize() + AUDIO_HISTORY_LENGTH_SIZE);
+}
+
+void AudioHistory::remove(size_t bytes) {
+  start = (start + bytes) % capacity;
+  used -= bytes;
+  frameCount--;
+}
+
+// ============================================================================
+// RING ACCESS (a frame may wrap around the end)
+// ============================================================================
+
+// position may run past the end of the ring (start + offset < 2 x capacity)
+void AudioHistory::copyIn(size_t position, const uint8_t* data, size_t size) {
+  size_t offset = position % capacity;
+  size_t first = min(size, capacity - offset);
+  memcpy(storage + offset, data, first);
+  memcpy(storage, data + first, size - first);
+}
+
+void AudioHistory::copyOut(size_t position, uint8_t* data, size_t size) const {
+  size_t offset = position % capacity;
+  size_t first = min(size, capacity - offset);
+  memcpy(data, storage + offset, first);
+  memcpy(data + first, storage, size - first);
+}
@@ -0,0 +1,79 @@
+/*
+ * Pre-Trigger Audio History for ESP32-C3 BEACON
+ * RAM ring of encoded audio frames, oldest overwritten first
+ *
+ * While streaming is gated, AudioDetector keeps encoding and parks every
+ * finished frame (ADPCM, comfort noise or log-mel) here instead of queuing
+ * it. A trigger flushes the ring oldest-first, so the phone receives the
+ * seconds before the incident, then the live stream.
+ *
+ * Frames are stored whole, back to back, each behind a 2-byte length, and
+ * keep their header (sequence, sampleIndex): the receiver places them in
+ * time and sees frames that were overwritten as an ordinary gap.
+ *
+ * Single task: append and flush both run in the capture task, no lock.
+ */
+
+#ifndef AUDIO_HISTORY_H
+#define AUDIO_HISTORY_H
+
+#include <Arduino.h>
+
+#define AUDIO_HISTORY_LENGTH_SIZE 2  // Length prefix per stored frame
+
+// ============================================================================
+// AUDIO HISTORY CLASS
+// ============================================================================
+
+class AudioHistory {
+public:
+  AudioHistory();
+  ~AudioHistory();
+
+  /**
+   * Allocate the ring
+   * @param capacityBytes Frames + length prefixes held before overwriting
+   */
+  bool begin(size_t capacityBytes);
+
+  void clear();
+
+  /**
+   * Append a frame, overwriting the oldest frames to make room
+   * @return false if the frame can never fit (larger than the ring)
+   */
+  bool push(const uint8_t* frame, size_t size);
+
+  /**
+   * Size of the oldest frame (0 if empty)
+   */
+  size_t peekSize() const;
+
+  /**
+   * Copy the oldest frame out and remove it
+   * @param maxSize Capacity of output (a larger frame is discarded)
+   * @return Frame size, 0 if empty or discarded
+   */
+  size_t pop(uint8_t* output, size_t maxSize);
+
+  bool isEmpty() const { return used == 0; }
+  size_t getUsed() const { return used; }
+  size_t getCapacity() const { return capacity; }
+  uint32_t getFrameCount() const { return frameCount; }
+  uint32_t getOverwrittenFrames() const { return overwrittenFrames; }
+
+private:
+  uint8_t* storage;
+  size_t capacity;
+  size_t start;         // Offset of the oldest frame's length prefix
+  size_t used;          // Bytes held (frames + prefixes)
+  uint32_t frameCount;  // Frames currently held
+  uint32_t overwrittenFrames;
+
+  void copyIn(size_t position, const uint8_t* data, size_t size);
+  void copyOut(size_t position, uint8_t* data, size_t size) const;
+  void remove(size_t bytes);
+  void dropOldest();
+};
+
+#endif // AUDIO_HISTORY_H
@@ -0,0 +1,201 @@
+/*
+ * Fixed-Point Audio DSP Pipeline Implementation
+ */
+
+#include "AudioPipeline.h"
+#include "ADPCMCodec.h"  // rmsFromEnergy
+
+static inline int16_t saturate16(int32_t value) {
+  return (int16_t)max((int32_t)-32768, min((int32_t)32767, value));
+}
+
+const char* audioStageName(AudioStage stage) {
+  switch (stage) {
+    case AUDIO_STAGE_DC_BLOCK: return "DC block";
+    case AUDIO_STAGE_HIGHPASS: return "high-pass";
+    case AUDIO_STAGE_AGC: return "AGC";
+    default: return "?";
+  }
+}
+
+// ============================================================================
+// DC BLOCKER
+// ============================================================================
+
+void DcBlocker::reset() {
+  previousInput = 0;
+  output = 0;
+}
+
+void DcBlocker::process(int16_t* samples, size_t count) {
+  int32_t x1 = previousInput;
+  int32_t y = output;
+  for (size_t i = 0; i < count; i++) {
+    int32_t x = samples[i];
+    // |y| <= 2^16, so y with 8 fractional bits stays well inside int32
+    y += ((x - x1) << 8) - (y >> DC_BLOCK_SHIFT);
+    x1 = x;
+    samples[i] = saturate16((y + 128) >> 8);
+  }
+  previousInput = (int16_t)x1;
+  output = y;
+}
+
+// ============================================================================
+// BIQUAD HIGH-PASS
+// ============================================================================
+
+BiquadFilter::BiquadFilter()
+  : b0(1 << BIQUAD_COEFF_BITS), b1(0), b2(0), a1(0), a2(0) {
+  reset();
+}
+
+void BiquadFilter::setHighPass(uint32_t sampleRate, uint32_t cutoffHz) {
+  // RBJ cookbook high-pass, Q = 1/sqrt(2) (Butterworth)
+  const float twoPi = 6.2831853f;
+  float w0 = twoPi * cutoffHz / sampleRate;
+  float cosW0 = cosf(w0);
+  float alpha = sinf(w0) / (2.0f * 0.70710678f);
+  float a0 = 1.0f + alpha;
+  float scale = (float)(1 << BIQUAD_COEFF_BITS) / a0;
+
+  b0 = (int32_t)lroundf((1.0f + cosW0) / 2.0f * scale);
+  b1 = -2 * b0;
+  b2 = b0;
+  a1 = (int32_t)lroundf(-2.0f * cosW0 * scale);
+  a2 = (int32_t)lroundf((1.0f - alpha) * scale);
+  reset();
+}
+
+void BiquadFilter::reset() {
+  x1 = x2 = y1 = y2 = 0;
+  error = 0;
+}
+
+void BiquadFilter::process(int16_t* samples, size_t count) {
+  const int64_t one = (int64_t)1 << BIQUAD_COEFF_BITS;
+  for (size_t i = 0; i < count; i++) {
+    int32_t x = samples[i];
+    // Direct form I; the dropped fraction of the last output is fed back
+    // (first-order error shaping), which keeps a 80 Hz pole pair at 16 kHz
+    // from drifting or limit-cycling
+    int64_t acc = (int64_t)b0 * x + (int64_t)b1 * x1 + (int64_t)b2 * x2
+                - (int64_t)a1 * y1 - (int64_t)a2 * y2 + error;
+    int32_t y = (int32_t)(acc >> BIQUAD_COEFF_BITS);
+    error = acc & (one - 1);
+    if (y > 32767 || y < -32768) {
+      y = saturate16(y);
+      error = 0;
+    }
+    x2 = x1;
+    x1 = x;
+    y2 = y1;
+    y1 = y;
+    samples[i] = (int16_t)y;
+  }
+}
+
+// ============================================================================
+// AUTOMATIC GAIN CONTROL
+// ============================================================================
+
+void AutomaticGainControl::reset() {
+  gain = AGC_GAIN_ONE;
+}
+
+void AutomaticGainControl::process(int16_t* samples, size_t count) {
+  if (count == 0) return;
+
+  // Level of the block as it arrives
+  uint64_t energy = 0;
+  uint32_t peak = 0;
+  for (size_t i = 0; i < count; i++) {
+    int32_t sample = samples[i];
+    energy += (uint32_t)(sample * sample);
+    uint32_t magnitude = (uint32_t)(sample < 0 ? -sample : sample);
+    if (magnitude > peak) peak = magnitude;
+  }
+  int16_t rms = rmsFromEnergy(energy, count);
+
+  // Move towards the target gain: down quickly, up slowly; hold in silence
+  uint32_t newGain = gain;
+  if (rms >= AGC_GATE_RMS) {
+    uint32_t desired = min((uint32_t)AGC_TARGET_RMS * AGC_GAIN_ONE / rms, (uint32_t)AGC_MAX_GAIN * AGC_GAIN_ONE);
+    if (desired < gain) {
+      newGain = gain - ((gain - desired) >> AGC_ATTACK_SHIFT);
+    } else {
+      newGain = min(gain + (gain >> AGC_RELEASE_SHIFT), desired);
+    }
+  }
+
+  // Look-ahead limiter: the whole block is known, so its peak never clips
+  if (peak > 0) newGain = min(newGain, (uint32_t)32767 * AGC_GAIN_ONE / peak);
+  newGain = max(newGain, (uint32_t)1);
+
+  if (newGain <= gain) {
+    // Falling (or steady): the lower gain from the first sample
+    int32_t g = (int32_t)newGain;
+    for (size_t i = 0; i < count; i++) {
+      samples[i] = saturate16((samples[i] * g + AGC_GAIN_ONE / 2) >> 12);
+    }
+  } else {
+    // Rising: linear ramp across the block (8 extra fractional bits)
+    int32_t g = (int32_t)gain << 8;
+    int32_t step = (int32_t)((newGain - gain) << 8) / (int32_t)count;
+    for (size_t i = 0; i < count; i++) {
+      g += step;
+      samples[i] = saturate16((samples[i] * (g >> 8) + AGC_GAIN_ONE / 2) >> 12);
+    }
+  }
+  gain = newGain;
+}
+
+// ============================================================================
+// AUDIO PIPELINE
+// ============================================================================
+
+AudioPipeline::AudioPipeline()
+  : stages(0),
+    blocks(0) {
+  memset(stageCycles, 0, sizeof(stageCycles));
+  memset(maxStageCycles, 0, sizeof(maxStageCycles));
+}
+
+void AudioPipeline::begin(uint32_t sampleRate, uint8_t stageMask) {
+  stages = stageMask;
+  highPass.setHighPass(sampleRate, HIGHPASS_FREQ_HZ);
+  reset();
+}
+
+void AudioPipeline::reset() {
+  dcBlocker.reset();
+  highPass.reset();
+  agc.reset();
+}
+
+void AudioPipeline::process(int16_t* samples, size_t count) {
+  if (stages == 0) return;
+  uint32_t start = hal::cycleCount();
+  if (hasStage(AUDIO_STAGE_DC_BLOCK)) {
+    dcBlocker.process(samples, count);
+    uint32_t now = hal::cycleCount();
+    recordCycles(AUDIO_STAGE_DC_BLOCK, now - start);
+    start = now;
+  }
+  if (hasStage(AUDIO_STAGE_HIGHPASS)) {
+    highPass.process(samples, count);
+    uint32_t now = hal::cycleCount();
+    recordCycles(AUDIO_STAGE_HIGHPASS, now - start);
+    start = now;
+  }
+  if (hasStage(AUDIO_STAGE_AGC)) {
+    agc.process(samples, count);
+    recordCycles(AUDIO_STAGE_AGC, hal::cycleCount() - start);
+  }
+  blocks++;
+}
+
+void AudioPipeline::recordCycles(AudioStage stage, uint32_t cycles) {
+  stageCycles[stage] = cycles;
+  if (cycles > maxStageCycles[stage]) maxStageCycles[stage] = cycles;
+}
@@ -0,0 +1,141 @@
+/*
+ * Fixed-Point Audio DSP Pipeline for ESP32-C3 BEACON
+ * Block-based conditioning of microphone samples ahead of the encoder
+ *
+ * Stages (each runs over a whole 256-sample block, in place, in this order):
+ * - DC blocker: one-pole DC notch, y = x - x[-1] + (1 - 2^-DC_BLOCK_SHIFT) y[-1].
+ *   Shift and add only; the fraction of y is carried in the state so the
+ *   output has no rounding bias. MEMS I2S microphones sit hundreds of LSB
+ *   off zero, which wastes ADPCM step range and reads as energy in the VAD.
+ * - High-pass: 2nd-order Butterworth biquad at HIGHPASS_FREQ_HZ (rumble,
+ *   handling and wind noise). Direct form I, Q2.28 coefficients, 64-bit
+ *   accumulator with error feedback so the low-frequency poles stay exact.
+ * - AGC: block RMS against AGC_TARGET_RMS. The block is known before the
+ *   gain is applied, so loud blocks are turned down at once (no clipping,
+ *   no overshoot); quiet blocks ramp up slowly across the block (no zipper
+ *   noise). Below AGC_GATE_RMS the gain holds, so room noise is not pumped.
+ *
+ * Which stages run is a mask fixed at compile time (AUDIO_INPUT_STAGES /
+ * AUDIO_STREAM_STAGES in Config.h); cycles are measured per stage.
+ */
+
+#ifndef AUDIO_PIPELINE_H
+#define AUDIO_PIPELINE_H
+
+#include <Arduino.h>
+#include "Hal.h"
+
+#define DC_BLOCK_SHIFT 8           // Pole 1 - 1/256 (~10 Hz at 16 kHz)
+#define HIGHPASS_FREQ_HZ 80        // Keeps the thud band (125-500 Hz) within 0.6 dB
+#define BIQUAD_COEFF_BITS 28       // Q2.28
+#define AGC_TARGET_RMS 3000        // ~-21 dBFS
+#define AGC_GATE_RMS 150           // Hold the gain below this (silence / room noise)
+#define AGC_MAX_GAIN 8             // +18 dB
+#define AGC_GAIN_ONE 4096          // Q12
+#define AGC_ATTACK_SHIFT 2         // Gain falls 1/4 per block towards the target ...
+#define AGC_RELEASE_SHIFT 6        // ... and rises 1/64 per block (~8 dB/s)
+
+enum AudioStage {
+  AUDIO_STAGE_DC_BLOCK,
+  AUDIO_STAGE_HIGHPASS,
+  AUDIO_STAGE_AGC,
+  AUDIO_STAGES
+};
+
+// Stage masks for AudioPipeline::begin()
+#define AUDIO_PIPELINE_DC_BLOCK (1 << AUDIO_STAGE_DC_BLOCK)
+#define AUDIO_PIPELINE_HIGHPASS (1 << AUDIO_STAGE_HIGHPASS)
+#define AUDIO_PIPELINE_AGC (1 << AUDIO_STAGE_AGC)
+
+/**
+ * Short stage name for logs
+ */
+const char* audioStageName(AudioStage stage);
+
+// ============================================================================
+// STAGES
+// ============================================================================
+
+class DcBlocker {
+public:
+  DcBlocker() { reset(); }
+  void reset();
+  void process(int16_t* samples, size_t count);
+
+private:
+  int16_t previousInput;
+  int32_t output;  // y[-1], 8 fractional bits
+};
+
+class BiquadFilter {
+public:
+  BiquadFilter();
+
+  /**
+   * Butterworth high-pass (coefficients from floats, once)
+   */
+  void setHighPass(uint32_t sampleRate, uint32_t cutoffHz);
+  void reset();
+  void process(int16_t* samples, size_t count);
+
+private:
+  int32_t b0, b1, b2, a1, a2;  // Q2.28, a0 = 1
+  int32_t x1, x2, y1, y2;
+  int64_t error;               // Fraction dropped from the last output
+};
+
+class AutomaticGainControl {
+public:
+  AutomaticGainControl() { reset(); }
+  void reset();
+  void process(int16_t* samples, size_t count);
+
+  uint32_t getGain() const { return gain; }  // Q12 (AGC_GAIN_ONE = x1)
+
+private:
+  uint32_t gain;
+};
+
+// ============================================================================
+// AUDIO PIPELINE CLASS
+// ============================================================================
+
+class AudioPipeline {
+public:
+  AudioPipeline();
+
+  /**
+   * Configure the stages and clear their state
+   * @param stages Mask of AUDIO_PIPELINE_* (0 = pass through)
+   */
+  void begin(uint32_t sampleRate, uint8_t stages);
+  void reset();
+
+  /**
+   * Run the enabled stages over one block, in place
+   */
+  void process(int16_t* samples, size_t count);
+
+  bool hasStage(AudioStage stage) const { return (stages & (1 << stage)) != 0; }
+  uint8_t getStages() const { return stages; }
+  uint32_t getAgcGain() const { return agc.getGain(); }
+
+  // Cycle statistics, per stage (last block and worst block)
+  uint32_t getStageCycles(AudioStage stage) const { return stageCycles[stage]; }
+  uint32_t getMaxStageCycles(AudioStage stage) const { return maxStageCycles[stage]; }
+  uint32_t getBlocks() const { return blocks; }
+
+private:
+  uint8_t stages;
+  DcBlocker dcBlocker;
+  BiquadFilter highPass;
+  AutomaticGainControl agc;
+
+  uint32_t stageCycles[AUDIO_STAGES];
+  uint32_t maxStageCycles[AUDIO_STAGES];
+  uint32_t blocks;
+
+  void recordCycles(AudioStage stage, uint32_t cycles);
+};
+
+#endif // AUDIO_PIPELINE_H
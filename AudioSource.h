@@ -0,0 +1,30 @@
+/*
+ * Audio Source for ESP32-C3 BEACON
+ * Where AudioDetector reads microphone samples from
+ *
+ * The default (no source installed) is the I2S microphone through the HAL,
+ * drained by the capture task. An installed source replaces it: I2S and
+ * the capture task are not started and update() pulls from the source in
+ * loop() context. Host tools use this to push recorded WAV files through
+ * the unchanged firmware audio path (host/WavSource.h).
+ */
+
+#ifndef AUDIO_SOURCE_H
+#define AUDIO_SOURCE_H
+
+#include <Arduino.h>
+
+struct AudioSource {
+  /**
+   * Read up to maxSamples 16 kHz mono samples without blocking
+   * @param samplesRead Samples written (0 = none available yet)
+   * @return false once the source is exhausted or failed
+   */
+  bool (*read)(void* context, int16_t* samples, size_t maxSamples, size_t& samplesRead);
+  void* context;
+  const char* name;  // For logs
+
+  AudioSource() : read(nullptr), context(nullptr), name("?") {}
+};
+
+#endif // AUDIO_SOURCE_H
@@ -37,6 +37,15 @@ void BLEManager::ServerCallbacks::onConnect(NimBLEServer* pServer) {
   bleManager->requestMTUUpdate();
 }
 
+void BLEManager::ServerCallbacks::onConnect(NimBLEServer* pServer, ble_gap_conn_desc* desc) {
+  (void)pServer;
+  // The central picks the interval; the link budget is sized from it
+  bleManager->connInterval = desc->conn_itvl;
+  Serial.print(F("  Connection interval: "));
+  Serial.print(desc->conn_itvl * 5 / 4);
+  Serial.println(F(" ms"));
+}
+
 void BLEManager::ServerCallbacks::onDisconnect(NimBLEServer* pServer) {
   bleManager->deviceConnected = false;
 
@@ -48,6 +57,23 @@ void BLEManager::ServerCallbacks::onDisconnect(NimBLEServer* pServer) {
   Serial.println(F(" ms"));
   Serial.println(F("  deviceConnected flag: SET TO FALSE"));
   Serial.println(F("========================================"));
+
+  // The next client starts with the default MTU and per-packet
+  // notifications; ACK mode stays until "ALERT_ACK:OFF", so alerts the
+  // tracker still holds are retransmitted after the reconnect
+  bleManager->currentMTU = 23;
+  bleManager->connInterval = BLE_CONN_INTERVAL_MIN;
+  bleManager->pendingTxFormat = BLE_TX_PACKETS;
+}
+
+void BLEManager::ServerCallbacks::onMTUChange(uint16_t MTU, ble_gap_conn_desc* desc) {
+  // MTU exchange usually completes after onConnect(); TLV bundles and the
+  // link budget follow it (the interval may have been updated meanwhile)
+  bleManager->currentMTU = MTU;
+  if (desc && desc->conn_itvl > 0) bleManager->connInterval = desc->conn_itvl;
+  Serial.print(F("[BLE CALLBACK] MTU changed: "));
+  Serial.print(MTU);
+  Serial.println(F(" bytes"));
 }
 
 // ============================================================================
@@ -67,6 +93,33 @@ void BLEManager::ControlCallbacks::onWrite(NimBLECharacteristic* pCharacteristic
     } else if (value == "TRIGGER_FALL") {
       Serial.println(F("[BLE Control] Manual fall trigger requested"));
       if (bleManager->triggerFallCallback) bleManager->triggerFallCallback();
+    } else if (value.compare(0, 11, "AUDIO_MODE:") == 0) {
+      AudioCodecMode mode;
+      if (audioCodecModeFromName(value.c_str() + 11, mode)) {
+        if (bleManager->audioModeCallback) bleManager->audioModeCallback(mode);
+      } else {
+        Serial.print(F("[BLE Control] Unknown audio mode: "));
+        Serial.println(value.c_str() + 11);
+      }
+    } else if (value == "AUDIO_STREAM:FEATURES" || value == "AUDIO_STREAM:AUDIO") {
+      AudioStreamMode mode = (value == "AUDIO_STREAM:FEATURES") ? AUDIO_STREAM_FEATURES : AUDIO_STREAM_CODEC;
+      if (bleManager->audioStreamCallback) bleManager->audioStreamCallback(mode);
+    } else if (value == "TX_FORMAT:TLV" || value == "TX_FORMAT:PACKETS") {
+      bleManager->pendingTxFormat = (value == "TX_FORMAT:TLV") ? BLE_TX_TLV : BLE_TX_PACKETS;
+      Serial.print(F("[BLE Control] TX format requested: "));
+      Serial.println(value.c_str() + 10);
+    } else if (value.compare(0, 4, "ACK:") == 0) {
+      // Alert delivered to the app (AlertTracker.h)
+      if (!bleManager->alertTracker.queueAck((uint32_t)strtoul(value.c_str() + 4, nullptr, 10))) {
+        Serial.println(F("[BLE Control] WARNING: ACK queue full"));
+      }
+    } else if (value == "ALERT_ACK:ON" || value == "ALERT_ACK:OFF") {
+      bleManager->pendingAlertAck = (value == "ALERT_ACK:ON");
+      Serial.print(F("[BLE Control] Alert ACKs requested: "));
+      Serial.println(value.c_str() + 10);
+    } else if (value == "AUDIO_TRIGGER") {
+      Serial.println(F("[BLE Control] Audio stream trigger requested"));
+      if (bleManager->audioTriggerCallback) bleManager->audioTriggerCallback();
     } else {
       Serial.print(F("[BLE Control] Unknown command: "));
       Serial.println(value.c_str());
@@ -74,6 +127,25 @@ void BLEManager::ControlCallbacks::onWrite(NimBLECharacteristic* pCharacteristic
   }
 }
 
+// ============================================================================
+// Notify Callbacks Implementation
+// ============================================================================
+
+void BLEManager::NotifyCallbacks::onStatus(NimBLECharacteristic* pCharacteristic, Status s, int code) {
+  (void)code;
+  // The result of hal::bleNotify() (notify() itself returns nothing)
+  hal::bleNotifyStatus(pCharacteristic, s == SUCCESS_NOTIFY || s == SUCCESS_INDICATE);
+
+  // Only stack outcomes count: a client that has not subscribed says
+  // nothing about the link
+  if (!bleManager->dataScheduler) return;
+  if (s == SUCCESS_NOTIFY) {
+    bleManager->dataScheduler->recordNotifyStatus(pCharacteristic->getDataLength(), true);
+  } else if (s == ERROR_GATT) {
+    bleManager->dataScheduler->recordNotifyStatus(pCharacteristic->getDataLength(), false);
+  }
+}
+
 // ============================================================================
 // BLEManager Implementation
 // ============================================================================
@@ -84,13 +156,23 @@ BLEManager::BLEManager()
     pAlertCharacteristic(nullptr),
     pControlCharacteristic(nullptr),
     pAudioCharacteristic(nullptr),
+    pLogCharacteristic(nullptr),
     deviceConnected(false),
     oldDeviceConnected(false),
     currentMTU(23),  // Default BLE MTU
+    connInterval(BLE_CONN_INTERVAL_MIN),
     connectionParamsUpdated(false),
     dataScheduler(nullptr),
+    txFormat(BLE_TX_PACKETS),
+    pendingTxFormat(BLE_TX_PACKETS),
+    alertAck(false),
+    pendingAlertAck(false),
+    restartAlerts(false),
     resetAlertCallback(nullptr),
-    triggerFallCallback(nullptr) {
+    triggerFallCallback(nullptr),
+    audioModeCallback(nullptr),
+    audioStreamCallback(nullptr),
+    audioTriggerCallback(nullptr) {
 }
 
 void BLEManager::begin() {
@@ -102,6 +184,17 @@ void BLEManager::begin() {
   // Set BLE power level to maximum for better range
   NimBLEDevice::setPower(ESP_PWR_LVL_P9);
 
+  aggregator.setSender(sendBundle, this);
+  aggregator.setHoldTime(BLE_TLV_HOLD_MS);
+#if STORE_FORWARD_ENABLED
+  storeForward.setSender(sendLogBundle, this);
+#endif
+  // Mounted either way: the log also keeps the boot counter that numbers
+  // alert sequences
+  storeForward.begin();
+  alertTracker.setSender(sendAlertRecord, this);
+  alertTracker.begin(storeForward.getLog().getBootId());  // 0 without a data partition
+
   // Create BLE Server
   pServer = NimBLEDevice::createServer();
   pServer->setCallbacks(new ServerCallbacks(this));
@@ -114,12 +207,14 @@ void BLEManager::begin() {
     HR_CHAR_UUID,
     NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY
   );
+  pHRCharacteristic->setCallbacks(new NotifyCallbacks(this));
 
   // Alert characteristic
   pAlertCharacteristic = pService->createCharacteristic(
     ALERT_CHAR_UUID,
     NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY
   );
+  pAlertCharacteristic->setCallbacks(new NotifyCallbacks(this));
 
   // Control command characteristic
   pControlCharacteristic = pService->createCharacteristic(
@@ -133,6 +228,14 @@ void BLEManager::begin() {
     AUDIO_CHAR_UUID,
     NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY
   );
+  pAudioCharacteristic->setCallbacks(new NotifyCallbacks(this));
+
+  // Logged history characteristic (backfill after a reconnect, see StoreForward.h)
+  pLogCharacteristic = pService->createCharacteristic(
+    LOG_CHAR_UUID,
+    NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY
+  );
+  pLogCharacteristic->setCallbacks(new NotifyCallbacks(this));
 
   // Start service
   pService->start();
@@ -215,15 +318,13 @@ void BLEManager::update() {
 
 void BLEManager::notifyHeartRate(uint8_t hr) {
   if (deviceConnected && pHRCharacteristic) {
-    pHRCharacteristic->setValue(&hr, 1);
-    pHRCharacteristic->notify();
+    hal::bleNotify(pHRCharacteristic, &hr, 1);
   }
 }
 
 void BLEManager::notifyAlert(const char* alertType) {
   if (deviceConnected && pAlertCharacteristic) {
-    pAlertCharacteristic->setValue(alertType);
-    pAlertCharacteristic->notify();
+    hal::bleNotify(pAlertCharacteristic, (const uint8_t*)alertType, strlen(alertType));
   }
 }
 
@@ -234,14 +335,12 @@ void BLEManager::notifyAudio(const uint8_t* audioData, size_t length) {
     const size_t maxChunkSize = 244;
 
     if (length <= maxChunkSize) {
-      pAudioCharacteristic->setValue(audioData, length);
-      pAudioCharacteristic->notify();
+      hal::bleNotify(pAudioCharacteristic, audioData, length);
     } else {
       // Send in chunks
       for (size_t offset = 0; offset < length; offset += maxChunkSize) {
         size_t chunkSize = (offset + maxChunkSize > length) ? (length - offset) : maxChunkSize;
-        pAudioCharacteristic->setValue(audioData + offset, chunkSize);
-        pAudioCharacteristic->notify();
+        hal::bleNotify(pAudioCharacteristic, audioData + offset, chunkSize);
         delay(10);  // Small delay between chunks to avoid overwhelming BLE stack
       }
     }
@@ -272,6 +371,18 @@ void BLEManager::setTriggerFallCallback(void (*callback)()) {
   triggerFallCallback = callback;
 }
 
+void BLEManager::setAudioModeCallback(void (*callback)(AudioCodecMode mode)) {
+  audioModeCallback = callback;
+}
+
+void BLEManager::setAudioStreamCallback(void (*callback)(AudioStreamMode mode)) {
+  audioStreamCallback = callback;
+}
+
+void BLEManager::setAudioTriggerCallback(void (*callback)()) {
+  audioTriggerCallback = callback;
+}
+
 // ============================================================================
 // DATA SCHEDULER INTEGRATION
 // ============================================================================
@@ -332,42 +443,93 @@ void BLEManager::processDataQueue() {
       Serial.println(F("  → BLE not connected - waiting for client..."));
       Serial.println(F("========================================"));
     }
+    aggregator.discard();  // Only held audio can be pending
+    restartAlerts = true;
+
+#if STORE_FORWARD_ENABLED
+    // Alerts and heart rate wait in flash instead of overflowing the queues
+    storeForward.store(*dataScheduler);
+#endif
     return;
   }
 
   // Reset diagnostic timer when connected
   lastDiagnosticLog = 0;
 
+  // Client-selected TX format, switched between drains
+  if (txFormat != pendingTxFormat) {
+    txFormat = pendingTxFormat;
+    Serial.print(F("[BLE TX] Format: "));
+    Serial.println(txFormat == BLE_TX_TLV ? "TLV bundles (audio characteristic)" : "one notification per packet");
+  }
+  if (alertAck != pendingAlertAck) {
+    alertAck = pendingAlertAck;
+    if (alertAck) restartAlerts = true;
+    Serial.print(F("[BLE TX] Alerts: "));
+    Serial.println(alertAck ? "sequenced, retransmitted until ACKed" : "plain");
+  }
+  if (restartAlerts) {
+    restartAlerts = false;
+    if (alertAck) alertTracker.restart();  // Alerts left from the last connection go again
+  }
+  aggregator.setMTU(currentMTU);
+  dataScheduler->setLinkParameters(currentMTU, connInterval);
+
+#if STORE_FORWARD_ENABLED
+  // Alerts logged while the link was down go out as live ones
+  storeForward.replayAlerts(*dataScheduler);
+#endif
+
+  // ACKs from the client, then alerts whose ACK is overdue (ahead of the
+  // queues, like the alerts themselves)
+  size_t retransmitted = alertTracker.poll(alertAck);
+  if (retransmitted > 0) dataScheduler->chargeAlert(retransmitted);
+
   // Process packets from DataScheduler (priority-ordered)
   DataPacket packet;
+  uint32_t dequeueStart = hal::cycleCount();
   while (dataScheduler->getNextPacket(packet, 0)) {  // Non-blocking
+    const uint8_t* data = dataScheduler->getPacketData(packet);
+    if (txFormat == BLE_TX_TLV) {
+      if (!bundlePacket(packet, data, dequeueStart)) break;  // Alert put back: link busy
+      yield();
+      dequeueStart = hal::cycleCount();
+      continue;
+    }
+
+    bool alertRequeued = false;
     switch (packet.type) {
       case DATA_ALERT:
         Serial.print(F("[BLE TX] 🚨 Dequeued ALERT: "));
-        Serial.write(packet.data, packet.dataSize);
+        Serial.write(data, packet.dataSize);
         Serial.print(F(" ("));
         Serial.print(packet.dataSize);
         Serial.println(F(" bytes)"));
-        if (pAlertCharacteristic) {
-          pAlertCharacteristic->setValue(packet.data, packet.dataSize);
-          pAlertCharacteristic->notify();
-          Serial.println(F("[BLE TX] ✅ Alert notification sent via BLE"));
-        } else {
+        if (!pAlertCharacteristic) {
           Serial.println(F("[BLE TX] ❌ ERROR: Alert characteristic NULL!"));
+        } else if (!sendAlert(packet, data)) {
+          // Stack buffers full: the alert goes back to the head of its
+          // queue and this drain ends (retrying now would fail again)
+          Serial.println(F("[BLE TX] ⚠️ Alert notification failed - requeued"));
+          alertRequeued = dataScheduler->requeueAlert(packet);
+          break;
+        } else {
+          Serial.println(F("[BLE TX] ✅ Alert notification sent via BLE"));
         }
+        dataScheduler->releasePacket(packet);
         break;
 
       case DATA_HEART_RATE:
         Serial.print(F("[BLE TX] ❤️ Dequeued HEART RATE: "));
-        Serial.print(packet.data[0]);
+        Serial.print(data[0]);
         Serial.println(F(" BPM"));
         if (pHRCharacteristic) {
-          pHRCharacteristic->setValue(packet.data, packet.dataSize);
-          pHRCharacteristic->notify();
+          hal::bleNotify(pHRCharacteristic, data, packet.dataSize);
           Serial.println(F("[BLE TX] ✅ Heart rate notification sent via BLE"));
         } else {
           Serial.println(F("[BLE TX] ❌ ERROR: HR characteristic NULL!"));
         }
+        dataScheduler->releasePacket(packet);
         break;
 
       case DATA_AUDIO:
@@ -381,17 +543,107 @@ void BLEManager::processDataQueue() {
           Serial.print(packet.dataSize);
           Serial.println(F(" bytes (ADPCM compressed)"));
         }
-        if (pAudioCharacteristic) {
-          // Send ADPCM-compressed audio
-          pAudioCharacteristic->setValue(packet.data, packet.dataSize);
-          pAudioCharacteristic->notify();
-        }
+        // Send ADPCM-compressed audio straight from the pooled frame buffer
+        // (NimBLE setValue() keeps its own copy for the stack)
+        bool sent = hal::bleNotify(pAudioCharacteristic, data, packet.dataSize);
+        dataScheduler->releasePacket(packet);
+        dataScheduler->recordAudioSent(hal::cycleCount() - dequeueStart, sent ? packet.dataSize : 0);
         break;
     }
+    if (alertRequeued) break;
 
     // Yield to avoid blocking other tasks
     yield();
+    dequeueStart = hal::cycleCount();
+  }
+
+  // Queues drained: a partly filled bundle goes out now unless it is audio
+  // that may wait for the next capture block
+  aggregator.poll();
+
+  // Logged history fills what live data leaves (once the client listens)
+  if (STORE_FORWARD_ENABLED && !dataScheduler->hasPackets() && pLogCharacteristic &&
+      pLogCharacteristic->getSubscribedCount() > 0) {
+    storeForward.backfill(*dataScheduler, currentMTU);
+  }
+}
+
+bool BLEManager::bundlePacket(DataPacket& packet, const uint8_t* data, uint32_t dequeueStart) {
+  switch (packet.type) {
+    case DATA_ALERT:
+      Serial.print(F("[BLE TX] 🚨 Dequeued ALERT: "));
+      Serial.write(data, packet.dataSize);
+      Serial.println(F(" (bundled)"));
+      if (!sendAlert(packet, data)) {
+        dataScheduler->requeueAlert(packet);
+        return false;
+      }
+      break;
+
+    case DATA_HEART_RATE:
+      Serial.print(F("[BLE TX] ❤️ Dequeued HEART RATE: "));
+      Serial.print(data[0]);
+      Serial.println(F(" BPM (bundled)"));
+      aggregator.add(TLV_TYPE_HEART_RATE, data, packet.dataSize);
+      break;
+
+    case DATA_AUDIO: {
+      // The frame is copied into the bundle; the notify copies the bundle
+      bool sent = aggregator.add(TLV_TYPE_AUDIO, data, packet.dataSize);
+      dataScheduler->releasePacket(packet);
+      dataScheduler->recordAudioSent(hal::cycleCount() - dequeueStart, sent ? packet.dataSize : 0);
+      return true;
+    }
   }
+  dataScheduler->releasePacket(packet);
+  return true;
+}
+
+bool BLEManager::sendAlert(DataPacket& packet, const uint8_t* data) {
+  if (alertAck) {
+    // Kept and retransmitted by the tracker until ACKed, sent or not
+    alertTracker.send(data, packet.dataSize, packet.timestamp);
+    return true;
+  }
+  return sendAlertRecord(this, data, packet.dataSize);
+}
+
+bool BLEManager::sendAlertRecord(void* context, const uint8_t* record, size_t length) {
+  BLEManager* manager = (BLEManager*)context;
+  if (manager->txFormat == BLE_TX_TLV) {
+    // Its own bundle, sent now, so the result is the alert's
+    PacketAggregator& aggregator = manager->aggregator;
+    aggregator.flush();
+    return aggregator.add(TLV_TYPE_ALERT, record, length) && aggregator.flush();
+  }
+  return manager->pAlertCharacteristic && hal::bleNotify(manager->pAlertCharacteristic, record, length);
+}
+
+bool BLEManager::sendBundle(void* context, const uint8_t* bundle, size_t length) {
+  BLEManager* manager = (BLEManager*)context;
+  return manager->pAudioCharacteristic && hal::bleNotify(manager->pAudioCharacteristic, bundle, length);
+}
+
+bool BLEManager::sendLogBundle(void* context, const uint8_t* bundle, size_t length) {
+  BLEManager* manager = (BLEManager*)context;
+  return manager->pLogCharacteristic && hal::bleNotify(manager->pLogCharacteristic, bundle, length);
+}
+
+void BLEManager::printStatistics() {
+  Serial.println(F("========================================"));
+  Serial.println(F("[BLE] TX Statistics"));
+  Serial.println(F("========================================"));
+  Serial.print(F("  Format: "));
+  Serial.print(txFormat == BLE_TX_TLV ? "TLV" : "PACKETS");
+  Serial.print(F(", MTU "));
+  Serial.print(currentMTU);
+  Serial.print(F(", interval "));
+  Serial.print(connInterval * 5 / 4);
+  Serial.println(F(" ms"));
+  if (txFormat == BLE_TX_TLV || aggregator.getBundles() > 0) aggregator.printStatistics();
+  if (alertAck || alertTracker.getTracked() > 0) alertTracker.printStatistics();
+  storeForward.printStatistics();
+  Serial.println(F("========================================"));
 }
 
 // ============================================================================
@@ -434,9 +686,9 @@ void BLEManager::requestMTUUpdate() {
     Serial.println(F(" bytes"));
 
     if (currentMTU < BLE_REQUESTED_MTU) {
-      Serial.print(F("[BLE] WARNING: MTU smaller than requested ("));
+      Serial.print(F("[BLE] MTU smaller than requested ("));
       Serial.print(BLE_REQUESTED_MTU);
-      Serial.println(F(" bytes)"));
+      Serial.println(F(" bytes) - until the client's MTU exchange (onMTUChange)"));
     }
   }
 }
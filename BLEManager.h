@@ -11,6 +11,18 @@
 #include <NimBLEDevice.h>
 #include "Config.h"
 #include "DataScheduler.h"
+#include "AudioCodec.h"
+#include "AlertTracker.h"
+#include "AudioFrame.h"
+#include "Hal.h"
+#include "PacketAggregator.h"
+#include "StoreForward.h"
+
+// How processDataQueue() notifies ("TX_FORMAT:PACKETS|TLV")
+enum BleTxFormat {
+  BLE_TX_PACKETS,  // One notification per packet on its own characteristic
+  BLE_TX_TLV       // MTU-sized TLV bundles on the audio characteristic (PacketAggregator.h)
+};
 
 class BLEManager {
 public:
@@ -38,10 +50,23 @@ public:
   bool isConnected() const { return deviceConnected; }
   NimBLEServer* getServer() { return pServer; }
   uint16_t getCurrentMTU() const { return currentMTU; }
+  uint16_t getConnInterval() const { return connInterval; }
+  BleTxFormat getTxFormat() const { return txFormat; }
+  bool isAlertAckEnabled() const { return alertAck; }
+  const AlertTracker& getAlertTracker() const { return alertTracker; }
+  const StoreForward& getStoreForward() const { return storeForward; }
+
+  /**
+   * Print TX statistics (for debugging)
+   */
+  void printStatistics();
 
   // Callbacks for control commands
   void setResetAlertCallback(void (*callback)());
   void setTriggerFallCallback(void (*callback)());
+  void setAudioModeCallback(void (*callback)(AudioCodecMode mode));  // "AUDIO_MODE:<name>"
+  void setAudioStreamCallback(void (*callback)(AudioStreamMode mode));  // "AUDIO_STREAM:AUDIO|FEATURES"
+  void setAudioTriggerCallback(void (*callback)());  // "AUDIO_TRIGGER"
 
 private:
   NimBLEServer* pServer;
@@ -49,29 +74,62 @@ private:
   NimBLECharacteristic* pAlertCharacteristic;
   NimBLECharacteristic* pControlCharacteristic;
   NimBLECharacteristic* pAudioCharacteristic;  // Audio streaming
+  NimBLECharacteristic* pLogCharacteristic;    // Logged history backfill
 
   bool deviceConnected;
   bool oldDeviceConnected;
-  uint16_t currentMTU;
+  volatile uint16_t currentMTU;
+  volatile uint16_t connInterval;  // Negotiated, 1.25 ms units
   bool connectionParamsUpdated;
 
   // DataScheduler for priority-based transmission
   DataScheduler* dataScheduler;
 
+  // TX format: set by the client (NimBLE task), applied by processDataQueue()
+  BleTxFormat txFormat;
+  volatile BleTxFormat pendingTxFormat;
+  PacketAggregator aggregator;
+
+  // Link down: alerts and heart rate to flash; backfilled after a reconnect
+  StoreForward storeForward;
+
+  // Acknowledged alerts: set by the client ("ALERT_ACK:ON|OFF", NimBLE
+  // task), applied by processDataQueue(); kept across reconnects
+  bool alertAck;
+  volatile bool pendingAlertAck;
+  bool restartAlerts;  // Link was down: tracked alerts go again when it is back
+  AlertTracker alertTracker;
+
   // Callbacks
   void (*resetAlertCallback)();
   void (*triggerFallCallback)();
+  void (*audioModeCallback)(AudioCodecMode mode);
+  void (*audioStreamCallback)(AudioStreamMode mode);
+  void (*audioTriggerCallback)();
 
   // Connection parameter optimization
   void requestConnectionUpdate();
   void requestMTUUpdate();
 
+  // TLV mode: add one dequeued packet to the current bundle and release it
+  // (false: an alert failed and was put back in its queue)
+  bool bundlePacket(DataPacket& packet, const uint8_t* data, uint32_t dequeueStart);
+  static bool sendBundle(void* context, const uint8_t* bundle, size_t length);
+  static bool sendLogBundle(void* context, const uint8_t* bundle, size_t length);
+
+  // Alert as a plain string, or through AlertTracker in ACK mode
+  // (false: plain alert not accepted by the stack, to be requeued)
+  bool sendAlert(DataPacket& packet, const uint8_t* data);
+  static bool sendAlertRecord(void* context, const uint8_t* record, size_t length);
+
   // Server callbacks
   class ServerCallbacks : public NimBLEServerCallbacks {
   public:
     ServerCallbacks(BLEManager* manager) : bleManager(manager) {}
     void onConnect(NimBLEServer* pServer);
+    void onConnect(NimBLEServer* pServer, ble_gap_conn_desc* desc);
     void onDisconnect(NimBLEServer* pServer);
+    void onMTUChange(uint16_t MTU, ble_gap_conn_desc* desc);
   private:
     BLEManager* bleManager;
   };
@@ -85,8 +143,19 @@ private:
     BLEManager* bleManager;
   };
 
+  // Notification completions (HR, alert, audio, log) feed the link rate
+  // estimate (DataScheduler::recordNotifyStatus())
+  class NotifyCallbacks : public NimBLECharacteristicCallbacks {
+  public:
+    NotifyCallbacks(BLEManager* manager) : bleManager(manager) {}
+    void onStatus(NimBLECharacteristic* pCharacteristic, Status s, int code);
+  private:
+    BLEManager* bleManager;
+  };
+
   friend class ServerCallbacks;
   friend class ControlCallbacks;
+  friend class NotifyCallbacks;
 };
 
 #endif // BLE_MANAGER_H
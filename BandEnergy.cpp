@@ -0,0 +1,159 @@
+/*
+ * Band Energy Analyzer Implementation
+ * Hann window + fixed-point Goertzel resonators, one per DFT bin
+ */
+
+#include "BandEnergy.h"
+#include "ADPCMCodec.h"  // rmsFromEnergy()
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+BandEnergyAnalyzer::BandEnergyAnalyzer()
+  : numBands(0),
+    firstBin(0),
+    numBins(0),
+    position(0),
+    energy(0),
+    cycles(0),
+    ready(false),
+    windowRms(0),
+    windowCycles(0),
+    maxWindowCycles(0),
+    windows(0),
+    overBudgetWindows(0) {
+  memset(bandRms, 0, sizeof(bandRms));
+  memset(state1, 0, sizeof(state1));
+  memset(state2, 0, sizeof(state2));
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+int8_t BandEnergyAnalyzer::addBand(uint16_t freqLow, uint16_t freqHigh) {
+  if (numBands >= BAND_MAX_BANDS) return -1;
+  bandFreqLow[numBands] = freqLow;
+  bandFreqHigh[numBands] = freqHigh;
+  return (int8_t)numBands++;
+}
+
+bool BandEnergyAnalyzer::begin(uint32_t sampleRate) {
+  if (numBands == 0 || sampleRate == 0) return false;
+
+  // Bin k covers k * sampleRate / N; round band edges inwards, DC excluded
+  uint32_t lowest = BAND_MAX_BINS + 1;
+  uint32_t highest = 0;
+  for (uint8_t b = 0; b < numBands; b++) {
+    uint32_t first = ((uint32_t)bandFreqLow[b] * BAND_WINDOW_SIZE + sampleRate - 1) / sampleRate;
+    uint32_t last = (uint32_t)bandFreqHigh[b] * BAND_WINDOW_SIZE / sampleRate;
+    if (first == 0) first = 1;
+    if (last < first) return false;
+    bandFirstBin[b] = (uint8_t)min(first, (uint32_t)255);
+    bandLastBin[b] = (uint8_t)min(last, (uint32_t)255);
+    lowest = min(lowest, first);
+    highest = max(highest, last);
+  }
+  if (highest - lowest + 1 > BAND_MAX_BINS) return false;
+
+  // One resonator per bin in the union of all bands
+  const float twoPi = 6.2831853f;
+  firstBin = (uint8_t)lowest;
+  numBins = (uint8_t)(highest - lowest + 1);
+  for (uint8_t i = 0; i < numBins; i++) {
+    float omega = twoPi * (firstBin + i) / BAND_WINDOW_SIZE;
+    coeffs[i] = (int32_t)lroundf(2.0f * cosf(omega) * 16384.0f);
+  }
+
+  // Hann window: sidelobes -31 dB, so a loud voice does not leak into the
+  // thud bins (a rectangular window only gives -13 dB)
+  for (size_t n = 0; n < BAND_WINDOW_SIZE; n++) {
+    float w = 0.5f - 0.5f * cosf(twoPi * n / BAND_WINDOW_SIZE);
+    window[n] = (int16_t)min(32767L, lroundf(w * 32768.0f));
+  }
+
+  memset(state1, 0, sizeof(state1));
+  memset(state2, 0, sizeof(state2));
+  position = 0;
+  energy = 0;
+  cycles = 0;
+  ready = false;
+  return true;
+}
+
+// ============================================================================
+// PROCESSING
+// ============================================================================
+
+size_t BandEnergyAnalyzer::process(const int16_t* samples, size_t count) {
+  ready = false;
+  if (numBins == 0) return count;
+
+  uint32_t start = hal::cycleCount();
+  size_t chunk = min(count, (size_t)BAND_WINDOW_SIZE - position);
+
+  // Window once, then run each resonator over the chunk with its state in registers
+  int16_t windowed[BAND_WINDOW_SIZE];
+  for (size_t i = 0; i < chunk; i++) {
+    int32_t sample = samples[i];
+    energy += (uint32_t)(sample * sample);
+    windowed[i] = (int16_t)((sample * window[position + i]) >> 15);
+  }
+
+  for (uint8_t k = 0; k < numBins; k++) {
+    int32_t coeff = coeffs[k];
+    int32_t s1 = state1[k];
+    int32_t s2 = state2[k];
+    for (size_t i = 0; i < chunk; i++) {
+      // s[n] = x[n] + 2cos(w) s[n-1] - s[n-2]; s reaches ~2^24 on a
+      // full-scale tone, so the Q14 product needs 64 bits
+      int32_t s0 = windowed[i] + (int32_t)(((int64_t)coeff * s1) >> 14) - s2;
+      s2 = s1;
+      s1 = s0;
+    }
+    state1[k] = s1;
+    state2[k] = s2;
+  }
+
+  position += chunk;
+  cycles += hal::cycleCount() - start;
+  if (position >= BAND_WINDOW_SIZE) finishWindow();
+  return chunk;
+}
+
+void BandEnergyAnalyzer::finishWindow() {
+  uint32_t start = hal::cycleCount();
+
+  // |X[k]|^2 = s1^2 + s2^2 - 2cos(w) s1 s2, summed per band
+  uint64_t binPower[BAND_MAX_BINS];
+  for (uint8_t k = 0; k < numBins; k++) {
+    int64_t s1 = state1[k];
+    int64_t s2 = state2[k];
+    int64_t power = s1 * s1 + s2 * s2 - ((coeffs[k] * s1) >> 14) * s2;
+    binPower[k] = power > 0 ? (uint64_t)power : 0;
+    state1[k] = 0;
+    state2[k] = 0;
+  }
+
+  // Parseval: band RMS^2 = 2 sum|X[k]|^2 / N^2, divided by the Hann power
+  // gain (3/8) to undo the window
+  for (uint8_t b = 0; b < numBands; b++) {
+    uint64_t sum = 0;
+    for (uint8_t k = bandFirstBin[b]; k <= bandLastBin[b]; k++) {
+      sum += binPower[k - firstBin];
+    }
+    bandRms[b] = rmsFromEnergy(sum * 16 / 3, (size_t)BAND_WINDOW_SIZE * BAND_WINDOW_SIZE);
+  }
+  windowRms = rmsFromEnergy(energy, BAND_WINDOW_SIZE);
+
+  windowCycles = cycles + (hal::cycleCount() - start);
+  if (windowCycles > maxWindowCycles) maxWindowCycles = windowCycles;
+  if (windowCycles > BAND_CYCLE_BUDGET) overBudgetWindows++;
+  windows++;
+
+  position = 0;
+  energy = 0;
+  cycles = 0;
+  ready = true;
+}
@@ -0,0 +1,104 @@
+/*
+ * Band Energy Analyzer for ESP32-C3 BEACON
+ * Fixed-point Goertzel filter bank for on-device sound event detection
+ *
+ * Samples are Hann-windowed and fed through one Goertzel resonator per DFT
+ * bin, 128-sample windows (125 Hz bins at 16 kHz). Bands are contiguous bin
+ * ranges; their energy is reported as the RMS amplitude of the signal in
+ * the band, so thresholds compare directly with sample amplitudes.
+ *
+ * Processing is incremental: blocks of any length are consumed as they are
+ * captured and a result is ready at every window boundary.
+ *
+ * Cycle budget: one 64-bit multiply-accumulate per bin per sample. The
+ * THUD + DISTRESS bands (bins 1-24) cost 24 x 128 = 3072 MACs per 8 ms
+ * window, measured per window against BAND_CYCLE_BUDGET.
+ */
+
+#ifndef BAND_ENERGY_H
+#define BAND_ENERGY_H
+
+#include <Arduino.h>
+#include "Hal.h"
+
+#define BAND_WINDOW_SIZE 128    // Samples per analysis window
+#define BAND_MAX_BINS 32        // Goertzel resonators (bins 1..32 = up to 4 kHz)
+#define BAND_MAX_BANDS 4
+#define BAND_CYCLE_BUDGET 60000 // Cycles per window (~375 us at 160 MHz, < 5% of 8 ms)
+
+// ============================================================================
+// BAND ENERGY ANALYZER CLASS
+// ============================================================================
+
+class BandEnergyAnalyzer {
+public:
+  BandEnergyAnalyzer();
+
+  /**
+   * Register a band before begin()
+   * @param freqLow / freqHigh Band edges in Hz (rounded inwards to whole bins)
+   * @return Band index, or -1 if BAND_MAX_BANDS are registered
+   */
+  int8_t addBand(uint16_t freqLow, uint16_t freqHigh);
+
+  /**
+   * Build the window and resonator coefficients for the registered bands
+   * @return false if a band is narrower than one bin or the bands need
+   *         more than BAND_MAX_BINS resonators
+   */
+  bool begin(uint32_t sampleRate);
+
+  /**
+   * Feed samples up to the end of the current window
+   * @return Samples consumed; check windowReady() after each call
+   */
+  size_t process(const int16_t* samples, size_t count);
+
+  /**
+   * True once per completed window (cleared by the next process())
+   */
+  bool windowReady() const { return ready; }
+
+  // Results of the last completed window
+  int16_t getBandRms(uint8_t band) const { return band < numBands ? bandRms[band] : 0; }
+  int16_t getRms() const { return windowRms; }  // Whole window, unfiltered
+
+  // Cycle statistics
+  uint32_t getWindowCycles() const { return windowCycles; }
+  uint32_t getMaxWindowCycles() const { return maxWindowCycles; }
+  uint32_t getWindows() const { return windows; }
+  uint32_t getOverBudgetWindows() const { return overBudgetWindows; }
+
+private:
+  // Bands (bin ranges, inclusive)
+  uint8_t numBands;
+  uint16_t bandFreqLow[BAND_MAX_BANDS];
+  uint16_t bandFreqHigh[BAND_MAX_BANDS];
+  uint8_t bandFirstBin[BAND_MAX_BANDS];
+  uint8_t bandLastBin[BAND_MAX_BANDS];
+  int16_t bandRms[BAND_MAX_BANDS];
+
+  // Resonators for bins firstBin..firstBin + numBins - 1
+  uint8_t firstBin;
+  uint8_t numBins;
+  int32_t coeffs[BAND_MAX_BINS];  // 2 cos(2 pi k / N), Q14
+  int32_t state1[BAND_MAX_BINS];
+  int32_t state2[BAND_MAX_BINS];
+  int16_t window[BAND_WINDOW_SIZE];  // Hann, Q15
+
+  // Current window
+  size_t position;
+  uint64_t energy;
+  uint32_t cycles;
+  bool ready;
+
+  int16_t windowRms;
+  uint32_t windowCycles;
+  uint32_t maxWindowCycles;
+  uint32_t windows;
+  uint32_t overBudgetWindows;
+
+  void finishWindow();
+};
+
+#endif // BAND_ENERGY_H
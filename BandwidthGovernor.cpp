@@ -0,0 +1,174 @@
+/*
+ * Bandwidth Governor Implementation
+ */
+
+#include "BandwidthGovernor.h"
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+BandwidthGovernor::BandwidthGovernor()
+  : enabled(true),
+    ceiling(0),
+    rate(0),
+    level(GOVERNOR_BUCKET_BYTES),
+    refillRemainder(0),
+    lastRefillUs(micros()),
+    mtu(0),
+    connInterval(0),
+    acceptedBytes(0),
+    failedNotifications(0),
+    windowStartUs(lastRefillUs),
+    windowAcceptedBytes(0),
+    windowFailures(0),
+    windowDeferrals(0),
+    goodput(0),
+    starvedWindows(0),
+    congestedWindows(0),
+    deferredPackets(0),
+    minRate(0) {
+  setLinkParameters(23, 12);  // Default MTU, 15 ms until a central connects
+}
+
+void BandwidthGovernor::setLinkParameters(uint16_t mtu, uint16_t connInterval) {
+  if (connInterval == 0) connInterval = 12;
+  if (mtu == this->mtu && connInterval == this->connInterval) return;
+  this->mtu = mtu;
+  this->connInterval = connInterval;
+
+  // A notification is MTU bytes on the ATT layer; interval is 1.25 ms units
+  uint32_t newCeiling = (uint32_t)GOVERNOR_PACKETS_PER_EVENT * mtu * 800 / connInterval;
+  newCeiling = max(newCeiling, (uint32_t)GOVERNOR_MIN_RATE);
+
+  // The estimate keeps its place relative to the ceiling (a congested link
+  // stays congested after an MTU exchange)
+  rate = (ceiling == 0) ? newCeiling : (uint32_t)((uint64_t)rate * newCeiling / ceiling);
+  rate = max((uint32_t)GOVERNOR_MIN_RATE, min(rate, newCeiling));
+  ceiling = newCeiling;
+}
+
+// ============================================================================
+// TOKEN BUCKET
+// ============================================================================
+
+void BandwidthGovernor::update() {
+  uint32_t now = micros();
+  uint32_t elapsed = now - lastRefillUs;
+  lastRefillUs = now;
+
+  uint64_t credit = (uint64_t)rate * elapsed + refillRemainder;
+  uint64_t tokens = credit / 1000000;
+  refillRemainder = (uint32_t)(credit % 1000000);
+  if (tokens >= (uint64_t)(GOVERNOR_BUCKET_BYTES - level)) {
+    level = GOVERNOR_BUCKET_BYTES;
+    refillRemainder = 0;
+  } else {
+    level += (int32_t)tokens;
+  }
+
+  if (now - windowStartUs >= (uint32_t)GOVERNOR_WINDOW_MS * 1000) closeWindow(now - windowStartUs);
+}
+
+bool BandwidthGovernor::trySend(uint8_t priority, size_t bytes) {
+  if (!enabled) return true;
+  int32_t cost = (int32_t)(bytes + GOVERNOR_ATT_OVERHEAD);
+
+  // Alerts go regardless; the debt is bounded by one bucket
+  if (priority == 0) {
+    level = max(level - cost, (int32_t)-GOVERNOR_BUCKET_BYTES);
+    return true;
+  }
+
+  int32_t reserve = GOVERNOR_CRITICAL_RESERVE;
+  if (priority > 1) reserve += GOVERNOR_HIGH_RESERVE;
+  if (level - cost < reserve) {
+    if (priority > 1) windowDeferrals++;  // Demand beyond the rate: probe up
+    if (priority == 2) deferredPackets++;
+    return false;
+  }
+  level -= cost;
+  return true;
+}
+
+void BandwidthGovernor::recordStatus(size_t bytes, bool success) {
+  if (success) {
+    acceptedBytes += (uint32_t)(bytes + GOVERNOR_ATT_OVERHEAD);
+  } else {
+    failedNotifications++;
+  }
+}
+
+// ============================================================================
+// LINK RATE ESTIMATE
+// ============================================================================
+
+void BandwidthGovernor::closeWindow(uint32_t elapsedUs) {
+  uint32_t accepted = acceptedBytes;
+  uint32_t failures = failedNotifications;
+  goodput = (uint32_t)((uint64_t)(accepted - windowAcceptedBytes) * 1000000 / elapsedUs);
+
+  if (windowDeferrals > 0) starvedWindows++;
+  if (failures != windowFailures) {
+    // The stack's buffers overflowed: the link carries what it accepted.
+    // Back off under it and let the buffers drain before audio resumes
+    congestedWindows++;
+    uint32_t target = min(rate, goodput);
+    rate = max((uint32_t)GOVERNOR_MIN_RATE, target - target / 16);
+    level = min(level, (int32_t)0);
+    if (minRate == 0 || rate < minRate) minRate = rate;
+  } else if (rate < ceiling) {
+    // Without deferrals the window was app-limited and says little about
+    // the link: probe no further than GOVERNOR_PROBE_FACTOR x the goodput
+    uint32_t limit = ceiling;
+    if (windowDeferrals == 0) limit = min(limit, max((uint32_t)GOVERNOR_MIN_RATE, goodput * GOVERNOR_PROBE_FACTOR));
+    if (rate < limit) rate = min(limit, rate + rate / 16);
+  }
+
+  windowStartUs += elapsedUs;
+  windowAcceptedBytes = accepted;
+  windowFailures = failures;
+  windowDeferrals = 0;
+}
+
+uint32_t BandwidthGovernor::getAudioBudget() const {
+  if (!enabled) return 0xFFFFFFFF;
+  return (rate > GOVERNOR_CONTROL_RATE) ? rate - GOVERNOR_CONTROL_RATE : 0;
+}
+
+uint32_t BandwidthGovernor::getAudioQueueAllowance() const {
+  if (!enabled) return 0xFFFFFFFF;
+  // Never less than one full frame, so audio keeps flowing on a slow link
+  return max(getAudioBudget() * GOVERNOR_QUEUE_MS / 1000, (uint32_t)256);
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void BandwidthGovernor::printStatistics() {
+  Serial.print(F("  Link Rate: "));
+  Serial.print(rate);
+  Serial.print(F(" B/s (ceiling "));
+  Serial.print(ceiling);
+  Serial.print(F(", goodput "));
+  Serial.print(goodput);
+  if (minRate > 0) {
+    Serial.print(F(", min "));
+    Serial.print(minRate);
+  }
+  Serial.print(F("), bucket "));
+  Serial.print(level);
+  Serial.print(F(" / "));
+  Serial.print(GOVERNOR_BUCKET_BYTES);
+  Serial.println(enabled ? F(" B") : F(" B (pacing off)"));
+  Serial.print(F("  Link Pacing: "));
+  Serial.print(congestedWindows);
+  Serial.print(F(" congested / "));
+  Serial.print(starvedWindows);
+  Serial.print(F(" starved windows, "));
+  Serial.print(deferredPackets);
+  Serial.print(F(" audio deferrals, "));
+  Serial.print(failedNotifications);
+  Serial.println(F(" failed notifications"));
+}
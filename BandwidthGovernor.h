@@ -0,0 +1,140 @@
+/*
+ * Bandwidth Governor for ESP32-C3 BEACON
+ * Byte token bucket that paces DataScheduler's dequeue to what the BLE link
+ * actually carries
+ *
+ * Tokens are bytes: a packet costs its payload plus the ATT header. The
+ * bucket refills at the link rate estimate and holds GOVERNOR_BUCKET_BYTES,
+ * about what NimBLE's transmit buffers absorb, so a burst (history flush,
+ * queue backlog after a stall) is spread out instead of overrunning them.
+ *
+ * Link rate estimate:
+ * - ceiling from the connection: GOVERNOR_PACKETS_PER_EVENT full
+ *   notifications (MTU - 3 bytes) per connection interval
+ * - every GOVERNOR_WINDOW_MS the bytes the stack accepted (notify
+ *   completions, recordStatus()) give the goodput. A window with failed
+ *   notifications (buffers full: the link carried less than was offered)
+ *   sets the rate just under that goodput; a clean window probes 1/16
+ *   higher, up to the ceiling (up to GOVERNOR_PROBE_FACTOR x the goodput
+ *   when audio or backfill was never deferred: the estimate does not drift up while
+ *   the codec leaves the link idle).
+ *
+ * Reserves: the bottom GOVERNOR_CRITICAL_RESERVE bytes of the bucket are
+ * spent only by alerts, the next GOVERNOR_HIGH_RESERVE by alerts and heart
+ * rate; audio, and the flash-log backfill after it (StoreForward.h), spend
+ * only above both. Alerts are never held back and may take the bucket into
+ * debt, which the refill repays before audio resumes.
+ *
+ * update() and trySend() run in the consumer (loop()); recordStatus() may
+ * run in the NimBLE host task and only advances counters.
+ */
+
+#ifndef BANDWIDTH_GOVERNOR_H
+#define BANDWIDTH_GOVERNOR_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// GOVERNOR CONFIGURATION
+// ============================================================================
+
+#define GOVERNOR_ATT_OVERHEAD 3        // ATT opcode + handle per notification
+#define GOVERNOR_BUCKET_BYTES 1536     // Burst size (~10 audio frames in flight)
+#define GOVERNOR_CRITICAL_RESERVE 128  // Alerts only (three 32-byte alerts + headers)
+#define GOVERNOR_HIGH_RESERVE 32       // Alerts and heart rate, above the alert reserve
+#define GOVERNOR_CONTROL_RATE 64       // Bytes/s kept out of the audio budget (HR 1 Hz, alerts)
+#define GOVERNOR_PACKETS_PER_EVENT 4   // Ceiling: notifications per connection event
+#define GOVERNOR_WINDOW_MS 250         // Goodput measurement window
+#define GOVERNOR_MIN_RATE 1000         // Bytes/s floor of the estimate
+#define GOVERNOR_PROBE_FACTOR 3        // App-limited windows probe up to this x goodput
+#define GOVERNOR_QUEUE_MS 250          // Audio admitted while the queue drains within this
+
+class BandwidthGovernor {
+public:
+  BandwidthGovernor();
+
+  /**
+   * Pacing on/off; off, trySend() always succeeds and the audio budget is
+   * unlimited (benchmarks of the unpaced path)
+   */
+  void setEnabled(bool enable) { enabled = enable; }
+  bool isEnabled() const { return enabled; }
+
+  /**
+   * Negotiated MTU and connection interval (1.25 ms units). The ceiling
+   * follows them and the current estimate scales with it.
+   */
+  void setLinkParameters(uint16_t mtu, uint16_t connInterval);
+
+  /**
+   * Refill the bucket for the time since the last call and close the
+   * measurement window when it is due
+   */
+  void update();
+
+  /**
+   * Spend the tokens for one packet
+   * @param priority DataPriority of the packet (0 = critical: always spent)
+   * @param bytes Payload bytes (the ATT header is added)
+   * @return false if the bucket cannot pay above this priority's reserve
+   */
+  bool trySend(uint8_t priority, size_t bytes);
+
+  /**
+   * Notification outcome reported by the stack (bytes = payload)
+   */
+  void recordStatus(size_t bytes, bool success);
+
+  /**
+   * Bytes/s audio may use: the rate estimate less GOVERNOR_CONTROL_RATE
+   * (0xFFFFFFFF while disabled)
+   */
+  uint32_t getAudioBudget() const;
+
+  /**
+   * Audio bytes that may wait in the queue (GOVERNOR_QUEUE_MS of budget)
+   */
+  uint32_t getAudioQueueAllowance() const;
+
+  uint32_t getRate() const { return rate; }
+  uint32_t getCeiling() const { return ceiling; }
+  uint32_t getGoodput() const { return goodput; }  // Last window, bytes/s
+
+  // Windows in which audio found the bucket dry / notifications failed
+  // (running counts; the codec adaptation watches the congested count)
+  uint32_t getStarvedWindows() const { return starvedWindows; }
+  uint32_t getCongestedWindows() const { return congestedWindows; }
+
+  void printStatistics();
+
+private:
+  bool enabled;
+  uint32_t ceiling;       // Bytes/s the connection parameters allow
+  uint32_t rate;          // Current estimate, GOVERNOR_MIN_RATE..ceiling
+  int32_t level;          // Tokens (bytes); negative = debt from alerts
+  uint32_t refillRemainder;  // Byte-microseconds not yet a whole token
+  uint32_t lastRefillUs;
+  uint16_t mtu;
+  uint16_t connInterval;
+
+  // Completions (written by the NimBLE host task, read by update())
+  volatile uint32_t acceptedBytes;
+  volatile uint32_t failedNotifications;
+
+  // Measurement window
+  uint32_t windowStartUs;
+  uint32_t windowAcceptedBytes;   // acceptedBytes at the window start
+  uint32_t windowFailures;        // failedNotifications at the window start
+  uint32_t windowDeferrals;       // trySend() refusals of audio / backfill in the window
+  uint32_t goodput;
+
+  // Statistics
+  uint32_t starvedWindows;
+  uint32_t congestedWindows;
+  uint32_t deferredPackets;       // Audio refusals (a packet may be refused several times)
+  uint32_t minRate;               // Lowest estimate after congestion (0 = none)
+
+  void closeWindow(uint32_t elapsedUs);
+};
+
+#endif // BANDWIDTH_GOVERNOR_H
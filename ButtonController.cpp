@@ -16,14 +16,14 @@ ButtonController::ButtonController()
 }
 
 void ButtonController::begin() {
-  pinMode(BUTTON_PIN, INPUT_PULLUP);
+  hal::gpioInputPullup(BUTTON_PIN);
   Serial.println(F("Button initialized on GPIO 3"));
 }
 
 void ButtonController::update() {
   uint32_t currentTime = millis();
 
-  int reading = digitalRead(BUTTON_PIN);
+  int reading = hal::gpioRead(BUTTON_PIN);
 
   if (reading != lastButtonState) {
     lastDebounceTime = currentTime;
@@ -8,6 +8,7 @@
 
 #include "Config.h"
 #include <Arduino.h>
+#include "Hal.h"
 
 class ButtonController {
 public:
@@ -22,6 +22,7 @@
 
 // Modular components
 #include "Config.h"
+#include "Hal.h"            // Clock / I2C / I2S / GPIO abstraction
 #include "DataScheduler.h"  // Priority-based BLE transmission
 #include "BLEManager.h"
 #include "HeartRateSensor.h"
@@ -29,6 +30,7 @@
 #include "PowerManager.h"
 #include "ButtonController.h"
 #include "AudioDetector.h"
+#include "CodecBenchmark.h"
 
 
 // ============================================================================
@@ -90,6 +92,7 @@ void onFallDetected() {
   Serial.println(F("ALERT: FALL_DETECTED!"));
   // Enqueue critical alert via DataScheduler (CRITICAL priority)
   dataScheduler.enqueueAlert("FALL_DETECTED");
+  audioDetector.triggerStreaming(AUDIO_TRIGGER_FALL);  // Seconds before the fall, then live
   powerManager.recordActivity();
   delay(10000);
   fallDetector.resetFallDetection();
@@ -103,6 +106,7 @@ void onManualAlert() {
   Serial.println(F("========================================"));
   // Enqueue critical alert via DataScheduler (CRITICAL priority)
   dataScheduler.enqueueAlert("MANUAL_ALERT");
+  audioDetector.triggerStreaming(AUDIO_TRIGGER_MANUAL_ALERT);
   powerManager.recordActivity();
 }
 
@@ -129,13 +133,40 @@ void onTriggerFall() {
   onFallDetected();
 }
 
-// Note: Local audio callbacks disabled - all ML inference on iPhone
+void onAudioModeRequest(AudioCodecMode mode) {
+  // Phone steps down the bitrate ladder on slow connection intervals
+  audioDetector.setCodecMode(mode);
+}
+
+void onAudioStreamRequest(AudioStreamMode mode) {
+  // Phone-side keyword spotting asks for log-mel features instead of audio
+  audioDetector.setStreamMode(mode);
+}
+
+void onAudioTriggerRequest() {
+  // Phone asks to listen in: pre-trigger history, then live
+  audioDetector.triggerStreaming(AUDIO_TRIGGER_COMMAND);
+}
+
+// Sound events detected on the watch (Goertzel bands); raised even while
+// the phone is away, queued alerts go out on reconnect
 void onAudioThud() {
-  // Disabled: Audio analysis now happens on iPhone via TensorFlow Lite
+  Serial.println(F("ALERT: AUDIO_THUD detected!"));
+  dataScheduler.enqueueAlert("AUDIO_THUD");
+  powerManager.recordActivity();
 }
 
 void onAudioDistress() {
-  // Disabled: Audio analysis now happens on iPhone via TensorFlow Lite
+  Serial.println(F("ALERT: DISTRESS_SOUND detected!"));
+  dataScheduler.enqueueAlert("DISTRESS_SOUND");
+  powerManager.recordActivity();
+}
+
+// Spoken "SOS" recognised on the watch (int8 keyword model)
+void onSosVoice() {
+  Serial.println(F("ALERT: SOS_VOICE detected!"));
+  dataScheduler.enqueueAlert("SOS_VOICE");
+  powerManager.recordActivity();
 }
 
 // ============================================================================
@@ -210,6 +241,23 @@ bool initVCNL4040() {
   return true;
 }
 
+// ============================================================================
+// DIAGNOSTICS
+// ============================================================================
+
+void runBootCodecBenchmark() {
+  size_t numSamples = (size_t)AUDIO_BASE_SAMPLE_RATE * CODEC_BENCHMARK_SECONDS;
+  int16_t* pcm = (int16_t*)malloc(numSamples * sizeof(int16_t));
+  if (!pcm) {
+    Serial.println(F("[CodecBench] ERROR: Out of memory"));
+    return;
+  }
+
+  generateSpeechTestSignal(pcm, numSamples, AUDIO_BASE_SAMPLE_RATE);
+  runCodecBenchmark(pcm, numSamples, AUDIO_BASE_SAMPLE_RATE);
+  free(pcm);
+}
+
 // ============================================================================
 // ARDUINO SETUP
 // ============================================================================
@@ -223,6 +271,10 @@ void setup() {
   Serial.println(F("BLE-Only Build (WiFi Removed)"));
   Serial.println(F("=================================\n"));
 
+#if ENABLE_CODEC_BENCHMARK
+  runBootCodecBenchmark();
+#endif
+
   // Initialize I2C with explicit pins
   Serial.println(F("Initializing I2C bus..."));
   Serial.print(F("SDA: GPIO"));
@@ -230,8 +282,7 @@ void setup() {
   Serial.print(F(", SCL: GPIO"));
   Serial.println(I2C_SCL_PIN);
 
-  Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
-  Wire.setClock(400000);  // 400kHz
+  hal::i2cBegin(I2C_SDA_PIN, I2C_SCL_PIN, 400000);  // 400kHz
   delay(100);  // Allow I2C to stabilize
 
   // Scan I2C bus for connected devices
@@ -244,10 +295,7 @@ void setup() {
 
   uint8_t devicesFound = 0;
   for (uint8_t addr = 1; addr < 127; addr++) {
-    Wire.beginTransmission(addr);
-    uint8_t error = Wire.endTransmission();
-
-    if (error == 0) {
+    if (hal::i2cProbe(addr)) {
       Serial.print(F("  [FOUND] Device at 0x"));
       if (addr < 16) Serial.print(F("0"));
       Serial.print(addr, HEX);
@@ -276,15 +324,12 @@ void setup() {
     Serial.println(F("  4. Wiring problem"));
     Serial.println(F("\nRetrying at 100kHz (slower speed)..."));
 
-    Wire.setClock(100000);  // Try slower speed
+    hal::i2cSetClock(100000);  // Try slower speed
     delay(100);
 
     // Retry scan at slower speed
     for (uint8_t addr = 1; addr < 127; addr++) {
-      Wire.beginTransmission(addr);
-      uint8_t error = Wire.endTransmission();
-
-      if (error == 0) {
+      if (hal::i2cProbe(addr)) {
         Serial.print(F("  [FOUND] Device at 0x"));
         if (addr < 16) Serial.print(F("0"));
         Serial.println(addr, HEX);
@@ -340,7 +385,7 @@ void setup() {
   } else {
     // Connect audio detector to DataScheduler for compressed streaming
     audioDetector.setDataScheduler(&dataScheduler);
-    audioDetector.enableStreaming(true);  // Enable ADPCM-compressed BLE streaming
+    audioDetector.enableStreaming(true);  // Enable ADPCM-compressed BLE streaming (gated by triggers)
     audioDetector.setAdaptiveRate(true);  // Enable VAD-based adaptive rate
     Serial.println(F("[Audio] ADPCM-compressed streaming configured for iOS SOS detection"));
   }
@@ -348,6 +393,9 @@ void setup() {
   // Set up BLE callbacks
   bleManager.setResetAlertCallback(onResetAlert);
   bleManager.setTriggerFallCallback(onTriggerFall);
+  bleManager.setAudioModeCallback(onAudioModeRequest);
+  bleManager.setAudioStreamCallback(onAudioStreamRequest);
+  bleManager.setAudioTriggerCallback(onAudioTriggerRequest);
 
   // Set up sensor callbacks
   hrSensor.setHeartRateCallback(onHeartRateUpdate);
@@ -358,6 +406,7 @@ void setup() {
   buttonController.setFalseAlarmCallback(onFalseAlarm);
   audioDetector.setThudCallback(onAudioThud);
   audioDetector.setDistressCallback(onAudioDistress);
+  audioDetector.setSosCallback(onSosVoice);
 
   // Set up power management callbacks
   powerManager.setSensorDimCallback(dimSensors);
@@ -413,6 +462,8 @@ void loop() {
   if (currentTime - lastStatsTime >= 10000) {
     lastStatsTime = currentTime;
     dataScheduler.printStatistics();
+    bleManager.printStatistics();
+    audioDetector.printStatistics();
   }
 
   yield();
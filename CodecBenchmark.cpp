@@ -0,0 +1,441 @@
+/*
+ * Codec Benchmark Implementation
+ * ADPCM round-trip throughput and SNR measurement
+ */
+
+#include "CodecBenchmark.h"
+#include "Config.h"
+
+// Block sizes swept by runCodecBenchmark (256 = AudioDetector streaming block)
+static const size_t BENCH_BLOCK_SIZES[] = {32, 64, 128, 256, 512, 1024};
+static const uint8_t BENCH_PASSES = 5;
+
+// ============================================================================
+// ROUND TRIP
+// ============================================================================
+
+bool benchmarkADPCMRoundTrip(const int16_t* pcm, size_t numSamples, size_t blockSize,
+                             ADPCMEncoderEngine engine, uint8_t passes, CodecBenchmarkResult& result) {
+  uint8_t* adpcm = (uint8_t*)malloc((numSamples + 1) / 2 + blockSize);
+  int16_t* decoded = (int16_t*)malloc(numSamples * sizeof(int16_t));
+  if (!adpcm || !decoded) {
+    free(adpcm);
+    free(decoded);
+    return false;
+  }
+
+  ADPCMCodec codec;
+  codec.setEncoderEngine(engine);
+  uint32_t bestEncode = UINT32_MAX;
+  uint32_t bestDecode = UINT32_MAX;
+
+  for (uint8_t pass = 0; pass < passes; pass++) {
+    // Encode in blocks with one continuous encoder state
+    codec.resetEncoder();
+    size_t outputOffset = 0;
+    uint32_t start = hal::cycleCount();
+    for (size_t offset = 0; offset < numSamples; offset += blockSize) {
+      size_t count = min(blockSize, numSamples - offset);
+      outputOffset += codec.encode(pcm + offset, count, adpcm + outputOffset);
+    }
+    uint32_t elapsed = hal::cycleCount() - start;
+    if (elapsed < bestEncode) bestEncode = elapsed;
+
+    // Decode in the same blocks (block sizes are even, so blocks stay byte-aligned)
+    codec.resetDecoder();
+    start = hal::cycleCount();
+    for (size_t offset = 0; offset < numSamples; offset += blockSize) {
+      size_t count = min(blockSize, numSamples - offset);
+      codec.decode(adpcm + offset / 2, count, decoded + offset);
+    }
+    elapsed = hal::cycleCount() - start;
+    if (elapsed < bestDecode) bestDecode = elapsed;
+  }
+
+  float nsPerCycle = 1000.0f / hal::cpuFrequencyMHz();
+
+  result.engine = engine;
+  result.blockSize = blockSize;
+  result.numSamples = numSamples;
+  result.encodeCycles = bestEncode;
+  result.decodeCycles = bestDecode;
+  result.encodeNsPerSample = bestEncode * nsPerCycle / numSamples;
+  result.decodeNsPerSample = bestDecode * nsPerCycle / numSamples;
+  result.snrDb = computeSNR(pcm, decoded, numSamples);
+
+  free(adpcm);
+  free(decoded);
+  return true;
+}
+
+long verifyEncoderEngines(const int16_t* pcm, size_t numSamples) {
+  // Odd block size exercises the unpaired trailing nibble too
+  const size_t blockSize = 255;
+  const size_t blockBytes = (blockSize + 1) / 2;
+  uint8_t* referenceOutput = (uint8_t*)malloc(blockBytes);
+  uint8_t* tableOutput = (uint8_t*)malloc(blockBytes);
+  if (!referenceOutput || !tableOutput) {
+    free(referenceOutput);
+    free(tableOutput);
+    return -1;
+  }
+
+  ADPCMCodec reference;
+  ADPCMCodec table;
+  reference.setEncoderEngine(ADPCM_ENCODER_REFERENCE);
+  table.setEncoderEngine(ADPCM_ENCODER_TABLE);
+
+  long mismatches = 0;
+  for (size_t offset = 0; offset < numSamples; offset += blockSize) {
+    size_t count = min(blockSize, numSamples - offset);
+    size_t written = reference.encode(pcm + offset, count, referenceOutput);
+    if (table.encode(pcm + offset, count, tableOutput) != written) mismatches++;
+
+    for (size_t i = 0; i < written; i++) {
+      if (referenceOutput[i] != tableOutput[i]) mismatches++;
+    }
+  }
+
+  int16_t referencePredicted, referenceIndex, tablePredicted, tableIndex;
+  reference.getState(referencePredicted, referenceIndex);
+  table.getState(tablePredicted, tableIndex);
+  if (referencePredicted != tablePredicted || referenceIndex != tableIndex) mismatches++;
+
+  free(referenceOutput);
+  free(tableOutput);
+  return mismatches;
+}
+
+bool benchmarkFusedKernel(const int16_t* pcm, size_t numSamples, uint8_t passes, FusedKernelResult& result) {
+  const size_t blockSize = 256;  // AudioDetector streaming block
+  const size_t outputBytes = (numSamples + 1) / 2 + blockSize;
+  uint8_t* separateOutput = (uint8_t*)malloc(outputBytes);
+  uint8_t* fusedOutput = (uint8_t*)malloc(outputBytes);
+  if (!separateOutput || !fusedOutput) {
+    free(separateOutput);
+    free(fusedOutput);
+    return false;
+  }
+
+  ADPCMCodec separate;
+  ADPCMCodec fused;
+  separate.setEncoderEngine(ADPCM_ENCODER_TABLE);
+  uint32_t bestSeparate = UINT32_MAX;
+  uint32_t bestFused = UINT32_MAX;
+  bool exact = true;
+
+  for (uint8_t pass = 0; pass < passes; pass++) {
+    separate.resetEncoder();
+    fused.resetEncoder();
+    size_t outputOffset = 0;
+    int32_t rmsSum = 0;
+    uint32_t start = hal::cycleCount();
+    for (size_t offset = 0; offset < numSamples; offset += blockSize) {
+      size_t count = min(blockSize, numSamples - offset);
+      rmsSum += calculateRMS(pcm + offset, count);
+      outputOffset += separate.encode(pcm + offset, count, separateOutput + outputOffset);
+    }
+    uint32_t elapsed = hal::cycleCount() - start;
+    if (elapsed < bestSeparate) bestSeparate = elapsed;
+
+    outputOffset = 0;
+    int32_t fusedRmsSum = 0;
+    start = hal::cycleCount();
+    for (size_t offset = 0; offset < numSamples; offset += blockSize) {
+      size_t count = min(blockSize, numSamples - offset);
+      AudioBlockStats stats;
+      outputOffset += fused.encodeWithStats(pcm + offset, count, fusedOutput + outputOffset, stats);
+      fusedRmsSum += stats.rms;
+    }
+    elapsed = hal::cycleCount() - start;
+    if (elapsed < bestFused) bestFused = elapsed;
+
+    int16_t separatePredicted, separateIndex, fusedPredicted, fusedIndex;
+    separate.getState(separatePredicted, separateIndex);
+    fused.getState(fusedPredicted, fusedIndex);
+    exact = exact && (rmsSum == fusedRmsSum) && (separatePredicted == fusedPredicted) &&
+            (separateIndex == fusedIndex) && (memcmp(separateOutput, fusedOutput, outputOffset) == 0);
+  }
+
+  result.numSamples = numSamples;
+  result.separateCycles = bestSeparate;
+  result.fusedCycles = bestFused;
+  result.bitExact = exact;
+
+  free(separateOutput);
+  free(fusedOutput);
+  return true;
+}
+
+bool benchmarkCodecMode(const int16_t* pcm, size_t numSamples, AudioCodecMode mode, uint8_t passes,
+                        CodecModeResult& result) {
+  const size_t frameSamples = 256;  // AudioDetector streaming block
+  numSamples -= numSamples % frameSamples;
+  uint8_t* payload = (uint8_t*)malloc(numSamples / 2 + frameSamples);
+  int16_t* decoded = (int16_t*)malloc(numSamples * sizeof(int16_t));
+  int16_t* reference = (int16_t*)malloc(numSamples * sizeof(int16_t));
+  size_t* frameOffsets = (size_t*)malloc((numSamples / frameSamples + 1) * sizeof(size_t));
+  int16_t* frameStates = (int16_t*)malloc((numSamples / frameSamples) * 2 * sizeof(int16_t));
+  if (!payload || !decoded || !reference || !frameOffsets || !frameStates) {
+    free(payload);
+    free(decoded);
+    free(reference);
+    free(frameOffsets);
+    free(frameStates);
+    return false;
+  }
+
+  size_t numFrames = numSamples / frameSamples;
+  size_t codedPerFrame = frameSamples / audioCodecDecimation(mode);
+  uint32_t bestEncode = UINT32_MAX;
+  uint32_t bestDecode = UINT32_MAX;
+
+  for (uint8_t pass = 0; pass < passes; pass++) {
+    AudioCodec codec;
+    codec.setMode(mode);
+    size_t outputOffset = 0;
+    uint32_t start = hal::cycleCount();
+    for (size_t f = 0; f < numFrames; f++) {
+      AudioBlockStats stats;
+      size_t codedSamples;
+      codec.getEncoderState(frameStates[2 * f], frameStates[2 * f + 1]);
+      frameOffsets[f] = outputOffset;
+      outputOffset += codec.encode(pcm + f * frameSamples, frameSamples, payload + outputOffset, codedSamples, stats);
+    }
+    uint32_t elapsed = hal::cycleCount() - start;
+    if (elapsed < bestEncode) bestEncode = elapsed;
+    frameOffsets[numFrames] = outputOffset;
+
+    start = hal::cycleCount();
+    for (size_t f = 0; f < numFrames; f++) {
+      codec.decode(mode, frameStates[2 * f], frameStates[2 * f + 1], payload + frameOffsets[f], codedPerFrame,
+                   decoded + f * codedPerFrame);
+    }
+    elapsed = hal::cycleCount() - start;
+    if (elapsed < bestDecode) bestDecode = elapsed;
+  }
+
+  // Reference at the coded rate; compare at the best lag (QMF delay for SUBBAND)
+  size_t codedTotal = numFrames * codedPerFrame;
+  if (audioCodecDecimation(mode) == 2) {
+    HalfbandDecimator decimator;
+    decimator.process(pcm, numSamples, reference);
+  } else {
+    memcpy(reference, pcm, numSamples * sizeof(int16_t));
+  }
+  const size_t maxLag = 32;
+  float bestSnr = -99.0f;
+  for (size_t lag = 0; lag < maxLag && lag < codedTotal; lag++) {
+    float snr = computeSNR(reference, decoded + lag, codedTotal - maxLag);
+    if (snr > bestSnr) bestSnr = snr;
+  }
+
+  result.mode = mode;
+  result.numSamples = numSamples;
+  result.encodeCycles = bestEncode;
+  result.decodeCycles = bestDecode;
+  result.payloadBytes = frameOffsets[numFrames];
+  result.snrDb = bestSnr;
+
+  free(payload);
+  free(decoded);
+  free(reference);
+  free(frameOffsets);
+  free(frameStates);
+  return true;
+}
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+static const char* engineName(ADPCMEncoderEngine engine) {
+  return (engine == ADPCM_ENCODER_TABLE) ? "table" : "ref";
+}
+
+static void printResultRow(const CodecBenchmarkResult& result) {
+  // Fraction of one CPU needed to encode in real time at the capture rate
+  float encodeLoad = result.encodeNsPerSample * AUDIO_BASE_SAMPLE_RATE / 1e7f;
+
+  Serial.print(F("  "));
+  Serial.print(engineName(result.engine));
+  Serial.print(F("\t| "));
+  Serial.print(result.blockSize);
+  Serial.print(F("\t| "));
+  Serial.print((float)result.encodeCycles / result.numSamples, 1);
+  Serial.print(F("\t| "));
+  Serial.print(result.encodeNsPerSample, 2);
+  Serial.print(F("\t| "));
+  Serial.print(1000.0f / result.encodeNsPerSample, 2);
+  Serial.print(F("\t| "));
+  Serial.print(result.decodeNsPerSample, 2);
+  Serial.print(F("\t| "));
+  Serial.print(1000.0f / result.decodeNsPerSample, 2);
+  Serial.print(F("\t| "));
+  Serial.print(encodeLoad, 3);
+  Serial.print(F("%\t| "));
+  Serial.println(result.snrDb, 2);
+}
+
+static void printBitExactCheck(const char* label, const int16_t* pcm, size_t numSamples) {
+  long mismatches = verifyEncoderEngines(pcm, numSamples);
+  Serial.print(F("  Bit-exact ("));
+  Serial.print(label);
+  Serial.print(F("): "));
+  if (mismatches == 0) {
+    Serial.println(F("YES"));
+  } else if (mismatches < 0) {
+    Serial.println(F("SKIPPED (out of memory)"));
+  } else {
+    Serial.print(F("NO - "));
+    Serial.print(mismatches);
+    Serial.println(F(" mismatches"));
+  }
+}
+
+void runCodecBenchmark(const int16_t* pcm, size_t numSamples, uint32_t sampleRate) {
+  Serial.println(F("========================================"));
+  Serial.println(F("[CodecBench] IMA ADPCM round trip"));
+  Serial.println(F("========================================"));
+  Serial.print(F("  Samples: "));
+  Serial.print(numSamples);
+  Serial.print(F(" @ "));
+  Serial.print(sampleRate);
+  Serial.print(F(" Hz, CPU: "));
+  Serial.print(hal::cpuFrequencyMHz());
+  Serial.println(F(" MHz"));
+
+  // Engines must agree on the real signal and on full-scale edge cases
+  printBitExactCheck("signal", pcm, numSamples);
+  const size_t edgeSamples = 4096;
+  int16_t* edge = (int16_t*)malloc(edgeSamples * sizeof(int16_t));
+  if (edge) {
+    uint32_t noiseState = 0xBEAC0001;
+    for (size_t i = 0; i < edgeSamples; i++) {
+      noiseState = noiseState * 1664525u + 1013904223u;
+      // Full-scale square bursts interleaved with random full-range noise
+      edge[i] = (i & 512) ? (int16_t)(noiseState >> 16) : ((i & 8) ? 32767 : -32768);
+    }
+    printBitExactCheck("full-scale", edge, edgeSamples);
+    free(edge);
+  }
+
+  Serial.println(F("  engine | block | enc cyc/smp | enc ns/smp | enc Msmp/s | dec ns/smp | dec Msmp/s | enc RT load | SNR dB"));
+
+  const ADPCMEncoderEngine engines[] = {ADPCM_ENCODER_REFERENCE, ADPCM_ENCODER_TABLE};
+  for (size_t i = 0; i < sizeof(BENCH_BLOCK_SIZES) / sizeof(BENCH_BLOCK_SIZES[0]); i++) {
+    for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+      CodecBenchmarkResult result;
+      if (!benchmarkADPCMRoundTrip(pcm, numSamples, BENCH_BLOCK_SIZES[i], engines[e], BENCH_PASSES, result)) {
+        Serial.println(F("[CodecBench] ERROR: Out of memory"));
+        return;
+      }
+      printResultRow(result);
+    }
+  }
+
+  FusedKernelResult fused;
+  if (benchmarkFusedKernel(pcm, numSamples, BENCH_PASSES, fused)) {
+    float nsPerCycle = 1000.0f / hal::cpuFrequencyMHz();
+    Serial.print(F("  Streaming block (256): RMS + encode "));
+    Serial.print(fused.separateCycles * nsPerCycle / fused.numSamples, 2);
+    Serial.print(F(" ns/smp, fused "));
+    Serial.print(fused.fusedCycles * nsPerCycle / fused.numSamples, 2);
+    Serial.print(F(" ns/smp, bit-exact: "));
+    Serial.println(fused.bitExact ? F("YES") : F("NO"));
+  }
+
+  // Bitrate ladder (ns per 16 kHz input sample, 256-sample frames)
+  Serial.println(F("  mode        | kbps | enc ns/smp | dec ns/smp | SNR dB"));
+  for (uint8_t m = AUDIO_CODEC_IMA4_16K; m <= AUDIO_CODEC_SUBBAND_16K; m++) {
+    CodecModeResult modeResult;
+    if (!benchmarkCodecMode(pcm, numSamples, (AudioCodecMode)m, BENCH_PASSES, modeResult)) {
+      Serial.println(F("[CodecBench] ERROR: Out of memory"));
+      break;
+    }
+    float nsPerCycle = 1000.0f / hal::cpuFrequencyMHz();
+    float seconds = (float)modeResult.numSamples / sampleRate;
+    Serial.print(F("  "));
+    Serial.print(audioCodecName(modeResult.mode));
+    Serial.print(F("\t| "));
+    Serial.print(modeResult.payloadBytes * 8.0f / seconds / 1000.0f, 1);
+    Serial.print(F("\t| "));
+    Serial.print(modeResult.encodeCycles * nsPerCycle / modeResult.numSamples, 2);
+    Serial.print(F("\t| "));
+    Serial.print(modeResult.decodeCycles * nsPerCycle / modeResult.numSamples, 2);
+    Serial.print(F("\t| "));
+    Serial.println(modeResult.snrDb, 2);
+  }
+
+  Serial.println(F("========================================"));
+}
+
+// ============================================================================
+// SIGNAL HELPERS
+// ============================================================================
+
+float computeSNR(const int16_t* reference, const int16_t* decoded, size_t count) {
+  double signalEnergy = 0;
+  double noiseEnergy = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    double s = reference[i];
+    double e = s - decoded[i];
+    signalEnergy += s * s;
+    noiseEnergy += e * e;
+  }
+
+  if (noiseEnergy == 0) return 99.0f;  // Bit-exact reconstruction
+  if (signalEnergy == 0) return 0.0f;
+  return (float)(10.0 * log10(signalEnergy / noiseEnergy));
+}
+
+void generateSpeechTestSignal(int16_t* samples, size_t count, uint32_t sampleRate) {
+  const float twoPi = 6.2831853f;
+  const size_t frameSize = sampleRate / 100;  // Formants move every 10 ms
+  const int maxHarmonics = 24;
+  float weights[maxHarmonics];
+
+  float phase = 0;
+  uint32_t noiseState = 0x12345678;
+
+  for (size_t i = 0; i < count; i++) {
+    float t = (float)i / sampleRate;
+    float pitch = 140.0f + 40.0f * sinf(twoPi * 0.7f * t);
+
+    if (i % frameSize == 0) {
+      // Two moving formants plus a fixed third, Lorentzian-shaped
+      float f1 = 600.0f + 150.0f * sinf(twoPi * 1.3f * t);
+      float f2 = 1400.0f + 400.0f * sinf(twoPi * 0.9f * t + 1.0f);
+      for (int k = 0; k < maxHarmonics; k++) {
+        float fk = pitch * (k + 1);
+        float d1 = (fk - f1) / 120.0f;
+        float d2 = (fk - f2) / 180.0f;
+        float d3 = (fk - 2600.0f) / 250.0f;
+        weights[k] = (fk < sampleRate / 2)
+                     ? (1.0f / (1 + d1 * d1) + 0.6f / (1 + d2 * d2) + 0.3f / (1 + d3 * d3))
+                     : 0.0f;
+      }
+    }
+
+    phase += twoPi * pitch / sampleRate;
+    if (phase > twoPi) phase -= twoPi;
+
+    float voiced = 0;
+    for (int k = 0; k < maxHarmonics; k++) {
+      if (weights[k] > 0.01f) voiced += weights[k] * sinf(phase * (k + 1));
+    }
+
+    // Syllable envelope (~4 Hz) with silent gaps
+    float envelope = sinf(twoPi * 2.0f * t);
+    envelope = (envelope > 0) ? envelope : 0;
+
+    noiseState = noiseState * 1664525u + 1013904223u;
+    float noise = ((int32_t)(noiseState >> 16) - 32768) / 32768.0f;
+
+    float value = 4000.0f * envelope * voiced + 150.0f * noise;
+    if (value > 32767.0f) value = 32767.0f;
+    if (value < -32768.0f) value = -32768.0f;
+    samples[i] = (int16_t)value;
+  }
+}
@@ -0,0 +1,119 @@
+/*
+ * Codec Benchmark for ESP32-C3 BEACON
+ * Round-trips PCM through ADPCMCodec::encode()/decode() and reports
+ * throughput and quality per block size
+ *
+ * Metrics (per block size and encoder engine):
+ * - Encode cycles per sample, encode / decode ns per sample and samples per second
+ * - Real-time load at the 16 kHz capture rate (% of one CPU)
+ * - SNR of the decoded signal vs. the original (dB)
+ *
+ * - Fused encode + block statistics kernel vs. separate RMS and encode passes
+ * - Bitrate ladder: throughput and SNR of every AudioCodec mode
+ *
+ * Runs on the watch (ENABLE_CODEC_BENCHMARK in Config.h, synthetic speech)
+ * and on the host (host/bench/codec_bench.cpp, recorded WAV files).
+ * Timing uses hal::cycleCount(), so figures are CPU cycles on target.
+ */
+
+#ifndef CODEC_BENCHMARK_H
+#define CODEC_BENCHMARK_H
+
+#include <Arduino.h>
+#include "ADPCMCodec.h"
+#include "AudioCodec.h"
+#include "Hal.h"
+
+// ============================================================================
+// BENCHMARK RESULT
+// ============================================================================
+
+struct CodecBenchmarkResult {
+  ADPCMEncoderEngine engine;
+  size_t blockSize;
+  size_t numSamples;
+  uint32_t encodeCycles;  // Best pass over the whole signal
+  uint32_t decodeCycles;
+  float encodeNsPerSample;
+  float decodeNsPerSample;
+  float snrDb;
+
+  CodecBenchmarkResult()
+    : engine(ADPCM_ENCODER_REFERENCE), blockSize(0), numSamples(0), encodeCycles(0), decodeCycles(0),
+      encodeNsPerSample(0), decodeNsPerSample(0), snrDb(0) {}
+};
+
+struct FusedKernelResult {
+  size_t numSamples;
+  uint32_t separateCycles;  // calculateRMS() + encode(), two passes per block
+  uint32_t fusedCycles;     // encodeWithStats(), one pass per block
+  bool bitExact;            // Same ADPCM bytes, state and RMS as the separate passes
+
+  FusedKernelResult() : numSamples(0), separateCycles(0), fusedCycles(0), bitExact(false) {}
+};
+
+struct CodecModeResult {
+  AudioCodecMode mode;
+  size_t numSamples;        // 16 kHz input samples
+  uint32_t encodeCycles;
+  uint32_t decodeCycles;
+  uint32_t payloadBytes;    // Whole signal, excluding frame headers
+  float snrDb;              // vs. the mode's own input (decimated for 8 kHz modes)
+
+  CodecModeResult()
+    : mode(AUDIO_CODEC_IMA4_16K), numSamples(0), encodeCycles(0), decodeCycles(0), payloadBytes(0), snrDb(0) {}
+};
+
+// ============================================================================
+// BENCHMARK FUNCTIONS
+// ============================================================================
+
+/**
+ * Round-trip numSamples of PCM through the ADPCM codec in blockSize chunks
+ * (one continuous encoder/decoder state, as in the streaming path)
+ * @param engine Encoder engine to time
+ * @param passes Timed passes; the fastest one is reported
+ * @return false if scratch buffers could not be allocated
+ */
+bool benchmarkADPCMRoundTrip(const int16_t* pcm, size_t numSamples, size_t blockSize,
+                             ADPCMEncoderEngine engine, uint8_t passes, CodecBenchmarkResult& result);
+
+/**
+ * Compare table-engine output and final state against the reference engine
+ * @return Number of mismatching output bytes (0 = bit-exact), or -1 on allocation failure
+ */
+long verifyEncoderEngines(const int16_t* pcm, size_t numSamples);
+
+/**
+ * Time the streaming-path block work (256-sample blocks) with separate
+ * RMS + encode passes and with the fused encodeWithStats() kernel
+ * @return false if scratch buffers could not be allocated
+ */
+bool benchmarkFusedKernel(const int16_t* pcm, size_t numSamples, uint8_t passes, FusedKernelResult& result);
+
+/**
+ * Encode and decode numSamples in 256-sample frames with one AudioCodec mode
+ * @return false if scratch buffers could not be allocated
+ */
+bool benchmarkCodecMode(const int16_t* pcm, size_t numSamples, AudioCodecMode mode, uint8_t passes,
+                        CodecModeResult& result);
+
+/**
+ * Check engines are bit-exact, then run the round trip for each standard
+ * block size and engine and print a table via Serial
+ */
+void runCodecBenchmark(const int16_t* pcm, size_t numSamples, uint32_t sampleRate);
+
+/**
+ * Signal-to-noise ratio of decoded vs. reference samples (dB)
+ */
+float computeSNR(const int16_t* reference, const int16_t* decoded, size_t count);
+
+/**
+ * Deterministic speech-like test signal (voiced harmonics with moving
+ * formants, syllable-rate envelope and a little noise), for targets
+ * without recorded clips
+ */
+void generateSpeechTestSignal(int16_t* samples, size_t count, uint32_t sampleRate);
+
+#endif // CODEC_BENCHMARK_H
@@ -76,14 +76,43 @@
 // ============================================================================
 #define AUDIO_ENABLE_ADPCM true           // Enable ADPCM compression (4:1 ratio)
 #define AUDIO_ADPCM_BUFFER_SIZE 256       // Samples to compress per chunk (128 bytes output)
+#define AUDIO_ADPCM_ENCODER_ENGINE ADPCM_ENCODER_TABLE  // or ADPCM_ENCODER_REFERENCE (bit-exact)
+#define AUDIO_CODEC_DEFAULT_MODE AUDIO_CODEC_IMA4_16K   // Start of the bitrate ladder (see AudioCodec.h)
 #define AUDIO_BASE_SAMPLE_RATE 16000      // Base sample rate (16 kHz)
 #define AUDIO_LOW_POWER_SAMPLE_RATE 8000  // Low power sample rate (8 kHz when idle)
-#define AUDIO_VAD_THRESHOLD 1500          // Voice Activity Detection RMS threshold
-#define AUDIO_ADAPTIVE_RATE true          // Enable adaptive sample rate based on VAD
-
-// Audio transmission rate limiting (packets per second)
-#define AUDIO_MAX_PACKETS_PER_SEC_HIGH 30  // High activity mode (with voice)
-#define AUDIO_MAX_PACKETS_PER_SEC_LOW 15   // Low activity mode (no voice)
+#define AUDIO_INPUT_STAGES (AUDIO_PIPELINE_DC_BLOCK | AUDIO_PIPELINE_HIGHPASS)  // Every block: events, VAD, encoder
+#define AUDIO_STREAM_STAGES AUDIO_PIPELINE_AGC  // Streamed audio only (event thresholds stay absolute); 0 = off
+#define AUDIO_ADAPTIVE_RATE true          // Code silence at 8 kHz (VAD-driven, see AudioCodec::setReducedRate)
+
+// Voice activity (adaptive rate and DTX) is decided by the multi-feature
+// detector; thresholds and attack / hangover in VoiceActivity.h
+
+// Link adaptation: step the codec down the bitrate ladder when the BLE link
+// budget (BandwidthGovernor.h) cannot carry it, and back up when it can
+#define AUDIO_LINK_ADAPTIVE true
+#define AUDIO_LINK_CHECK_MS 1000          // Adaptation cadence
+#define AUDIO_LINK_HEADROOM_PCT 85        // Share of the audio budget a mode may fill
+#define AUDIO_LINK_UPSHIFT_CHECKS 3       // Checks with room before stepping up...
+#define AUDIO_LINK_UPSHIFT_MAX_CHECKS 32  // ... doubled after each congestion step-down, up to this
+
+// Discontinuous transmission: while VAD stays silent, send small comfort-noise
+// frames (level + noise colour) instead of full ADPCM frames
+#define AUDIO_DTX_ENABLED true
+#define AUDIO_DTX_CN_INTERVAL_MS 480   // Comfort-noise frame cadence during silence
+
+// On-device SOS keyword spotting (int8 model, see KeywordSpotter.h); raises
+// SOS_VOICE without the phone. Off until a trained export replaces
+// SosModel.cpp: the shipped weights are a hand-set placeholder and must not
+// raise CRITICAL alerts
+#define AUDIO_SOS_KEYWORD false
+
+// Pre-trigger audio: frames are kept in a RAM history and only streamed after
+// a trigger (fall, manual alert, loud sound, sound event, "AUDIO_TRIGGER"),
+// history first. false = stream continuously
+#define AUDIO_PRETRIGGER_ENABLED true
+#define AUDIO_PRETRIGGER_SECONDS 5       // History sized for this much speech (~8.9 kB/s at IMA4_16K)
+#define AUDIO_TRIGGER_HOLD_MS 30000      // Live stream after the latest trigger
+#define AUDIO_TRIGGER_SPIKE_RMS 6000     // 8 ms window RMS that triggers by itself (VAD spike)
 
 // ============================================================================
 // BLE CONNECTION PARAMETERS (Bandwidth Optimization)
@@ -93,6 +122,26 @@
 #define BLE_CONN_LATENCY 0         // No latency - immediate response
 #define BLE_SUPERVISION_TIMEOUT 500 // 5000ms (500 * 10ms) - prevent premature disconnect
 #define BLE_REQUESTED_MTU 247      // Maximum BLE MTU (244 usable bytes + 3 header)
+#define BLE_PACING_ENABLED true     // Pace notifications to the measured link rate (BandwidthGovernor.h)
+#define BLE_TLV_HOLD_MS 20         // TLV mode: audio-only bundle may wait this long to fill (0 = send every drain)
+#define BLE_DEADLINE_HR_MS 2000     // Queued heart rate older than this is dropped (a newer one follows at 1 Hz)
+#define BLE_DEADLINE_AUDIO_MS 500   // Queued live audio older than this is dropped (alerts never expire)
+#define BLE_BACKFILL_RATE 4000      // Bytes/s of logged history sent after a reconnect (within the link budget too)
+
+// ============================================================================
+// ALERT DELIVERY ("ALERT_ACK:ON": sequenced alerts ACKed by the client, see AlertTracker.h)
+// ============================================================================
+#define ALERT_ACK_TIMEOUT_MS 1000      // First retransmission of an alert without ACK...
+#define ALERT_ACK_MAX_BACKOFF_MS 8000  // ... the wait doubling up to this
+#define ALERT_ACK_MAX_ATTEMPTS 8       // Sends before an alert is given up
+
+// ============================================================================
+// STORE AND FORWARD (link down: alerts and heart rate to flash, see StoreForward.h)
+// ============================================================================
+#define STORE_FORWARD_ENABLED true
+#define STORE_FORWARD_LOG_BYTES 131072   // Log area at the start of the SPIFFS partition (32 sectors)
+#define STORE_FORWARD_HR_BATCH 16        // Heart rates per log record...
+#define STORE_FORWARD_HR_BATCH_MS 30000  // ... or this long after the first one (at most 65535)
 
 // ============================================================================
 // BLE UUIDs - Unified Stage 1 Specification
@@ -101,8 +150,14 @@
 #define HR_CHAR_UUID "12345678-9012-3456-7890-1234567890AC"       // Heart Rate
 #define ALERT_CHAR_UUID "12345678-9012-3456-7890-1234567890AD"    // AlertStatus
 #define CONTROL_CHAR_UUID "12345678-9012-3456-7890-1234567890AE"  // ControlCommand
-#define AUDIO_CHAR_UUID "12345678-9012-3456-7890-1234567890AF"    // Audio Stream (16kHz, 16-bit)
+#define AUDIO_CHAR_UUID "12345678-9012-3456-7890-1234567890AF"    // Audio Stream (framed ADPCM, see AudioFrame.h)
+#define LOG_CHAR_UUID "12345678-9012-3456-7890-1234567890B0"      // Logged history backfill (TLV bundles, see StoreForward.h)
 
+// ============================================================================
+// DIAGNOSTICS / BENCHMARKS
+// ============================================================================
+#define ENABLE_CODEC_BENCHMARK false  // Run ADPCM round-trip benchmark once at boot (Serial)
+#define CODEC_BENCHMARK_SECONDS 1     // Synthetic speech length for the boot benchmark
 
 // ============================================================================
 // POWER STATE MACHINE
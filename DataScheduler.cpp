@@ -4,23 +4,41 @@
  */
 
 #include "DataScheduler.h"
+#include "Config.h"
 
 // ============================================================================
 // CONSTRUCTOR
 // ============================================================================
 
 DataScheduler::DataScheduler()
-  : criticalQueue(nullptr),
-    highQueue(nullptr),
-    normalQueue(nullptr),
-    audioRateLimit(30),  // Default: 30 audio packets/second (adaptive)
-    lastAudioTransmitTime(0),
-    audioPacketsThisSecond(0),
-    audioRateLimitWindowStart(0),
+  : criticalQueueSize(0),
+    highQueueSize(0),
+    normalQueueSize(0),
+    audioBytesCommitted(0),
+    audioBytesDequeued(0),
     droppedCriticalPackets(0),
+    requeuedAlerts(0),
     droppedHighPackets(0),
     droppedNormalPackets(0),
+    rateLimitedAudioPackets(0),
+    backlogAudioPackets(0),
+    expiredHighPackets(0),
+    expiredNormalPackets(0),
+    dtxSuppressedFrames(0),
+    dtxSuppressedBytes(0),
+    dtxComfortNoiseBytes(0),
+    enqueueCycles(0),
+    enqueueCount(0),
+    dequeueCycles(0),
+    dequeueCount(0),
     initialized(false) {
+  memset(&audioPathStats, 0, sizeof(audioPathStats));
+  for (int i = 0; i < 3; i++) queueAges[i].reset();
+  deadlineMs[DATA_ALERT] = 0;
+  deadlineMs[DATA_HEART_RATE] = BLE_DEADLINE_HR_MS;
+  deadlineMs[DATA_AUDIO] = BLE_DEADLINE_AUDIO_MS;
+  governor.setEnabled(BLE_PACING_ENABLED);
+  governor.setLinkParameters(23, BLE_CONN_INTERVAL_MIN);
 }
 
 // ============================================================================
@@ -30,28 +48,46 @@ DataScheduler::DataScheduler()
 bool DataScheduler::begin(size_t criticalQueueSize, size_t highQueueSize, size_t normalQueueSize) {
   Serial.println(F("[DataScheduler] Initializing priority queues..."));
 
-  // Create FreeRTOS queues for each priority level
-  criticalQueue = xQueueCreate(criticalQueueSize, sizeof(DataPacket));
-  if (criticalQueue == nullptr) {
+  // Create queues for each priority level
+  if (!criticalQueue.create(criticalQueueSize, sizeof(PacketRef))) {
     Serial.println(F("[DataScheduler] ERROR: Failed to create critical queue"));
     return false;
   }
 
-  highQueue = xQueueCreate(highQueueSize, sizeof(DataPacket));
-  if (highQueue == nullptr) {
+  if (!highQueue.create(highQueueSize, sizeof(PacketRef))) {
     Serial.println(F("[DataScheduler] ERROR: Failed to create high priority queue"));
-    vQueueDelete(criticalQueue);
+    criticalQueue.destroy();
     return false;
   }
 
-  normalQueue = xQueueCreate(normalQueueSize, sizeof(DataPacket));
-  if (normalQueue == nullptr) {
+  if (!normalQueue.create(normalQueueSize, sizeof(PacketRef))) {
     Serial.println(F("[DataScheduler] ERROR: Failed to create normal priority queue"));
-    vQueueDelete(criticalQueue);
-    vQueueDelete(highQueue);
+    criticalQueue.destroy();
+    highQueue.destroy();
     return false;
   }
 
+  // One buffer per queued frame, plus one being encoded and one being sent
+  if (!audioPool.begin(normalQueueSize + 2, MAX_AUDIO_SIZE)) {
+    Serial.println(F("[DataScheduler] ERROR: Failed to allocate audio buffer pool"));
+    criticalQueue.destroy();
+    highQueue.destroy();
+    normalQueue.destroy();
+    return false;
+  }
+
+  if (!controlPool.begin(criticalQueueSize + highQueueSize + 2, MAX_ALERT_SIZE)) {
+    Serial.println(F("[DataScheduler] ERROR: Failed to allocate control buffer pool"));
+    criticalQueue.destroy();
+    highQueue.destroy();
+    normalQueue.destroy();
+    audioPool.end();
+    return false;
+  }
+  this->criticalQueueSize = criticalQueueSize;
+  this->highQueueSize = highQueueSize;
+  this->normalQueueSize = normalQueueSize;
+
   initialized = true;
 
   Serial.print(F("[DataScheduler] Queue sizes - Critical: "));
@@ -60,6 +96,9 @@ bool DataScheduler::begin(size_t criticalQueueSize, size_t highQueueSize, size_t
   Serial.print(highQueueSize);
   Serial.print(F(", Normal: "));
   Serial.println(normalQueueSize);
+  Serial.print(F("[DataScheduler] Packet RAM: "));
+  Serial.print(getMemoryUsage());
+  Serial.println(F(" bytes (queues + buffer pools)"));
   Serial.println(F("[DataScheduler] Initialized successfully"));
 
   return true;
@@ -75,15 +114,8 @@ bool DataScheduler::enqueueAlert(const char* alertMessage) {
     return false;
   }
 
-  DataPacket packet;
-  packet.priority = PRIORITY_CRITICAL;
-  packet.type = DATA_ALERT;
-  packet.timestamp = millis();
-  packet.dataSize = min(strlen(alertMessage), (size_t)(MAX_ALERT_SIZE - 1));
-  memcpy(packet.data, alertMessage, packet.dataSize);
-  packet.data[packet.dataSize] = '\0';  // Null-terminate
-
-  if (xQueueSend(criticalQueue, &packet, 0) != pdTRUE) {
+  size_t size = min(strlen(alertMessage), (size_t)(MAX_ALERT_SIZE - 1));
+  if (!enqueueControl(PRIORITY_CRITICAL, (const uint8_t*)alertMessage, size)) {
     droppedCriticalPackets++;
     Serial.println(F("[DataScheduler] WARNING: Critical queue full - alert dropped!"));
     return false;
@@ -104,14 +136,7 @@ bool DataScheduler::enqueueAlert(const char* alertMessage) {
 bool DataScheduler::enqueueHeartRate(uint8_t hr) {
   if (!initialized) return false;
 
-  DataPacket packet;
-  packet.priority = PRIORITY_HIGH;
-  packet.type = DATA_HEART_RATE;
-  packet.timestamp = millis();
-  packet.dataSize = 1;
-  packet.data[0] = hr;
-
-  if (xQueueSend(highQueue, &packet, 0) != pdTRUE) {
+  if (!enqueueControl(PRIORITY_HIGH, &hr, 1)) {
     droppedHighPackets++;
     Serial.println(F("[DataScheduler] WARNING: High priority queue full - HR dropped"));
     return false;
@@ -126,35 +151,90 @@ bool DataScheduler::enqueueHeartRate(uint8_t hr) {
   return true;
 }
 
+bool DataScheduler::enqueueControl(DataPriority priority, const uint8_t* data, size_t size) {
+  uint32_t start = hal::cycleCount();
+  PacketRef ref;
+  ref.slot = controlPool.acquire();
+  if (ref.slot == PACKET_POOL_NONE) return false;
+
+  uint8_t* buffer = controlPool.getBuffer(ref.slot);
+  memcpy(buffer, data, size);
+  buffer[size] = '\0';  // Alerts stay null-terminated
+  ref.timestamp = millis();
+  ref.dataSize = (uint16_t)size;
+  ref.flags = 0;
+
+  bool queued = (priority == PRIORITY_CRITICAL) ? criticalQueue.send(&ref) : highQueue.send(&ref);
+  if (!queued) {
+    controlPool.release(ref.slot);
+    return false;
+  }
+  enqueueCycles += hal::cycleCount() - start;
+  enqueueCount++;
+  return true;
+}
+
 bool DataScheduler::enqueueAudio(const uint8_t* audioData, size_t size) {
   if (!initialized) return false;
 
-  // Check rate limiting
-  if (!canSendAudio()) {
-    // Drop audio packet (not critical data)
+  uint8_t slot;
+  uint8_t* buffer = acquireAudioBuffer(slot);
+  if (!buffer) {
+    droppedNormalPackets++;
     return false;
   }
 
-  DataPacket packet;
-  packet.priority = PRIORITY_NORMAL;
-  packet.type = DATA_AUDIO;
-  packet.timestamp = millis();
-  packet.dataSize = min(size, (size_t)MAX_AUDIO_SIZE);
-  memcpy(packet.data, audioData, packet.dataSize);
+  size = min(size, (size_t)MAX_AUDIO_SIZE);
+  memcpy(buffer, audioData, size);
+  recordAudioCopy(size);
+  return commitAudio(slot, size);
+}
 
-  if (xQueueSend(normalQueue, &packet, 0) != pdTRUE) {
+uint8_t* DataScheduler::acquireAudioBuffer(uint8_t& slot) {
+  slot = initialized ? audioPool.acquire() : PACKET_POOL_NONE;
+  return (slot != PACKET_POOL_NONE) ? audioPool.getBuffer(slot) : nullptr;
+}
+
+bool DataScheduler::commitAudio(uint8_t slot, size_t size, bool backlog) {
+  if (!initialized || slot == PACKET_POOL_NONE) return false;
+
+  // Check the link budget (an unpublished slot simply stays free). A
+  // flushed history goes out as fast as the link allows, ahead of the live
+  // frames the producer holds back behind it
+  if (!backlog && !canSendAudio(size)) {
+    // Drop audio packet (not critical data; frame sequence shows the gap)
+    rateLimitedAudioPackets++;
+    return false;
+  }
+
+  uint32_t start = hal::cycleCount();
+  PacketRef ref;
+  ref.timestamp = millis();
+  ref.dataSize = (uint16_t)min(size, (size_t)MAX_AUDIO_SIZE);
+  ref.slot = slot;
+  ref.flags = backlog ? PACKET_REF_BACKLOG : 0;
+
+  // Publish before the send: the consumer may release it straight away
+  audioPool.publish();
+  if (!normalQueue.send(&ref)) {
+    audioPool.unpublish();
     droppedNormalPackets++;
     // Don't log every dropped audio packet (too verbose)
     return false;
   }
-
-  // Update rate limiting counters
-  lastAudioTransmitTime = millis();
-  audioPacketsThisSecond++;
+  enqueueCycles += hal::cycleCount() - start;
+  enqueueCount++;
+  audioBytesCommitted += ref.dataSize;
+  if (backlog) backlogAudioPackets++;
 
   return true;
 }
 
+bool DataScheduler::hasAudioRoom() {
+  if (!initialized) return false;
+  return audioPool.getFreeCount() > 0 && normalQueue.count() < normalQueueSize;
+}
+
 // ============================================================================
 // DEQUEUE FUNCTIONS
 // ============================================================================
@@ -162,32 +242,146 @@ bool DataScheduler::enqueueAudio(const uint8_t* audioData, size_t size) {
 bool DataScheduler::getNextPacket(DataPacket& packet, uint32_t timeoutMs) {
   if (!initialized) return false;
 
-  TickType_t timeout = (timeoutMs == 0) ? 0 : pdMS_TO_TICKS(timeoutMs);
+  uint32_t start = hal::cycleCount();
+  governor.update();
+  uint32_t now = millis();
+  PacketRef ref;
 
-  // Priority 1: Check critical queue first (alerts)
-  if (xQueueReceive(criticalQueue, &packet, 0) == pdTRUE) {
-    return true;
+  // Priority 1: Check critical queue first (alerts, never held back)
+  if (criticalQueue.receive(&ref)) {
+    governor.trySend(PRIORITY_CRITICAL, ref.dataSize);
+    packet.priority = PRIORITY_CRITICAL;
+    packet.type = DATA_ALERT;
+  }
+  // Priority 2: Check high priority queue (heart rate). The head stays
+  // queued until the bucket can pay for it (single consumer, so the
+  // peeked packet is the one received)
+  else if (peekLive(highQueue, DATA_HEART_RATE, ref, now, 0)) {
+    if (!governor.trySend(PRIORITY_HIGH, ref.dataSize) || !highQueue.receive(&ref)) return false;
+    packet.priority = PRIORITY_HIGH;
+    packet.type = DATA_HEART_RATE;
+  }
+  // Priority 3: Check normal priority queue (audio)
+  else if (peekLive(normalQueue, DATA_AUDIO, ref, now, timeoutMs)) {
+    start = hal::cycleCount();  // Don't count the wait
+    if (!governor.trySend(PRIORITY_NORMAL, ref.dataSize) || !normalQueue.receive(&ref)) return false;
+    audioBytesDequeued += ref.dataSize;
+    packet.priority = PRIORITY_NORMAL;
+    packet.type = DATA_AUDIO;
+  } else {
+    return false;
   }
 
-  // Priority 2: Check high priority queue (heart rate)
-  if (xQueueReceive(highQueue, &packet, 0) == pdTRUE) {
-    return true;
+  packet.timestamp = ref.timestamp;
+  packet.dataSize = ref.dataSize;
+  packet.poolSlot = ref.slot;
+  queueAges[packet.type].record(now - ref.timestamp);
+  dequeueCycles += hal::cycleCount() - start;
+  dequeueCount++;
+  return true;
+}
+
+bool DataScheduler::peekLive(SpscRing& ring, DataType type, PacketRef& ref, uint32_t& now, uint32_t timeoutMs) {
+  // The ring never blocks: a consumer that asked to wait polls it
+  while (!ring.peek(&ref)) {
+    if (millis() - now >= timeoutMs) return false;
+    hal::delayMs(1);
+  }
+  if (timeoutMs > 0) now = millis();
+  if (deadlineMs[type] == 0) return true;
+
+  // Expired heads are taken out as they surface (the ring is FIFO with
+  // one deadline per type, so nothing behind a live head is older)
+  while (!(ref.flags & PACKET_REF_BACKLOG) && now - ref.timestamp > deadlineMs[type]) {
+    ring.receive(&ref);
+    if (type == DATA_AUDIO) {
+      audioBytesDequeued += ref.dataSize;
+      audioPool.release(ref.slot);
+      expiredNormalPackets++;
+    } else {
+      controlPool.release(ref.slot);
+      expiredHighPackets++;
+    }
+    if (!ring.peek(&ref)) return false;
   }
+  return true;
+}
 
-  // Priority 3: Check normal priority queue (audio)
-  if (xQueueReceive(normalQueue, &packet, timeout) == pdTRUE) {
-    return true;
+bool DataScheduler::requeueAlert(DataPacket& packet) {
+  if (!initialized || packet.type != DATA_ALERT) return false;
+
+  PacketRef ref;
+  ref.timestamp = packet.timestamp;
+  ref.dataSize = packet.dataSize;
+  ref.slot = packet.poolSlot;
+  ref.flags = 0;
+  if (!criticalQueue.sendToFront(&ref)) {
+    droppedCriticalPackets++;
+    releasePacket(packet);
+    Serial.println(F("[DataScheduler] WARNING: Critical queue full - failed alert dropped!"));
+    return false;
+  }
+  requeuedAlerts++;
+  packet.poolSlot = PACKET_POOL_NONE;  // The queue owns the block again
+  return true;
+}
+
+bool DataScheduler::takeControlPacket(DataPacket& packet) {
+  if (!initialized) return false;
+
+  PacketRef ref;
+  if (criticalQueue.receive(&ref)) {
+    packet.priority = PRIORITY_CRITICAL;
+    packet.type = DATA_ALERT;
+  } else if (highQueue.receive(&ref)) {
+    packet.priority = PRIORITY_HIGH;
+    packet.type = DATA_HEART_RATE;
+  } else {
+    return false;
   }
+  packet.timestamp = ref.timestamp;
+  packet.dataSize = ref.dataSize;
+  packet.poolSlot = ref.slot;
+  return true;
+}
+
+bool DataScheduler::trySendBackfill(size_t bytes) {
+  if (!initialized) return false;
+  governor.update();
+  return governor.trySend(PRIORITY_BACKFILL, bytes);
+}
+
+void DataScheduler::chargeAlert(size_t bytes) {
+  if (!initialized) return;
+  governor.update();
+  governor.trySend(PRIORITY_CRITICAL, bytes);
+}
 
-  return false;
+void DataScheduler::setDeadline(DataType type, uint32_t deadlineMs) {
+  if (type == DATA_ALERT) return;  // Alerts never expire
+  this->deadlineMs[type] = deadlineMs;
+}
+
+const uint8_t* DataScheduler::getPacketData(const DataPacket& packet) {
+  if (packet.type == DATA_AUDIO) return audioPool.getBuffer(packet.poolSlot);
+  return controlPool.getBuffer(packet.poolSlot);
+}
+
+void DataScheduler::releasePacket(DataPacket& packet) {
+  if (packet.type == DATA_AUDIO) {
+    audioPool.release(packet.poolSlot);
+  } else {
+    controlPool.release(packet.poolSlot);
+  }
+  packet.poolSlot = PACKET_POOL_NONE;
 }
 
 bool DataScheduler::hasPackets() {
   if (!initialized) return false;
 
-  return (uxQueueMessagesWaiting(criticalQueue) > 0 ||
-          uxQueueMessagesWaiting(highQueue) > 0 ||
-          uxQueueMessagesWaiting(normalQueue) > 0);
+  return (criticalQueue.count() > 0 ||
+          highQueue.count() > 0 ||
+          normalQueue.count() > 0);
 }
 
 // ============================================================================
@@ -196,51 +390,152 @@ bool DataScheduler::hasPackets() {
 
 size_t DataScheduler::getCriticalQueueCount() {
   if (!initialized) return 0;
-  return uxQueueMessagesWaiting(criticalQueue);
+  return criticalQueue.count();
 }
 
 size_t DataScheduler::getHighQueueCount() {
   if (!initialized) return 0;
-  return uxQueueMessagesWaiting(highQueue);
+  return highQueue.count();
 }
 
 size_t DataScheduler::getNormalQueueCount() {
   if (!initialized) return 0;
-  return uxQueueMessagesWaiting(normalQueue);
+  return normalQueue.count();
 }
 
 void DataScheduler::clearAllQueues() {
   if (!initialized) return;
 
-  xQueueReset(criticalQueue);
-  xQueueReset(highQueue);
-  xQueueReset(normalQueue);
+  // Queued packets give their blocks back to the pools
+  PacketRef ref;
+  while (criticalQueue.receive(&ref)) {
+    controlPool.release(ref.slot);
+  }
+  while (highQueue.receive(&ref)) {
+    controlPool.release(ref.slot);
+  }
+  while (normalQueue.receive(&ref)) {
+    audioBytesDequeued += ref.dataSize;
+    audioPool.release(ref.slot);
+  }
 
   Serial.println(F("[DataScheduler] All queues cleared"));
 }
 
 // ============================================================================
-// AUDIO RATE LIMITING
+// BANDWIDTH MANAGEMENT
+// ============================================================================
+
+void DataScheduler::setLinkParameters(uint16_t mtu, uint16_t connInterval) {
+  governor.setLinkParameters(mtu, connInterval);
+}
+
+void DataScheduler::recordNotifyStatus(size_t bytes, bool success) {
+  governor.recordStatus(bytes, success);
+}
+
+void DataScheduler::setPacingEnabled(bool enable) {
+  governor.setEnabled(enable);
+  Serial.print(F("[DataScheduler] Link pacing "));
+  Serial.println(enable ? F("enabled") : F("disabled"));
+}
+
+bool DataScheduler::canSendAudio(size_t size) {
+  // Bytes already waiting would take this long to drain at the audio
+  // budget: a frame that cannot go out soon is dropped now, so latency
+  // stays bounded and the codec adaptation sees the shortfall
+  uint32_t queued = audioBytesCommitted - audioBytesDequeued;
+  return (queued + size <= governor.getAudioQueueAllowance());
+}
+
+void DataScheduler::recordDtxSavings(size_t suppressedBytes, size_t comfortNoiseBytes) {
+  if (suppressedBytes > 0) {
+    dtxSuppressedFrames++;
+    dtxSuppressedBytes += suppressedBytes;
+  }
+  dtxComfortNoiseBytes += comfortNoiseBytes;
+}
+
+// ============================================================================
+// AUDIO PATH INSTRUMENTATION
+// ============================================================================
+
+void DataScheduler::recordAudioCopy(size_t bytes) {
+  audioPathStats.copies++;
+  audioPathStats.copyBytes += bytes;
+}
+
+void DataScheduler::recordAudioBlock(uint32_t cycles) {
+  audioPathStats.blocks++;
+  audioPathStats.producerCycles += cycles;
+}
+
+void DataScheduler::recordAudioSent(uint32_t cycles, size_t copiedBytes) {
+  audioPathStats.packetsSent++;
+  audioPathStats.consumerCycles += cycles;
+  if (copiedBytes > 0) {
+    audioPathStats.sendCopies++;
+    audioPathStats.sendCopyBytes += copiedBytes;
+  }
+}
+
+// ============================================================================
+// QUEUE AGE HISTOGRAM
 // ============================================================================
 
-void DataScheduler::setAudioRateLimit(uint16_t maxAudioPacketsPerSecond) {
-  audioRateLimit = maxAudioPacketsPerSecond;
-  Serial.print(F("[DataScheduler] Audio rate limit set to "));
-  Serial.print(audioRateLimit);
-  Serial.println(F(" packets/second"));
+static const uint16_t QUEUE_AGE_EDGES_MS[QUEUE_AGE_BUCKETS] = {
+  1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000
+};
+
+void QueueAgeHistogram::reset() {
+  memset(counts, 0, sizeof(counts));
+  total = 0;
+  maxAgeMs = 0;
 }
 
-bool DataScheduler::canSendAudio() {
-  uint32_t currentTime = millis();
+void QueueAgeHistogram::record(uint32_t ageMs) {
+  uint8_t bucket = 0;
+  while (bucket < QUEUE_AGE_BUCKETS && ageMs > QUEUE_AGE_EDGES_MS[bucket]) bucket++;
+  counts[bucket]++;
+  total++;
+  if (ageMs > maxAgeMs) maxAgeMs = ageMs;
+}
 
-  // Reset counter every second
-  if (currentTime - audioRateLimitWindowStart >= 1000) {
-    audioRateLimitWindowStart = currentTime;
-    audioPacketsThisSecond = 0;
+uint32_t QueueAgeHistogram::percentile(uint8_t percent) const {
+  if (total == 0) return 0;
+  // Rank of the sample, rounded up (p100 = the oldest)
+  uint32_t rank = (uint32_t)(((uint64_t)total * percent + 99) / 100);
+  if (rank == 0) rank = 1;
+  uint32_t seen = 0;
+  for (uint8_t bucket = 0; bucket < QUEUE_AGE_BUCKETS; bucket++) {
+    seen += counts[bucket];
+    if (seen >= rank) return min((uint32_t)QUEUE_AGE_EDGES_MS[bucket], maxAgeMs);
   }
+  return maxAgeMs;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
 
-  // Check if we're within rate limit
-  return (audioPacketsThisSecond < audioRateLimit);
+static void printQueueAge(const char* label, const QueueAgeHistogram& ages) {
+  Serial.print(label);
+  Serial.print(ages.percentile(50));
+  Serial.print(F(" / "));
+  Serial.print(ages.percentile(95));
+  Serial.print(F(" / "));
+  Serial.print(ages.percentile(99));
+  Serial.print(F(" / "));
+  Serial.print(ages.maxAgeMs);
+  Serial.print(F(" ms ("));
+  Serial.print(ages.total);
+  Serial.println(F(" sent)"));
+}
+
+size_t DataScheduler::getMemoryUsage() const {
+  // The rings keep one slot empty
+  size_t queues = (criticalQueueSize + highQueueSize + 1 + normalQueueSize + 1) * sizeof(PacketRef);
+  return queues + audioPool.getMemoryUsage() + controlPool.getMemoryUsage();
 }
 
 void DataScheduler::printStatistics() {
@@ -252,27 +547,112 @@ void DataScheduler::printStatistics() {
 
   Serial.print(F("  Critical Queue: "));
   Serial.print(getCriticalQueueCount());
-  Serial.print(F(" / 10 (Dropped: "));
+  Serial.print(F(" / "));
+  Serial.print(criticalQueueSize);
+  Serial.print(F(" (Dropped: "));
   Serial.print(droppedCriticalPackets);
+  Serial.print(F(", Requeued: "));
+  Serial.print(requeuedAlerts);
   Serial.println(F(")"));
 
   Serial.print(F("  High Queue:     "));
   Serial.print(getHighQueueCount());
-  Serial.print(F(" / 10 (Dropped: "));
+  Serial.print(F(" / "));
+  Serial.print(highQueueSize);
+  Serial.print(F(" (Dropped: "));
   Serial.print(droppedHighPackets);
   Serial.println(F(")"));
 
   Serial.print(F("  Normal Queue:   "));
   Serial.print(getNormalQueueCount());
-  Serial.print(F(" / 20 (Dropped: "));
+  Serial.print(F(" / "));
+  Serial.print(normalQueueSize);
+  Serial.print(F(" (Dropped: "));
   Serial.print(droppedNormalPackets);
   Serial.println(F(")"));
 
-  Serial.print(F("  Audio Rate: "));
-  Serial.print(audioPacketsThisSecond);
+  governor.printStatistics();
+  Serial.print(F("  Audio Budget: "));
+  Serial.print(governor.isEnabled() ? governor.getAudioBudget() : 0);
+  Serial.print(F(" B/s (Over budget: "));
+  Serial.print(rateLimitedAudioPackets);
+  Serial.print(F(", History flushed: "));
+  Serial.print(backlogAudioPackets);
+  Serial.println(F(")"));
+
+  Serial.print(F("  Expired: "));
+  Serial.print(expiredHighPackets);
+  Serial.print(F(" heart rates (> "));
+  Serial.print(deadlineMs[DATA_HEART_RATE]);
+  Serial.print(F(" ms), "));
+  Serial.print(expiredNormalPackets);
+  Serial.print(F(" audio frames (> "));
+  Serial.print(deadlineMs[DATA_AUDIO]);
+  Serial.println(F(" ms), alerts never"));
+  Serial.println(F("  Queue age p50 / p95 / p99 / max:"));
+  printQueueAge("    Alerts:     ", queueAges[DATA_ALERT]);
+  printQueueAge("    Heart rate: ", queueAges[DATA_HEART_RATE]);
+  printQueueAge("    Audio:      ", queueAges[DATA_AUDIO]);
+
+  Serial.print(F("  Audio DTX: "));
+  Serial.print(dtxSuppressedFrames);
+  Serial.print(F(" frames suppressed, "));
+  Serial.print((long)dtxSuppressedBytes - (long)dtxComfortNoiseBytes);
+  Serial.print(F(" bytes saved ("));
+  Serial.print(dtxComfortNoiseBytes);
+  Serial.println(F(" comfort-noise bytes sent)"));
+
+  Serial.print(F("  Audio Pool: "));
+  Serial.print(audioPool.getFreeCount());
+  Serial.print(F(" / "));
+  Serial.print(audioPool.getSlotCount());
+  Serial.print(F(" free (Exhausted: "));
+  Serial.print(audioPool.getExhaustedCount());
+  if (audioPool.getMisorderedCount() > 0) {
+    Serial.print(F(", Misordered releases: "));
+    Serial.print(audioPool.getMisorderedCount());
+  }
+  Serial.println(F(")"));
+
+  Serial.print(F("  Control Pool: "));
+  Serial.print(controlPool.getFreeCount());
   Serial.print(F(" / "));
-  Serial.print(audioRateLimit);
-  Serial.println(F(" pkt/s"));
+  Serial.print(controlPool.getBlockCount());
+  Serial.print(F(" free (Exhausted: "));
+  Serial.print(controlPool.getExhaustedCount());
+  if (controlPool.getInvalidReleaseCount() > 0) {
+    Serial.print(F(", Invalid releases: "));
+    Serial.print(controlPool.getInvalidReleaseCount());
+  }
+  Serial.println(F(")"));
+
+  Serial.print(F("  Packet RAM: "));
+  Serial.print(getMemoryUsage());
+  Serial.print(F(" bytes"));
+  if (enqueueCount > 0 && dequeueCount > 0) {
+    Serial.print(F(", "));
+    Serial.print(getMeanEnqueueCycles());
+    Serial.print(F(" cycles/enqueue, "));
+    Serial.print(getMeanDequeueCycles());
+    Serial.print(F(" cycles/dequeue"));
+  }
+  Serial.println();
+
+  if (audioPathStats.blocks > 0) {
+    Serial.print(F("  Audio Path: "));
+    Serial.print((float)(audioPathStats.copies + audioPathStats.sendCopies) / audioPathStats.blocks, 2);
+    Serial.print(F(" copies/block ("));
+    Serial.print((unsigned long)((audioPathStats.copyBytes + audioPathStats.sendCopyBytes) / audioPathStats.blocks));
+    Serial.print(F(" B), "));
+    Serial.print((unsigned long)(audioPathStats.producerCycles / audioPathStats.blocks));
+    Serial.print(F(" cycles/block encode+enqueue"));
+    if (audioPathStats.packetsSent > 0) {
+      Serial.print(F(", "));
+      Serial.print((unsigned long)(audioPathStats.consumerCycles / audioPathStats.packetsSent));
+      Serial.print(F(" cycles/packet send"));
+    }
+    Serial.println();
+  }
 
   Serial.println(F("========================================"));
 }
@@ -1,21 +1,46 @@
 /*
  * Data Scheduler for ESP32-C3 BEACON
- * Priority-based BLE data transmission using FreeRTOS queues
+ * Priority-based BLE data transmission: alerts in a FreeRTOS queue (via
+ * hal::Queue, any task may raise one), heart rate and audio in lock-free
+ * SPSC rings (SpscRing.h, one producer each, no critical section per frame)
  *
  * Priority levels:
  * 1. CRITICAL: Alerts (FALL, HEART_STOP, MANUAL) - immediate transmission
  * 2. HIGH: Heart rate data - 1 Hz guaranteed
  * 3. NORMAL: Audio data - fills remaining bandwidth
  *
- * Prevents BLE bandwidth saturation by scheduling transmissions
+ * Prevents BLE bandwidth saturation by scheduling transmissions: a byte
+ * token bucket (BandwidthGovernor.h) fed by notify completions paces the
+ * dequeue to the measured link rate, with reserves that keep alerts and
+ * heart rate moving while audio waits, and live audio is only admitted
+ * while the queued bytes drain within GOVERNOR_QUEUE_MS
+ *
+ * Deadlines: every packet expires a per-type time after it was queued
+ * (BLE_DEADLINE_HR_MS, BLE_DEADLINE_AUDIO_MS; alerts never). Each class
+ * holds one type, so the head of its FIFO is also its earliest deadline
+ * (EDF within the class); getNextPacket() drops expired heads instead of
+ * sending them, so after a stall the link carries fresh heart rate and
+ * audio rather than seconds-old backlog. A flushed pre-trigger history is
+ * old by design and does not expire.
+ *
+ * Payloads live in fixed-block pools and every queue carries only an 8-byte
+ * PacketRef to the block, so queue operations move handles, not payloads:
+ * - audio: MTU-sized PacketPool ring; frames are encoded straight into it
+ *   (zero-copy). One producer (AudioDetector) and one consumer
+ *   (BLEManager::processDataQueue()), like its SpscRing.
+ * - alerts / heart rate: small BlockPool blocks (MAX_ALERT_SIZE bytes),
+ *   free list guarded by a critical section since alerts come from any task
+ * The block is returned after the notification (releasePacket()).
  */
 
 #ifndef DATA_SCHEDULER_H
 #define DATA_SCHEDULER_H
 
 #include <Arduino.h>
-#include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
+#include "BandwidthGovernor.h"
+#include "Hal.h"
+#include "PacketPool.h"
+#include "SpscRing.h"
 
 // ============================================================================
 // DATA PACKET TYPES
@@ -24,7 +49,8 @@
 enum DataPriority {
   PRIORITY_CRITICAL = 0,  // Alerts - immediate
   PRIORITY_HIGH = 1,      // Heart rate - guaranteed 1 Hz
-  PRIORITY_NORMAL = 2     // Audio - best effort
+  PRIORITY_NORMAL = 2,    // Audio - best effort
+  PRIORITY_BACKFILL = 3   // Logged history (StoreForward) - only with the queues empty
 };
 
 enum DataType {
@@ -42,16 +68,54 @@ enum DataType {
 // DATA PACKET STRUCTURE
 // ============================================================================
 
+// Dequeued packet: a handle to its pooled payload (getPacketData()),
+// released with releasePacket() once sent
 struct DataPacket {
   DataPriority priority;
   DataType type;
   uint32_t timestamp;  // millis() when packet was created
   uint16_t dataSize;
-  uint8_t data[MAX_AUDIO_SIZE];  // Union-style data storage
+  uint8_t poolSlot;    // Block holding the data (pool selected by type)
 
-  DataPacket() : priority(PRIORITY_NORMAL), type(DATA_AUDIO), timestamp(0), dataSize(0) {
-    memset(data, 0, sizeof(data));
-  }
+  DataPacket() : priority(PRIORITY_NORMAL), type(DATA_AUDIO), timestamp(0), dataSize(0),
+                 poolSlot(PACKET_POOL_NONE) {}
+};
+
+// Queue item: every packet travels by reference to its pool block
+struct PacketRef {
+  uint32_t timestamp;
+  uint16_t dataSize;
+  uint8_t slot;
+  uint8_t flags;       // PACKET_REF_* (fills the padding byte)
+};
+
+#define PACKET_REF_BACKLOG 0x01  // Pre-trigger history frame: no deadline
+
+// Queue age of sent packets (ms), 1-2-5 buckets up to 5 s; percentiles
+// read as the upper edge of the bucket that holds them
+#define QUEUE_AGE_BUCKETS 12
+
+struct QueueAgeHistogram {
+  uint32_t counts[QUEUE_AGE_BUCKETS + 1];  // Last bucket: over 5 s
+  uint32_t total;
+  uint32_t maxAgeMs;
+
+  void reset();
+  void record(uint32_t ageMs);
+  uint32_t percentile(uint8_t percent) const;  // 0 if empty
+};
+
+// Audio path instrumentation (copies of audio data and CPU cycles).
+// Producer and consumer fields are written by their own task only.
+struct AudioPathStats {
+  uint32_t blocks;          // 16 ms capture blocks encoded
+  uint32_t copies;          // Producer passes over audio data (DMA read, memcpy)
+  uint64_t copyBytes;
+  uint64_t producerCycles;  // Capture-to-enqueue cycles, summed over blocks
+  uint32_t packetsSent;
+  uint32_t sendCopies;      // Consumer passes over audio data (setValue)
+  uint64_t sendCopyBytes;
+  uint64_t consumerCycles;  // Dequeue-to-release cycles, summed over packets
 };
 
 // ============================================================================
@@ -73,16 +137,85 @@ public:
    */
   bool enqueueAlert(const char* alertMessage);
   bool enqueueHeartRate(uint8_t hr);
-  bool enqueueAudio(const uint8_t* audioData, size_t size);
+  bool enqueueAudio(const uint8_t* audioData, size_t size);  // Copies into a pool slot
+
+  /**
+   * Zero-copy audio (single producer): write the frame into an acquired
+   * buffer, then commit it. A buffer that is not committed stays free.
+   * @param slot Set to the slot handle (PACKET_POOL_NONE if the pool is exhausted)
+   * @return Buffer of MAX_AUDIO_SIZE bytes, or nullptr if the pool is exhausted
+   */
+  uint8_t* acquireAudioBuffer(uint8_t& slot);
 
   /**
-   * Get next packet to transmit (priority-ordered)
+   * Queue an acquired buffer
+   * @param backlog Buffered history being flushed after a trigger: exempt
+   *                from the link budget (the dequeue still paces it)
+   * @return true if queued, false if over the link budget or the queue is full
+   */
+  bool commitAudio(uint8_t slot, size_t size, bool backlog = false);
+
+  /**
+   * Room for one more audio frame (a free buffer and a queue place)
+   */
+  bool hasAudioRoom();
+
+  /**
+   * Get next packet to transmit (priority-ordered, paced by the governor)
    * @param packet Output parameter for next packet
    * @param timeoutMs Maximum time to wait for a packet (0 = no wait)
    * @return true if packet was retrieved, false if no packets available
+   *         or the link budget holds the next one back
    */
   bool getNextPacket(DataPacket& packet, uint32_t timeoutMs = 0);
 
+  /**
+   * Put back a dequeued alert whose notification failed, at the head of
+   * the critical queue (sent again before newer alerts, next drain)
+   * @return false if the queue filled meanwhile (alert dropped, block
+   *         released)
+   */
+  bool requeueAlert(DataPacket& packet);
+
+  /**
+   * Link down: take the next alert or heart rate for the flash log
+   * (StoreForward), regardless of link budget and deadline
+   * @return false if neither queue holds one
+   */
+  bool takeControlPacket(DataPacket& packet);
+
+  /**
+   * Spend link budget for a backfill notification of logged history
+   * (PRIORITY_BACKFILL: above the same reserves as audio)
+   * @param bytes Notification payload bytes
+   * @return false if the bucket cannot pay for it now
+   */
+  bool trySendBackfill(size_t bytes);
+
+  /**
+   * Account for alert bytes sent outside getNextPacket() (retransmissions,
+   * AlertTracker): alerts are never held back, but the link budget pays
+   */
+  void chargeAlert(size_t bytes);
+
+  /**
+   * Queue deadline per type (ms after enqueue; 0 = never). Alerts never
+   * expire and ignore this.
+   */
+  void setDeadline(DataType type, uint32_t deadlineMs);
+  uint32_t getDeadline(DataType type) const { return deadlineMs[type]; }
+
+  /**
+   * Packet payload (the packet's pool block)
+   */
+  const uint8_t* getPacketData(const DataPacket& packet);
+
+  /**
+   * Return a sent packet's pool block (required for every packet; audio
+   * packets in dequeue order)
+   */
+  void releasePacket(DataPacket& packet);
+
   /**
    * Check if any packets are available
    */
@@ -92,6 +225,7 @@ public:
    * Get queue statistics
    */
   size_t getCriticalQueueCount();
+  size_t getCriticalQueueSize() const { return criticalQueueSize; }
   size_t getHighQueueCount();
   size_t getNormalQueueCount();
 
@@ -101,16 +235,74 @@ public:
   void clearAllQueues();
 
   /**
-   * Bandwidth management - limit audio transmission rate
-   * @param maxAudioPacketsPerSecond Maximum audio packets to transmit per second
+   * Bandwidth management (BandwidthGovernor)
+   * setLinkParameters: negotiated MTU and connection interval (1.25 ms units)
+   * recordNotifyStatus: outcome of one notification (payload bytes), from
+   *                     the stack's completion callback
+   * setPacingEnabled: off = dequeue and admit as fast as the queues allow
+   */
+  void setLinkParameters(uint16_t mtu, uint16_t connInterval);
+  void recordNotifyStatus(size_t bytes, bool success);
+  void setPacingEnabled(bool enable);
+  const BandwidthGovernor& getGovernor() const { return governor; }
+
+  /**
+   * Bytes/s of link budget left for audio (for codec adaptation)
+   */
+  uint32_t getAudioBudget() const { return governor.getAudioBudget(); }
+
+  /**
+   * Check if a live audio frame fits the link budget
+   * @return true if the queued audio plus this frame drains within
+   *         GOVERNOR_QUEUE_MS at the audio budget
+   */
+  bool canSendAudio(size_t size);
+
+  /**
+   * Account for discontinuous transmission (audio DTX)
+   * @param suppressedBytes Full audio frame bytes not sent (0 if none)
+   * @param comfortNoiseBytes Comfort-noise frame bytes sent instead (0 if none)
+   */
+  void recordDtxSavings(size_t suppressedBytes, size_t comfortNoiseBytes);
+
+  /**
+   * Audio path instrumentation
+   * recordAudioCopy: one producer-side pass over `bytes` of audio data
+   * recordAudioBlock: cycles from capture-complete to enqueue for one block
+   * recordAudioSent: cycles from dequeue to notify/release for one packet,
+   *                  and the bytes the notify copied (0 if not sent)
+   */
+  void recordAudioCopy(size_t bytes);
+  void recordAudioBlock(uint32_t cycles);
+  void recordAudioSent(uint32_t cycles, size_t copiedBytes);
+  const AudioPathStats& getAudioPathStats() const { return audioPathStats; }
+
+  /**
+   * RAM held by queue storage and payload pools (bytes)
    */
-  void setAudioRateLimit(uint16_t maxAudioPacketsPerSecond);
+  size_t getMemoryUsage() const;
 
   /**
-   * Check if audio transmission should be throttled
-   * @return true if we can send audio now, false if rate-limited
+   * Mean cycles per queued packet (pool + queue work, no logging) and per
+   * getNextPacket() that returned one (0 before the first)
    */
-  bool canSendAudio();
+  uint32_t getMeanEnqueueCycles() const { return enqueueCount ? (uint32_t)(enqueueCycles / enqueueCount) : 0; }
+  uint32_t getMeanDequeueCycles() const { return dequeueCount ? (uint32_t)(dequeueCycles / dequeueCount) : 0; }
+
+  // Audio drop counters (see printStatistics)
+  uint32_t getRateLimitedAudioPackets() const { return rateLimitedAudioPackets; }
+  uint32_t getDroppedAudioPackets() const { return droppedNormalPackets; }
+
+  // Alerts: dropped on a full critical queue, put back after a failed notify
+  uint32_t getDroppedAlerts() const { return droppedCriticalPackets; }
+  uint32_t getRequeuedAlerts() const { return requeuedAlerts; }
+
+  // Packets dropped at dequeue past their deadline
+  uint32_t getExpiredHeartRates() const { return expiredHighPackets; }
+  uint32_t getExpiredAudioPackets() const { return expiredNormalPackets; }
+
+  // Queue age of sent packets per type (indexed by DataType)
+  const QueueAgeHistogram& getQueueAges(DataType type) const { return queueAges[type]; }
 
   /**
    * Print queue statistics (for debugging)
@@ -118,21 +310,53 @@ public:
   void printStatistics();
 
 private:
-  // FreeRTOS queue handles
-  QueueHandle_t criticalQueue;
-  QueueHandle_t highQueue;
-  QueueHandle_t normalQueue;
+  // Copy a small payload into a control block and queue its reference
+  // (alerts: criticalQueue, heart rate: highQueue)
+  bool enqueueControl(DataPriority priority, const uint8_t* data, size_t size);
+
+  // Drop expired packets from the head of a ring; false if none is left
+  // (now: millis() of the dequeue, updated after a wait)
+  bool peekLive(SpscRing& ring, DataType type, PacketRef& ref, uint32_t& now, uint32_t timeoutMs);
+
+  // Priority queues, PacketRef items: alerts may come from any task (FreeRTOS
+  // queue on target); heart rate and audio have one producer each (SPSC)
+  hal::Queue criticalQueue;
+  SpscRing highQueue;
+  SpscRing normalQueue;
+  size_t criticalQueueSize;
+  size_t highQueueSize;
+  size_t normalQueueSize;
+
+  // Payload blocks (queue depth + one being filled + one being sent)
+  PacketPool audioPool;    // MTU class, audio frames
+  BlockPool controlPool;   // Small class, alerts and heart rate
+
+  // Link pacing; queued audio bytes = committed - dequeued (each counter
+  // has a single writer: producer / consumer)
+  BandwidthGovernor governor;
+  uint32_t audioBytesCommitted;
+  uint32_t audioBytesDequeued;
 
-  // Audio rate limiting
-  uint16_t audioRateLimit;           // Max audio packets/second
-  uint32_t lastAudioTransmitTime;    // millis() of last audio packet
-  uint16_t audioPacketsThisSecond;   // Counter for current second
-  uint32_t audioRateLimitWindowStart; // Start of current 1-second window
+  uint32_t deadlineMs[3];  // Per DataType, 0 = never
 
   // Statistics
   uint32_t droppedCriticalPackets;
+  uint32_t requeuedAlerts;           // Failed alert notifies put back (requeueAlert())
   uint32_t droppedHighPackets;
   uint32_t droppedNormalPackets;
+  uint32_t rateLimitedAudioPackets;  // Audio frames refused over the link budget
+  uint32_t backlogAudioPackets;      // History frames queued past the link budget
+  uint32_t expiredHighPackets;       // Heart rates past their deadline
+  uint32_t expiredNormalPackets;     // Live audio frames past their deadline
+  QueueAgeHistogram queueAges[3];    // Per DataType
+  uint32_t dtxSuppressedFrames;      // Audio frames replaced by DTX
+  uint32_t dtxSuppressedBytes;
+  uint32_t dtxComfortNoiseBytes;
+  AudioPathStats audioPathStats;
+  uint64_t enqueueCycles;  // Pool + queue operations of queued packets
+  uint32_t enqueueCount;
+  uint64_t dequeueCycles;  // getNextPacket() calls that returned a packet
+  uint32_t dequeueCount;
 
   bool initialized;
 };
@@ -0,0 +1,400 @@
+/*
+ * Flash Log Implementation
+ */
+
+#include "FlashLog.h"
+
+namespace {
+
+struct SectorHeader {
+  uint32_t magic;
+  uint32_t sequence;
+  uint32_t eraseCount;
+  uint32_t check;
+};
+
+uint32_t sectorCheck(const SectorHeader& header) {
+  return ~(header.magic ^ header.sequence ^ header.eraseCount);
+}
+
+uint16_t crc16(uint16_t crc, const uint8_t* data, size_t length) {
+  // CRC-16/CCITT (polynomial 0x1021), bitwise: records are short
+  for (size_t i = 0; i < length; i++) {
+    crc ^= (uint16_t)data[i] << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+// CRC of a record: type, length, boot, timestamp and payload
+uint16_t recordCrc(const uint8_t* header, const uint8_t* payload) {
+  uint16_t crc = crc16(0xFFFF, header + 2, 4);
+  crc = crc16(crc, header + 8, 4);
+  return crc16(crc, payload, header[3]);
+}
+
+size_t recordSize(uint8_t length) {
+  return (FLASH_LOG_RECORD_HEADER + length + 3) & ~(size_t)3;
+}
+
+}  // namespace
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+FlashLog::FlashLog()
+  : sectorCount(0),
+    bootId(0),
+    headSequence(0),
+    readPending(0),
+    pendingCount(0),
+    appendedRecords(0),
+    payloadBytes(0),
+    flashBytesWritten(0),
+    sectorErases(0),
+    droppedRecords(0),
+    corruptRecords(0),
+    commitFailures(0) {
+  memset(sectorSequence, 0, sizeof(sectorSequence));
+  memset(sectorEraseCount, 0, sizeof(sectorEraseCount));
+  head.sector = tail.sector = read.sector = 0;
+  head.offset = tail.offset = read.offset = FLASH_LOG_SECTOR_HEADER;
+}
+
+// ============================================================================
+// MOUNT
+// ============================================================================
+
+bool FlashLog::begin(size_t maxBytes) {
+  sectorCount = 0;
+  size_t partitionSize = 0;
+  if (!hal::flashBegin(partitionSize)) {
+    Serial.println(F("[FlashLog] ERROR: No data partition"));
+    return false;
+  }
+  size_t sectors = min(partitionSize, maxBytes) / FLASH_SECTOR_SIZE;
+  if (sectors > FLASH_LOG_MAX_SECTORS) sectors = FLASH_LOG_MAX_SECTORS;
+  if (sectors < 2) {
+    Serial.println(F("[FlashLog] ERROR: Partition too small"));
+    return false;
+  }
+  sectorCount = (uint8_t)sectors;
+
+  // Sector headers: the newest sector is the head
+  uint8_t headSector = 0;
+  headSequence = 0;
+  for (uint8_t sector = 0; sector < sectorCount; sector++) {
+    SectorHeader header;
+    hal::flashRead(sectorOffset(sector), &header, sizeof(header));
+    bool valid = header.magic == FLASH_LOG_MAGIC && header.sequence != 0 && header.check == sectorCheck(header);
+    sectorSequence[sector] = valid ? header.sequence : 0;
+    sectorEraseCount[sector] = valid ? header.eraseCount : 0;
+    if (valid && header.sequence > headSequence) {
+      headSequence = header.sequence;
+      headSector = sector;
+    }
+  }
+
+  // Records, oldest sector first: pending count, oldest pending record,
+  // newest boot, and the end of the head sector
+  pendingCount = 0;
+  uint16_t lastBoot = 0;
+  head.sector = headSector;
+  head.offset = FLASH_LOG_SECTOR_HEADER;
+  uint8_t sector = headSector;
+  for (uint8_t i = 0; i < sectorCount && headSequence > 0; i++) {
+    sector = nextSector(sector);
+    if (sectorSequence[sector] == 0) continue;
+
+    uint16_t offset = FLASH_LOG_SECTOR_HEADER;
+    while (offset + FLASH_LOG_RECORD_HEADER <= FLASH_SECTOR_SIZE) {
+      uint8_t header[FLASH_LOG_RECORD_HEADER];
+      uint8_t payload[FLASH_LOG_MAX_PAYLOAD];
+      hal::flashRead(sectorOffset(sector) + offset, header, sizeof(header));
+      if (header[0] == 0xFF) break;  // Free space
+
+      bool valid = header[0] == FLASH_LOG_MARKER && header[3] > 0 && header[3] <= FLASH_LOG_MAX_PAYLOAD &&
+                   offset + FLASH_LOG_RECORD_HEADER + header[3] <= FLASH_SECTOR_SIZE &&
+                   hal::flashRead(sectorOffset(sector) + offset + FLASH_LOG_RECORD_HEADER, payload, header[3]) &&
+                   recordCrc(header, payload) == (uint16_t)(header[6] | (header[7] << 8));
+      if (!valid) {
+        // Torn write (power lost mid-record): the rest of the sector is
+        // not trusted and not written to
+        corruptRecords++;
+        offset = FLASH_SECTOR_SIZE;
+        break;
+      }
+
+      uint16_t boot = (uint16_t)(header[4] | (header[5] << 8));
+      if (boot > lastBoot) lastBoot = boot;
+      if (header[1] == 0xFF && pendingCount++ == 0) {
+        tail.sector = sector;
+        tail.offset = offset;
+      }
+      offset += recordSize(header[3]);
+    }
+    if (sector == headSector) head.offset = min(offset, (uint16_t)FLASH_SECTOR_SIZE);
+  }
+  if (pendingCount == 0) tail = head;
+  read = tail;
+  readPending = 0;
+  bootId = lastBoot + 1;
+
+  // First use: the head sector is opened now (later ones when reached)
+  if (headSequence == 0 && !openSector(0)) {
+    sectorCount = 0;
+    return false;
+  }
+
+  // Persist this boot: the next mount counts on from here even if nothing
+  // else is logged
+  uint8_t boot[2] = { (uint8_t)bootId, (uint8_t)(bootId >> 8) };
+  if (!writeRecord(FLASH_LOG_TYPE_BOOT, 0x00, boot, sizeof(boot), millis())) {
+    Serial.println(F("[FlashLog] WARNING: Boot record not written"));
+  }
+
+  Serial.print(F("[FlashLog] Mounted: "));
+  Serial.print(sectorCount);
+  Serial.print(F(" sectors, "));
+  Serial.print(pendingCount);
+  Serial.print(F(" pending records, boot "));
+  Serial.println(bootId);
+  return true;
+}
+
+// ============================================================================
+// APPEND
+// ============================================================================
+
+bool FlashLog::append(uint8_t type, const uint8_t* data, size_t length, uint32_t timestamp) {
+  if (!isReady() || type == FLASH_LOG_TYPE_BOOT || length == 0 || length > FLASH_LOG_MAX_PAYLOAD) return false;
+  if (!writeRecord(type, 0xFF, data, length, timestamp)) return false;
+
+  pendingCount++;
+  appendedRecords++;
+  payloadBytes += length;
+  return true;
+}
+
+bool FlashLog::writeRecord(uint8_t type, uint8_t state, const uint8_t* data, size_t length, uint32_t timestamp) {
+  if (head.offset + recordSize((uint8_t)length) > FLASH_SECTOR_SIZE) {
+    if (!openSector(nextSector(head.sector))) return false;
+  }
+
+  uint8_t record[FLASH_LOG_RECORD_HEADER + FLASH_LOG_MAX_PAYLOAD];
+  record[0] = FLASH_LOG_MARKER;
+  record[1] = state;
+  record[2] = type;
+  record[3] = (uint8_t)length;
+  record[4] = (uint8_t)bootId;
+  record[5] = (uint8_t)(bootId >> 8);
+  memcpy(record + 8, &timestamp, 4);
+  memcpy(record + FLASH_LOG_RECORD_HEADER, data, length);
+  uint16_t crc = recordCrc(record, data);
+  record[6] = (uint8_t)crc;
+  record[7] = (uint8_t)(crc >> 8);
+
+  // One write: a record is either whole or fails its CRC at mount. The
+  // alignment padding is left erased.
+  size_t bytes = FLASH_LOG_RECORD_HEADER + length;
+  if (!hal::flashWrite(sectorOffset(head.sector) + head.offset, record, bytes)) return false;
+
+  head.offset += recordSize((uint8_t)length);
+  flashBytesWritten += bytes;
+  return true;
+}
+
+bool FlashLog::openSector(uint8_t sector) {
+  // Reusing the oldest sector drops whatever is still pending in it (the
+  // tail is there if anything is)
+  bool tailHere = (tail.sector == sector) && !(tail.sector == head.sector && tail.offset == head.offset);
+  if (tailHere && pendingCount > 0) {
+    uint32_t dropped = countPending(sector, tail.offset);
+    droppedRecords += dropped;
+    pendingCount -= min(dropped, pendingCount);
+  }
+
+  uint32_t erases = sectorEraseCount[sector] + 1;
+  if (!hal::flashErase(sectorOffset(sector), FLASH_SECTOR_SIZE)) return false;
+
+  SectorHeader header;
+  header.magic = FLASH_LOG_MAGIC;
+  header.sequence = headSequence + 1;
+  header.eraseCount = erases;
+  header.check = sectorCheck(header);
+  if (!hal::flashWrite(sectorOffset(sector), &header, sizeof(header))) return false;
+
+  headSequence = header.sequence;
+  sectorSequence[sector] = header.sequence;
+  sectorEraseCount[sector] = erases;
+  sectorErases++;
+  flashBytesWritten += sizeof(header);
+
+  head.sector = sector;
+  head.offset = FLASH_LOG_SECTOR_HEADER;
+  if (tail.sector == sector || pendingCount == 0) {
+    // Oldest remaining records start in the following sector
+    tail.sector = pendingCount ? nextSector(sector) : sector;
+    tail.offset = FLASH_LOG_SECTOR_HEADER;
+    read = tail;
+    readPending = 0;
+  }
+  return true;
+}
+
+// ============================================================================
+// READING
+// ============================================================================
+
+bool FlashLog::readAt(FlashLogPosition& position, uint8_t* header, uint8_t* payload) {
+  while (!(position.sector == head.sector && position.offset == head.offset)) {
+    uint32_t address = sectorOffset(position.sector) + position.offset;
+    if (position.offset + FLASH_LOG_RECORD_HEADER <= FLASH_SECTOR_SIZE &&
+        hal::flashRead(address, header, FLASH_LOG_RECORD_HEADER) && header[0] == FLASH_LOG_MARKER &&
+        header[3] > 0 && header[3] <= FLASH_LOG_MAX_PAYLOAD &&
+        position.offset + FLASH_LOG_RECORD_HEADER + header[3] <= FLASH_SECTOR_SIZE) {
+      if (!payload) return true;
+      if (hal::flashRead(address + FLASH_LOG_RECORD_HEADER, payload, header[3]) &&
+          recordCrc(header, payload) == (uint16_t)(header[6] | (header[7] << 8))) {
+        return true;
+      }
+    }
+
+    // End of this sector's records
+    if (position.sector == head.sector) {
+      position = head;
+      return false;
+    }
+    position.sector = nextSector(position.sector);
+    position.offset = FLASH_LOG_SECTOR_HEADER;
+  }
+  return false;
+}
+
+uint32_t FlashLog::countPending(uint8_t sector, uint16_t offset) {
+  uint32_t pending = 0;
+  while (offset + FLASH_LOG_RECORD_HEADER <= FLASH_SECTOR_SIZE) {
+    uint8_t header[FLASH_LOG_RECORD_HEADER];
+    hal::flashRead(sectorOffset(sector) + offset, header, sizeof(header));
+    if (header[0] != FLASH_LOG_MARKER || header[3] == 0 || header[3] > FLASH_LOG_MAX_PAYLOAD) break;
+    if (header[1] == 0xFF) pending++;
+    offset += recordSize(header[3]);
+  }
+  return pending;
+}
+
+bool FlashLog::next(FlashLogRecord& record, size_t maxLength) {
+  if (!isReady()) return false;
+
+  uint8_t header[FLASH_LOG_RECORD_HEADER];
+  while (readAt(read, header, record.data)) {
+    if (header[1] != 0xFF) {  // Forwarded before
+      read.offset += recordSize(header[3]);
+      continue;
+    }
+    if (header[3] > maxLength) return false;
+    record.position = read;
+    read.offset += recordSize(header[3]);
+
+    record.type = header[2];
+    record.length = header[3];
+    record.boot = (uint16_t)(header[4] | (header[5] << 8));
+    memcpy(&record.timestamp, header + 8, 4);
+    readPending++;
+    return true;
+  }
+  return false;
+}
+
+bool FlashLog::commit() {
+  // Clear the state byte of every pending record read: programming 0xFF
+  // -> 0x00 in place needs no erase
+  uint8_t header[FLASH_LOG_RECORD_HEADER];
+  FlashLogPosition position = tail;
+  while (readPending > 0 && !(position.sector == read.sector && position.offset == read.offset) &&
+         readAt(position, header, nullptr)) {
+    if (header[1] == 0xFF) {
+      uint8_t forwarded = 0x00;
+      if (!hal::flashWrite(sectorOffset(position.sector) + position.offset + 1, &forwarded, 1)) {
+        // Flash still says pending from here on: so does the count, and
+        // these records are read (and sent) again
+        commitFailures++;
+        tail = position;
+        read = tail;
+        readPending = 0;
+        return false;
+      }
+      flashBytesWritten++;
+      readPending--;
+      pendingCount--;
+    }
+    position.offset += recordSize(header[3]);
+  }
+  tail = read;
+  readPending = 0;
+  return true;
+}
+
+bool FlashLog::forward(const FlashLogRecord& record) {
+  if (!isReady()) return false;
+  uint8_t forwarded = 0x00;
+  if (!hal::flashWrite(sectorOffset(record.position.sector) + record.position.offset + 1, &forwarded, 1)) {
+    commitFailures++;
+    return false;
+  }
+  flashBytesWritten++;
+  pendingCount--;
+  return true;
+}
+
+void FlashLog::rewind() {
+  read = tail;
+  readPending = 0;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void FlashLog::printStatistics() {
+  uint32_t minErases = 0;
+  uint32_t maxErases = 0;
+  for (uint8_t sector = 0; sector < sectorCount; sector++) {
+    if (sector == 0 || sectorEraseCount[sector] < minErases) minErases = sectorEraseCount[sector];
+    if (sectorEraseCount[sector] > maxErases) maxErases = sectorEraseCount[sector];
+  }
+
+  Serial.print(F("  Flash Log: "));
+  Serial.print(sectorCount);
+  Serial.print(F(" sectors ("));
+  Serial.print(getSize() / 1024);
+  Serial.print(F(" kB), boot "));
+  Serial.print(bootId);
+  Serial.print(F(", "));
+  Serial.print(pendingCount);
+  Serial.println(F(" records pending"));
+  Serial.print(F("  Logged: "));
+  Serial.print(appendedRecords);
+  Serial.print(F(" records, "));
+  Serial.print(payloadBytes);
+  Serial.print(F(" payload bytes -> "));
+  Serial.print(flashBytesWritten);
+  Serial.print(F(" flash bytes (write amplification "));
+  Serial.print(payloadBytes > 0 ? (float)flashBytesWritten / payloadBytes : 0.0f, 2);
+  Serial.println(F(")"));
+  Serial.print(F("  Erases: "));
+  Serial.print(sectorErases);
+  Serial.print(F(" (per sector "));
+  Serial.print(minErases);
+  Serial.print(F("-"));
+  Serial.print(maxErases);
+  Serial.print(F("), Dropped: "));
+  Serial.print(droppedRecords);
+  Serial.print(F(", Corrupt: "));
+  Serial.print(corruptRecords);
+  Serial.print(F(", Commit failures: "));
+  Serial.println(commitFailures);
+}
@@ -0,0 +1,167 @@
+/*
+ * Flash Log for ESP32-C3 BEACON
+ * Log-structured append log of small records in the raw data partition
+ * (hal::flash*), for store-and-forward while BLE is down (StoreForward.h)
+ *
+ * Layout: the log area is a ring of FLASH_SECTOR_SIZE sectors, written in
+ * order and erased only when the head wraps onto the oldest one, so every
+ * sector is erased once per lap (wear levelling by rotation; the erase
+ * count is kept in each sector header). A full log drops its oldest
+ * sector.
+ *
+ * Sector: 16-byte header {magic, sequence, erase count, check}, then
+ * records back to back, each 4-byte aligned:
+ *   [0]     marker  FLASH_LOG_MARKER (0xFF: free space from here on)
+ *   [1]     state   0xFF pending, 0x00 forwarded (cleared in place: no erase)
+ *   [2]     type    Caller's record type
+ *   [3]     length  Payload bytes (1..FLASH_LOG_MAX_PAYLOAD)
+ *   [4-5]   boot    Boot the record was written in (max in the log + 1 at mount)
+ *   [6-7]   crc     CRC-16/CCITT over bytes 2-5, timestamp and payload
+ *   [8-11]  timestamp  millis() when logged (valid in its own boot only)
+ *   [12..]  payload
+ * A record is written with one flash write; a torn one fails its CRC at
+ * mount and the rest of that sector is skipped.
+ *
+ * Boot counter: every mount writes a FLASH_LOG_TYPE_BOOT record (payload:
+ * the boot id) already marked forwarded, so the newest boot id is always in
+ * the log, even when nothing else was logged since the previous boot.
+ *
+ * Reading: next() walks pending records from the oldest without changing
+ * flash; commit() marks everything read so far forwarded (up to a failed
+ * write), rewind() goes back (a notification that failed is read again).
+ */
+
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <Arduino.h>
+#include "Hal.h"
+
+// ============================================================================
+// LOG CONFIGURATION
+// ============================================================================
+
+#define FLASH_LOG_MAGIC 0x474F4C42UL  // "BLOG"
+#define FLASH_LOG_MARKER 0xA5
+#define FLASH_LOG_SECTOR_HEADER 16
+#define FLASH_LOG_RECORD_HEADER 12
+#define FLASH_LOG_MAX_PAYLOAD 64
+#define FLASH_LOG_MAX_SECTORS 64      // 256 kB of log at most
+#define FLASH_LOG_TYPE_BOOT 0x00      // Boot record (caller types are non-zero)
+
+struct FlashLogPosition {
+  uint8_t sector;
+  uint16_t offset;
+};
+
+struct FlashLogRecord {
+  uint8_t type;
+  uint8_t length;
+  uint16_t boot;
+  uint32_t timestamp;
+  FlashLogPosition position;  // Set by next(), for forward()
+  uint8_t data[FLASH_LOG_MAX_PAYLOAD];
+};
+
+class FlashLog {
+public:
+  FlashLog();
+
+  /**
+   * Mount the log at the start of the data partition: recover the head,
+   * the oldest pending record and the erase counts; a blank or foreign
+   * area is taken over sector by sector as the head reaches it, then
+   * record this boot (getBootId() grows by one on every mount)
+   * @param maxBytes Log size (rounded down to sectors, at most the partition)
+   * @return false without a data partition or with under two sectors
+   */
+  bool begin(size_t maxBytes);
+  bool isReady() const { return sectorCount > 0; }
+
+  /**
+   * Append one record (written to flash before this returns)
+   * @return false if not mounted, the payload is too long or the write failed
+   */
+  bool append(uint8_t type, const uint8_t* data, size_t length, uint32_t timestamp);
+
+  /**
+   * Next pending record after the read position
+   * @param maxLength Longest payload wanted: a longer record stays unread
+   * @return false if every pending record has been read or the next one
+   *         is longer than maxLength
+   */
+  bool next(FlashLogRecord& record, size_t maxLength = FLASH_LOG_MAX_PAYLOAD);
+
+  /**
+   * Mark every record read since the last commit()/rewind() forwarded
+   * @return false if a flash write failed: records from that one on stay
+   *         pending and are read again
+   */
+  bool commit();
+
+  /**
+   * Mark one record read by next() forwarded, out of order (records read
+   * before it stay pending); rewind() before reading on
+   * @return false if the flash write failed: the record stays pending
+   */
+  bool forward(const FlashLogRecord& record);
+
+  /**
+   * Read again from the oldest pending record
+   */
+  void rewind();
+
+  uint32_t getPendingCount() const { return pendingCount; }
+  uint16_t getBootId() const { return bootId; }
+  size_t getSize() const { return (size_t)sectorCount * FLASH_SECTOR_SIZE; }
+
+  // Statistics (since begin())
+  uint32_t getAppendedRecords() const { return appendedRecords; }
+  uint32_t getPayloadBytes() const { return payloadBytes; }          // Logged payload
+  uint32_t getFlashBytesWritten() const { return flashBytesWritten; } // Programmed, all overhead included
+  uint32_t getSectorErases() const { return sectorErases; }
+  uint32_t getDroppedRecords() const { return droppedRecords; }       // Pending, overwritten when full
+  uint32_t getCorruptRecords() const { return corruptRecords; }
+  uint32_t getCommitFailures() const { return commitFailures; }      // State writes that failed
+
+  void printStatistics();
+
+private:
+  uint8_t sectorCount;
+  uint16_t bootId;
+  uint32_t sectorSequence[FLASH_LOG_MAX_SECTORS];  // 0 = not a log sector
+  uint32_t sectorEraseCount[FLASH_LOG_MAX_SECTORS];
+  uint32_t headSequence;  // Sequence of the newest sector
+
+  FlashLogPosition head;  // Next record is written here
+  FlashLogPosition tail;  // Oldest pending record (or head)
+  FlashLogPosition read;  // next() position, tail..head
+  uint32_t readPending;   // Pending records between tail and read
+  uint32_t pendingCount;
+
+  uint32_t appendedRecords;
+  uint32_t payloadBytes;
+  uint32_t flashBytesWritten;
+  uint32_t sectorErases;
+  uint32_t droppedRecords;
+  uint32_t corruptRecords;  // Failed CRC (torn writes)
+  uint32_t commitFailures;
+
+  uint32_t sectorOffset(uint8_t sector) const { return (uint32_t)sector * FLASH_SECTOR_SIZE; }
+  uint8_t nextSector(uint8_t sector) const { return (sector + 1 == sectorCount) ? 0 : sector + 1; }
+
+  // Record at position (a header, plus the payload if one is given, which
+  // is then CRC-checked); moves position over the end of a sector and
+  // over an unreadable rest of one. false once position reaches head.
+  bool readAt(FlashLogPosition& position, uint8_t* header, uint8_t* payload);
+
+  // Pending records in sector from offset on
+  uint32_t countPending(uint8_t sector, uint16_t offset);
+
+  bool openSector(uint8_t sector);  // Erase and stamp the next head sector
+
+  // Write one record at the head (state: 0xFF pending, 0x00 forwarded)
+  bool writeRecord(uint8_t type, uint8_t state, const uint8_t* data, size_t length, uint32_t timestamp);
+};
+
+#endif // FLASH_LOG_H
@@ -0,0 +1,213 @@
+/*
+ * Hardware Abstraction Layer for ESP32-C3 BEACON
+ * Thin wrappers over clock, GPIO, I2C, I2S, queue, critical section, task,
+ * flash and BLE notify APIs
+ *
+ * Firmware modules call these instead of Arduino/FreeRTOS/i2s/NimBLE
+ * directly, so the same .cpp files build for:
+ * - ESP32-C3 (Hal_ESP32.cpp, compiled by the Arduino IDE)
+ * - Linux host (host/Hal_Host.cpp, stub/mock backends, see CMakeLists.txt)
+ *
+ * Host builds use the same module sources to benchmark the codec,
+ * scheduler and detectors without flashing a board.
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class NimBLECharacteristic;
+
+namespace hal {
+
+// ============================================================================
+// CLOCK
+// ============================================================================
+
+uint32_t millis();
+uint32_t micros();
+void delayMs(uint32_t ms);
+
+/**
+ * Free-running CPU cycle counter (esp_cpu_get_cycle_count on target)
+ * Use for per-block cycle budgets; wraps every 2^32 cycles (~26 s at 160 MHz)
+ * On host the counter ticks in nanoseconds (cpuFrequencyMHz() == 1000)
+ */
+uint32_t cycleCount();
+uint32_t cpuFrequencyMHz();
+
+/**
+ * 32 random bits (esp_random() on target: hardware RNG, seeded by RF noise
+ * once the radio is up; std::random_device on host)
+ */
+uint32_t random32();
+
+// ============================================================================
+// GPIO
+// ============================================================================
+
+void gpioInputPullup(uint8_t pin);
+int gpioRead(uint8_t pin);
+
+// ============================================================================
+// I2C
+// ============================================================================
+
+bool i2cBegin(uint8_t sdaPin, uint8_t sclPin, uint32_t clockHz);
+void i2cSetClock(uint32_t clockHz);
+
+/**
+ * Probe for an ACK at the given 7-bit address
+ * @return true if a device responded
+ */
+bool i2cProbe(uint8_t address);
+
+// ============================================================================
+// I2S (microphone input)
+// ============================================================================
+
+struct I2SConfig {
+  uint32_t sampleRate;
+  uint8_t dmaBufCount;
+  uint16_t dmaBufLen;  // Samples per DMA buffer
+  int bckPin;
+  int wsPin;
+  int dataInPin;
+  uint8_t eventQueueSize;  // Driver event queue depth (0 = none, see i2sWaitEvent)
+};
+
+enum I2SEvent {
+  I2S_RX_TIMEOUT,  // No event within the timeout
+  I2S_RX_READY,    // A DMA buffer was filled
+  I2S_RX_OVERRUN   // Driver dropped the oldest unread DMA buffer (dmaBufLen samples lost)
+};
+
+bool i2sBegin(const I2SConfig& config);
+void i2sEnd();
+
+/**
+ * Read up to maxSamples 16-bit samples from the I2S DMA buffers
+ * @param samplesRead Output: number of samples actually read
+ * @param timeoutMs Maximum time to block waiting for DMA data
+ * @return true on success (samplesRead may still be 0 on timeout)
+ */
+bool i2sRead(int16_t* samples, size_t maxSamples, size_t& samplesRead, uint32_t timeoutMs);
+
+/**
+ * Block until the I2S driver reports an event (requires eventQueueSize > 0)
+ */
+I2SEvent i2sWaitEvent(uint32_t timeoutMs);
+
+// ============================================================================
+// QUEUE (FreeRTOS queue on target, mutex-protected deque on host)
+// ============================================================================
+
+class Queue {
+public:
+  Queue() : handle(nullptr) {}
+
+  bool create(size_t length, size_t itemSize);
+  void destroy();
+  bool isValid() const { return handle != nullptr; }
+
+  /**
+   * Copy item into the queue
+   * @return true if queued, false if full after timeoutMs
+   */
+  bool send(const void* item, uint32_t timeoutMs = 0);
+
+  /**
+   * Copy item into the queue ahead of everything queued (put back)
+   * @return true if queued, false if full after timeoutMs
+   */
+  bool sendToFront(const void* item, uint32_t timeoutMs = 0);
+
+  /**
+   * Copy the oldest item out of the queue
+   * @return true if an item was received within timeoutMs
+   */
+  bool receive(void* item, uint32_t timeoutMs = 0);
+
+  /**
+   * Copy the oldest item out without removing it
+   * @return true if an item was present within timeoutMs
+   */
+  bool peek(void* item, uint32_t timeoutMs = 0);
+
+  size_t count() const;
+  void reset();
+
+private:
+  void* handle;
+};
+
+// ============================================================================
+// CRITICAL SECTION (portENTER_CRITICAL on target, mutex on host)
+// ============================================================================
+
+/**
+ * Guard a few instructions of state shared between tasks (nestable)
+ * Interrupts are masked on target: no blocking calls or logging inside
+ */
+void enterCritical();
+void exitCritical();
+
+// ============================================================================
+// TASKS (FreeRTOS task on target, std::thread on host)
+// ============================================================================
+
+typedef void (*TaskFunction)(void* context);
+
+/**
+ * Start a task running function(context); the task ends when it returns
+ * @param stackBytes Stack size in bytes (ignored on host)
+ * @param priority FreeRTOS priority (loop() runs at 1; ignored on host)
+ */
+bool taskStart(TaskFunction function, const char* name, uint32_t stackBytes,
+               uint8_t priority, void* context);
+
+// ============================================================================
+// FLASH (raw data partition: the SPIFFS partition on target, RAM image on host)
+// ============================================================================
+
+#define FLASH_SECTOR_SIZE 4096  // Erase unit
+
+/**
+ * Open the data partition (NOR semantics: erase sets a sector to 0xFF,
+ * a write can only clear bits)
+ * @param size Output: partition size in bytes
+ * @return false if there is no data partition
+ */
+bool flashBegin(size_t& size);
+
+bool flashRead(uint32_t offset, void* data, size_t length);
+bool flashWrite(uint32_t offset, const void* data, size_t length);
+
+/**
+ * Erase whole sectors (offset and length multiples of FLASH_SECTOR_SIZE)
+ */
+bool flashErase(uint32_t offset, size_t length);
+
+// ============================================================================
+// BLE CHARACTERISTIC
+// ============================================================================
+
+/**
+ * Set characteristic value and send a notification
+ * @return true if the BLE stack accepted it for every subscriber, false if
+ *         a failure was reported through bleNotifyStatus() while sending
+ */
+bool bleNotify(NimBLECharacteristic* characteristic, const uint8_t* data, size_t length);
+
+/**
+ * Outcome of a notification, from NimBLECharacteristicCallbacks::onStatus()
+ * (NimBLE reports it from inside notify(), which returns nothing itself);
+ * only reports made during bleNotify() in the sending task count
+ */
+void bleNotifyStatus(NimBLECharacteristic* characteristic, bool accepted);
+
+}  // namespace hal
+
+#endif // HAL_H
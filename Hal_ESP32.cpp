@@ -0,0 +1,314 @@
+/*
+ * Hardware Abstraction Layer - ESP32-C3 backend
+ * Arduino core + ESP-IDF (FreeRTOS, legacy i2s driver) + NimBLE
+ *
+ * Host builds compile host/Hal_Host.cpp instead of this file.
+ */
+
+#if defined(ARDUINO)
+
+#include "Hal.h"
+#include <Arduino.h>
+#include <Wire.h>
+#include <NimBLEDevice.h>
+#include <driver/i2s.h>
+#include "esp_cpu.h"
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#define HAL_I2S_PORT I2S_NUM_0
+
+namespace hal {
+
+namespace {
+
+QueueHandle_t i2sEventQueue = nullptr;
+portMUX_TYPE criticalMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Notification in progress (bleNotify() -> onStatus() -> bleNotifyStatus())
+NimBLECharacteristic* notifying = nullptr;
+TaskHandle_t notifyingTask = nullptr;
+bool notifyFailed = false;
+const esp_partition_t* dataPartition = nullptr;
+
+struct TaskStart {
+  TaskFunction function;
+  void* context;
+};
+
+void taskTrampoline(void* arg) {
+  TaskStart start = *(TaskStart*)arg;
+  delete (TaskStart*)arg;
+  start.function(start.context);
+  vTaskDelete(NULL);  // FreeRTOS tasks must not return
+}
+
+}  // namespace
+
+// ============================================================================
+// CLOCK
+// ============================================================================
+
+uint32_t millis() {
+  return ::millis();
+}
+
+uint32_t micros() {
+  return ::micros();
+}
+
+void delayMs(uint32_t ms) {
+  ::delay(ms);
+}
+
+uint32_t cycleCount() {
+  return (uint32_t)esp_cpu_get_cycle_count();
+}
+
+uint32_t cpuFrequencyMHz() {
+  return getCpuFrequencyMhz();
+}
+
+uint32_t random32() {
+  return esp_random();
+}
+
+// ============================================================================
+// GPIO
+// ============================================================================
+
+void gpioInputPullup(uint8_t pin) {
+  pinMode(pin, INPUT_PULLUP);
+}
+
+int gpioRead(uint8_t pin) {
+  return digitalRead(pin);
+}
+
+// ============================================================================
+// I2C
+// ============================================================================
+
+bool i2cBegin(uint8_t sdaPin, uint8_t sclPin, uint32_t clockHz) {
+  if (!Wire.begin(sdaPin, sclPin)) {
+    return false;
+  }
+  Wire.setClock(clockHz);
+  return true;
+}
+
+void i2cSetClock(uint32_t clockHz) {
+  Wire.setClock(clockHz);
+}
+
+bool i2cProbe(uint8_t address) {
+  Wire.beginTransmission(address);
+  return (Wire.endTransmission() == 0);
+}
+
+// ============================================================================
+// I2S
+// ============================================================================
+
+bool i2sBegin(const I2SConfig& config) {
+  i2s_config_t i2s_config = {
+    .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
+    .sample_rate = config.sampleRate,
+    .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+    .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
+    .communication_format = I2S_COMM_FORMAT_STAND_I2S,
+    .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
+    .dma_buf_count = config.dmaBufCount,
+    .dma_buf_len = config.dmaBufLen,
+    .use_apll = false,
+    .tx_desc_auto_clear = false,
+    .fixed_mclk = 0
+  };
+
+  i2s_pin_config_t pin_config = {
+    .bck_io_num = config.bckPin,
+    .ws_io_num = config.wsPin,
+    .data_out_num = I2S_PIN_NO_CHANGE,
+    .data_in_num = config.dataInPin
+  };
+
+  i2sEventQueue = nullptr;
+  esp_err_t err = i2s_driver_install(HAL_I2S_PORT, &i2s_config, config.eventQueueSize,
+                                     config.eventQueueSize ? &i2sEventQueue : NULL);
+  if (err != ESP_OK) {
+    Serial.print(F("[HAL] I2S driver install failed: "));
+    Serial.println(err);
+    return false;
+  }
+
+  err = i2s_set_pin(HAL_I2S_PORT, &pin_config);
+  if (err != ESP_OK) {
+    Serial.print(F("[HAL] I2S pin config failed: "));
+    Serial.println(err);
+    i2s_driver_uninstall(HAL_I2S_PORT);
+    return false;
+  }
+
+  // Start I2S
+  i2s_zero_dma_buffer(HAL_I2S_PORT);
+
+  return true;
+}
+
+void i2sEnd() {
+  i2s_driver_uninstall(HAL_I2S_PORT);
+  i2sEventQueue = nullptr;
+}
+
+bool i2sRead(int16_t* samples, size_t maxSamples, size_t& samplesRead, uint32_t timeoutMs) {
+  size_t bytesRead = 0;
+  esp_err_t err = i2s_read(HAL_I2S_PORT, samples, maxSamples * sizeof(int16_t),
+                           &bytesRead, pdMS_TO_TICKS(timeoutMs));
+  samplesRead = bytesRead / sizeof(int16_t);
+  return (err == ESP_OK);
+}
+
+I2SEvent i2sWaitEvent(uint32_t timeoutMs) {
+  i2s_event_t event;
+  if (!i2sEventQueue) {
+    ::delay(timeoutMs);
+    return I2S_RX_TIMEOUT;
+  }
+
+  TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeoutMs);
+  for (;;) {
+    TickType_t now = xTaskGetTickCount();
+    TickType_t wait = ((int32_t)(deadline - now) > 0) ? (deadline - now) : 0;
+    if (xQueueReceive(i2sEventQueue, &event, wait) != pdTRUE) return I2S_RX_TIMEOUT;
+    if (event.type == I2S_EVENT_RX_Q_OVF) return I2S_RX_OVERRUN;
+    if (event.type == I2S_EVENT_RX_DONE) return I2S_RX_READY;
+    // TX / DMA error events are not used by the microphone path
+  }
+}
+
+// ============================================================================
+// QUEUE
+// ============================================================================
+
+bool Queue::create(size_t length, size_t itemSize) {
+  handle = xQueueCreate(length, itemSize);
+  return (handle != nullptr);
+}
+
+void Queue::destroy() {
+  if (handle) {
+    vQueueDelete((QueueHandle_t)handle);
+    handle = nullptr;
+  }
+}
+
+bool Queue::send(const void* item, uint32_t timeoutMs) {
+  TickType_t timeout = (timeoutMs == 0) ? 0 : pdMS_TO_TICKS(timeoutMs);
+  return (xQueueSend((QueueHandle_t)handle, item, timeout) == pdTRUE);
+}
+
+bool Queue::sendToFront(const void* item, uint32_t timeoutMs) {
+  TickType_t timeout = (timeoutMs == 0) ? 0 : pdMS_TO_TICKS(timeoutMs);
+  return (xQueueSendToFront((QueueHandle_t)handle, item, timeout) == pdTRUE);
+}
+
+bool Queue::receive(void* item, uint32_t timeoutMs) {
+  TickType_t timeout = (timeoutMs == 0) ? 0 : pdMS_TO_TICKS(timeoutMs);
+  return (xQueueReceive((QueueHandle_t)handle, item, timeout) == pdTRUE);
+}
+
+bool Queue::peek(void* item, uint32_t timeoutMs) {
+  TickType_t timeout = (timeoutMs == 0) ? 0 : pdMS_TO_TICKS(timeoutMs);
+  return (xQueuePeek((QueueHandle_t)handle, item, timeout) == pdTRUE);
+}
+
+size_t Queue::count() const {
+  return uxQueueMessagesWaiting((QueueHandle_t)handle);
+}
+
+void Queue::reset() {
+  xQueueReset((QueueHandle_t)handle);
+}
+
+// ============================================================================
+// CRITICAL SECTION
+// ============================================================================
+
+void enterCritical() {
+  portENTER_CRITICAL(&criticalMux);
+}
+
+void exitCritical() {
+  portEXIT_CRITICAL(&criticalMux);
+}
+
+// ============================================================================
+// TASKS
+// ============================================================================
+
+bool taskStart(TaskFunction function, const char* name, uint32_t stackBytes,
+               uint8_t priority, void* context) {
+  TaskStart* start = new TaskStart;
+  start->function = function;
+  start->context = context;
+  // ESP-IDF FreeRTOS takes the stack depth in bytes
+  if (xTaskCreate(taskTrampoline, name, stackBytes, start, priority, NULL) != pdPASS) {
+    delete start;
+    return false;
+  }
+  return true;
+}
+
+// ============================================================================
+// FLASH
+// ============================================================================
+
+bool flashBegin(size_t& size) {
+  // The SPIFFS partition of the partition scheme, used raw (not mounted)
+  dataPartition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, NULL);
+  size = dataPartition ? dataPartition->size : 0;
+  return dataPartition != nullptr;
+}
+
+bool flashRead(uint32_t offset, void* data, size_t length) {
+  return dataPartition && esp_partition_read(dataPartition, offset, data, length) == ESP_OK;
+}
+
+bool flashWrite(uint32_t offset, const void* data, size_t length) {
+  return dataPartition && esp_partition_write(dataPartition, offset, data, length) == ESP_OK;
+}
+
+bool flashErase(uint32_t offset, size_t length) {
+  return dataPartition && esp_partition_erase_range(dataPartition, offset, length) == ESP_OK;
+}
+
+// ============================================================================
+// BLE CHARACTERISTIC
+// ============================================================================
+
+bool bleNotify(NimBLECharacteristic* characteristic, const uint8_t* data, size_t length) {
+  if (!characteristic) return false;
+  characteristic->setValue(data, length);
+
+  // notify() returns nothing; ble_gattc_notify_custom()'s result for each
+  // subscriber (ENOMEM when the stack has no buffer) reaches onStatus()
+  // before it returns, in this task
+  notifyingTask = xTaskGetCurrentTaskHandle();
+  notifyFailed = false;
+  notifying = characteristic;
+  characteristic->notify();
+  notifying = nullptr;
+  return !notifyFailed;
+}
+
+void bleNotifyStatus(NimBLECharacteristic* characteristic, bool accepted) {
+  if (characteristic == notifying && xTaskGetCurrentTaskHandle() == notifyingTask && !accepted) {
+    notifyFailed = true;
+  }
+}
+
+}  // namespace hal
+
+#endif // ARDUINO
@@ -0,0 +1,103 @@
+/*
+ * On-Device SOS Keyword Spotter Implementation
+ */
+
+#include "KeywordSpotter.h"
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+KeywordSpotter::KeywordSpotter()
+  : ready(false),
+    ringHead(0),
+    ringCount(0),
+    hopsSinceInference(0),
+    holdOffHops(0),
+    consecutiveHits(0),
+    detection(false),
+    lastScore(0),
+    inferences(0),
+    detections(0),
+    inferenceCycles(0),
+    maxInferenceCycles(0) {
+  memset(ring, 0, sizeof(ring));
+  memset(arena, 0, sizeof(arena));
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+bool KeywordSpotter::begin() {
+  extractor.begin();
+  ready = interpreter.begin(&sosModel, arena, sizeof(arena));
+  reset();
+  return ready;
+}
+
+void KeywordSpotter::reset() {
+  extractor.reset();
+  ringHead = 0;
+  ringCount = 0;
+  hopsSinceInference = 0;
+  consecutiveHits = 0;
+  detection = false;
+}
+
+// ============================================================================
+// PROCESSING
+// ============================================================================
+
+size_t KeywordSpotter::process(const int16_t* samples, size_t count) {
+  detection = false;
+  if (!ready) return count;
+
+  size_t consumed = extractor.process(samples, count);
+  if (!extractor.frameReady()) return consumed;
+
+  memcpy(ring[ringHead], extractor.getFrame(), MEL_BINS);
+  ringHead = (ringHead + 1) % SOS_MODEL_FRAMES;
+  if (ringCount < SOS_MODEL_FRAMES) ringCount++;
+  if (holdOffHops > 0) holdOffHops--;
+
+  // The model sees a full window only
+  if (++hopsSinceInference >= KWS_INFERENCE_HOPS && ringCount == SOS_MODEL_FRAMES && holdOffHops == 0) {
+    hopsSinceInference = 0;
+    runInference();
+  }
+  return consumed;
+}
+
+void KeywordSpotter::runInference() {
+  uint32_t start = hal::cycleCount();
+
+  // Unroll the ring into the input tensor, oldest vector first
+  int8_t* input = interpreter.getInput();
+  size_t tail = (SOS_MODEL_FRAMES - ringHead) * MEL_BINS;
+  memcpy(input, ring[ringHead], tail);
+  memcpy(input + tail, ring[0], FEATURE_BYTES - tail);
+
+  const int8_t* output = interpreter.invoke();
+
+  // Two-class softmax = logistic of the logit difference
+  float margin = interpreter.dequantize(output[SOS_CLASS_SOS]) -
+                 interpreter.dequantize(output[SOS_CLASS_BACKGROUND]);
+  lastScore = (uint8_t)lroundf(100.0f / (1.0f + expf(-margin)));
+
+  inferenceCycles = hal::cycleCount() - start;
+  if (inferenceCycles > maxInferenceCycles) maxInferenceCycles = inferenceCycles;
+  inferences++;
+
+  if (lastScore < KWS_SOS_THRESHOLD_PERCENT) {
+    consecutiveHits = 0;
+    return;
+  }
+  if (++consecutiveHits < KWS_DETECTIONS_REQUIRED) return;
+
+  // One report per utterance: wait until it has left the window
+  consecutiveHits = 0;
+  holdOffHops = SOS_MODEL_FRAMES;
+  detection = true;
+  detections++;
+}
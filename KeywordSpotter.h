@@ -0,0 +1,103 @@
+/*
+ * On-Device SOS Keyword Spotter for ESP32-C3 BEACON
+ * Raises SOS_VOICE from the watch microphone, phone connected or not
+ *
+ * Samples -> MelFeatureExtractor (10 ms hops) -> ring of the last
+ * SOS_MODEL_FRAMES vectors -> int8 model (SosModel.h) every
+ * KWS_INFERENCE_HOPS hops. A detection needs KWS_DETECTIONS_REQUIRED
+ * consecutive inferences above KWS_SOS_THRESHOLD_PERCENT, then the
+ * spotter holds off for one model window so a single utterance is
+ * reported once.
+ *
+ * Memory is fixed at compile time: the tensor arena (KWS_ARENA_SIZE), the
+ * feature ring and the extractor tables live in this object, nothing is
+ * allocated at run time.
+ */
+
+#ifndef KEYWORD_SPOTTER_H
+#define KEYWORD_SPOTTER_H
+
+#include <Arduino.h>
+#include "Hal.h"
+#include "MelFeatures.h"
+#include "NNKernels.h"
+#include "SosModel.h"
+
+#define KWS_ARENA_SIZE 4096             // Bytes; largest layer input + output (conv: 3880 + 192)
+#define KWS_INFERENCE_HOPS 8            // Run the model every 80 ms
+#define KWS_SOS_THRESHOLD_PERCENT 80    // SOS probability for a hit
+#define KWS_DETECTIONS_REQUIRED 2       // Consecutive hits for a detection
+
+// ============================================================================
+// KEYWORD SPOTTER CLASS
+// ============================================================================
+
+class KeywordSpotter {
+public:
+  KeywordSpotter();
+
+  /**
+   * Build the feature tables and plan the model into the arena
+   * @return false if the model does not fit KWS_ARENA_SIZE
+   */
+  bool begin();
+
+  /**
+   * Forget buffered audio (after a gap in the input)
+   */
+  void reset();
+
+  /**
+   * Feed samples up to the end of the current 10 ms hop; runs the model
+   * when one is due
+   * @return Samples consumed; check detected() after each call
+   */
+  size_t process(const int16_t* samples, size_t count);
+
+  /**
+   * True once per detected keyword (cleared by the next process())
+   */
+  bool detected() const { return detection; }
+
+  // Last inference
+  uint8_t getLastScore() const { return lastScore; }  // SOS probability, percent
+
+  // Statistics
+  uint32_t getInferences() const { return inferences; }
+  uint32_t getDetections() const { return detections; }
+  uint32_t getInferenceCycles() const { return inferenceCycles; }
+  uint32_t getMaxInferenceCycles() const { return maxInferenceCycles; }
+  uint32_t getMacsPerInference() const { return interpreter.getMacsPerInference(); }
+  size_t getArenaPeak() const { return interpreter.getArenaPeak(); }
+  size_t getArenaSize() const { return KWS_ARENA_SIZE; }
+  size_t getStaticRam() const { return sizeof(KeywordSpotter); }
+
+private:
+  static const size_t FEATURE_BYTES = (size_t)SOS_MODEL_FRAMES * MEL_BINS;
+
+  MelFeatureExtractor extractor;
+  NNInterpreter interpreter;
+  bool ready;
+
+  // Feature ring (oldest vector at ringHead once full)
+  int8_t ring[SOS_MODEL_FRAMES][MEL_BINS];
+  size_t ringHead;
+  size_t ringCount;
+  uint16_t hopsSinceInference;
+  uint16_t holdOffHops;      // After a detection
+  uint8_t consecutiveHits;
+  bool detection;
+
+  uint8_t lastScore;
+  uint32_t inferences;
+  uint32_t detections;
+  uint32_t inferenceCycles;
+  uint32_t maxInferenceCycles;
+
+  // Tensor arena: statically sized, planned by NNInterpreter::begin()
+  uint8_t arena[KWS_ARENA_SIZE];
+
+  void runInference();
+};
+
+#endif // KEYWORD_SPOTTER_H
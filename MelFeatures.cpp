@@ -0,0 +1,247 @@
+/*
+ * Streaming Log-Mel Front-End Implementation
+ */
+
+#include "MelFeatures.h"
+
+// log2 of the reference power in Q8: a full-scale sine (after pre-emphasis)
+// is stored at half scale, 16384, and the Hann window sums to 200, so its
+// peak bin has |X| = 16384 x 200 / 2 = 1638400 -> 2 log2(1638400) x 256
+#define MEL_FULL_SCALE_LOG2_Q8 10570
+
+// 2 x 10 log10(2) in Q16: log2 Q8 -> half-dB steps
+#define MEL_LOG2_TO_HALF_DB_Q16 1541
+
+// log2(1 + i / 32) in Q8, i = 0..32
+static const uint16_t LOG2_TABLE[33] = {
+  0, 11, 22, 33, 44, 54, 63, 73, 82, 92, 100, 109, 118, 126, 134, 142,
+  150, 157, 165, 172, 179, 186, 193, 200, 207, 213, 220, 226, 232, 238, 244, 250,
+  256
+};
+
+/**
+ * log2(x) in Q8 for x > 0
+ */
+static int32_t log2Q8(uint64_t x) {
+  int32_t msb = 63 - __builtin_clzll(x);
+  // 13-bit mantissa below the leading one: 5 bits of table index, 8 of interpolation
+  uint32_t mantissa = (msb >= 13) ? (uint32_t)(x >> (msb - 13)) : (uint32_t)(x << (13 - msb));
+  uint32_t fraction = mantissa & 0x1FFF;
+  uint32_t index = fraction >> 8;
+  uint32_t remainder = fraction & 0xFF;
+  int32_t value = LOG2_TABLE[index] + (((LOG2_TABLE[index + 1] - LOG2_TABLE[index]) * remainder) >> 8);
+  return msb * 256 + value;
+}
+
+static float hzToMel(float hz) {
+  return 2595.0f * log10f(1.0f + hz / 700.0f);
+}
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+MelFeatureExtractor::MelFeatureExtractor()
+  : lastInput(0),
+    hopFill(0),
+    cycles(0),
+    ready(false),
+    frameCycles(0),
+    maxFrameCycles(0),
+    frames(0) {
+  memset(window, 0, sizeof(window));
+  memset(twiddleCos, 0, sizeof(twiddleCos));
+  memset(twiddleSin, 0, sizeof(twiddleSin));
+  memset(binFilter, 0xFF, sizeof(binFilter));
+  memset(binWeight, 0, sizeof(binWeight));
+  memset(history, 0, sizeof(history));
+  memset(fftRe, 0, sizeof(fftRe));
+  memset(fftIm, 0, sizeof(fftIm));
+  memset(features, INT8_MIN, sizeof(features));
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void MelFeatureExtractor::begin() {
+  const float twoPi = 6.2831853f;
+
+  for (size_t n = 0; n < MEL_WINDOW_SIZE; n++) {
+    float w = 0.5f - 0.5f * cosf(twoPi * n / MEL_WINDOW_SIZE);
+    window[n] = (int16_t)min(32767L, lroundf(w * 32768.0f));
+  }
+
+  for (size_t k = 0; k < HALF_FFT; k++) {
+    float angle = twoPi * k / MEL_FFT_SIZE;
+    twiddleCos[k] = (int16_t)min(32767L, lroundf(cosf(angle) * 32768.0f));
+    twiddleSin[k] = (int16_t)min(32767L, lroundf(sinf(angle) * 32768.0f));
+  }
+
+  // MEL_BINS + 2 points evenly spaced in mel; filter j rises from point j
+  // to its peak at j + 1 and falls to j + 2. Each FFT bin lies between two
+  // points, so it feeds at most two filters.
+  float melLow = hzToMel(MEL_FREQ_LOW);
+  float melHigh = hzToMel(MEL_FREQ_HIGH);
+  float melStep = (melHigh - melLow) / (MEL_BINS + 1);
+  for (size_t k = 0; k < SPECTRUM_BINS; k++) {
+    float mel = hzToMel((float)k * MEL_SAMPLE_RATE / MEL_FFT_SIZE);
+    binFilter[k] = 0xFF;
+    binWeight[k] = 0;
+    if (mel <= melLow || mel >= melHigh) continue;
+    float position = (mel - melLow) / melStep;
+    uint8_t segment = (uint8_t)position;
+    binFilter[k] = segment;
+    binWeight[k] = (int16_t)min(32767L, lroundf((position - segment) * 32768.0f));
+  }
+
+  reset();
+}
+
+void MelFeatureExtractor::reset() {
+  memset(history, 0, sizeof(history));
+  lastInput = 0;
+  hopFill = 0;
+  cycles = 0;
+  ready = false;
+}
+
+// ============================================================================
+// PROCESSING
+// ============================================================================
+
+size_t MelFeatureExtractor::process(const int16_t* samples, size_t count) {
+  ready = false;
+  uint32_t start = hal::cycleCount();
+  size_t chunk = min(count, (size_t)MEL_HOP_SIZE - hopFill);
+
+  // y[n] = (x[n] - 0.97 x[n-1]) / 2: halved so high frequencies cannot clip
+  int16_t* out = &history[MEL_WINDOW_SIZE - MEL_HOP_SIZE + hopFill];
+  int32_t previous = lastInput;
+  for (size_t i = 0; i < chunk; i++) {
+    int32_t sample = samples[i];
+    out[i] = (int16_t)((sample * 32768 - previous * MEL_PREEMPHASIS_Q15) >> 16);
+    previous = sample;
+  }
+  lastInput = (int16_t)previous;
+  hopFill += chunk;
+
+  if (hopFill >= MEL_HOP_SIZE) {
+    computeFrame();
+    memmove(history, &history[MEL_HOP_SIZE], (MEL_WINDOW_SIZE - MEL_HOP_SIZE) * sizeof(int16_t));
+    hopFill = 0;
+    ready = true;
+
+    frameCycles = cycles + (hal::cycleCount() - start);
+    if (frameCycles > maxFrameCycles) maxFrameCycles = frameCycles;
+    frames++;
+    cycles = 0;
+  } else {
+    cycles += hal::cycleCount() - start;
+  }
+  return chunk;
+}
+
+void MelFeatureExtractor::computeFrame() {
+  // Window at full product precision, then pick a block exponent so the
+  // peak lands just under 2^13: quiet frames keep their resolution and the
+  // FFT cannot overflow. The product is recomputed rather than stored, to
+  // keep this off the capture task's stack.
+  uint32_t peak = 0;
+  for (size_t n = 0; n < MEL_WINDOW_SIZE; n++) {
+    int32_t product = (int32_t)history[n] * window[n];
+    uint32_t magnitude = (uint32_t)(product < 0 ? -product : product);
+    if (magnitude > peak) peak = magnitude;
+  }
+  if (peak == 0) {
+    memset(features, INT8_MIN, sizeof(features));
+    return;
+  }
+  int32_t rightShift = (32 - __builtin_clz(peak)) - 13;
+  if (rightShift < 0) rightShift = 0;
+  int32_t exponent = 15 - rightShift;  // Frame is scaled by 2^exponent
+
+  // Real 512-point FFT as a 256-point complex FFT of even/odd pairs
+  int16_t* re = fftRe;
+  int16_t* im = fftIm;
+  for (size_t m = 0; m < HALF_FFT; m++) {
+    size_t n = 2 * m;
+    re[m] = (n < MEL_WINDOW_SIZE) ? (int16_t)(((int32_t)history[n] * window[n]) >> rightShift) : 0;
+    im[m] = (n + 1 < MEL_WINDOW_SIZE) ? (int16_t)(((int32_t)history[n + 1] * window[n + 1]) >> rightShift) : 0;
+  }
+  fft(re, im);
+
+  // Split: X[k] = Fe[k] + W^k Fo[k] with W = exp(-j 2 pi / 512), then
+  // spread each bin's power over its (at most two) mel filters
+  uint64_t melEnergy[MEL_BINS];
+  memset(melEnergy, 0, sizeof(melEnergy));
+  for (size_t k = 1; k < HALF_FFT; k++) {
+    uint8_t segment = binFilter[k];
+    if (segment == 0xFF) continue;
+
+    size_t mirror = HALF_FFT - k;
+    int32_t evenRe = ((int32_t)re[k] + re[mirror]) >> 1;
+    int32_t evenIm = ((int32_t)im[k] - im[mirror]) >> 1;
+    int32_t oddRe = ((int32_t)im[k] + im[mirror]) >> 1;
+    int32_t oddIm = ((int32_t)re[mirror] - re[k]) >> 1;
+    int32_t c = twiddleCos[k];
+    int32_t s = twiddleSin[k];
+    int32_t xRe = evenRe + ((c * oddRe + s * oddIm) >> 15);
+    int32_t xIm = evenIm + ((c * oddIm - s * oddRe) >> 15);
+    uint64_t power = (uint64_t)((int64_t)xRe * xRe + (int64_t)xIm * xIm);
+
+    uint64_t upper = (power * (uint32_t)binWeight[k]) >> 15;
+    if (segment < MEL_BINS) melEnergy[segment] += upper;
+    if (segment > 0) melEnergy[segment - 1] += power - upper;
+  }
+
+  // The FFT halves every stage (/256): log2 P = log2 P' + 16 - 2 x exponent
+  int32_t offset = 16 * 256 - 2 * exponent * 256 - MEL_FULL_SCALE_LOG2_Q8;
+  for (size_t j = 0; j < MEL_BINS; j++) {
+    if (melEnergy[j] == 0) {
+      features[j] = INT8_MIN;
+      continue;
+    }
+    int32_t level = log2Q8(melEnergy[j]) + offset;
+    int32_t q = ((level * MEL_LOG2_TO_HALF_DB_Q16 + 32768) >> 16) + 127;
+    features[j] = (int8_t)max(-128, min(127, q));
+  }
+}
+
+/**
+ * In-place radix-2 decimation-in-time FFT, HALF_FFT points, Q15 twiddles.
+ * Each stage halves its outputs, so the result is DFT / HALF_FFT.
+ */
+void MelFeatureExtractor::fft(int16_t* re, int16_t* im) {
+  // Bit-reversed reorder
+  for (size_t i = 1, j = 0; i < HALF_FFT; i++) {
+    size_t bit = HALF_FFT >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) {
+      int16_t t = re[i]; re[i] = re[j]; re[j] = t;
+      t = im[i]; im[i] = im[j]; im[j] = t;
+    }
+  }
+
+  for (size_t size = 2; size <= HALF_FFT; size <<= 1) {
+    size_t half = size >> 1;
+    size_t step = MEL_FFT_SIZE / size;  // Twiddle stride in the 512-point table
+    for (size_t j = 0; j < half; j++) {
+      int32_t c = twiddleCos[j * step];
+      int32_t s = twiddleSin[j * step];
+      for (size_t i = j; i < HALF_FFT; i += size) {
+        size_t k = i + half;
+        // b x (c - j s)
+        int32_t tRe = (re[k] * c + im[k] * s + 16384) >> 15;
+        int32_t tIm = (im[k] * c - re[k] * s + 16384) >> 15;
+        int32_t aRe = re[i];
+        int32_t aIm = im[i];
+        re[i] = (int16_t)((aRe + tRe + 1) >> 1);
+        im[i] = (int16_t)((aIm + tIm + 1) >> 1);
+        re[k] = (int16_t)((aRe - tRe + 1) >> 1);
+        im[k] = (int16_t)((aIm - tIm + 1) >> 1);
+      }
+    }
+  }
+}
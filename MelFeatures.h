@@ -0,0 +1,102 @@
+/*
+ * Streaming Log-Mel Front-End for ESP32-C3 BEACON
+ * Keyword-spotting features computed on the watch, so the audio
+ * characteristic can carry features instead of audio
+ *
+ * Per 10 ms hop (160 samples at 16 kHz), over the last 25 ms (400 samples):
+ *   pre-emphasis (0.97) -> Hann window -> block-floating-point scaling ->
+ *   512-point real FFT (256-point complex Q15 FFT + split) -> power ->
+ *   40 triangular mel filters (20-7600 Hz) -> log2 -> int8
+ *
+ * Quantisation: q = 2 x dBFS + 127, clamped to int8 (0.5 dB steps,
+ * 127 = 0 dBFS, -128 = silence). 0 dBFS is the peak-bin power of a
+ * full-scale sine after pre-emphasis.
+ *
+ * Everything is fixed point; floats are only used once in begin() to
+ * build the tables (~3.5 KB RAM per extractor, tables and FFT scratch).
+ */
+
+#ifndef MEL_FEATURES_H
+#define MEL_FEATURES_H
+
+#include <Arduino.h>
+#include "Hal.h"
+
+#define MEL_SAMPLE_RATE 16000
+#define MEL_WINDOW_SIZE 400       // 25 ms analysis window
+#define MEL_HOP_SIZE 160          // 10 ms between feature frames
+#define MEL_FFT_SIZE 512
+#define MEL_BINS 40
+#define MEL_FREQ_LOW 20           // Hz
+#define MEL_FREQ_HIGH 7600        // Hz
+#define MEL_PREEMPHASIS_Q15 31785 // 0.97
+
+// ============================================================================
+// MEL FEATURE EXTRACTOR CLASS
+// ============================================================================
+
+class MelFeatureExtractor {
+public:
+  MelFeatureExtractor();
+
+  /**
+   * Build window, twiddle and filterbank tables
+   */
+  void begin();
+
+  /**
+   * Clear the analysis history (after a gap in the input)
+   */
+  void reset();
+
+  /**
+   * Feed samples up to the end of the current hop
+   * @return Samples consumed; check frameReady() after each call
+   */
+  size_t process(const int16_t* samples, size_t count);
+
+  /**
+   * True once per completed hop (cleared by the next process())
+   */
+  bool frameReady() const { return ready; }
+
+  /**
+   * Last feature frame (MEL_BINS int8 values)
+   */
+  const int8_t* getFrame() const { return features; }
+
+  // Cycle statistics
+  uint32_t getFrameCycles() const { return frameCycles; }
+  uint32_t getMaxFrameCycles() const { return maxFrameCycles; }
+  uint32_t getFrames() const { return frames; }
+
+private:
+  static const size_t HALF_FFT = MEL_FFT_SIZE / 2;
+  static const size_t SPECTRUM_BINS = HALF_FFT + 1;
+
+  // Tables (begin())
+  int16_t window[MEL_WINDOW_SIZE];  // Hann, Q15
+  int16_t twiddleCos[HALF_FFT];     // cos / sin(2 pi k / MEL_FFT_SIZE), Q15
+  int16_t twiddleSin[HALF_FFT];
+  uint8_t binFilter[SPECTRUM_BINS];   // Mel point below each FFT bin (0xFF = outside)
+  int16_t binWeight[SPECTRUM_BINS];   // Q15 share of the upper filter
+
+  // Streaming state
+  int16_t history[MEL_WINDOW_SIZE];  // Pre-emphasised input, oldest first
+  int16_t lastInput;                 // For pre-emphasis across calls
+  size_t hopFill;
+  uint32_t cycles;  // Spent on the current hop so far
+  bool ready;
+  int8_t features[MEL_BINS];
+  int16_t fftRe[HALF_FFT];  // FFT scratch (not on the capture task's stack)
+  int16_t fftIm[HALF_FFT];
+
+  uint32_t frameCycles;
+  uint32_t maxFrameCycles;
+  uint32_t frames;
+
+  void computeFrame();
+  void fft(int16_t* re, int16_t* im);
+};
+
+#endif // MEL_FEATURES_H
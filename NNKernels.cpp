@@ -0,0 +1,184 @@
+/*
+ * int8 Neural Network Kernels Implementation
+ */
+
+#include "NNKernels.h"
+
+// ============================================================================
+// REQUANTISATION
+// ============================================================================
+
+/**
+ * int32 accumulator -> int8 output: round(acc x multiplier / 2^(31 + shift))
+ * + zero point, clamped to the activation range
+ */
+static inline int8_t requantize(int32_t accumulator, const NNLayer& layer) {
+  int64_t product = (int64_t)accumulator * layer.outputMultiplier;
+  uint8_t shift = 31 + layer.outputShift;
+  int32_t value = (int32_t)((product + ((int64_t)1 << (shift - 1))) >> shift) + layer.outputZeroPoint;
+  if (value < layer.activationMin) value = layer.activationMin;
+  if (value > layer.activationMax) value = layer.activationMax;
+  return (int8_t)value;
+}
+
+// ============================================================================
+// KERNELS
+// ============================================================================
+
+NNShape nnOutputShape(const NNLayer& layer, const NNShape& input) {
+  NNShape output;
+  if (layer.type == NN_FULLY_CONNECTED) {
+    output.height = 1;
+    output.width = 1;
+    output.channels = layer.outputChannels;
+    return output;
+  }
+  if (input.height < layer.kernelHeight || input.width < layer.kernelWidth ||
+      layer.strideHeight == 0 || layer.strideWidth == 0) {
+    output.height = output.width = output.channels = 0;
+    return output;
+  }
+  output.height = (input.height - layer.kernelHeight) / layer.strideHeight + 1;
+  output.width = (input.width - layer.kernelWidth) / layer.strideWidth + 1;
+  output.channels = (layer.type == NN_DEPTHWISE_CONV2D) ? input.channels : layer.outputChannels;
+  return output;
+}
+
+void nnConv2D(const NNLayer& layer, const int8_t* input, const NNShape& inputShape,
+              int8_t* output, const NNShape& outputShape) {
+  const int32_t inputOffset = -layer.inputZeroPoint;
+  const size_t inputChannels = inputShape.channels;
+  const size_t rowStride = (size_t)inputShape.width * inputChannels;
+  const size_t kernelRow = (size_t)layer.kernelWidth * inputChannels;  // Contiguous in HWC
+  const size_t filterSize = layer.kernelHeight * kernelRow;
+
+  for (size_t oy = 0; oy < outputShape.height; oy++) {
+    for (size_t ox = 0; ox < outputShape.width; ox++) {
+      const int8_t* patch = input + (oy * layer.strideHeight) * rowStride + (ox * layer.strideWidth) * inputChannels;
+      for (size_t oc = 0; oc < outputShape.channels; oc++) {
+        const int8_t* filter = layer.weights + oc * filterSize;
+        int32_t accumulator = layer.bias ? layer.bias[oc] : 0;
+        for (size_t ky = 0; ky < layer.kernelHeight; ky++) {
+          const int8_t* row = patch + ky * rowStride;
+          const int8_t* weights = filter + ky * kernelRow;
+          for (size_t i = 0; i < kernelRow; i++) {
+            accumulator += (row[i] + inputOffset) * weights[i];
+          }
+        }
+        *output++ = requantize(accumulator, layer);
+      }
+    }
+  }
+}
+
+void nnDepthwiseConv2D(const NNLayer& layer, const int8_t* input, const NNShape& inputShape,
+                       int8_t* output, const NNShape& outputShape) {
+  const int32_t inputOffset = -layer.inputZeroPoint;
+  const size_t channels = inputShape.channels;
+  const size_t rowStride = (size_t)inputShape.width * channels;
+
+  for (size_t oy = 0; oy < outputShape.height; oy++) {
+    for (size_t ox = 0; ox < outputShape.width; ox++) {
+      const int8_t* patch = input + (oy * layer.strideHeight) * rowStride + (ox * layer.strideWidth) * channels;
+      for (size_t c = 0; c < channels; c++) {
+        int32_t accumulator = layer.bias ? layer.bias[c] : 0;
+        for (size_t ky = 0; ky < layer.kernelHeight; ky++) {
+          for (size_t kx = 0; kx < layer.kernelWidth; kx++) {
+            int32_t value = patch[ky * rowStride + kx * channels + c] + inputOffset;
+            accumulator += value * layer.weights[(ky * layer.kernelWidth + kx) * channels + c];
+          }
+        }
+        *output++ = requantize(accumulator, layer);
+      }
+    }
+  }
+}
+
+void nnFullyConnected(const NNLayer& layer, const int8_t* input, size_t inputSize,
+                      int8_t* output, size_t outputSize) {
+  const int32_t inputOffset = -layer.inputZeroPoint;
+  for (size_t o = 0; o < outputSize; o++) {
+    const int8_t* weights = layer.weights + o * inputSize;
+    int32_t accumulator = layer.bias ? layer.bias[o] : 0;
+    for (size_t i = 0; i < inputSize; i++) {
+      accumulator += (input[i] + inputOffset) * weights[i];
+    }
+    output[o] = requantize(accumulator, layer);
+  }
+}
+
+// ============================================================================
+// INTERPRETER
+// ============================================================================
+
+NNInterpreter::NNInterpreter()
+  : model(nullptr),
+    arena(nullptr),
+    arenaSize(0),
+    arenaPeak(0),
+    outputSize(0),
+    macs(0) {
+}
+
+bool NNInterpreter::begin(const NNModel* modelToRun, uint8_t* arenaMemory, size_t size) {
+  model = nullptr;
+  if (!modelToRun || !arenaMemory || modelToRun->numLayers == 0) return false;
+
+  // Walk the shapes once: every layer's input + output must fit together
+  NNShape shape = modelToRun->input;
+  size_t peak = shape.size();
+  uint32_t totalMacs = 0;
+  for (uint8_t i = 0; i < modelToRun->numLayers; i++) {
+    const NNLayer& layer = modelToRun->layers[i];
+    NNShape next = nnOutputShape(layer, shape);
+    if (next.size() == 0) return false;
+
+    size_t perOutput;
+    if (layer.type == NN_CONV2D) {
+      perOutput = (size_t)layer.kernelHeight * layer.kernelWidth * shape.channels;
+    } else if (layer.type == NN_DEPTHWISE_CONV2D) {
+      perOutput = (size_t)layer.kernelHeight * layer.kernelWidth;
+    } else {
+      perOutput = shape.size();
+    }
+    totalMacs += next.size() * perOutput;
+    peak = max(peak, shape.size() + next.size());
+    shape = next;
+  }
+  if (peak > size) return false;
+
+  model = modelToRun;
+  arena = arenaMemory;
+  arenaSize = size;
+  arenaPeak = peak;
+  outputSize = shape.size();
+  macs = totalMacs;
+  return true;
+}
+
+const int8_t* NNInterpreter::invoke() {
+  if (!model) return nullptr;
+
+  // Ping-pong: outputs alternate between the top and the bottom of the arena
+  int8_t* input = (int8_t*)arena;
+  NNShape shape = model->input;
+  bool outputAtTop = true;
+  for (uint8_t i = 0; i < model->numLayers; i++) {
+    const NNLayer& layer = model->layers[i];
+    NNShape next = nnOutputShape(layer, shape);
+    int8_t* output = outputAtTop ? (int8_t*)arena + arenaSize - next.size() : (int8_t*)arena;
+
+    if (layer.type == NN_CONV2D) {
+      nnConv2D(layer, input, shape, output, next);
+    } else if (layer.type == NN_DEPTHWISE_CONV2D) {
+      nnDepthwiseConv2D(layer, input, shape, output, next);
+    } else {
+      nnFullyConnected(layer, input, shape.size(), output, next.size());
+    }
+
+    input = output;
+    shape = next;
+    outputAtTop = !outputAtTop;
+  }
+  return input;
+}
@@ -0,0 +1,129 @@
+/*
+ * int8 Neural Network Kernels for ESP32-C3 BEACON
+ * Minimal inference runtime for small keyword-spotting models
+ *
+ * Quantisation follows the usual int8 scheme: activations are
+ * real = scale x (q - zeroPoint), weights are symmetric (zero point 0) with
+ * one scale per tensor, biases are int32 at inputScale x weightScale. Each
+ * layer requantises its int32 accumulators with a fixed-point multiplier
+ * (Q31, < 1) and a right shift, then clamps (ReLU = clamp at the zero point).
+ *
+ * Tensors are HWC int8, padding is VALID. Layouts:
+ *   CONV2D              weights [outC][kH][kW][inC]
+ *   DEPTHWISE_CONV2D    weights [kH][kW][C] (channel multiplier 1)
+ *   FULLY_CONNECTED     weights [out][in], input flattened HWC
+ *
+ * NNInterpreter runs a layer list in a caller-provided arena. Layer outputs
+ * alternate between the two ends of the arena (input at the low end), so
+ * peak use is the largest input + output pair; begin() checks it fits.
+ */
+
+#ifndef NN_KERNELS_H
+#define NN_KERNELS_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// MODEL DESCRIPTION
+// ============================================================================
+
+enum NNLayerType {
+  NN_CONV2D,
+  NN_DEPTHWISE_CONV2D,
+  NN_FULLY_CONNECTED
+};
+
+struct NNShape {
+  uint16_t height;
+  uint16_t width;
+  uint16_t channels;
+
+  size_t size() const { return (size_t)height * width * channels; }
+};
+
+struct NNLayer {
+  uint8_t type;            // NNLayerType
+  uint8_t kernelHeight;    // Convolutions only
+  uint8_t kernelWidth;
+  uint8_t strideHeight;
+  uint8_t strideWidth;
+  uint16_t outputChannels; // CONV2D / FULLY_CONNECTED (depthwise keeps its input's)
+  const int8_t* weights;
+  const int32_t* bias;     // One per output channel
+  int8_t inputZeroPoint;
+  int8_t outputZeroPoint;
+  int32_t outputMultiplier;  // Q31
+  uint8_t outputShift;       // Extra right shift after the multiplier
+  int8_t activationMin;
+  int8_t activationMax;
+};
+
+struct NNModel {
+  NNShape input;
+  float inputScale;
+  int8_t inputZeroPoint;
+  const NNLayer* layers;
+  uint8_t numLayers;
+  float outputScale;
+  int8_t outputZeroPoint;
+};
+
+// ============================================================================
+// KERNELS
+// ============================================================================
+
+/**
+ * Layer output shape for the given input (VALID padding)
+ */
+NNShape nnOutputShape(const NNLayer& layer, const NNShape& input);
+
+void nnConv2D(const NNLayer& layer, const int8_t* input, const NNShape& inputShape,
+              int8_t* output, const NNShape& outputShape);
+void nnDepthwiseConv2D(const NNLayer& layer, const int8_t* input, const NNShape& inputShape,
+                       int8_t* output, const NNShape& outputShape);
+void nnFullyConnected(const NNLayer& layer, const int8_t* input, size_t inputSize,
+                      int8_t* output, size_t outputSize);
+
+// ============================================================================
+// INTERPRETER
+// ============================================================================
+
+class NNInterpreter {
+public:
+  NNInterpreter();
+
+  /**
+   * Plan the model into arena
+   * @return false if a layer does not fit the arena or the shapes do not chain
+   */
+  bool begin(const NNModel* model, uint8_t* arena, size_t arenaSize);
+
+  /**
+   * Input tensor (model->input, HWC); fill before invoke()
+   */
+  int8_t* getInput() { return (int8_t*)arena; }
+
+  /**
+   * Run all layers
+   * @return Output tensor (valid until the input is refilled)
+   */
+  const int8_t* invoke();
+
+  size_t getOutputSize() const { return outputSize; }
+  float dequantize(int8_t value) const { return model->outputScale * (value - model->outputZeroPoint); }
+
+  // Arena use: peak bytes of any layer's input + output
+  size_t getArenaPeak() const { return arenaPeak; }
+  size_t getArenaSize() const { return arenaSize; }
+  uint32_t getMacsPerInference() const { return macs; }
+
+private:
+  const NNModel* model;
+  uint8_t* arena;
+  size_t arenaSize;
+  size_t arenaPeak;
+  size_t outputSize;
+  uint32_t macs;
+};
+
+#endif // NN_KERNELS_H
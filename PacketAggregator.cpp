@@ -0,0 +1,208 @@
+/*
+ * Packet Aggregator Implementation
+ */
+
+#include "PacketAggregator.h"
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+PacketAggregator::PacketAggregator()
+  : sender(nullptr),
+    senderContext(nullptr),
+    bundleSize(TLV_BUNDLE_MIN_SIZE),
+    used(0),
+    holdMs(0),
+    pendingSince(0),
+    pendingUrgent(false),
+    items(0),
+    fragmentedItems(0),
+    bundles(0),
+    valueBytes(0),
+    bundleBytes(0),
+    capacityBytes(0),
+    sendFailures(0) {
+}
+
+void PacketAggregator::setSender(BundleSender sender, void* context) {
+  this->sender = sender;
+  senderContext = context;
+}
+
+void PacketAggregator::setMTU(uint16_t mtu) {
+  size_t size = (mtu > 3) ? (size_t)(mtu - 3) : 0;
+  size = max((size_t)TLV_BUNDLE_MIN_SIZE, min(size, (size_t)TLV_BUNDLE_MAX_SIZE));
+  if (size == bundleSize) return;
+  if (used > size) flush();
+  bundleSize = size;
+}
+
+// ============================================================================
+// AGGREGATION
+// ============================================================================
+
+void PacketAggregator::append(uint8_t type, const uint8_t* value, size_t length) {
+  if (used == 0) pendingSince = millis();
+  if ((type & TLV_TYPE_MASK) != TLV_TYPE_AUDIO) pendingUrgent = true;
+  bundle[used] = type;
+  bundle[used + 1] = (uint8_t)length;
+  memcpy(bundle + used + TLV_HEADER_SIZE, value, length);
+  used += TLV_HEADER_SIZE + length;
+  valueBytes += length;
+}
+
+bool PacketAggregator::add(uint8_t type, const uint8_t* value, size_t length) {
+  if (length == 0) return true;
+  type &= TLV_TYPE_MASK;
+  items++;
+
+  // Fill the bundle, splitting the item where it runs out. After a failed
+  // notification mid-item the rest is dropped, so the receiver sees a
+  // broken chain rather than a spliced item.
+  bool sent = true;
+  size_t offset = 0;
+  uint8_t flags = 0;
+  while (offset < length) {
+    size_t space = bundleSize - used;
+    size_t rest = length - offset;
+    if (TLV_HEADER_SIZE + rest > space && space < TLV_HEADER_SIZE + TLV_MIN_FRAGMENT) {
+      if (!flush()) {
+        if (flags) return false;
+        sent = false;
+      }
+      continue;
+    }
+
+    size_t chunk = min(rest, space - TLV_HEADER_SIZE);
+    bool more = chunk < rest;
+    append(type | flags | (more ? TLV_FLAG_MORE : 0), value + offset, chunk);
+    offset += chunk;
+    if (more) {
+      if (!flags) fragmentedItems++;
+      flags = TLV_FLAG_CONTINUED;
+      if (!flush()) return false;
+    }
+  }
+  return sent;
+}
+
+bool PacketAggregator::poll() {
+  if (used == 0) return true;
+  if (!pendingUrgent && holdMs > 0 && millis() - pendingSince < holdMs) return true;
+  return flush();
+}
+
+bool PacketAggregator::flush() {
+  if (used == 0) return true;
+  bool sent = sender && sender(senderContext, bundle, used);
+  bundles++;
+  bundleBytes += used;
+  capacityBytes += bundleSize;
+  if (!sent) sendFailures++;
+  used = 0;
+  pendingUrgent = false;
+  return sent;
+}
+
+void PacketAggregator::discard() {
+  used = 0;
+  pendingUrgent = false;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void PacketAggregator::printStatistics() {
+  Serial.print(F("  TLV Bundles: "));
+  Serial.print(bundles);
+  Serial.print(F(" notifications for "));
+  Serial.print(items);
+  Serial.print(F(" items ("));
+  Serial.print(bundles > 0 ? (float)items / bundles : 0.0f, 2);
+  Serial.print(F(" items/notification, "));
+  Serial.print(fragmentedItems);
+  Serial.print(F(" fragmented, "));
+  Serial.print(bundleSize);
+  Serial.println(F("-byte bundles)"));
+  if (bundles > 0) {
+    Serial.print(F("  TLV Fill: "));
+    Serial.print(100.0f * bundleBytes / capacityBytes, 1);
+    Serial.print(F("% of bundle capacity, "));
+    Serial.print(100.0f * valueBytes / bundleBytes, 1);
+    Serial.print(F("% item data (Send failures: "));
+    Serial.print(sendFailures);
+    Serial.println(F(")"));
+  }
+}
+
+// ============================================================================
+// PACKET BUNDLE READER
+// ============================================================================
+
+PacketBundleReader::PacketBundleReader()
+  : handler(nullptr),
+    handlerContext(nullptr),
+    itemLength(0),
+    itemType(0),
+    items(0),
+    malformed(0),
+    brokenFragments(0) {
+}
+
+void PacketBundleReader::setHandler(BundleItemHandler handler, void* context) {
+  this->handler = handler;
+  handlerContext = context;
+}
+
+void PacketBundleReader::reset() {
+  itemLength = 0;
+  itemType = 0;
+}
+
+bool PacketBundleReader::read(const uint8_t* bundle, size_t length) {
+  size_t position = 0;
+  while (position < length) {
+    if (length - position < TLV_HEADER_SIZE || bundle[position + 1] == 0 ||
+        bundle[position + 1] > length - position - TLV_HEADER_SIZE) {
+      malformed++;
+      return false;
+    }
+    uint8_t flags = bundle[position] & ~TLV_TYPE_MASK;
+    uint8_t type = bundle[position] & TLV_TYPE_MASK;
+    const uint8_t* value = bundle + position + TLV_HEADER_SIZE;
+    size_t valueLength = bundle[position + 1];
+    position += TLV_HEADER_SIZE + valueLength;
+
+    // A chain must continue with its own fragments, and only a chain may
+    bool continued = (flags & TLV_FLAG_CONTINUED) != 0;
+    if (itemType != 0 && (!continued || type != itemType)) {
+      brokenFragments++;
+      reset();
+    }
+    if (continued && itemType == 0) {
+      brokenFragments++;
+      continue;
+    }
+
+    if (flags & (TLV_FLAG_MORE | TLV_FLAG_CONTINUED)) {
+      if (itemLength + valueLength > sizeof(item)) {
+        brokenFragments++;
+        reset();
+        continue;
+      }
+      memcpy(item + itemLength, value, valueLength);
+      itemLength += valueLength;
+      itemType = type;
+      if (flags & TLV_FLAG_MORE) continue;
+      value = item;
+      valueLength = itemLength;
+      reset();
+    }
+
+    items++;
+    if (handler) handler(handlerContext, type, value, valueLength);
+  }
+  return true;
+}
@@ -0,0 +1,186 @@
+/*
+ * Packet Aggregator for ESP32-C3 BEACON
+ * Packs queued items (alerts, heart rate, audio frames) into MTU-sized
+ * notifications with type-length-value framing
+ *
+ * One notification per DataPacket leaves most of a 247-byte MTU empty and
+ * spends a connection-event slot on every 1-byte heart rate. In TLV mode
+ * ("TX_FORMAT:TLV" on the control characteristic) BLEManager adds every
+ * dequeued item to a bundle and notifies the bundle on the audio
+ * characteristic when it is full, or at the end of the drain (poll()).
+ *
+ * Bundle layout: items back to back, each
+ *   [0]  type    TLV_TYPE_* in bits 0-5; fragments of a split item carry
+ *                bit 7 (TLV_FLAG_MORE) on all but the last and bit 6
+ *                (TLV_FLAG_CONTINUED) on all but the first
+ *   [1]  length  Value bytes in this item (1-255)
+ *   [2..] value  Alert string (no terminator), heart rate (BPM), or one
+ *                audio frame (AudioFrame.h)
+ *
+ * The bundle size follows the negotiated MTU (ATT payload = MTU - 3).
+ * Bundles are filled to the byte: an item that does not fit the space left
+ * is split, its first fragment ending this bundle and the rest starting the
+ * next (unless under TLV_MIN_FRAGMENT bytes would fit). Two 140-byte audio
+ * frames thus take 2 x 142 / 244 notifications instead of 2, and at the
+ * default MTU of 23 (20-byte payload) a frame spans 8 notifications. The
+ * fragments of one item are consecutive, so a receiver needs a single
+ * reassembly buffer (PacketBundleReader).
+ *
+ * A bundle holding only audio may wait up to the hold time for more frames
+ * (one capture block fills the rest); anything else is sent at the next
+ * poll(), i.e. in the drain that dequeued it.
+ */
+
+#ifndef PACKET_AGGREGATOR_H
+#define PACKET_AGGREGATOR_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// TLV FORMAT
+// ============================================================================
+
+#define TLV_HEADER_SIZE 2
+#define TLV_TYPE_ALERT 0x01
+#define TLV_TYPE_HEART_RATE 0x02
+#define TLV_TYPE_AUDIO 0x03
+#define TLV_TYPE_LOG_ALERT 0x04        // Logged while disconnected (StoreForward.h)
+#define TLV_TYPE_LOG_HEART_RATES 0x05  // Logged heart-rate batch (StoreForward.h)
+#define TLV_TYPE_MASK 0x3F
+#define TLV_FLAG_MORE 0x80        // Fragment: value continues in the next item
+#define TLV_FLAG_CONTINUED 0x40   // Fragment: continues the previous item
+
+#define TLV_MIN_FRAGMENT 8        // Smallest first fragment worth ending a bundle with
+#define TLV_BUNDLE_MIN_SIZE 20    // ATT payload at the default MTU (23 - 3)
+#define TLV_BUNDLE_MAX_SIZE 244   // ATT payload at BLE_REQUESTED_MTU (247 - 3)
+#define TLV_ITEM_MAX_SIZE 256     // Largest reassembled item (receiver)
+
+/**
+ * Notify one bundle
+ * @return false if the notification failed
+ */
+typedef bool (*BundleSender)(void* context, const uint8_t* bundle, size_t length);
+
+// ============================================================================
+// PACKET AGGREGATOR CLASS (sender)
+// ============================================================================
+
+class PacketAggregator {
+public:
+  PacketAggregator();
+
+  void setSender(BundleSender sender, void* context);
+
+  /**
+   * Bundle size from the negotiated MTU (ATT payload = MTU - 3, clamped to
+   * TLV_BUNDLE_MIN_SIZE..TLV_BUNDLE_MAX_SIZE). A pending bundle that no
+   * longer fits is sent first.
+   */
+  void setMTU(uint16_t mtu);
+  size_t getBundleSize() const { return bundleSize; }
+
+  /**
+   * How long a bundle holding only audio may wait for more (0 = never)
+   */
+  void setHoldTime(uint16_t ms) { holdMs = ms; }
+
+  /**
+   * Append one item; sends full bundles as it goes
+   * @param type TLV_TYPE_*
+   * @return false if a bundle notification failed
+   */
+  bool add(uint8_t type, const uint8_t* value, size_t length);
+
+  /**
+   * End of a drain: send the pending bundle unless it holds only audio
+   * for less than the hold time
+   * @return false if the notification failed
+   */
+  bool poll();
+
+  /**
+   * Send the pending bundle (if any)
+   * @return false if the notification failed
+   */
+  bool flush();
+
+  /**
+   * Drop the pending bundle (link lost)
+   */
+  void discard();
+
+  bool hasPending() const { return used > 0; }
+
+  // Statistics
+  uint32_t getItems() const { return items; }
+  uint32_t getFragmentedItems() const { return fragmentedItems; }
+  uint32_t getBundles() const { return bundles; }
+  uint32_t getSendFailures() const { return sendFailures; }
+  void printStatistics();
+
+private:
+  BundleSender sender;
+  void* senderContext;
+  uint8_t bundle[TLV_BUNDLE_MAX_SIZE];
+  size_t bundleSize;
+  size_t used;
+  uint16_t holdMs;
+  uint32_t pendingSince;  // millis() of the pending bundle's first item
+  bool pendingUrgent;     // Pending bundle holds more than audio
+
+  uint32_t items;
+  uint32_t fragmentedItems;  // Items split across bundles
+  uint32_t bundles;          // Notifications sent
+  uint64_t valueBytes;       // Item bytes carried
+  uint64_t bundleBytes;      // Notification bytes (values + TLV headers)
+  uint64_t capacityBytes;    // bundleSize per notification
+  uint32_t sendFailures;
+
+  void append(uint8_t type, const uint8_t* value, size_t length);
+};
+
+// ============================================================================
+// PACKET BUNDLE READER CLASS (reference receiver)
+// ============================================================================
+
+/**
+ * Item callback: type without fragment flags, value reassembled from its
+ * fragments. value is valid only during the call.
+ */
+typedef void (*BundleItemHandler)(void* context, uint8_t type, const uint8_t* value, size_t length);
+
+/**
+ * Splits received bundles back into items (host tools, gateway; mirrors
+ * what the phone app needs). A fragment chain broken by a lost
+ * notification is dropped, not delivered truncated.
+ */
+class PacketBundleReader {
+public:
+  PacketBundleReader();
+
+  void setHandler(BundleItemHandler handler, void* context);
+  void reset();
+
+  /**
+   * Parse one notification
+   * @return false if it was malformed (items before the error are delivered)
+   */
+  bool read(const uint8_t* bundle, size_t length);
+
+  uint32_t getItems() const { return items; }
+  uint32_t getMalformed() const { return malformed; }
+  uint32_t getBrokenFragments() const { return brokenFragments; }
+
+private:
+  BundleItemHandler handler;
+  void* handlerContext;
+  uint8_t item[TLV_ITEM_MAX_SIZE];
+  size_t itemLength;
+  uint8_t itemType;  // Type of the fragment chain in progress (0 = none)
+
+  uint32_t items;
+  uint32_t malformed;
+  uint32_t brokenFragments;
+};
+
+#endif // PACKET_AGGREGATOR_H
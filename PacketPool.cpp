@@ -0,0 +1,147 @@
+/*
+ * Packet Buffer Pools Implementation
+ */
+
+#include "PacketPool.h"
+#include "Hal.h"
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+PacketPool::PacketPool()
+  : storage(nullptr),
+    numSlots(0),
+    slotSize(0),
+    head(0),
+    tail(0),
+    exhaustedCount(0),
+    misorderedCount(0) {
+}
+
+PacketPool::~PacketPool() {
+  free(storage);
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+bool PacketPool::begin(size_t slots, size_t size) {
+  end();
+  if (slots == 0 || slots > PACKET_POOL_MAX_SLOTS || size == 0) return false;
+
+  // Allocated once at boot; slots are never freed while running
+  storage = (uint8_t*)malloc(slots * size);
+  if (!storage) return false;
+
+  numSlots = slots;
+  slotSize = size;
+  head = 0;
+  tail = 0;
+  return true;
+}
+
+void PacketPool::end() {
+  free(storage);
+  storage = nullptr;
+  numSlots = 0;
+  slotSize = 0;
+  head = 0;
+  tail = 0;
+}
+
+// ============================================================================
+// SLOT MANAGEMENT
+// ============================================================================
+
+uint8_t PacketPool::acquire() {
+  if (!storage || (uint32_t)(head - tail) >= numSlots) {
+    exhaustedCount++;
+    return PACKET_POOL_NONE;
+  }
+  return (uint8_t)(head % numSlots);
+}
+
+bool PacketPool::release(uint8_t slot) {
+  if (slot == PACKET_POOL_NONE) return true;
+  if (head == tail || slot != tail % numSlots) {
+    misorderedCount++;
+    return false;
+  }
+  tail++;
+  return true;
+}
+
+// ============================================================================
+// BLOCK POOL
+// ============================================================================
+
+BlockPool::BlockPool()
+  : storage(nullptr),
+    inUseMask(0),
+    numBlocks(0),
+    blockSize(0),
+    freeCount(0),
+    exhaustedCount(0),
+    invalidReleaseCount(0) {
+}
+
+BlockPool::~BlockPool() {
+  free(storage);
+}
+
+bool BlockPool::begin(size_t blocks, size_t size) {
+  end();
+  if (blocks == 0 || blocks > PACKET_POOL_MAX_SLOTS || size == 0) return false;
+
+  // Allocated once at boot, like PacketPool
+  storage = (uint8_t*)malloc(blocks * size);
+  if (!storage) return false;
+
+  numBlocks = blocks;
+  blockSize = size;
+  // Lowest handles on top, so a lightly used pool keeps touching the same blocks
+  for (size_t i = 0; i < blocks; i++) {
+    freeList[i] = (uint8_t)(blocks - 1 - i);
+  }
+  freeCount = blocks;
+  inUseMask = 0;
+  return true;
+}
+
+void BlockPool::end() {
+  free(storage);
+  storage = nullptr;
+  numBlocks = 0;
+  blockSize = 0;
+  freeCount = 0;
+  inUseMask = 0;
+}
+
+uint8_t BlockPool::acquire() {
+  hal::enterCritical();
+  if (freeCount == 0) {
+    exhaustedCount++;
+    hal::exitCritical();
+    return PACKET_POOL_NONE;
+  }
+  uint8_t block = freeList[--freeCount];
+  inUseMask |= (1UL << block);
+  hal::exitCritical();
+  return block;
+}
+
+bool BlockPool::release(uint8_t block) {
+  if (block == PACKET_POOL_NONE) return true;
+  hal::enterCritical();
+  if (block >= numBlocks || !(inUseMask & (1UL << block))) {
+    invalidReleaseCount++;
+    hal::exitCritical();
+    return false;
+  }
+  inUseMask &= ~(1UL << block);
+  freeList[freeCount++] = block;
+  hal::exitCritical();
+  return true;
+}
@@ -0,0 +1,142 @@
+/*
+ * Packet Buffer Pools for ESP32-C3 BEACON
+ * Fixed-size transmit buffers handed out by a one-byte slot handle
+ *
+ * Two block classes back DataScheduler, so no queue carries payload bytes:
+ * - PacketPool: MTU-sized audio frames (FIFO ring, below)
+ * - BlockPool:  small control payloads - alerts and heart rate (free list)
+ *
+ * The audio encoder writes its frame straight into a pooled buffer; only the
+ * slot handle travels through DataScheduler to the BLE notify call, which
+ * releases it.
+ *
+ * Slots are used as a FIFO ring: one producer (audio capture) takes the next
+ * slot and publishes it when the frame is queued, one consumer (BLE) releases
+ * slots in the order they were queued. Each side writes only its own index,
+ * so no lock or queue operation is needed on either side.
+ */
+
+#ifndef PACKET_POOL_H
+#define PACKET_POOL_H
+
+#include <Arduino.h>
+
+#define PACKET_POOL_NONE 0xFF    // "No slot" handle
+#define PACKET_POOL_MAX_SLOTS 32
+
+// ============================================================================
+// PACKET POOL CLASS
+// ============================================================================
+
+class PacketPool {
+public:
+  PacketPool();
+  ~PacketPool();
+
+  /**
+   * Allocate slot storage
+   * @param numSlots Buffers in the pool (max PACKET_POOL_MAX_SLOTS)
+   * @param slotSize Bytes per buffer
+   */
+  bool begin(size_t numSlots, size_t slotSize);
+
+  /**
+   * Free slot storage (begin() may be called again)
+   */
+  void end();
+
+  /**
+   * Producer: next free slot to fill (stays free until publish())
+   * @return Slot handle, or PACKET_POOL_NONE if every slot is in flight
+   */
+  uint8_t acquire();
+
+  /**
+   * Producer: mark the acquired slot in flight; call before handing the
+   * handle to the consumer. unpublish() takes it back if the hand-off failed.
+   */
+  void publish() { head++; }
+  void unpublish() { head--; }
+
+  /**
+   * Consumer: return the oldest in-flight slot
+   * @return false if slot is not the oldest in-flight slot (ignored)
+   */
+  bool release(uint8_t slot);
+
+  uint8_t* getBuffer(uint8_t slot) { return storage + (size_t)slot * slotSize; }
+  size_t getSlotSize() const { return slotSize; }
+  size_t getSlotCount() const { return numSlots; }
+  size_t getFreeCount() const { return numSlots - (uint32_t)(head - tail); }
+  size_t getMemoryUsage() const { return numSlots * slotSize; }
+
+  uint32_t getExhaustedCount() const { return exhaustedCount; }
+  uint32_t getMisorderedCount() const { return misorderedCount; }
+
+private:
+  uint8_t* storage;
+  size_t numSlots;
+  size_t slotSize;
+  volatile uint32_t head;  // Slots published (producer only)
+  volatile uint32_t tail;  // Slots released (consumer only)
+  uint32_t exhaustedCount;   // acquire() calls that found no free slot
+  uint32_t misorderedCount;  // release() calls out of FIFO order
+};
+
+// ============================================================================
+// BLOCK POOL CLASS
+// ============================================================================
+
+// Any-order slab of small fixed blocks. Allocation pops and release pushes a
+// free-list stack of slot handles (O(1), no search, no memset). Alerts are
+// raised from loop() and from the NimBLE host task (TRIGGER_FALL write), so
+// acquire() and release() touch the free list inside a HAL critical section.
+class BlockPool {
+public:
+  BlockPool();
+  ~BlockPool();
+
+  /**
+   * Allocate block storage
+   * @param numBlocks Blocks in the pool (max PACKET_POOL_MAX_SLOTS)
+   * @param blockSize Bytes per block
+   */
+  bool begin(size_t numBlocks, size_t blockSize);
+
+  /**
+   * Free block storage (begin() may be called again)
+   */
+  void end();
+
+  /**
+   * @return Block handle, or PACKET_POOL_NONE if every block is in use
+   */
+  uint8_t acquire();
+
+  /**
+   * Return a block (PACKET_POOL_NONE is ignored)
+   * @return false if the handle is out of range or already free (ignored)
+   */
+  bool release(uint8_t block);
+
+  uint8_t* getBuffer(uint8_t block) { return storage + (size_t)block * blockSize; }
+  size_t getBlockSize() const { return blockSize; }
+  size_t getBlockCount() const { return numBlocks; }
+  size_t getFreeCount() const { return freeCount; }
+  size_t getMemoryUsage() const { return numBlocks * (blockSize + 1); }
+
+  uint32_t getExhaustedCount() const { return exhaustedCount; }
+  uint32_t getInvalidReleaseCount() const { return invalidReleaseCount; }
+
+private:
+  uint8_t* storage;
+  uint8_t freeList[PACKET_POOL_MAX_SLOTS];  // Free handles, top at freeCount - 1
+  uint32_t inUseMask;                       // Bit per block, catches double release
+  size_t numBlocks;
+  size_t blockSize;
+  size_t freeCount;
+  uint32_t exhaustedCount;       // acquire() calls that found no free block
+  uint32_t invalidReleaseCount;  // release() of a free or unknown block
+};
+
+#endif // PACKET_POOL_H
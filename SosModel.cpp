@@ -0,0 +1,84 @@
+/*
+ * SOS Keyword Model (hand-set template weights, see SosModel.h)
+ *
+ * Quantisation: conv weights 1/30 per 127, depthwise 1/4 per 127, FC
+ * 1/16 per 127; activations 0.25 dB steps (zero point -128) between layers,
+ * logits 0.1 per step.
+ */
+
+#include "SosModel.h"
+
+// ============================================================================
+// WEIGHTS
+// ============================================================================
+
+// Filters: [0] tilt above +28 dB (fricative), [1] high band above 5 dB,
+// [2] tilt below -18 dB (voiced), [3] low band level. Levels are dB above
+// -63.5 dBFS; each filter averages 3 frames of bins 30-39 (4-7.6 kHz)
+// and / or 4-13 (300-1000 Hz).
+static const int8_t CONV_WEIGHTS[480] = {
+  0, 0, 0, 0, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127,
+  0, 0, 0, 0, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127,
+  0, 0, 0, 0, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127,
+  0, 0, 0, 0, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127,
+  0, 0, 0, 0, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127,
+  0, 0, 0, 0, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -127, -127, -127, -127, -127, -127, -127, -127, -127, -127,
+  0, 0, 0, 0, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static const int32_t CONV_BIAS[4] = {
+  -213360, -38100, -137160, 0
+};
+
+// Mean of 4 steps per channel
+static const int8_t DEPTHWISE_WEIGHTS[16] = {
+  127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127
+};
+
+// [0] background: bias only (the detection threshold); [1] SOS: +fricative
+// -voiced in steps 1-3 and 9-10, +voiced -fricative in steps 5-7
+static const int8_t FC_WEIGHTS[96] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 127, 64, -127, -64, 127, 64, -127, -64, 127, 64, -127, -64, 0, 0, 0, 0, -127, -64, 127, 64,
+  -127, -64, 127, 64, -127, -64, 127, 64, 0, 0, 0, 0, 127, 64, -127, -64, 127, 64, -127, -64, 0, 0, 0, 0
+};
+
+static const int32_t FC_BIAS[2] = {
+  50800, 0
+};
+
+// ============================================================================
+// MODEL
+// ============================================================================
+
+//   type, kH, kW, sH, sW, outC, weights, bias, inZP, outZP, multiplier, shift, actMin, actMax
+static const NNLayer SOS_LAYERS[3] = {
+  { NN_CONV2D, 3, MEL_BINS, 2, 1, 4, CONV_WEIGHTS, CONV_BIAS, 0, -128, 1154342916, 10, -128, 127 },
+  { NN_DEPTHWISE_CONV2D, 4, 1, 4, 1, 0, DEPTHWISE_WEIGHTS, nullptr, -128, -128, 1082196484, 8, -128, 127 },
+  { NN_FULLY_CONNECTED, 0, 0, 0, 0, 2, FC_WEIGHTS, FC_BIAS, -128, 0, 1352745605, 9, -128, 127 }
+};
+
+const NNModel sosModel = {
+  { SOS_MODEL_FRAMES, MEL_BINS, 1 },
+  0.5f, 0,
+  SOS_LAYERS, 3,
+  0.1f, 0
+};
@@ -0,0 +1,34 @@
+/*
+ * SOS Keyword Model for ESP32-C3 BEACON
+ * int8 model run by KeywordSpotter (NNKernels.h)
+ *
+ * Input: SOS_MODEL_FRAMES x MEL_BINS log-mel vectors (MelFeatures.h, about
+ * 1 s), oldest first, used as-is (scale 0.5 dB, zero point 0).
+ * Output: two logits, [SOS_CLASS_BACKGROUND, SOS_CLASS_SOS].
+ *
+ *   CONV2D 3x40 stride 2x1, 4 ch, ReLU  ->  48 x 1 x 4
+ *   DEPTHWISE 4x1 stride 4x1, ReLU      ->  12 x 1 x 4  (80 ms steps)
+ *   FULLY_CONNECTED 48 -> 2
+ *
+ * The weights are a hand-set template, not a trained network: the
+ * convolution measures spectral tilt (fricative vs. voiced) and band
+ * loudness per frame pair, and the fully-connected layer scores the
+ * "S - O - S" sequence (hiss, vowel, hiss) across the 12 steps against a
+ * fixed background logit. A trained export with the same input drops in
+ * by replacing SosModel.cpp; until then AUDIO_SOS_KEYWORD stays false so
+ * the placeholder cannot raise SOS_VOICE alerts.
+ */
+
+#ifndef SOS_MODEL_H
+#define SOS_MODEL_H
+
+#include "NNKernels.h"
+#include "MelFeatures.h"
+
+#define SOS_MODEL_FRAMES 97       // 10 ms hops (~1 s of audio)
+#define SOS_CLASS_BACKGROUND 0
+#define SOS_CLASS_SOS 1
+
+extern const NNModel sosModel;
+
+#endif // SOS_MODEL_H
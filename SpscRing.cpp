@@ -0,0 +1,86 @@
+/*
+ * SPSC Ring Implementation
+ */
+
+#include "SpscRing.h"
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+SpscRing::SpscRing()
+  : storage(nullptr),
+    slots(0),
+    itemSize(0),
+    head(0),
+    tail(0) {
+}
+
+SpscRing::~SpscRing() {
+  destroy();
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+bool SpscRing::create(size_t length, size_t itemSize) {
+  if (length == 0 || itemSize == 0) return false;
+  destroy();
+
+  storage = (uint8_t*)malloc((length + 1) * itemSize);
+  if (!storage) return false;
+
+  slots = length + 1;
+  this->itemSize = itemSize;
+  head.store(0, std::memory_order_relaxed);
+  tail.store(0, std::memory_order_relaxed);
+  return true;
+}
+
+void SpscRing::destroy() {
+  free(storage);
+  storage = nullptr;
+  slots = 0;
+}
+
+// ============================================================================
+// PRODUCER / CONSUMER
+// ============================================================================
+
+bool SpscRing::send(const void* item) {
+  if (!storage) return false;
+  uint32_t index = head.load(std::memory_order_relaxed);
+  uint32_t following = next(index);
+  if (following == tail.load(std::memory_order_acquire)) return false;  // Full
+
+  memcpy(storage + (size_t)index * itemSize, item, itemSize);
+  head.store(following, std::memory_order_release);  // Publishes the item
+  return true;
+}
+
+bool SpscRing::receive(void* item) {
+  if (!storage) return false;
+  uint32_t index = tail.load(std::memory_order_relaxed);
+  if (index == head.load(std::memory_order_acquire)) return false;  // Empty
+
+  memcpy(item, storage + (size_t)index * itemSize, itemSize);
+  tail.store(next(index), std::memory_order_release);  // Frees the slot
+  return true;
+}
+
+bool SpscRing::peek(void* item) {
+  if (!storage) return false;
+  uint32_t index = tail.load(std::memory_order_relaxed);
+  if (index == head.load(std::memory_order_acquire)) return false;
+
+  memcpy(item, storage + (size_t)index * itemSize, itemSize);
+  return true;
+}
+
+size_t SpscRing::count() const {
+  if (!storage) return 0;
+  uint32_t written = head.load(std::memory_order_acquire);
+  uint32_t read = tail.load(std::memory_order_acquire);
+  return (written >= read) ? written - read : slots - read + written;
+}
@@ -0,0 +1,76 @@
+/*
+ * SPSC Ring for ESP32-C3 BEACON
+ * Lock-free single-producer / single-consumer ring of fixed-size items
+ *
+ * Replaces a FreeRTOS queue where exactly one context sends and one
+ * receives (audio capture -> BLE, heart rate -> BLE): no critical section,
+ * no task switch, no scheduler call, so send() and receive() may run in an
+ * ISR as well as in a task. Items are copied in and out (DataScheduler
+ * carries 8-byte PacketRefs).
+ *
+ * Indices: the producer writes only head, the consumer only tail; one
+ * storage slot stays empty so head == tail means empty without a shared
+ * counter. Release / acquire ordering on the index publishes the item
+ * before the index that makes it visible (a compiler barrier on the
+ * single-core ESP32-C3, real fences on a multi-core host). Indices are
+ * only loaded and stored, never read-modify-written, so no atomic
+ * instructions are needed (RV32IMC has none).
+ *
+ * Non-blocking only: a consumer that wants to wait polls.
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <Arduino.h>
+#include <atomic>
+
+class SpscRing {
+public:
+  SpscRing();
+  ~SpscRing();
+
+  /**
+   * Allocate storage (at boot; not while the ring is in use)
+   * @param length Items the ring holds
+   * @param itemSize Bytes per item
+   */
+  bool create(size_t length, size_t itemSize);
+  void destroy();
+  bool isValid() const { return storage != nullptr; }
+
+  /**
+   * Producer: copy item in
+   * @return false if the ring is full
+   */
+  bool send(const void* item);
+
+  /**
+   * Consumer: copy the oldest item out and remove it
+   * @return false if the ring is empty
+   */
+  bool receive(void* item);
+
+  /**
+   * Consumer: copy the oldest item out, leaving it queued
+   * @return false if the ring is empty
+   */
+  bool peek(void* item);
+
+  /**
+   * Items queued (exact from either side; a snapshot from a third context)
+   */
+  size_t count() const;
+  size_t capacity() const { return slots > 0 ? slots - 1 : 0; }
+
+private:
+  uint8_t* storage;
+  size_t slots;     // length + 1
+  size_t itemSize;
+  std::atomic<uint32_t> head;  // Next slot to write (producer only)
+  std::atomic<uint32_t> tail;  // Next slot to read (consumer only)
+
+  uint32_t next(uint32_t index) const { return (index + 1 == slots) ? 0 : index + 1; }
+};
+
+#endif // SPSC_RING_H
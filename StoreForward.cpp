@@ -0,0 +1,236 @@
+/*
+ * Store and Forward Implementation
+ */
+
+#include "StoreForward.h"
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+StoreForward::StoreForward()
+  : sender(nullptr),
+    senderContext(nullptr),
+    hrCount(0),
+    hrBatchStart(0),
+    credit(0),
+    lastRefillUs(0),
+    alertsLogged(false),
+    storedAlerts(0),
+    storedHeartRates(0),
+    storeFailures(0),
+    replayedAlerts(0),
+    backfillRecords(0),
+    backfillBytes(0),
+    backfillBundles(0),
+    backfillFailures(0),
+    backfillMs(0),
+    backfillStart(0),
+    backfilling(false) {
+}
+
+bool StoreForward::begin() {
+  if (!log.begin(STORE_FORWARD_LOG_BYTES)) return false;
+  alertsLogged = log.getPendingCount() > 0;  // Alerts from an earlier boot
+  return true;
+}
+
+void StoreForward::setSender(BundleSender sender, void* context) {
+  this->sender = sender;
+  senderContext = context;
+}
+
+// ============================================================================
+// LINK DOWN
+// ============================================================================
+
+void StoreForward::store(DataScheduler& scheduler) {
+  if (!log.isReady()) return;
+  endBackfill();
+
+  DataPacket packet;
+  while (scheduler.takeControlPacket(packet)) {
+    const uint8_t* data = scheduler.getPacketData(packet);
+    if (packet.type == DATA_ALERT) {
+      flushHeartRates();  // Earlier readings first
+      if (log.append(TLV_TYPE_LOG_ALERT, data, packet.dataSize, packet.timestamp)) {
+        storedAlerts++;
+        alertsLogged = true;
+        Serial.print(F("[StoreForward] Logged ALERT: "));
+        Serial.write(data, packet.dataSize);
+        Serial.println();
+      } else {
+        storeFailures++;
+      }
+    } else {
+      if (hrCount > 0 && packet.timestamp - hrBatchStart > STORE_FORWARD_HR_BATCH_MS) flushHeartRates();
+      if (hrCount == 0) hrBatchStart = packet.timestamp;
+      uint16_t offset = (uint16_t)(packet.timestamp - hrBatchStart);
+      uint8_t* entry = hrBatch + hrCount * STORE_FORWARD_HR_ENTRY;
+      entry[0] = data[0];
+      entry[1] = (uint8_t)offset;
+      entry[2] = (uint8_t)(offset >> 8);
+      hrCount++;
+      storedHeartRates++;
+      if (hrCount == STORE_FORWARD_HR_BATCH) flushHeartRates();
+    }
+    scheduler.releasePacket(packet);
+  }
+
+  if (hrCount > 0 && millis() - hrBatchStart >= STORE_FORWARD_HR_BATCH_MS) flushHeartRates();
+}
+
+bool StoreForward::flushHeartRates() {
+  if (hrCount == 0) return true;
+  bool logged = log.append(TLV_TYPE_LOG_HEART_RATES, hrBatch, hrCount * STORE_FORWARD_HR_ENTRY, hrBatchStart);
+  if (!logged) storeFailures++;
+  hrCount = 0;
+  return logged;
+}
+
+// ============================================================================
+// LINK UP
+// ============================================================================
+
+void StoreForward::replayAlerts(DataScheduler& scheduler) {
+  if (!log.isReady() || !alertsLogged) return;
+
+  size_t room = max(scheduler.getCriticalQueueSize() / 2, (size_t)1);
+  bool queueFull = false;
+  char text[MAX_ALERT_SIZE];
+  FlashLogRecord record;
+  while (log.next(record)) {
+    if (record.type != TLV_TYPE_LOG_ALERT) continue;
+    if (scheduler.getCriticalQueueCount() >= room) {
+      queueFull = true;  // The rest next pass
+      break;
+    }
+    size_t length = min((size_t)record.length, sizeof(text) - 1);
+    memcpy(text, record.data, length);
+    text[length] = '\0';
+    if (!scheduler.enqueueAlert(text)) {
+      queueFull = true;
+      break;
+    }
+    // A failed mark leaves the record pending: backfill sends it as well
+    if (log.forward(record)) replayedAlerts++;
+  }
+  log.rewind();
+  if (!queueFull) alertsLogged = false;
+}
+
+void StoreForward::backfill(DataScheduler& scheduler, uint16_t mtu) {
+  if (!log.isReady() || !sender || alertsLogged) return;
+  flushHeartRates();  // Readings batched before the reconnect
+
+  uint32_t nowUs = micros();
+  if (log.getPendingCount() == 0) {
+    endBackfill();
+    lastRefillUs = nowUs;
+    return;
+  }
+
+  size_t bundleSize = (mtu > 3) ? min((size_t)(mtu - 3), (size_t)TLV_BUNDLE_MAX_SIZE) : 0;
+  if (bundleSize < STORE_FORWARD_MIN_BUNDLE) return;  // Before the MTU exchange
+
+  if (!backfilling) {
+    backfilling = true;
+    backfillStart = millis();
+    lastRefillUs = nowUs;
+    credit = (int32_t)bundleSize;  // The first bundle goes at once
+  }
+  uint64_t refill = (uint64_t)(nowUs - lastRefillUs) * BLE_BACKFILL_RATE / 1000000;
+  credit = (int32_t)min((uint64_t)credit + refill, (uint64_t)bundleSize);
+  if (refill > 0) lastRefillUs = nowUs;
+
+  uint32_t now = millis();
+  uint8_t bundle[TLV_BUNDLE_MAX_SIZE];
+  while (credit > 0) {
+    // Whole records only, oldest first, up to the bundle size and the credit
+    size_t limit = min(bundleSize, (size_t)credit);
+    size_t used = 0;
+    uint32_t records = 0;
+    FlashLogRecord record;
+    while (used + TLV_HEADER_SIZE + STORE_FORWARD_AGE_SIZE < limit &&
+           log.next(record, limit - used - TLV_HEADER_SIZE - STORE_FORWARD_AGE_SIZE)) {
+      uint32_t age = (record.boot == log.getBootId()) ? now - record.timestamp : STORE_FORWARD_AGE_UNKNOWN;
+      uint8_t* item = bundle + used;
+      item[0] = record.type;
+      item[1] = (uint8_t)(STORE_FORWARD_AGE_SIZE + record.length);
+      item[2] = (uint8_t)age;
+      item[3] = (uint8_t)(age >> 8);
+      item[4] = (uint8_t)(age >> 16);
+      item[5] = (uint8_t)(age >> 24);
+      memcpy(item + TLV_HEADER_SIZE + STORE_FORWARD_AGE_SIZE, record.data, record.length);
+      used += TLV_HEADER_SIZE + STORE_FORWARD_AGE_SIZE + record.length;
+      records++;
+    }
+    if (records == 0 || !scheduler.trySendBackfill(used)) {
+      log.rewind();
+      break;
+    }
+    if (!sender(senderContext, bundle, used)) {
+      backfillFailures++;
+      log.rewind();
+      break;
+    }
+    bool committed = log.commit();
+    credit -= (int32_t)used;
+    backfillRecords += records;
+    backfillBytes += used;
+    backfillBundles++;
+    if (!committed) break;  // Sent, but still pending in flash: sent again later
+  }
+
+  if (log.getPendingCount() == 0) {
+    endBackfill();
+    Serial.print(F("[StoreForward] Backfill complete: "));
+    Serial.print(backfillRecords);
+    Serial.println(F(" records forwarded"));
+  }
+}
+
+void StoreForward::endBackfill() {
+  if (!backfilling) return;
+  backfillMs += millis() - backfillStart;
+  backfilling = false;
+}
+
+uint32_t StoreForward::getBackfillMs() const {
+  return backfillMs + (backfilling ? millis() - backfillStart : 0);
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+void StoreForward::printStatistics() {
+  if (!log.isReady()) return;
+  Serial.print(F("  Stored: "));
+  Serial.print(storedAlerts);
+  Serial.print(F(" alerts, "));
+  Serial.print(storedHeartRates);
+  Serial.print(F(" heart rates (Failures: "));
+  Serial.print(storeFailures);
+  Serial.print(F("), "));
+  Serial.print(replayedAlerts);
+  Serial.println(F(" alerts replayed"));
+  log.printStatistics();
+
+  uint32_t ms = getBackfillMs();
+  Serial.print(F("  Backfill: "));
+  Serial.print(backfillRecords);
+  Serial.print(F(" records, "));
+  Serial.print(backfillBytes);
+  Serial.print(F(" bytes in "));
+  Serial.print(backfillBundles);
+  Serial.print(F(" notifications over "));
+  Serial.print(ms / 1000.0f, 1);
+  Serial.print(F(" s ("));
+  Serial.print(ms > 0 ? backfillBytes * 1000.0f / ms : 0.0f, 0);
+  Serial.print(F(" B/s, "));
+  Serial.print(ms > 0 ? backfillRecords * 1000.0f / ms : 0.0f, 1);
+  Serial.print(F(" records/s, Send failures: "));
+  Serial.print(backfillFailures);
+  Serial.println(F(")"));
+}
@@ -0,0 +1,139 @@
+/*
+ * Store and Forward for ESP32-C3 BEACON
+ * Keeps alerts and heart rate while BLE is down in the flash log
+ * (FlashLog.h) and streams them back after a reconnect
+ *
+ * Link down (BLEManager::processDataQueue()): store() takes every queued
+ * alert and heart rate out of DataScheduler instead of letting them
+ * overflow their queues. An alert is logged at once (one flash write);
+ * heart rates are batched in RAM, STORE_FORWARD_HR_BATCH readings or
+ * STORE_FORWARD_HR_BATCH_MS per record, so 1 Hz readings do not cost a
+ * 12-byte header each. A batch is logged before an alert to keep the log
+ * in time order. Audio is not logged.
+ *
+ * Link up: replayAlerts() puts logged alerts back in the critical queue,
+ * oldest first, up to half its size per pass (the rest is left for live
+ * alerts), so they go out on the alert characteristic like live ones,
+ * through AlertTracker in ACK mode. A replayed record is marked forwarded
+ * once it is queued; if the link drops again before it is sent, store()
+ * logs it anew.
+ *
+ * backfill() runs after the live drain, once every logged alert has been
+ * replayed and only while the live queues are empty, and sends the rest
+ * of the log (heart rate) oldest first as TLV bundles
+ * (PacketAggregator.h framing, no fragments) on the log characteristic.
+ * It is paced twice: its own BLE_BACKFILL_RATE token bucket, and the
+ * link budget at PRIORITY_BACKFILL (DataScheduler::trySendBackfill()), so
+ * live alerts, heart rate and audio keep their share. Records are marked
+ * forwarded once their notification is accepted; a failed one is read
+ * again next time.
+ *
+ * Backfill items (value = 4-byte age + logged payload, little-endian):
+ *   TLV_TYPE_LOG_HEART_RATES  [age ms u32]{[bpm][offset ms u16]} x n
+ *   TLV_TYPE_LOG_ALERT        [age ms u32][alert string]
+ *                             (only an alert whose forwarded mark failed
+ *                             to write after it was replayed)
+ * age: ms from the (first) reading to the send, 0xFFFFFFFF for records
+ * from an earlier boot (millis() restarted); heart-rate offsets are from
+ * the first reading of the batch.
+ * The largest item (70 bytes) must fit one bundle: backfill waits for the
+ * MTU exchange (ATT payload >= STORE_FORWARD_MIN_BUNDLE).
+ */
+
+#ifndef STORE_FORWARD_H
+#define STORE_FORWARD_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "DataScheduler.h"
+#include "FlashLog.h"
+#include "PacketAggregator.h"
+
+#define STORE_FORWARD_AGE_SIZE 4
+#define STORE_FORWARD_AGE_UNKNOWN 0xFFFFFFFFUL  // Logged in an earlier boot
+#define STORE_FORWARD_HR_ENTRY 3                // [bpm][offset ms u16]
+#define STORE_FORWARD_MIN_BUNDLE (TLV_HEADER_SIZE + STORE_FORWARD_AGE_SIZE + FLASH_LOG_MAX_PAYLOAD)
+
+class StoreForward {
+public:
+  StoreForward();
+
+  /**
+   * Mount the flash log (STORE_FORWARD_LOG_BYTES)
+   * @return false without flash: store() and backfill() do nothing
+   */
+  bool begin();
+  bool isReady() const { return log.isReady(); }
+
+  /**
+   * Notifies one backfill bundle (the log characteristic)
+   */
+  void setSender(BundleSender sender, void* context);
+
+  /**
+   * Link down: move queued alerts and heart rates to the log
+   */
+  void store(DataScheduler& scheduler);
+
+  /**
+   * Link up: queue logged alerts for the alert characteristic (first)
+   */
+  void replayAlerts(DataScheduler& scheduler);
+
+  /**
+   * Link up, alerts replayed, live queues drained: send logged records
+   * within both budgets
+   * @param mtu Negotiated MTU (bundle size = MTU - 3)
+   */
+  void backfill(DataScheduler& scheduler, uint16_t mtu);
+
+  /**
+   * Records not forwarded yet (including heart rates still batched in RAM)
+   */
+  uint32_t getBacklog() const { return log.getPendingCount() + (hrCount > 0 ? 1 : 0); }
+
+  const FlashLog& getLog() const { return log; }
+
+  // Statistics
+  uint32_t getStoredAlerts() const { return storedAlerts; }
+  uint32_t getStoredHeartRates() const { return storedHeartRates; }
+  uint32_t getStoreFailures() const { return storeFailures; }
+  uint32_t getReplayedAlerts() const { return replayedAlerts; }
+  uint32_t getBackfillRecords() const { return backfillRecords; }
+  uint32_t getBackfillBytes() const { return backfillBytes; }
+  uint32_t getBackfillMs() const;  // Time with a backlog while connected
+  void printStatistics();
+
+private:
+  FlashLog log;
+  BundleSender sender;
+  void* senderContext;
+
+  // Heart rates not logged yet
+  uint8_t hrBatch[STORE_FORWARD_HR_BATCH * STORE_FORWARD_HR_ENTRY];
+  uint8_t hrCount;
+  uint32_t hrBatchStart;  // millis() of the first reading
+
+  // Backfill pacing (bytes, refilled at BLE_BACKFILL_RATE up to one bundle)
+  int32_t credit;
+  uint32_t lastRefillUs;
+
+  bool alertsLogged;  // The log may hold alerts not replayed yet
+
+  uint32_t storedAlerts;
+  uint32_t storedHeartRates;
+  uint32_t storeFailures;   // Flash writes that failed (record lost)
+  uint32_t replayedAlerts;
+  uint32_t backfillRecords;
+  uint32_t backfillBytes;   // Notification payload bytes
+  uint32_t backfillBundles;
+  uint32_t backfillFailures;
+  uint32_t backfillMs;      // Closed backfill periods
+  uint32_t backfillStart;   // millis() of the open period
+  bool backfilling;
+
+  bool flushHeartRates();
+  void endBackfill();
+};
+
+#endif // STORE_FORWARD_H
@@ -0,0 +1,170 @@
+/*
+ * Voice Activity Detector Implementation
+ */
+
+#include "VoiceActivity.h"
+
+// dB (power) -> log2 Q8: x 256 / 3.0103
+#define VAD_DB_TO_Q8(db) ((int32_t)(db) * 85)
+
+/**
+ * log2(x) in Q8 for x > 0 (linear between powers of two, < 0.09 error)
+ */
+static int32_t log2Q8(uint64_t x) {
+  if (x == 0) return 0;
+  int32_t msb = 63 - __builtin_clzll(x);
+  uint32_t fraction = (msb >= 8) ? (uint32_t)(x >> (msb - 8)) : (uint32_t)(x << (8 - msb));
+  return msb * 256 + (int32_t)(fraction & 0xFF);
+}
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+VoiceActivityDetector::VoiceActivityDetector()
+  : attackSamples(0),
+    hangoverSamples(0),
+    noiseWindowSamples(1),
+    minimumNoiseLevel(log2Q8((uint64_t)VAD_MIN_NOISE_RMS * VAD_MIN_NOISE_RMS)),
+    noiseFlatnessQ8(log2Q8(VAD_NOISE_FLATNESS_PERCENT * 256) - log2Q8(100 * 256)),
+    blocks(0),
+    activeBlocks(0),
+    transitions(0),
+    blockCycles(0),
+    maxBlockCycles(0) {
+  reset();
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void VoiceActivityDetector::begin(uint32_t sampleRate) {
+  attackSamples = (uint32_t)VAD_ATTACK_MS * sampleRate / 1000;
+  hangoverSamples = (uint32_t)VAD_HANGOVER_MS * sampleRate / 1000;
+  noiseWindowSamples = (uint32_t)VAD_NOISE_WINDOW_MS * sampleRate / 1000;
+  reset();
+}
+
+void VoiceActivityDetector::reset() {
+  memset(noiseMinima, 0, sizeof(noiseMinima));
+  noiseIndex = 0;
+  windowMinimum = INT32_MAX;
+  windowFill = 0;
+  noiseLevel = minimumNoiseLevel;
+  primed = false;
+  snrQ8 = 0;
+  flatnessQ8 = 0;
+  zeroCrossingPercent = 0;
+  speechBlock = false;
+  active = false;
+  onsetSamples = 0;
+  hangoverLeft = 0;
+}
+
+// ============================================================================
+// CLASSIFICATION
+// ============================================================================
+
+bool VoiceActivityDetector::process(const int16_t* samples, size_t count, const AudioBlockStats& stats) {
+  if (count == 0) return active;
+  uint32_t start = hal::cycleCount();
+
+  // Mean power per sample, log2 Q8
+  int32_t level = log2Q8(stats.energy / count + 1);
+  trackNoise(level, count);
+  snrQ8 = level - noiseLevel;
+  zeroCrossingPercent = (uint8_t)min((uint32_t)100, (uint32_t)(stats.zeroCrossings * 100 / count));
+  flatnessQ8 = spectralFlatness(samples, count);
+
+  bool noiseLike = (flatnessQ8 > noiseFlatnessQ8) && (zeroCrossingPercent > VAD_NOISE_ZCR_PERCENT);
+  speechBlock = (snrQ8 >= VAD_DB_TO_Q8(VAD_SNR_DB)) && !noiseLike;
+
+  // Attack: consecutive speech before switching on; hangover: time since
+  // the last speech block before switching off
+  bool wasActive = active;
+  if (speechBlock) {
+    onsetSamples += count;
+    if (active || onsetSamples >= attackSamples) {
+      active = true;
+      hangoverLeft = hangoverSamples;
+    }
+  } else {
+    onsetSamples = 0;
+    if (hangoverLeft > count) {
+      hangoverLeft -= count;
+    } else {
+      hangoverLeft = 0;
+      active = false;
+    }
+  }
+  if (active != wasActive) transitions++;
+
+  blocks++;
+  if (active) activeBlocks++;
+  blockCycles = hal::cycleCount() - start;
+  if (blockCycles > maxBlockCycles) maxBlockCycles = blockCycles;
+  return active;
+}
+
+void VoiceActivityDetector::trackNoise(int32_t level, size_t count) {
+  // Start from the first block rather than from silence
+  if (!primed) {
+    for (uint8_t i = 0; i < VAD_NOISE_WINDOWS; i++) noiseMinima[i] = level;
+    primed = true;
+  }
+
+  if (level < windowMinimum) windowMinimum = level;
+  windowFill += count;
+  if (windowFill >= noiseWindowSamples) {
+    noiseMinima[noiseIndex] = windowMinimum;
+    noiseIndex = (noiseIndex + 1) % VAD_NOISE_WINDOWS;
+    windowMinimum = INT32_MAX;
+    windowFill = 0;
+  }
+
+  // Floor = lowest level over the window history and the open sub-window
+  int32_t floor = windowMinimum;
+  for (uint8_t i = 0; i < VAD_NOISE_WINDOWS; i++) {
+    if (noiseMinima[i] < floor) floor = noiseMinima[i];
+  }
+  noiseLevel = max(floor, minimumNoiseLevel);
+}
+
+int32_t VoiceActivityDetector::spectralFlatness(const int16_t* samples, size_t count) {
+  // 8-point Walsh-Hadamard transform of each 8-sample group; band energy is
+  // the sum of one coefficient's squares. Band order does not matter here
+  uint64_t bands[VAD_WALSH_BANDS] = { 0 };
+  for (size_t g = 0; g + VAD_WALSH_BANDS <= count; g += VAD_WALSH_BANDS) {
+    const int16_t* x = samples + g;
+    int32_t a0 = x[0] + x[1], a1 = x[0] - x[1], a2 = x[2] + x[3], a3 = x[2] - x[3];
+    int32_t a4 = x[4] + x[5], a5 = x[4] - x[5], a6 = x[6] + x[7], a7 = x[6] - x[7];
+    int32_t b0 = a0 + a2, b1 = a0 - a2, b2 = a1 + a3, b3 = a1 - a3;
+    int32_t b4 = a4 + a6, b5 = a4 - a6, b6 = a5 + a7, b7 = a5 - a7;
+    int32_t c[VAD_WALSH_BANDS] = { b0 + b4, b0 - b4, b1 + b5, b1 - b5, b2 + b6, b2 - b6, b3 + b7, b3 - b7 };
+    for (uint8_t i = 0; i < VAD_WALSH_BANDS; i++) {
+      bands[i] += (uint64_t)((int64_t)c[i] * c[i]);
+    }
+  }
+
+  // log2 of geometric mean - log2 of arithmetic mean
+  int32_t logSum = 0;
+  uint64_t total = 0;
+  for (uint8_t i = 0; i < VAD_WALSH_BANDS; i++) {
+    logSum += log2Q8(bands[i] + 1);
+    total += bands[i];
+  }
+  return logSum / VAD_WALSH_BANDS - log2Q8(total / VAD_WALSH_BANDS + 1);
+}
+
+// ============================================================================
+// FEATURE ACCESS
+// ============================================================================
+
+int16_t VoiceActivityDetector::getNoiseFloorRms() const {
+  return (int16_t)min(32767.0f, sqrtf(exp2f(noiseLevel / 256.0f)));
+}
+
+uint8_t VoiceActivityDetector::getFlatnessPercent() const {
+  return (uint8_t)min(100.0f, 100.0f * exp2f(flatnessQ8 / 256.0f));
+}
@@ -0,0 +1,116 @@
+/*
+ * Voice Activity Detector for ESP32-C3 BEACON
+ * Multi-feature VAD with attack and hangover timers
+ *
+ * Each block is scored on three features:
+ * - Energy against a tracked noise floor. The floor is the minimum block
+ *   level over the last VAD_NOISE_WINDOWS x VAD_NOISE_WINDOW_MS (minimum
+ *   statistics), so it follows a fan or a busy room within ~2 s while
+ *   syllable gaps keep it from rising into speech. Being a minimum, it sits
+ *   a little below the noise mean; VAD_SNR_DB includes that margin.
+ * - Zero-crossing rate (crossings per 100 samples): voiced speech is low,
+ *   hiss and broadband noise high.
+ * - Spectral flatness of 8 Walsh-Hadamard sequency bands (8-sample groups,
+ *   adds only): geometric / arithmetic mean of the band energies. White
+ *   noise is flat (1.0), speech is concentrated in the lowest bands.
+ *
+ * A block is speech if it is VAD_SNR_DB above the floor and not noise-like
+ * (flat AND high ZCR). The detector switches on after VAD_ATTACK_MS of
+ * consecutive speech blocks (clicks do not count) and off VAD_HANGOVER_MS
+ * after the last one (syllable gaps and trailing consonants stay active).
+ *
+ * Energy and zero crossings come from the encoder's fused pass
+ * (AudioBlockStats); only the flatness reads the samples again.
+ */
+
+#ifndef VOICE_ACTIVITY_H
+#define VOICE_ACTIVITY_H
+
+#include <Arduino.h>
+#include "Hal.h"
+#include "ADPCMCodec.h"  // AudioBlockStats
+
+#define VAD_SNR_DB 12                // Block level above the noise floor
+#define VAD_MIN_NOISE_RMS 60        // Floor never assumed below this (mic self-noise)
+#define VAD_NOISE_WINDOW_MS 500     // Minimum-statistics sub-window
+#define VAD_NOISE_WINDOWS 4         // Sub-windows in the floor (2 s)
+#define VAD_NOISE_FLATNESS_PERCENT 50  // Flatter than this ...
+#define VAD_NOISE_ZCR_PERCENT 25       // ... and crossing more than this = noise
+#define VAD_ATTACK_MS 32            // Speech blocks needed to switch on
+#define VAD_HANGOVER_MS 400         // Stay on this long after the last speech block
+#define VAD_WALSH_BANDS 8
+
+// ============================================================================
+// VOICE ACTIVITY DETECTOR CLASS
+// ============================================================================
+
+class VoiceActivityDetector {
+public:
+  VoiceActivityDetector();
+
+  /**
+   * Set the timers for the sample rate and restart
+   */
+  void begin(uint32_t sampleRate);
+  void reset();
+
+  /**
+   * Classify one block
+   * @param stats Energy / zero crossings of the same samples (encoder pass)
+   * @return isActive() after this block
+   */
+  bool process(const int16_t* samples, size_t count, const AudioBlockStats& stats);
+
+  bool isActive() const { return active; }
+  bool isSpeechBlock() const { return speechBlock; }  // Last block, before attack / hangover
+
+  // Features of the last block
+  float getSnrDb() const { return snrQ8 * 3.0103f / 256; }
+  int16_t getNoiseFloorRms() const;
+  uint8_t getZeroCrossingPercent() const { return zeroCrossingPercent; }
+  uint8_t getFlatnessPercent() const;
+
+  // Statistics
+  uint32_t getBlocks() const { return blocks; }
+  uint32_t getActiveBlocks() const { return activeBlocks; }
+  uint32_t getTransitions() const { return transitions; }
+  uint32_t getBlockCycles() const { return blockCycles; }
+  uint32_t getMaxBlockCycles() const { return maxBlockCycles; }
+
+private:
+  // Timers (samples)
+  uint32_t attackSamples;
+  uint32_t hangoverSamples;
+  uint32_t noiseWindowSamples;
+  int32_t minimumNoiseLevel;  // VAD_MIN_NOISE_RMS as log2 power, Q8
+  int32_t noiseFlatnessQ8;    // VAD_NOISE_FLATNESS_PERCENT as log2, Q8
+
+  // Noise floor: level minima (log2 power, Q8) of the last sub-windows
+  int32_t noiseMinima[VAD_NOISE_WINDOWS];
+  uint8_t noiseIndex;
+  int32_t windowMinimum;
+  uint32_t windowFill;
+  int32_t noiseLevel;
+  bool primed;
+
+  // State
+  int32_t snrQ8;
+  int32_t flatnessQ8;  // log2(flatness), Q8 (<= 0)
+  uint8_t zeroCrossingPercent;
+  bool speechBlock;
+  bool active;
+  uint32_t onsetSamples;
+  uint32_t hangoverLeft;
+
+  // Statistics
+  uint32_t blocks;
+  uint32_t activeBlocks;
+  uint32_t transitions;
+  uint32_t blockCycles;
+  uint32_t maxBlockCycles;
+
+  void trackNoise(int32_t level, size_t count);
+  int32_t spectralFlatness(const int16_t* samples, size_t count);
+};
+
+#endif // VOICE_ACTIVITY_H
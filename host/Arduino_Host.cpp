@@ -0,0 +1,68 @@
+/*
+ * Host implementations of the Arduino core globals (Serial, Wire)
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <stdio.h>
+#include "HalHost.h"
+
+HardwareSerial Serial;
+TwoWire Wire;
+
+namespace {
+bool serialMuted = false;
+}
+
+namespace hal {
+namespace host {
+
+void muteSerial(bool mute) {
+  serialMuted = mute;
+}
+
+}  // namespace host
+}  // namespace hal
+
+void HardwareSerial::flush() {
+  fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (serialMuted) return 1;
+  return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (serialMuted) return size;
+  return fwrite(buffer, 1, size, stdout);
+}
+
+size_t HardwareSerial::print(const char* s) {
+  return write((const uint8_t*)s, strlen(s));
+}
+
+size_t HardwareSerial::print(char c) {
+  return write((uint8_t)c);
+}
+
+size_t HardwareSerial::print(long long n, int base) {
+  if (base == DEC) {
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%lld", n);
+    return print(buffer);
+  }
+  return print((unsigned long long)n, base);
+}
+
+size_t HardwareSerial::print(unsigned long long n, int base) {
+  char buffer[24];
+  snprintf(buffer, sizeof(buffer), (base == HEX) ? "%llX" : "%llu", n);
+  return print(buffer);
+}
+
+size_t HardwareSerial::print(double n, int digits) {
+  char buffer[48];
+  snprintf(buffer, sizeof(buffer), "%.*f", digits, n);
+  return print(buffer);
+}
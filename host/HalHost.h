@@ -0,0 +1,105 @@
+/*
+ * Host HAL backend - mock controls
+ * Lets host programs script the clock, microphone, GPIO and I2C bus,
+ * and observe every BLE notification the firmware sends.
+ */
+
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#include "Hal.h"
+
+namespace hal {
+namespace host {
+
+// ============================================================================
+// CLOCK
+// ============================================================================
+
+/**
+ * Manual clock: millis()/micros() only move when advanced explicitly and
+ * delayMs() advances instead of sleeping (deterministic, faster than real time)
+ * Default is the real monotonic clock.
+ */
+void useManualClock(bool manual);
+void advanceMicros(uint64_t us);
+
+// ============================================================================
+// I2S SOURCE
+// ============================================================================
+
+/**
+ * Microphone source callback
+ * @return number of samples written (0 = no data available)
+ * With no source installed, i2sRead() returns silence paced at the
+ * configured sample rate.
+ */
+typedef size_t (*I2SSource)(int16_t* samples, size_t maxSamples, void* context);
+void setI2SSource(I2SSource source, void* context);
+uint32_t getI2SSampleRate();
+
+// ============================================================================
+// GPIO / I2C
+// ============================================================================
+
+void setGpioLevel(uint8_t pin, int level);  // Default: HIGH (pull-up)
+
+void clearI2CDevices();
+void addI2CDevice(uint8_t address);  // Default bus: MAX30105, BNO085, VCNL4040
+
+// ============================================================================
+// BLE NOTIFICATIONS
+// ============================================================================
+
+typedef void (*NotifyHook)(const char* uuid, const uint8_t* data, size_t length, void* context);
+void setNotifyHook(NotifyHook hook, void* context);
+uint32_t getNotifyCount();
+
+/**
+ * BLE link model: the stack buffers up to bufferPackets notifications and
+ * every intervalUs a connection event sends bytesPerEvent of them (payload
+ * + 7 bytes ATT/L2CAP header each). A notification that finds the buffers
+ * full fails like NimBLE's (onStatus ERROR_GATT, BLE_HS_ENOMEM; bleNotify()
+ * returns false) and never reaches the notify hook.
+ * intervalUs = 0 (default): every notification goes out.
+ */
+void setLinkModel(uint32_t intervalUs, uint16_t bytesPerEvent, uint8_t bufferPackets);
+uint32_t getNotifyFailures();
+
+/**
+ * Link model: no connection events for the next stallUs (interference,
+ * central busy); buffered notifications wait, new ones fill the buffers
+ */
+void stallLink(uint32_t stallUs);
+
+// ============================================================================
+// FLASH
+// ============================================================================
+
+struct FlashStats {
+  uint64_t bytesWritten;    // Programmed through flashWrite()
+  uint64_t bytesRead;
+  uint32_t writes;
+  uint32_t sectorErases;
+  uint32_t bitViolations;   // Written bits that needed an erase (0 -> 1): firmware bug
+  uint32_t minSectorErases; // Over the image's sectors (wear spread)
+  uint32_t maxSectorErases;
+};
+
+/**
+ * Data partition size (default 896 kB); blank (0xFF) again from the next
+ * flashBegin(). The image survives flashBegin() otherwise, like a reboot.
+ */
+void setFlashSize(size_t size);
+FlashStats getFlashStats();
+
+// ============================================================================
+// SERIAL
+// ============================================================================
+
+void muteSerial(bool mute);
+
+}  // namespace host
+}  // namespace hal
+
+#endif // HAL_HOST_H
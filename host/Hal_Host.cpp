@@ -0,0 +1,561 @@
+/*
+ * Hardware Abstraction Layer - Linux host backend
+ * Mock clock, scripted I2S microphone, virtual GPIO/I2C bus,
+ * std::mutex-based queues, a NOR flash image in RAM and recorded BLE
+ * notifications.
+ */
+
+#include "HalHost.h"
+#include <NimBLEDevice.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+namespace hal {
+
+namespace {
+
+typedef std::chrono::steady_clock SteadyClock;
+
+const SteadyClock::time_point startTime = SteadyClock::now();
+bool manualClock = false;
+uint64_t manualMicros = 0;
+
+uint64_t nowMicros() {
+  if (manualClock) return manualMicros;
+  return std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - startTime).count();
+}
+
+// I2S state
+bool i2sActive = false;
+uint32_t i2sSampleRate = 0;
+uint64_t i2sStartMicros = 0;
+uint64_t i2sSamplesDelivered = 0;
+uint16_t i2sDmaBufLen = 0;
+uint8_t i2sDmaBufCount = 0;
+uint32_t i2sPendingOverruns = 0;
+host::I2SSource i2sSource = nullptr;
+void* i2sSourceContext = nullptr;
+
+// GPIO / I2C state
+int gpioLevels[32] = {};
+bool gpioLevelsInitialized = false;
+std::vector<uint8_t> i2cDevices = {0x57, 0x4A, 0x60};
+
+// Flash image: NOR semantics (erase -> 0xFF, writes clear bits)
+size_t flashSize = 0xE0000;  // "Huge APP" scheme: 896 kB SPIFFS partition
+std::vector<uint8_t> flashImage;
+std::vector<uint32_t> flashSectorErases;
+host::FlashStats flashStats = {};
+
+// Critical section: one lock for every caller, like the target spinlock
+std::recursive_mutex criticalMutex;
+
+// BLE state
+host::NotifyHook notifyHook = nullptr;
+void* notifyHookContext = nullptr;
+uint32_t notifyCount = 0;
+uint32_t notifyFailures = 0;
+thread_local NimBLECharacteristic* notifying = nullptr;  // As on target: the sending task only
+thread_local bool notifyFailed = false;
+
+// BLE link model: notifications wait in the stack's buffers until a
+// connection event has room for them (linkIntervalUs = 0: no model)
+uint32_t linkIntervalUs = 0;
+uint16_t linkBytesPerEvent = 0;
+uint8_t linkBufferPackets = 0;
+uint64_t linkNextEventUs = 0;
+std::deque<uint16_t> linkBuffered;  // On-air bytes of each buffered notification
+
+const uint16_t LINK_PACKET_OVERHEAD = 7;  // ATT opcode + handle, L2CAP header
+const int BLE_HS_ENOMEM = 6;
+
+// Connection events since the last call each send linkBytesPerEvent bytes
+// of buffered notifications (whole notifications; unused airtime is lost)
+void drainLink() {
+  uint64_t now = nowMicros();
+  while (linkNextEventUs <= now) {
+    if (linkBuffered.empty()) {
+      uint64_t events = (now - linkNextEventUs) / linkIntervalUs + 1;
+      linkNextEventUs += events * linkIntervalUs;
+      break;
+    }
+    uint32_t airtime = linkBytesPerEvent;
+    while (!linkBuffered.empty() && linkBuffered.front() <= airtime) {
+      airtime -= linkBuffered.front();
+      linkBuffered.pop_front();
+    }
+    linkNextEventUs += linkIntervalUs;
+  }
+}
+
+// Paced silence emulates dmaBufCount DMA buffers: when the reader falls
+// behind, the oldest whole buffers are dropped and reported as overruns
+void emulateDmaOverrun() {
+  if (i2sDmaBufLen == 0) return;
+  uint64_t due = (nowMicros() - i2sStartMicros) * i2sSampleRate / 1000000;
+  uint64_t backlog = (due > i2sSamplesDelivered) ? (due - i2sSamplesDelivered) : 0;
+  uint64_t capacity = (uint64_t)i2sDmaBufCount * i2sDmaBufLen;
+  if (backlog > capacity) {
+    uint64_t lostBuffers = (backlog - capacity + i2sDmaBufLen - 1) / i2sDmaBufLen;
+    i2sSamplesDelivered += lostBuffers * i2sDmaBufLen;
+    i2sPendingOverruns += (uint32_t)lostBuffers;
+  }
+}
+
+struct HostQueue {
+  std::mutex mutex;
+  std::condition_variable notEmpty;
+  std::condition_variable notFull;
+  std::deque<std::vector<uint8_t>> items;
+  size_t length;
+  size_t itemSize;
+};
+
+}  // namespace
+
+// ============================================================================
+// CLOCK
+// ============================================================================
+
+uint32_t millis() {
+  return (uint32_t)(nowMicros() / 1000);
+}
+
+uint32_t micros() {
+  return (uint32_t)nowMicros();
+}
+
+void delayMs(uint32_t ms) {
+  if (manualClock) {
+    manualMicros += (uint64_t)ms * 1000;
+  } else {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  }
+}
+
+uint32_t cycleCount() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      SteadyClock::now().time_since_epoch()).count();
+}
+
+uint32_t cpuFrequencyMHz() {
+  return 1000;  // cycleCount() ticks in ns
+}
+
+uint32_t random32() {
+  static std::random_device device;
+  return device();
+}
+
+// ============================================================================
+// GPIO
+// ============================================================================
+
+void gpioInputPullup(uint8_t pin) {
+  if (pin < 32) gpioLevels[pin] = 1;
+}
+
+int gpioRead(uint8_t pin) {
+  if (!gpioLevelsInitialized) {
+    for (int& level : gpioLevels) level = 1;
+    gpioLevelsInitialized = true;
+  }
+  return (pin < 32) ? gpioLevels[pin] : 0;
+}
+
+// ============================================================================
+// I2C
+// ============================================================================
+
+bool i2cBegin(uint8_t sdaPin, uint8_t sclPin, uint32_t clockHz) {
+  (void)sdaPin;
+  (void)sclPin;
+  (void)clockHz;
+  return true;
+}
+
+void i2cSetClock(uint32_t clockHz) {
+  (void)clockHz;
+}
+
+bool i2cProbe(uint8_t address) {
+  for (uint8_t device : i2cDevices) {
+    if (device == address) return true;
+  }
+  return false;
+}
+
+// ============================================================================
+// I2S
+// ============================================================================
+
+bool i2sBegin(const I2SConfig& config) {
+  i2sActive = true;
+  i2sSampleRate = config.sampleRate;
+  i2sStartMicros = nowMicros();
+  i2sSamplesDelivered = 0;
+  i2sDmaBufLen = config.dmaBufLen;
+  i2sDmaBufCount = config.dmaBufCount;
+  i2sPendingOverruns = 0;
+  return true;
+}
+
+void i2sEnd() {
+  i2sActive = false;
+}
+
+bool i2sRead(int16_t* samples, size_t maxSamples, size_t& samplesRead, uint32_t timeoutMs) {
+  samplesRead = 0;
+  if (!i2sActive) return false;
+
+  // Scripted source: as fast as the caller can consume
+  if (i2sSource) {
+    samplesRead = i2sSource(samples, maxSamples, i2sSourceContext);
+    return true;
+  }
+
+  // No source: silence paced at the configured sample rate
+  emulateDmaOverrun();
+  uint64_t due = (nowMicros() - i2sStartMicros) * i2sSampleRate / 1000000;
+  if (due <= i2sSamplesDelivered) {
+    uint64_t waitUs = 1000000 / (i2sSampleRate ? i2sSampleRate : 1) + 1;
+    if (waitUs > (uint64_t)timeoutMs * 1000) waitUs = (uint64_t)timeoutMs * 1000;
+    if (manualClock) {
+      manualMicros += waitUs;
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(waitUs));
+    }
+    due = (nowMicros() - i2sStartMicros) * i2sSampleRate / 1000000;
+  }
+
+  uint64_t available = (due > i2sSamplesDelivered) ? (due - i2sSamplesDelivered) : 0;
+  samplesRead = (available < maxSamples) ? (size_t)available : maxSamples;
+  memset(samples, 0, samplesRead * sizeof(int16_t));
+  i2sSamplesDelivered += samplesRead;
+  return true;
+}
+
+I2SEvent i2sWaitEvent(uint32_t timeoutMs) {
+  if (!i2sActive || i2sDmaBufLen == 0) {
+    delayMs(timeoutMs);
+    return I2S_RX_TIMEOUT;
+  }
+
+  // Scripted source: a buffer is always ready
+  if (i2sSource) return I2S_RX_READY;
+
+  uint64_t waitedUs = 0;
+  for (;;) {
+    emulateDmaOverrun();
+    if (i2sPendingOverruns > 0) {
+      i2sPendingOverruns--;
+      return I2S_RX_OVERRUN;
+    }
+
+    uint64_t due = (nowMicros() - i2sStartMicros) * i2sSampleRate / 1000000;
+    uint64_t backlog = (due > i2sSamplesDelivered) ? (due - i2sSamplesDelivered) : 0;
+    if (backlog >= i2sDmaBufLen) return I2S_RX_READY;
+    if (waitedUs >= (uint64_t)timeoutMs * 1000) return I2S_RX_TIMEOUT;
+
+    // Sleep until the next buffer completes (or the timeout)
+    uint64_t waitUs = (i2sDmaBufLen - backlog) * 1000000 / i2sSampleRate + 1;
+    if (waitUs > (uint64_t)timeoutMs * 1000 - waitedUs) waitUs = (uint64_t)timeoutMs * 1000 - waitedUs;
+    if (manualClock) {
+      manualMicros += waitUs;
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(waitUs));
+    }
+    waitedUs += waitUs;
+  }
+}
+
+// ============================================================================
+// QUEUE
+// ============================================================================
+
+bool Queue::create(size_t length, size_t itemSize) {
+  HostQueue* queue = new HostQueue();
+  queue->length = length;
+  queue->itemSize = itemSize;
+  handle = queue;
+  return true;
+}
+
+void Queue::destroy() {
+  delete (HostQueue*)handle;
+  handle = nullptr;
+}
+
+bool Queue::send(const void* item, uint32_t timeoutMs) {
+  HostQueue* queue = (HostQueue*)handle;
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (queue->items.size() >= queue->length) {
+    if (timeoutMs == 0 ||
+        !queue->notFull.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                 [queue] { return queue->items.size() < queue->length; })) {
+      return false;
+    }
+  }
+  const uint8_t* bytes = (const uint8_t*)item;
+  queue->items.emplace_back(bytes, bytes + queue->itemSize);
+  queue->notEmpty.notify_one();
+  return true;
+}
+
+bool Queue::sendToFront(const void* item, uint32_t timeoutMs) {
+  HostQueue* queue = (HostQueue*)handle;
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (queue->items.size() >= queue->length) {
+    if (timeoutMs == 0 ||
+        !queue->notFull.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                 [queue] { return queue->items.size() < queue->length; })) {
+      return false;
+    }
+  }
+  const uint8_t* bytes = (const uint8_t*)item;
+  queue->items.emplace_front(bytes, bytes + queue->itemSize);
+  queue->notEmpty.notify_one();
+  return true;
+}
+
+bool Queue::receive(void* item, uint32_t timeoutMs) {
+  HostQueue* queue = (HostQueue*)handle;
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (queue->items.empty()) {
+    if (timeoutMs == 0 ||
+        !queue->notEmpty.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                  [queue] { return !queue->items.empty(); })) {
+      return false;
+    }
+  }
+  memcpy(item, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  queue->notFull.notify_one();
+  return true;
+}
+
+bool Queue::peek(void* item, uint32_t timeoutMs) {
+  HostQueue* queue = (HostQueue*)handle;
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (queue->items.empty()) {
+    if (timeoutMs == 0 ||
+        !queue->notEmpty.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                                  [queue] { return !queue->items.empty(); })) {
+      return false;
+    }
+  }
+  memcpy(item, queue->items.front().data(), queue->itemSize);
+  return true;
+}
+
+size_t Queue::count() const {
+  HostQueue* queue = (HostQueue*)handle;
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  return queue->items.size();
+}
+
+void Queue::reset() {
+  HostQueue* queue = (HostQueue*)handle;
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  queue->items.clear();
+  queue->notFull.notify_all();
+}
+
+// ============================================================================
+// CRITICAL SECTION
+// ============================================================================
+
+void enterCritical() {
+  criticalMutex.lock();
+}
+
+void exitCritical() {
+  criticalMutex.unlock();
+}
+
+// ============================================================================
+// TASKS
+// ============================================================================
+
+bool taskStart(TaskFunction function, const char* name, uint32_t stackBytes,
+               uint8_t priority, void* context) {
+  (void)name;
+  (void)stackBytes;
+  (void)priority;
+  std::thread(function, context).detach();
+  return true;
+}
+
+// ============================================================================
+// FLASH
+// ============================================================================
+
+bool flashBegin(size_t& size) {
+  if (flashImage.size() != flashSize) {
+    flashImage.assign(flashSize, 0xFF);
+    flashSectorErases.assign(flashSize / FLASH_SECTOR_SIZE, 0);
+  }
+  size = flashSize;
+  return flashSize > 0;
+}
+
+bool flashRead(uint32_t offset, void* data, size_t length) {
+  if ((size_t)offset + length > flashImage.size()) return false;
+  memcpy(data, flashImage.data() + offset, length);
+  flashStats.bytesRead += length;
+  return true;
+}
+
+bool flashWrite(uint32_t offset, const void* data, size_t length) {
+  if ((size_t)offset + length > flashImage.size()) return false;
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (size_t i = 0; i < length; i++) {
+    uint8_t& cell = flashImage[offset + i];
+    if (bytes[i] & ~cell) flashStats.bitViolations++;  // 0 -> 1 needs an erase
+    cell &= bytes[i];
+  }
+  flashStats.bytesWritten += length;
+  flashStats.writes++;
+  return true;
+}
+
+bool flashErase(uint32_t offset, size_t length) {
+  if (offset % FLASH_SECTOR_SIZE || length % FLASH_SECTOR_SIZE || (size_t)offset + length > flashImage.size()) {
+    return false;
+  }
+  memset(flashImage.data() + offset, 0xFF, length);
+  for (size_t sector = offset / FLASH_SECTOR_SIZE; sector < (offset + length) / FLASH_SECTOR_SIZE; sector++) {
+    flashSectorErases[sector]++;
+    flashStats.sectorErases++;
+  }
+  return true;
+}
+
+// ============================================================================
+// BLE CHARACTERISTIC
+// ============================================================================
+
+bool bleNotify(NimBLECharacteristic* characteristic, const uint8_t* data, size_t length) {
+  if (!characteristic) return false;
+  characteristic->setValue(data, length);
+  notifying = characteristic;
+  notifyFailed = false;
+
+  // Like NimBLE: a notification that finds no buffer fails with ENOMEM
+  // and is reported through onStatus()
+  if (linkIntervalUs > 0) {
+    drainLink();
+    if (linkBuffered.size() >= linkBufferPackets) {
+      notifyFailures++;
+      characteristic->hostNotifyStatus(BLE_HS_ENOMEM);
+      notifying = nullptr;
+      return false;
+    }
+    linkBuffered.push_back((uint16_t)(length + LINK_PACKET_OVERHEAD));
+  }
+
+  notifyCount++;
+  if (notifyHook) {
+    notifyHook(characteristic->getUUIDString(), data, length, notifyHookContext);
+  }
+  characteristic->hostNotifyStatus(0);
+  notifying = nullptr;
+  return !notifyFailed;
+}
+
+void bleNotifyStatus(NimBLECharacteristic* characteristic, bool accepted) {
+  if (characteristic == notifying && !accepted) notifyFailed = true;
+}
+
+// ============================================================================
+// MOCK CONTROLS
+// ============================================================================
+
+namespace host {
+
+void useManualClock(bool manual) {
+  if (manual && !manualClock) manualMicros = nowMicros();
+  manualClock = manual;
+}
+
+void advanceMicros(uint64_t us) {
+  manualMicros += us;
+}
+
+void setI2SSource(I2SSource source, void* context) {
+  i2sSource = source;
+  i2sSourceContext = context;
+}
+
+uint32_t getI2SSampleRate() {
+  return i2sSampleRate;
+}
+
+void setGpioLevel(uint8_t pin, int level) {
+  gpioRead(0);  // Ensure defaults are initialized
+  if (pin < 32) gpioLevels[pin] = level;
+}
+
+void clearI2CDevices() {
+  i2cDevices.clear();
+}
+
+void addI2CDevice(uint8_t address) {
+  i2cDevices.push_back(address);
+}
+
+void setNotifyHook(NotifyHook hook, void* context) {
+  notifyHook = hook;
+  notifyHookContext = context;
+}
+
+uint32_t getNotifyCount() {
+  return notifyCount;
+}
+
+void setLinkModel(uint32_t intervalUs, uint16_t bytesPerEvent, uint8_t bufferPackets) {
+  linkIntervalUs = intervalUs;
+  linkBytesPerEvent = bytesPerEvent;
+  linkBufferPackets = bufferPackets;
+  linkNextEventUs = nowMicros();
+  linkBuffered.clear();
+}
+
+uint32_t getNotifyFailures() {
+  return notifyFailures;
+}
+
+void stallLink(uint32_t stallUs) {
+  if (linkIntervalUs == 0) return;
+  drainLink();
+  linkNextEventUs = nowMicros() + stallUs;
+}
+
+void setFlashSize(size_t size) {
+  flashSize = size - size % FLASH_SECTOR_SIZE;
+  flashImage.clear();
+  flashSectorErases.clear();
+  flashStats = FlashStats();
+}
+
+FlashStats getFlashStats() {
+  FlashStats stats = flashStats;
+  stats.minSectorErases = 0;
+  stats.maxSectorErases = 0;
+  for (size_t i = 0; i < flashSectorErases.size(); i++) {
+    if (i == 0 || flashSectorErases[i] < stats.minSectorErases) stats.minSectorErases = flashSectorErases[i];
+    if (flashSectorErases[i] > stats.maxSectorErases) stats.maxSectorErases = flashSectorErases[i];
+  }
+  return stats;
+}
+
+}  // namespace host
+
+}  // namespace hal
@@ -0,0 +1,70 @@
+/*
+ * Minimal WAV (RIFF PCM) file reader
+ */
+
+#include "WavFile.h"
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t readLE32(const uint8_t* p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t readLE16(const uint8_t* p) {
+  return p[0] | (p[1] << 8);
+}
+
+bool loadWavFile(const char* path, WavData& wav) {
+  FILE* file = fopen(path, "rb");
+  if (!file) {
+    fprintf(stderr, "[wav] cannot open %s\n", path);
+    return false;
+  }
+
+  uint8_t header[12];
+  if (fread(header, 1, 12, file) != 12 || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+    fprintf(stderr, "[wav] %s is not a RIFF/WAVE file\n", path);
+    fclose(file);
+    return false;
+  }
+
+  uint16_t bitsPerSample = 0;
+  uint16_t format = 0;
+  bool haveFormat = false;
+  uint8_t chunkHeader[8];
+
+  while (fread(chunkHeader, 1, 8, file) == 8) {
+    uint32_t chunkSize = readLE32(chunkHeader + 4);
+
+    if (memcmp(chunkHeader, "fmt ", 4) == 0) {
+      uint8_t fmt[16];
+      if (chunkSize < 16 || fread(fmt, 1, 16, file) != 16) break;
+      format = readLE16(fmt);
+      wav.channels = readLE16(fmt + 2);
+      wav.sampleRate = readLE32(fmt + 4);
+      bitsPerSample = readLE16(fmt + 14);
+      haveFormat = true;
+      fseek(file, (chunkSize - 16) + (chunkSize & 1), SEEK_CUR);
+    } else if (memcmp(chunkHeader, "data", 4) == 0 && haveFormat) {
+      // 1 = PCM, 0xFFFE = WAVE_FORMAT_EXTENSIBLE (assumed PCM)
+      if ((format != 1 && format != 0xFFFE) || bitsPerSample != 16 || wav.channels == 0) {
+        fprintf(stderr, "[wav] %s: only 16-bit PCM is supported\n", path);
+        break;
+      }
+      std::vector<int16_t> interleaved(chunkSize / 2);
+      size_t read = fread(interleaved.data(), 2, interleaved.size(), file);
+      wav.samples.resize(read / wav.channels);
+      for (size_t i = 0; i < wav.samples.size(); i++) {
+        wav.samples[i] = interleaved[i * wav.channels];
+      }
+      fclose(file);
+      return true;
+    } else {
+      fseek(file, chunkSize + (chunkSize & 1), SEEK_CUR);
+    }
+  }
+
+  fprintf(stderr, "[wav] %s: no usable data chunk\n", path);
+  fclose(file);
+  return false;
+}
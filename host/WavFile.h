@@ -0,0 +1,26 @@
+/*
+ * Minimal WAV (RIFF PCM) file reader for host benchmarks
+ * Supports 16-bit PCM; multi-channel files are reduced to the first channel.
+ */
+
+#ifndef WAV_FILE_H
+#define WAV_FILE_H
+
+#include <stdint.h>
+#include <vector>
+
+struct WavData {
+  uint32_t sampleRate;
+  uint16_t channels;
+  std::vector<int16_t> samples;  // First channel only
+
+  WavData() : sampleRate(0), channels(0) {}
+};
+
+/**
+ * Load a 16-bit PCM WAV file
+ * @return false (with a message on stderr) if the file is missing or unsupported
+ */
+bool loadWavFile(const char* path, WavData& wav);
+
+#endif // WAV_FILE_H
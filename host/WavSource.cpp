@@ -0,0 +1,56 @@
+/*
+ * WAV replay source implementation
+ */
+
+#include "WavSource.h"
+#include <Arduino.h>
+#include <stdio.h>
+
+WavAudioSource::WavAudioSource()
+  : position(0),
+    lastMicros(0),
+    elapsedMicros(0),
+    started(false) {
+  source.read = read;
+  source.context = this;
+  source.name = "WAV file";
+}
+
+bool WavAudioSource::open(const char* path, uint32_t sampleRate) {
+  if (!loadWavFile(path, wav)) return false;
+  if (wav.sampleRate != sampleRate) {
+    fprintf(stderr, "[wav] %s is %u Hz, the capture path runs at %u Hz\n", path,
+            (unsigned)wav.sampleRate, (unsigned)sampleRate);
+    return false;
+  }
+  position = 0;
+  elapsedMicros = 0;
+  started = false;
+  return true;
+}
+
+bool WavAudioSource::read(void* context, int16_t* samples, size_t maxSamples, size_t& samplesRead) {
+  WavAudioSource* self = (WavAudioSource*)context;
+  samplesRead = 0;
+  if (self->position >= self->wav.samples.size()) return false;
+
+  // Clock deltas are summed, so recordings longer than the 32-bit
+  // micros() wrap (71 min) replay correctly
+  uint32_t now = micros();
+  if (!self->started) {
+    self->started = true;
+    self->lastMicros = now;
+  }
+  self->elapsedMicros += (uint32_t)(now - self->lastMicros);
+  self->lastMicros = now;
+
+  // Only what the "DMA" has captured by now
+  uint64_t due = self->elapsedMicros * self->wav.sampleRate / 1000000;
+  if (due > self->wav.samples.size()) due = self->wav.samples.size();
+  if (due <= self->position) return true;
+
+  samplesRead = (size_t)min((uint64_t)maxSamples, due - self->position);
+  memcpy(samples, &self->wav.samples[self->position], samplesRead * sizeof(int16_t));
+  self->position += samplesRead;
+  return true;
+}
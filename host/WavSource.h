@@ -0,0 +1,46 @@
+/*
+ * WAV replay source for AudioDetector (host builds)
+ * Feeds a recorded clip through AudioDetector::setAudioSource() instead of
+ * the I2S microphone. Samples become available as the HAL clock advances
+ * (like DMA buffers filling), so with hal::host::useManualClock() a replay
+ * runs as fast as the CPU allows and is repeatable to the byte.
+ */
+
+#ifndef WAV_SOURCE_H
+#define WAV_SOURCE_H
+
+#include "AudioSource.h"
+#include "WavFile.h"
+
+class WavAudioSource {
+public:
+  WavAudioSource();
+
+  /**
+   * Load a 16-bit PCM WAV file (first channel)
+   * @return false if missing, unsupported or not at the capture rate
+   */
+  bool open(const char* path, uint32_t sampleRate);
+
+  /**
+   * Source to install with AudioDetector::setAudioSource(); the clock
+   * starts at the first read
+   */
+  const AudioSource* getSource() { return &source; }
+
+  size_t getPosition() const { return position; }
+  size_t getLength() const { return wav.samples.size(); }
+  uint32_t getSampleRate() const { return wav.sampleRate; }
+
+private:
+  WavData wav;
+  AudioSource source;
+  size_t position;
+  uint32_t lastMicros;
+  uint64_t elapsedMicros;  // Since the first read
+  bool started;
+
+  static bool read(void* context, int16_t* samples, size_t maxSamples, size_t& samplesRead);
+};
+
+#endif // WAV_SOURCE_H
@@ -0,0 +1,291 @@
+/*
+ * Alert delivery benchmark (host)
+ * BLEManager on the slow link model (30 ms interval, 251 B/event) raises a
+ * numbered alert every 10 s for 10 min with heart rate at 1 Hz. The
+ * simulated phone app loses a share of alert notifications (lossy radio,
+ * app not scheduled), is suspended for 10 s of every minute (everything
+ * lost), loses a share of its ACK writes, and answers after ACK_DELAY_MS.
+ * The link drops for 20 s once (alerts raised meanwhile go to the flash
+ * log and are replayed on the alert characteristic, StoreForward.h); the
+ * app does not send "ALERT_ACK:ON" again after the reconnect.
+ *
+ * Each case runs plain (alerts as strings, as before) and with
+ * "ALERT_ACK:ON" (AlertTracker.h) and reports alerts delivered to the app
+ * of those raised (all of them with ACKs), alerts the app saw twice after duplicate suppression
+ * (must be 0), retransmissions, duplicates suppressed by AlertReceiver,
+ * alerts given up, and latency from enqueueAlert() to delivery and to ACK.
+ * A last check replays records across reboots through AlertReceiver,
+ * flash-log and random boot ids.
+ *
+ * Usage: alert_ack_bench
+ */
+
+#include <Arduino.h>
+#include "AlertTracker.h"
+#include "BLEManager.h"
+#include "Config.h"
+#include "DataScheduler.h"
+#include "HalHost.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static const uint32_t STEP_US = 4000;        // loop() pass
+static const uint32_t RUN_MS = 600000;
+static const uint32_t SETTLE_MS = 60000;     // No new alerts: retransmissions finish
+static const uint32_t ALERT_EVERY_MS = 10000;
+static const uint32_t ACK_DELAY_MS = 80;     // Two connection events + app
+static const uint32_t SUSPEND_EVERY_MS = 60000;
+static const uint32_t SUSPEND_MS = 10000;
+static const uint32_t OUTAGE_AT_MS = 400000;
+static const uint32_t OUTAGE_MS = 20000;
+
+struct LossCase {
+  const char* name;
+  uint8_t alertLossPct;  // Alert notifications the app never sees
+  uint8_t ackLossPct;    // ACK writes lost
+};
+
+static const LossCase CASES[] = {
+  { "0% / 0% lost", 0, 0 },
+  { "10% / 10% lost", 10, 10 },
+  { "30% / 20% lost", 30, 20 },
+};
+
+struct PendingAck {
+  uint32_t dueMs;
+  uint32_t sequence;
+};
+
+struct Phone {
+  const LossCase* loss;
+  uint32_t random;
+  bool suspended;
+  AlertReceiver receiver;
+  std::vector<uint32_t> raisedMs;     // Per alert number
+  std::vector<bool> delivered;
+  uint32_t deliveredCount;
+  uint32_t deliveredTwice;            // Reached the app twice (duplicate not suppressed)
+  uint32_t notificationsLost;
+  QueueAgeHistogram latency;          // enqueueAlert() -> app
+  std::vector<PendingAck> acks;
+};
+
+static bool lose(Phone* phone, uint8_t percent) {
+  phone->random = phone->random * 1103515245 + 12345;
+  return ((phone->random >> 16) % 100) < percent;
+}
+
+// "ALERT_<n>" (anything after the number is ignored)
+static void deliver(Phone* phone, const uint8_t* text, size_t length) {
+  char name[MAX_ALERT_SIZE + 1];
+  length = min(length, (size_t)MAX_ALERT_SIZE);
+  memcpy(name, text, length);
+  name[length] = '\0';
+  if (strncmp(name, "ALERT_", 6) != 0) return;
+  size_t number = (size_t)atoi(name + 6);
+  if (number >= phone->delivered.size()) return;
+  if (phone->delivered[number]) {
+    phone->deliveredTwice++;
+    return;
+  }
+  phone->delivered[number] = true;
+  phone->deliveredCount++;
+  phone->latency.record(millis() - phone->raisedMs[number]);
+}
+
+static void onNotify(const char* uuid, const uint8_t* data, size_t length, void* context) {
+  Phone* phone = (Phone*)context;
+  if (strcasecmp(uuid, ALERT_CHAR_UUID) != 0) return;
+  if (phone->suspended || lose(phone, phone->loss->alertLossPct)) {
+    phone->notificationsLost++;
+    return;
+  }
+
+  uint32_t sequence;
+  size_t alertLength;
+  if (phone->receiver.receive(data, length, sequence, alertLength)) deliver(phone, data, alertLength);
+  if (sequence != 0 && !lose(phone, phone->loss->ackLossPct)) {
+    phone->acks.push_back({ (uint32_t)millis() + ACK_DELAY_MS, sequence });
+  }
+}
+
+static void writeControl(NimBLEServer* server, const char* command) {
+  server->getCharacteristic(CONTROL_CHAR_UUID)->hostWrite(command);
+}
+
+
+// ACK mode must deliver every alert, and no run may deliver one twice
+static bool run(BLEManager& ble, const LossCase& loss, bool ack) {
+  hal::host::muteSerial(true);
+  DataScheduler scheduler;
+  scheduler.begin();
+  ble.setDataScheduler(&scheduler);
+  NimBLEServer* server = ble.getServer();
+  const AlertTracker& tracker = ble.getAlertTracker();
+  uint32_t retransmissionsBefore = tracker.getRetransmissions();
+  uint32_t givenUpBefore = tracker.getGivenUp();
+  uint32_t acknowledgedBefore = tracker.getAcknowledged();
+
+  Phone* phone = new Phone();
+  phone->loss = &loss;
+  phone->random = 1;
+  phone->suspended = false;
+  phone->deliveredCount = 0;
+  phone->deliveredTwice = 0;
+  phone->notificationsLost = 0;
+  phone->latency.reset();
+  hal::host::setNotifyHook(onNotify, phone);
+
+  hal::host::setLinkModel(24 * 1250, 251, 12);
+  server->hostConnect(BLE_REQUESTED_MTU, 24);
+  writeControl(server, ack ? "ALERT_ACK:ON" : "ALERT_ACK:OFF");  // One BLEManager for all runs
+  bool connected = true;
+  uint32_t start = millis();
+  uint32_t nextAlert = 0;
+  uint32_t nextHeartRate = 0;
+  for (uint32_t ms = 0; ms < RUN_MS + SETTLE_MS; ms = millis() - start) {
+    if (ms >= nextAlert && ms < RUN_MS) {
+      char name[MAX_ALERT_SIZE];
+      snprintf(name, sizeof(name), "ALERT_%u", (unsigned)phone->raisedMs.size());
+      if (scheduler.enqueueAlert(name)) {
+        phone->raisedMs.push_back(millis());
+        phone->delivered.push_back(false);
+      }
+      nextAlert += ALERT_EVERY_MS;
+    }
+    if (ms >= nextHeartRate) {
+      scheduler.enqueueHeartRate((uint8_t)(60 + (ms / 1000) % 40));
+      nextHeartRate += 1000;
+    }
+    phone->suspended = (ms % SUSPEND_EVERY_MS) >= SUSPEND_EVERY_MS - SUSPEND_MS;
+
+    bool outage = ms >= OUTAGE_AT_MS && ms < OUTAGE_AT_MS + OUTAGE_MS;
+    if (outage && connected) {
+      server->hostDisconnect();
+      phone->acks.clear();
+      connected = false;
+    } else if (!outage && !connected) {
+      server->hostConnect(BLE_REQUESTED_MTU, 24);  // ACK mode carries over
+      connected = true;
+    }
+
+    // ACKs written when due (the app answers on its own schedule)
+    for (size_t i = 0; i < phone->acks.size();) {
+      if ((int32_t)(millis() - phone->acks[i].dueMs) >= 0 && connected) {
+        char command[24];
+        AlertReceiver::formatAck(phone->acks[i].sequence, command, sizeof(command));
+        writeControl(server, command);
+        phone->acks.erase(phone->acks.begin() + i);
+      } else {
+        i++;
+      }
+    }
+
+    ble.processDataQueue();
+    hal::host::advanceMicros(STEP_US);
+  }
+
+  hal::host::setNotifyHook(nullptr, nullptr);
+  server->hostDisconnect();
+  ble.processDataQueue();
+  hal::host::setLinkModel(0, 0, 0);
+  ble.setDataScheduler(nullptr);
+  hal::host::muteSerial(false);
+
+  Serial.print(F("    "));
+  Serial.print(ack ? F("ACK:   ") : F("plain: "));
+  Serial.print(phone->deliveredCount);
+  Serial.print(F("/"));
+  Serial.print(phone->raisedMs.size());
+  Serial.print(F(" alerts delivered ("));
+  Serial.print(phone->notificationsLost);
+  Serial.print(F(" notifications lost), delivered twice "));
+  Serial.print(phone->deliveredTwice);
+  Serial.print(F(", latency p50 / p99 / max "));
+  Serial.print(phone->latency.percentile(50));
+  Serial.print(F(" / "));
+  Serial.print(phone->latency.percentile(99));
+  Serial.print(F(" / "));
+  Serial.print(phone->latency.maxAgeMs);
+  Serial.println(F(" ms"));
+  if (ack) {
+    Serial.print(F("           "));
+    Serial.print(tracker.getAcknowledged() - acknowledgedBefore);
+    Serial.print(F(" ACKed, "));
+    Serial.print(tracker.getRetransmissions() - retransmissionsBefore);
+    Serial.print(F(" retransmissions, "));
+    Serial.print(phone->receiver.getDuplicates());
+    Serial.print(F(" duplicates suppressed, "));
+    Serial.print(tracker.getGivenUp() - givenUpBefore);
+    Serial.print(F(" given up; enqueue -> ACK p50 / p99 / max (all runs) "));
+    Serial.print(tracker.getLatency().percentile(50));
+    Serial.print(F(" / "));
+    Serial.print(tracker.getLatency().percentile(99));
+    Serial.print(F(" / "));
+    Serial.print(tracker.getLatency().maxAgeMs);
+    Serial.println(F(" ms"));
+  }
+  bool ok = phone->deliveredTwice == 0 && (!ack || phone->deliveredCount == phone->raisedMs.size());
+  if (!ok) Serial.println(F("           FAIL"));
+  delete phone;
+  return ok;
+}
+
+// AlertReceiver across reboots: the new boot's alerts are delivered, a
+// late retransmission from before it is not, and does not reopen the
+// window; a lower (random, no flash log) boot id is still a new boot
+static bool receiverAcrossReboot() {
+  AlertReceiver receiver;
+  char record[32];
+  uint32_t sequence;
+  size_t alertLength;
+  bool ok = true;
+  for (uint32_t count = 1; count <= 40; count++) {
+    int length = snprintf(record, sizeof(record), "FALL_DETECTED#%lu", (unsigned long)((1UL << 16) | count));
+    ok = ok && receiver.receive((const uint8_t*)record, length, sequence, alertLength);
+  }
+  const uint32_t replayed[] = {(2UL << 16) | 1, (1UL << 16) | 1, (2UL << 16) | 1, (1UL << 16) | 40,
+                               (2UL << 16) | 2, (0x9A3CUL << 16) | 1, (2UL << 16) | 3, (0x0471UL << 16) | 1,
+                               (0x9A3CUL << 16) | 2, (0x0471UL << 16) | 2};
+  const bool delivered[] = {true, false, false, false, true, true, false, true, false, true};
+  for (size_t i = 0; i < sizeof(replayed) / sizeof(replayed[0]); i++) {
+    int length = snprintf(record, sizeof(record), "HEART_STOP#%lu", (unsigned long)replayed[i]);
+    ok = ok && receiver.receive((const uint8_t*)record, length, sequence, alertLength) == delivered[i];
+  }
+  return ok && receiver.getDuplicates() == 5;
+}
+
+int main() {
+  hal::host::useManualClock(true);
+  hal::host::muteSerial(true);
+  BLEManager ble;  // One NimBLE server for all runs
+  ble.begin();
+  hal::host::muteSerial(false);
+
+  Serial.println(F("========================================"));
+  Serial.print(F("[AlertAckBench] Alert every "));
+  Serial.print(ALERT_EVERY_MS / 1000);
+  Serial.print(F(" s for "));
+  Serial.print(RUN_MS / 60000);
+  Serial.print(F(" min, app suspended "));
+  Serial.print(SUSPEND_MS / 1000);
+  Serial.print(F(" s/min, link down "));
+  Serial.print(OUTAGE_MS / 1000);
+  Serial.println(F(" s once"));
+  Serial.println(F("========================================"));
+  bool runsOk = true;
+  for (const LossCase& loss : CASES) {
+    Serial.print(F("  Alerts / ACKs "));
+    Serial.println(loss.name);
+    runsOk = run(ble, loss, false) && runsOk;
+    runsOk = run(ble, loss, true) && runsOk;
+  }
+  bool receiverOk = receiverAcrossReboot();
+  Serial.print(F("  Receiver across reboots (first alert delivered, stale retransmission dropped): "));
+  Serial.println(receiverOk ? F("OK") : F("FAIL"));
+  Serial.println(F("========================================"));
+  return (runsOk && receiverOk) ? 0 : 1;
+}
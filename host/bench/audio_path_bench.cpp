@@ -0,0 +1,245 @@
+/*
+ * Audio transmit path benchmark (host)
+ * Pushes speech through capture -> encode -> DataScheduler -> BLE notify
+ * twice and reports audio-data copies and cycles per 16 ms block:
+ * - copy:   the original path (32-sample chunk buffer, stream buffer,
+ *           encoder buffer memcpy'd into a 244-byte DataPacket that is
+ *           queued by value)
+ * - pooled: DMA reads straight into the capture ring, the encoder writes
+ *           into a PacketPool slot and only its handle is queued
+ *
+ * Host queues are mutex/deque based, so absolute cycle counts differ from
+ * FreeRTOS; copy counts are exact.
+ *
+ * Usage: audio_path_bench [seconds]   (default 10)
+ */
+
+#include <Arduino.h>
+#include "AudioCodec.h"
+#include "AudioFrame.h"
+#include "CodecBenchmark.h"
+#include "Config.h"
+#include "DataScheduler.h"
+#include "HalHost.h"
+#include <NimBLEDevice.h>
+
+#include <vector>
+
+static const size_t BLOCK_SAMPLES = 256;  // AudioDetector::STREAM_BUFFER_SIZE
+static const size_t CHUNK_SAMPLES = 32;   // AudioDetector i2sRead() chunk
+static const uint8_t BENCH_PASSES = 5;
+
+struct PathResult {
+  uint32_t blocks;
+  uint32_t copies;
+  uint64_t copyBytes;
+  uint64_t producerCycles;
+  uint64_t consumerCycles;
+  uint64_t encodeCycles;  // Part of producerCycles spent in AudioCodec::encode()
+};
+
+// DataPacket as it was queued by value before the pools
+struct LegacyDataPacket {
+  DataPriority priority;
+  DataType type;
+  uint32_t timestamp;
+  uint16_t dataSize;
+  uint8_t data[MAX_AUDIO_SIZE];
+
+  LegacyDataPacket() : priority(PRIORITY_NORMAL), type(DATA_AUDIO), timestamp(0), dataSize(0) {
+    memset(data, 0, sizeof(data));
+  }
+};
+
+// Simulated DMA -> caller copy done by i2s_read()
+static void dmaRead(const std::vector<int16_t>& signal, size_t& position, int16_t* out, size_t count) {
+  memcpy(out, &signal[position], count * sizeof(int16_t));
+  position += count;
+}
+
+static void writeHeader(AudioCodec& codec, uint16_t sequence, uint32_t sampleIndex, uint8_t* frame) {
+  AudioFrameHeader header;
+  int16_t predicted, stepIndex;
+  codec.getEncoderState(predicted, stepIndex);
+  header.format = codec.getMode();
+  header.stepIndex = (uint8_t)stepIndex;
+  header.predictor = predicted;
+  header.sequence = sequence;
+  header.sampleIndex = sampleIndex;
+  header.sampleCount = BLOCK_SAMPLES;
+  writeAudioFrameHeader(header, frame);
+}
+
+// Original path, reconstructed from the pre-pool firmware
+static PathResult runCopyPath(const std::vector<int16_t>& signal, NimBLECharacteristic* characteristic) {
+  PathResult result;
+  memset(&result, 0, sizeof(result));
+
+  // Same queue layout and rate-limit clock reads as the old DataScheduler
+  hal::Queue criticalQueue, highQueue, normalQueue;
+  criticalQueue.create(10, sizeof(LegacyDataPacket));
+  highQueue.create(10, sizeof(LegacyDataPacket));
+  normalQueue.create(20, sizeof(LegacyDataPacket));
+  uint32_t windowStart = 0, lastTransmit = 0;
+  AudioCodec codec;
+  int16_t streamBuffer[BLOCK_SAMPLES];
+  uint8_t frameBuffer[AUDIO_FRAME_HEADER_SIZE + BLOCK_SAMPLES / 2];
+  size_t position = 0;
+
+  while (position + BLOCK_SAMPLES <= signal.size()) {
+    uint32_t start = hal::cycleCount();
+
+    for (size_t filled = 0; filled < BLOCK_SAMPLES; filled += CHUNK_SAMPLES) {
+      int16_t samples[CHUNK_SAMPLES];
+      dmaRead(signal, position, samples, CHUNK_SAMPLES);
+      for (size_t i = 0; i < CHUNK_SAMPLES; i++) streamBuffer[filled + i] = samples[i];
+    }
+    result.copies += 2;
+    result.copyBytes += 2 * BLOCK_SAMPLES * sizeof(int16_t);
+
+    writeHeader(codec, (uint16_t)result.blocks, result.blocks * BLOCK_SAMPLES, frameBuffer);
+    AudioBlockStats stats;
+    size_t codedSamples;
+    uint32_t encodeStart = hal::cycleCount();
+    size_t size = AUDIO_FRAME_HEADER_SIZE +
+                  codec.encode(streamBuffer, BLOCK_SAMPLES, frameBuffer + AUDIO_FRAME_HEADER_SIZE, codedSamples, stats);
+    result.encodeCycles += hal::cycleCount() - encodeStart;
+
+    if (millis() - windowStart >= 1000) windowStart = millis();
+    LegacyDataPacket packet;
+    packet.type = DATA_AUDIO;
+    packet.timestamp = millis();
+    packet.dataSize = (uint16_t)size;
+    memcpy(packet.data, frameBuffer, size);
+    normalQueue.send(&packet);
+    lastTransmit = millis();
+    result.copies += 2;  // memcpy + queue send (whole struct)
+    result.copyBytes += size + sizeof(LegacyDataPacket);
+    result.producerCycles += hal::cycleCount() - start;
+
+    start = hal::cycleCount();
+    LegacyDataPacket received;
+    if (!criticalQueue.receive(&received) && !highQueue.receive(&received)) {
+      normalQueue.receive(&received);
+    }
+    hal::bleNotify(characteristic, received.data, received.dataSize);
+    result.copies += 2;  // queue receive (whole struct) + setValue
+    result.copyBytes += sizeof(LegacyDataPacket) + received.dataSize;
+    result.consumerCycles += hal::cycleCount() - start;
+
+    result.blocks++;
+  }
+  (void)lastTransmit;
+  criticalQueue.destroy();
+  highQueue.destroy();
+  normalQueue.destroy();
+  return result;
+}
+
+// Pooled path, mirroring AudioDetector::captureAvailable()/streamBlock() and
+// BLEManager::processDataQueue()
+static PathResult runPooledPath(const std::vector<int16_t>& signal, NimBLECharacteristic* characteristic) {
+  DataScheduler scheduler;
+  scheduler.begin();
+  scheduler.setPacingEnabled(false);
+
+  AudioCodec codec;
+  int16_t streamBuffer[BLOCK_SAMPLES];
+  size_t position = 0;
+  uint32_t blocks = 0;
+  uint64_t encodeCycles = 0;
+
+  while (position + BLOCK_SAMPLES <= signal.size()) {
+    uint32_t start = hal::cycleCount();
+
+    for (size_t filled = 0; filled < BLOCK_SAMPLES; filled += CHUNK_SAMPLES) {
+      dmaRead(signal, position, &streamBuffer[filled], CHUNK_SAMPLES);
+    }
+    scheduler.recordAudioCopy(BLOCK_SAMPLES * sizeof(int16_t));
+
+    uint8_t slot;
+    uint8_t* frame = scheduler.acquireAudioBuffer(slot);
+    writeHeader(codec, (uint16_t)blocks, blocks * BLOCK_SAMPLES, frame);
+    AudioBlockStats stats;
+    size_t codedSamples;
+    uint32_t encodeStart = hal::cycleCount();
+    size_t size = AUDIO_FRAME_HEADER_SIZE +
+                  codec.encode(streamBuffer, BLOCK_SAMPLES, frame + AUDIO_FRAME_HEADER_SIZE, codedSamples, stats);
+    encodeCycles += hal::cycleCount() - encodeStart;
+    scheduler.commitAudio(slot, size);
+    scheduler.recordAudioBlock(hal::cycleCount() - start);
+
+    start = hal::cycleCount();
+    DataPacket packet;
+    scheduler.getNextPacket(packet);
+    hal::bleNotify(characteristic, scheduler.getPacketData(packet), packet.dataSize);
+    scheduler.releasePacket(packet);
+    scheduler.recordAudioSent(hal::cycleCount() - start, packet.dataSize);
+
+    blocks++;
+  }
+
+  const AudioPathStats& stats = scheduler.getAudioPathStats();
+  PathResult result;
+  result.blocks = stats.blocks;
+  result.copies = stats.copies + stats.sendCopies;
+  result.copyBytes = stats.copyBytes + stats.sendCopyBytes;
+  result.producerCycles = stats.producerCycles;
+  result.consumerCycles = stats.consumerCycles;
+  result.encodeCycles = encodeCycles;
+  return result;
+}
+
+static uint64_t pathCycles(const PathResult& result) {
+  return result.producerCycles + result.consumerCycles - result.encodeCycles;
+}
+
+static void printRow(const char* name, const PathResult& result) {
+  Serial.print(F("  "));
+  Serial.print(name);
+  Serial.print(F("\t| "));
+  Serial.print((float)result.copies / result.blocks, 2);
+  Serial.print(F("\t| "));
+  Serial.print((unsigned long)(result.copyBytes / result.blocks));
+  Serial.print(F("\t| "));
+  Serial.print((unsigned long)(result.producerCycles / result.blocks));
+  Serial.print(F("\t| "));
+  Serial.print((unsigned long)(result.consumerCycles / result.blocks));
+  Serial.print(F("\t| "));
+  Serial.println((unsigned long)(pathCycles(result) / result.blocks));
+}
+
+int main(int argc, char** argv) {
+  size_t seconds = (argc > 1) ? (size_t)atoi(argv[1]) : 10;
+  if (seconds == 0) seconds = 1;
+
+  std::vector<int16_t> signal(AUDIO_BASE_SAMPLE_RATE * seconds);
+  generateSpeechTestSignal(signal.data(), signal.size(), AUDIO_BASE_SAMPLE_RATE);
+  NimBLECharacteristic characteristic(AUDIO_CHAR_UUID, 0);
+
+  // Warm up caches and the allocator, then keep the best of BENCH_PASSES runs
+  hal::host::muteSerial(true);
+  PathResult copyPath = runCopyPath(signal, &characteristic);
+  PathResult pooledPath = runPooledPath(signal, &characteristic);
+  for (uint8_t pass = 0; pass < BENCH_PASSES; pass++) {
+    PathResult result = runCopyPath(signal, &characteristic);
+    if (pathCycles(result) < pathCycles(copyPath)) copyPath = result;
+    result = runPooledPath(signal, &characteristic);
+    if (pathCycles(result) < pathCycles(pooledPath)) pooledPath = result;
+  }
+  hal::host::muteSerial(false);
+
+  Serial.println(F("========================================"));
+  Serial.println(F("[AudioPathBench] Capture -> BLE notify, per 16 ms block"));
+  Serial.println(F("========================================"));
+  Serial.print(F("  "));
+  Serial.print(copyPath.blocks);
+  Serial.print(F(" blocks of "));
+  Serial.print(BLOCK_SAMPLES);
+  Serial.println(F(" samples (IMA4_16K)"));
+  Serial.println(F("  path\t| copies | bytes | produce cyc | send cyc | path cyc (excl. encode)"));
+  printRow("copy", copyPath);
+  printRow("pooled", pooledPath);
+  Serial.println(F("========================================"));
+  return 0;
+}
@@ -0,0 +1,35 @@
+/*
+ * ADPCM codec benchmark (host)
+ * Round-trips recorded speech through ADPCMCodec::encode()/decode() and
+ * prints ns/sample, samples/s and SNR per block size.
+ *
+ * Usage: codec_bench [clip.wav ...]
+ * Without arguments a 10 s synthetic speech signal is used.
+ */
+
+#include <Arduino.h>
+#include "CodecBenchmark.h"
+#include "Config.h"
+#include "WavFile.h"
+
+#include <vector>
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    const uint32_t sampleRate = AUDIO_BASE_SAMPLE_RATE;
+    std::vector<int16_t> pcm(sampleRate * 10);
+    generateSpeechTestSignal(pcm.data(), pcm.size(), sampleRate);
+    Serial.println(F("[CodecBench] Source: synthetic speech (10 s)"));
+    runCodecBenchmark(pcm.data(), pcm.size(), sampleRate);
+    return 0;
+  }
+
+  for (int i = 1; i < argc; i++) {
+    WavData wav;
+    if (!loadWavFile(argv[i], wav)) return 1;
+    Serial.print(F("[CodecBench] Source: "));
+    Serial.println(argv[i]);
+    runCodecBenchmark(wav.samples.data(), wav.samples.size(), wav.sampleRate);
+  }
+  return 0;
+}
@@ -0,0 +1,236 @@
+/*
+ * Audio DSP pipeline benchmark (host)
+ * Runs each AudioPipeline stage on its own and the firmware chain
+ * (AUDIO_INPUT_STAGES then AUDIO_STREAM_STAGES) over a clip in 256-sample
+ * blocks, and reports:
+ * - cycles per block per stage (best of several passes; host: nanoseconds)
+ * - DC blocker / high-pass response: DC residual and tone gains
+ * - ADPCM coding noise and the quietest block level (what the VAD takes
+ *   as the noise floor) of the raw vs. conditioned microphone signal
+ * - AGC output level, peak and clipped samples for speech at several levels
+ *
+ * Usage: dsp_bench [clip.wav]   (16 kHz mono, as recorded by the microphone)
+ * Without arguments, synthetic speech with a -900 LSB offset and 30 Hz
+ * rumble stands in for a raw MEMS microphone.
+ */
+
+#include <Arduino.h>
+#include "AudioPipeline.h"
+#include "ADPCMCodec.h"
+#include "CodecBenchmark.h"
+#include "Config.h"
+#include "WavFile.h"
+
+#include <vector>
+
+static const size_t BLOCK_SAMPLES = 256;  // AudioDetector::STREAM_BUFFER_SIZE
+static const uint32_t SAMPLE_RATE = 16000;
+static const uint8_t PASSES = 5;
+static const int16_t MIC_OFFSET = -900;      // Typical MEMS I2S DC offset
+static const float RUMBLE_AMPLITUDE = 1500;  // 30 Hz handling / wind rumble
+
+// ============================================================================
+// SIGNALS
+// ============================================================================
+
+static std::vector<int16_t> rawMicrophone(const std::vector<int16_t>& speech) {
+  const float twoPi = 6.2831853f;
+  std::vector<int16_t> raw(speech.size());
+  for (size_t i = 0; i < raw.size(); i++) {
+    float sample = speech[i] + MIC_OFFSET + RUMBLE_AMPLITUDE * sinf(twoPi * 30.0f * i / SAMPLE_RATE);
+    raw[i] = (int16_t)max(-32768.0f, min(32767.0f, sample));
+  }
+  return raw;
+}
+
+static std::vector<int16_t> tone(float frequency, float seconds) {
+  const float twoPi = 6.2831853f;
+  std::vector<int16_t> samples((size_t)(seconds * SAMPLE_RATE));
+  for (size_t i = 0; i < samples.size(); i++) {
+    samples[i] = (int16_t)(8000.0f * sinf(twoPi * frequency * i / SAMPLE_RATE));
+  }
+  return samples;
+}
+
+static float rmsOf(const int16_t* samples, size_t count) {
+  double energy = 0;
+  for (size_t i = 0; i < count; i++) energy += (double)samples[i] * samples[i];
+  return count ? (float)sqrt(energy / count) : 0.0f;
+}
+
+static void runPipeline(AudioPipeline& pipeline, std::vector<int16_t>& samples) {
+  for (size_t offset = 0; offset + BLOCK_SAMPLES <= samples.size(); offset += BLOCK_SAMPLES) {
+    pipeline.process(&samples[offset], BLOCK_SAMPLES);
+  }
+}
+
+// ============================================================================
+// BENCHMARKS
+// ============================================================================
+
+// Mean cycles per block of one stage mask, best of PASSES
+static uint32_t stageCost(const std::vector<int16_t>& input, uint8_t stages) {
+  uint64_t best = UINT64_MAX;
+  size_t blocks = input.size() / BLOCK_SAMPLES;
+  for (uint8_t pass = 0; pass < PASSES; pass++) {
+    std::vector<int16_t> samples(input);
+    AudioPipeline pipeline;
+    pipeline.begin(SAMPLE_RATE, stages);
+    uint32_t start = hal::cycleCount();
+    runPipeline(pipeline, samples);
+    best = min(best, (uint64_t)(hal::cycleCount() - start));
+  }
+  return blocks ? (uint32_t)(best / blocks) : 0;
+}
+
+static void printCosts(const std::vector<int16_t>& raw) {
+  Serial.println(F("  Cost per 256-sample block (best of 5 passes):"));
+  for (uint8_t i = 0; i < AUDIO_STAGES; i++) {
+    Serial.print(F("    "));
+    Serial.print(audioStageName((AudioStage)i));
+    Serial.print(F(": "));
+    Serial.print(stageCost(raw, 1 << i));
+    Serial.println(F(" cycles"));
+  }
+  Serial.print(F("    firmware chain (input + stream stages): "));
+  Serial.print(stageCost(raw, AUDIO_INPUT_STAGES | AUDIO_STREAM_STAGES));
+  Serial.println(F(" cycles"));
+}
+
+static void printResponse() {
+  Serial.println(F("  DC block + high-pass response (steady state, after 1 s):"));
+  AudioPipeline pipeline;
+  pipeline.begin(SAMPLE_RATE, AUDIO_PIPELINE_DC_BLOCK | AUDIO_PIPELINE_HIGHPASS);
+  std::vector<int16_t> dc(2 * SAMPLE_RATE, MIC_OFFSET);
+  runPipeline(pipeline, dc);
+  double sum = 0;
+  for (size_t i = SAMPLE_RATE; i < dc.size(); i++) sum += dc[i];
+  Serial.print(F("    DC "));
+  Serial.print(MIC_OFFSET);
+  Serial.print(F(" LSB -> "));
+  Serial.print(sum / SAMPLE_RATE, 2);
+  Serial.println(F(" LSB"));
+
+  const float frequencies[] = { 30, 50, 80, 125, 250, 1000, 4000 };
+  for (float frequency : frequencies) {
+    std::vector<int16_t> input = tone(frequency, 2.0f);
+    std::vector<int16_t> output(input);
+    pipeline.begin(SAMPLE_RATE, AUDIO_PIPELINE_DC_BLOCK | AUDIO_PIPELINE_HIGHPASS);
+    runPipeline(pipeline, output);
+    float gain = rmsOf(&output[SAMPLE_RATE], SAMPLE_RATE) / rmsOf(&input[SAMPLE_RATE], SAMPLE_RATE);
+    Serial.print(F("    "));
+    Serial.print((int)frequency);
+    Serial.print(F(" Hz: "));
+    Serial.print(20.0f * log10f(max(gain, 1e-6f)), 1);
+    Serial.println(F(" dB"));
+  }
+}
+
+// RMS of the ADPCM coding error (decoded - input), one encoder state
+static float codingNoise(const std::vector<int16_t>& input) {
+  ADPCMCodec codec;
+  uint8_t codes[BLOCK_SAMPLES / 2];
+  int16_t decoded[BLOCK_SAMPLES];
+  double error = 0;
+  size_t count = 0;
+  for (size_t offset = 0; offset + BLOCK_SAMPLES <= input.size(); offset += BLOCK_SAMPLES) {
+    codec.encode(&input[offset], BLOCK_SAMPLES, codes);
+    codec.decode(codes, BLOCK_SAMPLES, decoded);
+    for (size_t i = 0; i < BLOCK_SAMPLES; i++) {
+      double difference = (double)decoded[i] - input[offset + i];
+      error += difference * difference;
+    }
+    count += BLOCK_SAMPLES;
+  }
+  return count ? (float)sqrt(error / count) : 0.0f;
+}
+
+// Quietest block RMS: what the VAD sees as the noise floor
+static float quietestBlock(const std::vector<int16_t>& input) {
+  float quietest = 32767;
+  for (size_t offset = 0; offset + BLOCK_SAMPLES <= input.size(); offset += BLOCK_SAMPLES) {
+    quietest = min(quietest, rmsOf(&input[offset], BLOCK_SAMPLES));
+  }
+  return quietest;
+}
+
+static void printConditioning(const std::vector<int16_t>& raw) {
+  std::vector<int16_t> conditioned(raw);
+  AudioPipeline pipeline;
+  pipeline.begin(SAMPLE_RATE, AUDIO_INPUT_STAGES);
+  runPipeline(pipeline, conditioned);
+
+  Serial.println(F("  Raw microphone vs. input stages:"));
+  Serial.print(F("    ADPCM coding noise RMS: "));
+  Serial.print(codingNoise(raw), 1);
+  Serial.print(F(" -> "));
+  Serial.println(codingNoise(conditioned), 1);
+  Serial.print(F("    Quietest block RMS (VAD noise floor): "));
+  Serial.print(quietestBlock(raw), 1);
+  Serial.print(F(" -> "));
+  Serial.println(quietestBlock(conditioned), 1);
+}
+
+static void printAgc(const std::vector<int16_t>& speech) {
+  // The target applies to blocks above the gate; pauses pull the mean down
+  Serial.println(F("  AGC on speech (last half of the clip):"));
+  const float levels[] = { 0.03f, 0.1f, 0.3f, 1.0f, 3.0f };
+  for (float level : levels) {
+    std::vector<int16_t> samples(speech.size());
+    for (size_t i = 0; i < samples.size(); i++) {
+      samples[i] = (int16_t)max(-32768.0f, min(32767.0f, speech[i] * level));
+    }
+    size_t half = samples.size() / 2;
+    float inputRms = rmsOf(&samples[half], samples.size() - half);
+
+    AudioPipeline pipeline;
+    pipeline.begin(SAMPLE_RATE, AUDIO_PIPELINE_AGC);
+    runPipeline(pipeline, samples);
+    uint32_t clipped = 0;
+    int32_t peak = 0;
+    for (size_t i = half; i < samples.size(); i++) {
+      int32_t magnitude = abs((int32_t)samples[i]);
+      peak = max(peak, magnitude);
+      if (magnitude >= 32767) clipped++;
+    }
+    Serial.print(F("    in RMS "));
+    Serial.print((int)inputRms);
+    Serial.print(F(" -> out RMS "));
+    Serial.print((int)rmsOf(&samples[half], samples.size() - half));
+    Serial.print(F(", peak "));
+    Serial.print(peak);
+    Serial.print(F(", clipped "));
+    Serial.print(clipped);
+    Serial.print(F(", gain x"));
+    Serial.println(pipeline.getAgcGain() / (float)AGC_GAIN_ONE, 2);
+  }
+}
+
+int main(int argc, char** argv) {
+  Serial.println(F("========================================"));
+  Serial.println(F("[DspBench] Audio DSP pipeline: DC block, high-pass, AGC"));
+  Serial.println(F("========================================"));
+
+  std::vector<int16_t> speech(4 * SAMPLE_RATE);
+  generateSpeechTestSignal(speech.data(), speech.size(), SAMPLE_RATE);
+  std::vector<int16_t> raw;
+  if (argc > 1) {
+    WavData wav;
+    if (!loadWavFile(argv[1], wav)) return 1;
+    if (wav.sampleRate != SAMPLE_RATE) {
+      Serial.println(F("  Clip is not 16 kHz"));
+      return 1;
+    }
+    raw.swap(wav.samples);
+    speech = raw;
+  } else {
+    raw = rawMicrophone(speech);
+  }
+
+  printCosts(raw);
+  printResponse();
+  printConditioning(raw);
+  printAgc(speech);
+  Serial.println(F("========================================"));
+  return 0;
+}
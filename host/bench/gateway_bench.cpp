@@ -0,0 +1,185 @@
+/*
+ * Gateway multi-stream decoder benchmark (host)
+ * Decodes N framed BEACON audio streams in lockstep with each
+ * MultiStreamADPCMDecoder engine and reports streams per core at the
+ * 16 kHz capture rate, against the per-stream ADPCMCodec::decode() loop.
+ *
+ * Usage: gateway_bench [streams]   (default 64)
+ */
+
+#include <Arduino.h>
+#include "ADPCMCodec.h"
+#include "AudioFrame.h"
+#include "CodecBenchmark.h"
+#include "Config.h"
+#include "gateway/MultiStreamDecoder.h"
+
+#include <vector>
+
+static const size_t FRAME_SAMPLES = 256;       // AudioDetector streaming block
+static const size_t STREAM_SECONDS = 2;
+static const uint8_t BENCH_PASSES = 5;
+
+struct StreamSet {
+  size_t numStreams;
+  size_t numFrames;
+  std::vector<std::vector<uint8_t>> frames;    // [stream] -> numFrames framed packets
+  std::vector<std::vector<int16_t>> reference; // [stream] -> ADPCMCodec::decode() output
+};
+
+static size_t frameBytes() {
+  return AUDIO_FRAME_HEADER_SIZE + FRAME_SAMPLES / 2;
+}
+
+// Encode each stream from a different offset of the speech signal, framed
+// exactly as AudioDetector sends it
+static void buildStreams(StreamSet& set, size_t numStreams) {
+  const uint32_t sampleRate = AUDIO_BASE_SAMPLE_RATE;
+  std::vector<int16_t> speech(sampleRate * 10);
+  generateSpeechTestSignal(speech.data(), speech.size(), sampleRate);
+
+  set.numStreams = numStreams;
+  set.numFrames = sampleRate * STREAM_SECONDS / FRAME_SAMPLES;
+  set.frames.assign(numStreams, std::vector<uint8_t>(set.numFrames * frameBytes()));
+  set.reference.assign(numStreams, std::vector<int16_t>(set.numFrames * FRAME_SAMPLES));
+
+  std::vector<int16_t> block(FRAME_SAMPLES);
+  for (size_t s = 0; s < numStreams; s++) {
+    ADPCMCodec encoder;
+    ADPCMCodec decoder;
+    size_t offset = (s * 7919) % speech.size();
+
+    for (size_t f = 0; f < set.numFrames; f++) {
+      for (size_t i = 0; i < FRAME_SAMPLES; i++) {
+        // Per-stream gain so lanes do not run in identical states
+        int32_t value = speech[(offset + f * FRAME_SAMPLES + i) % speech.size()] * (int32_t)(4 + s % 5) / 4;
+        block[i] = (int16_t)max((int32_t)-32768, min((int32_t)32767, value));
+      }
+
+      uint8_t* frame = &set.frames[s][f * frameBytes()];
+      AudioFrameHeader header;
+      int16_t predicted, stepIndex;
+      encoder.getState(predicted, stepIndex);
+      header.stepIndex = (uint8_t)stepIndex;
+      header.predictor = predicted;
+      header.sequence = (uint16_t)f;
+      header.sampleIndex = f * FRAME_SAMPLES;
+      header.sampleCount = FRAME_SAMPLES;
+      writeAudioFrameHeader(header, frame);
+      encoder.encode(block.data(), FRAME_SAMPLES, frame + AUDIO_FRAME_HEADER_SIZE);
+
+      decoder.setDecoderState(header.predictor, header.stepIndex);
+      decoder.decode(frame + AUDIO_FRAME_HEADER_SIZE, FRAME_SAMPLES, &set.reference[s][f * FRAME_SAMPLES]);
+    }
+  }
+}
+
+// Baseline: one scalar ADPCMCodec per stream, frame by frame
+static uint32_t timeCodecLoop(const StreamSet& set, std::vector<std::vector<int16_t>>& output) {
+  std::vector<ADPCMCodec> decoders(set.numStreams);
+  uint32_t best = UINT32_MAX;
+
+  for (uint8_t pass = 0; pass < BENCH_PASSES; pass++) {
+    uint32_t start = hal::cycleCount();
+    for (size_t f = 0; f < set.numFrames; f++) {
+      for (size_t s = 0; s < set.numStreams; s++) {
+        const uint8_t* frame = &set.frames[s][f * frameBytes()];
+        AudioFrameHeader header;
+        parseAudioFrameHeader(frame, frameBytes(), header);
+        decoders[s].setDecoderState(header.predictor, header.stepIndex);
+        decoders[s].decode(frame + AUDIO_FRAME_HEADER_SIZE, header.sampleCount, &output[s][f * FRAME_SAMPLES]);
+      }
+    }
+    uint32_t elapsed = hal::cycleCount() - start;
+    if (elapsed < best) best = elapsed;
+  }
+  return best;
+}
+
+static uint32_t timeMultiStream(const StreamSet& set, MultiStreamEngine engine,
+                                std::vector<std::vector<int16_t>>& output) {
+  MultiStreamADPCMDecoder decoder(set.numStreams);
+  decoder.setEngine(engine);
+
+  std::vector<const uint8_t*> frames(set.numStreams);
+  std::vector<size_t> lengths(set.numStreams, frameBytes());
+  std::vector<int16_t*> outputs(set.numStreams);
+  uint32_t best = UINT32_MAX;
+
+  for (uint8_t pass = 0; pass < BENCH_PASSES; pass++) {
+    uint32_t start = hal::cycleCount();
+    for (size_t f = 0; f < set.numFrames; f++) {
+      for (size_t s = 0; s < set.numStreams; s++) {
+        frames[s] = &set.frames[s][f * frameBytes()];
+        outputs[s] = &output[s][f * FRAME_SAMPLES];
+      }
+      decoder.decodeFrames(frames.data(), lengths.data(), outputs.data(), FRAME_SAMPLES);
+    }
+    uint32_t elapsed = hal::cycleCount() - start;
+    if (elapsed < best) best = elapsed;
+  }
+  return best;
+}
+
+static void printRow(const char* name, uint32_t elapsed, const StreamSet& set,
+                     const std::vector<std::vector<int16_t>>& output) {
+  size_t totalSamples = set.numStreams * set.numFrames * FRAME_SAMPLES;
+  float nsPerSample = elapsed * (1000.0f / hal::cpuFrequencyMHz()) / totalSamples;
+
+  bool exact = true;
+  for (size_t s = 0; s < set.numStreams && exact; s++) {
+    exact = (output[s] == set.reference[s]);
+  }
+
+  Serial.print(F("  "));
+  Serial.print(name);
+  Serial.print(F("\t| "));
+  Serial.print(nsPerSample, 3);
+  Serial.print(F("\t| "));
+  Serial.print(1000.0f / nsPerSample, 1);
+  Serial.print(F("\t| "));
+  Serial.print((unsigned long)(1e9f / (nsPerSample * AUDIO_BASE_SAMPLE_RATE)));
+  Serial.print(F("\t| "));
+  Serial.println(exact ? F("YES") : F("NO"));
+}
+
+int main(int argc, char** argv) {
+  size_t numStreams = (argc > 1) ? (size_t)atoi(argv[1]) : 64;
+  if (numStreams == 0) numStreams = 1;
+
+  StreamSet set;
+  buildStreams(set, numStreams);
+  std::vector<std::vector<int16_t>> output(numStreams, std::vector<int16_t>(set.numFrames * FRAME_SAMPLES));
+
+  Serial.println(F("========================================"));
+  Serial.println(F("[GatewayBench] Multi-stream ADPCM decode"));
+  Serial.println(F("========================================"));
+  Serial.print(F("  Streams: "));
+  Serial.print(numStreams);
+  Serial.print(F(", "));
+  Serial.print(set.numFrames);
+  Serial.print(F(" frames x "));
+  Serial.print(FRAME_SAMPLES);
+  Serial.print(F(" samples each @ "));
+  Serial.print(AUDIO_BASE_SAMPLE_RATE);
+  Serial.println(F(" Hz"));
+  Serial.println(F("  engine | ns/smp | Msmp/s | streams/core @16k | bit-exact"));
+
+  printRow("codec", timeCodecLoop(set, output), set, output);
+
+  const MultiStreamEngine engines[] = {MULTISTREAM_SCALAR, MULTISTREAM_SSE41, MULTISTREAM_AVX2};
+  for (size_t e = 0; e < sizeof(engines) / sizeof(engines[0]); e++) {
+    const char* name = MultiStreamADPCMDecoder::engineName(engines[e]);
+    if (!MultiStreamADPCMDecoder::engineSupported(engines[e])) {
+      Serial.print(F("  "));
+      Serial.print(name);
+      Serial.println(F("\t| not supported on this CPU"));
+      continue;
+    }
+    for (size_t s = 0; s < numStreams; s++) std::fill(output[s].begin(), output[s].end(), 0);
+    printRow(name, timeMultiStream(set, engines[e], output), set, output);
+  }
+
+  Serial.println(F("========================================"));
+  return 0;
+}
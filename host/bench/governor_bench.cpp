@@ -0,0 +1,286 @@
+/*
+ * BLE bandwidth governor benchmark (host)
+ * Streams speech through AudioDetector, DataScheduler and
+ * BLEManager::processDataQueue() (per-packet notifications) into the host
+ * BLE link model, with heart rate at 1 Hz and an alert every 5 s, on a
+ * manual clock. Each link is run twice:
+ * - unpaced:  governor and codec adaptation off; every queued packet is
+ *             notified at once, as before the governor
+ * - governed: byte token bucket fed by notify completions, codec stepping
+ *             down / up the ladder with the link budget
+ * and reports per run: notifications that failed on full stack buffers
+ * (overfill), audio frames and payload delivered, alerts and heart rates
+ * delivered of those queued, live frames refused over the link budget,
+ * codec changes, the final estimate of the link rate, packets expired past
+ * their queue deadline and the queue age (p50 / p99) of what was sent.
+ * Every alert must arrive (a failed alert notify is requeued): the bench
+ * fails otherwise.
+ *
+ * Stall: the ample link stops for 2 s every 10 s (governed), with plain
+ * FIFO queues (no deadlines: the stale backlog goes out first after each
+ * stall) and with the scheduler's deadlines (EDF, expired packets dropped).
+ *
+ * Worst-case load: DTX and adaptive rate are off, so every 16 ms block is
+ * a full frame (IMA4_16K: 140 bytes, ~9 kB/s on the link).
+ *
+ * Usage: governor_bench [clip.wav]   (default: 30 s synthetic speech)
+ */
+
+#include <Arduino.h>
+#include "AudioDetector.h"
+#include "BLEManager.h"
+#include "CodecBenchmark.h"
+#include "Config.h"
+#include "DataScheduler.h"
+#include "HalHost.h"
+#include "WavFile.h"
+
+#include <string.h>
+#include <vector>
+
+static const uint32_t BLOCK_US = 16000;
+static const uint32_t DRAIN_US = 4000;  // loop() passes per capture block: 4
+static const uint32_t SYNTHETIC_SECONDS = 30;
+static const uint32_t STALL_EVERY_MS = 10000;
+static const uint32_t STALL_MS = 2000;
+static const uint32_t ALERT_DRAIN_US = 5000000;  // After the run, for alerts still queued
+
+struct LinkCase {
+  const char* name;
+  uint16_t connInterval;   // 1.25 ms units
+  uint16_t bytesPerEvent;  // On-air bytes per connection event
+  uint8_t bufferPackets;   // Stack TX buffers
+};
+
+// One 251-byte LL packet per event on the slow links: a full IMA4_16K
+// frame (147 bytes on air) leaves no room for a second one
+static const LinkCase LINKS[] = {
+  { "ample  (15 ms, 4 x 251 B/event)", 12, 1004, 12 },
+  { "slow   (30 ms, 251 B/event)   ", 24, 251, 12 },
+  { "poor   (45 ms, 251 B/event)   ", 36, 251, 12 },
+};
+
+// Samples become available as the clock advances (like DMA buffers)
+struct PacedSource {
+  const std::vector<int16_t>* pcm;
+  size_t position;
+  uint64_t elapsedMicros;
+  uint32_t lastMicros;
+  bool started;
+};
+
+static bool readPaced(void* context, int16_t* samples, size_t maxSamples, size_t& samplesRead) {
+  PacedSource* source = (PacedSource*)context;
+  samplesRead = 0;
+  if (source->position >= source->pcm->size()) return false;
+  uint32_t now = micros();
+  if (!source->started) {
+    source->started = true;
+    source->lastMicros = now;
+  }
+  source->elapsedMicros += (uint32_t)(now - source->lastMicros);
+  source->lastMicros = now;
+
+  uint64_t due = min((uint64_t)source->pcm->size(), source->elapsedMicros * I2S_SAMPLE_RATE / 1000000);
+  if (due <= source->position) return true;
+  samplesRead = (size_t)min((uint64_t)maxSamples, due - source->position);
+  memcpy(samples, &(*source->pcm)[source->position], samplesRead * sizeof(int16_t));
+  source->position += samplesRead;
+  return true;
+}
+
+struct Delivered {
+  uint32_t audioFrames;
+  uint64_t audioBytes;
+  uint32_t alerts;
+  uint32_t heartRates;
+};
+
+static void onNotify(const char* uuid, const uint8_t* data, size_t length, void* context) {
+  (void)data;
+  Delivered* delivered = (Delivered*)context;
+  if (strcasecmp(uuid, AUDIO_CHAR_UUID) == 0) {
+    delivered->audioFrames++;
+    delivered->audioBytes += length;
+  } else if (strcasecmp(uuid, ALERT_CHAR_UUID) == 0) {
+    delivered->alerts++;
+  } else if (strcasecmp(uuid, HR_CHAR_UUID) == 0) {
+    delivered->heartRates++;
+  }
+}
+
+static bool run(BLEManager& ble, const std::vector<int16_t>& pcm, const LinkCase& link, const char* label,
+                bool governed, bool deadlines, bool stalls) {
+  hal::host::muteSerial(true);
+  DataScheduler scheduler;
+  scheduler.begin();
+  scheduler.setPacingEnabled(governed);
+  if (!deadlines) {
+    scheduler.setDeadline(DATA_HEART_RATE, 0);
+    scheduler.setDeadline(DATA_AUDIO, 0);
+  }
+  ble.setDataScheduler(&scheduler);
+
+  PacedSource paced = { &pcm, 0, 0, 0, false };
+  AudioSource source;
+  source.read = readPaced;
+  source.context = &paced;
+  source.name = "bench speech";
+  AudioDetector* detector = new AudioDetector();
+  detector->setAudioSource(&source);
+  detector->begin();
+  detector->setDataScheduler(&scheduler);
+  detector->setPreTrigger(false);
+  detector->setDTX(false);
+  detector->setAdaptiveRate(false);
+  detector->setLinkAdaptation(governed);
+  detector->enableStreaming(true);
+
+  hal::host::setLinkModel((uint32_t)link.connInterval * 1250, link.bytesPerEvent, link.bufferPackets);
+  NimBLEServer* server = ble.getServer();
+  server->hostConnect(BLE_REQUESTED_MTU, link.connInterval);
+  Delivered delivered;
+  memset(&delivered, 0, sizeof(delivered));
+  hal::host::setNotifyHook(onNotify, &delivered);
+  uint32_t failuresBefore = hal::host::getNotifyFailures();
+
+  uint32_t alertsQueued = 0, heartRatesQueued = 0, codecChanges = 0;
+  AudioCodecMode codec = detector->getCodecMode();
+  uint32_t blocks = (uint32_t)((uint64_t)pcm.size() * 1000000 / I2S_SAMPLE_RATE / BLOCK_US);
+  for (uint32_t block = 0; block < blocks; block++) {
+    uint32_t ms = block * BLOCK_US / 1000;
+    if (ms % 5000 < BLOCK_US / 1000 && scheduler.enqueueAlert("FALL_DETECTED")) alertsQueued++;
+    if (ms % 1000 < BLOCK_US / 1000 && scheduler.enqueueHeartRate((uint8_t)(60 + block % 40))) heartRatesQueued++;
+    if (stalls && (ms + STALL_EVERY_MS / 2) % STALL_EVERY_MS < BLOCK_US / 1000) hal::host::stallLink(STALL_MS * 1000);
+    for (uint32_t us = 0; us < BLOCK_US; us += DRAIN_US) {
+      hal::host::advanceMicros(DRAIN_US);
+      if (us == 0) detector->update();
+      ble.processDataQueue();
+    }
+    if (detector->getCodecMode() != codec) {
+      codec = detector->getCodecMode();
+      codecChanges++;
+    }
+  }
+
+  // Alerts still queued at the end (a failed notify put back behind a
+  // stall) get the link to themselves until they are out
+  for (uint32_t us = 0; us < ALERT_DRAIN_US && scheduler.getCriticalQueueCount() > 0; us += DRAIN_US) {
+    hal::host::advanceMicros(DRAIN_US);
+    ble.processDataQueue();
+  }
+
+  uint32_t failures = hal::host::getNotifyFailures() - failuresBefore;
+  uint32_t requeued = scheduler.getRequeuedAlerts();
+  hal::host::setNotifyHook(nullptr, nullptr);
+  server->hostDisconnect();
+  ble.processDataQueue();  // Sees the disconnect
+  hal::host::setLinkModel(0, 0, 0);
+  const BandwidthGovernor& governor = scheduler.getGovernor();
+  uint32_t refused = scheduler.getRateLimitedAudioPackets() + scheduler.getDroppedAudioPackets();
+  const QueueAgeHistogram& audioAges = scheduler.getQueueAges(DATA_AUDIO);
+  const QueueAgeHistogram& heartRateAges = scheduler.getQueueAges(DATA_HEART_RATE);
+  detector->end();
+  delete detector;
+  ble.setDataScheduler(nullptr);
+  hal::host::muteSerial(false);
+
+  float seconds = (float)blocks * BLOCK_US / 1000000;
+  Serial.print(F("    "));
+  Serial.print(label);
+  Serial.print(failures);
+  Serial.print(F(" failed notifies, audio "));
+  Serial.print(delivered.audioFrames / seconds, 1);
+  Serial.print(F(" frames/s ("));
+  Serial.print(delivered.audioBytes * 8 / seconds / 1000, 1);
+  Serial.print(F(" kbps), alerts "));
+  Serial.print(delivered.alerts);
+  Serial.print(F("/"));
+  Serial.print(alertsQueued);
+  if (requeued > 0) {
+    Serial.print(F(" ("));
+    Serial.print(requeued);
+    Serial.print(F(" requeued)"));
+  }
+  Serial.print(F(", HR "));
+  Serial.print(delivered.heartRates);
+  Serial.print(F("/"));
+  Serial.println(heartRatesQueued);
+  Serial.print(F("              "));
+  Serial.print(refused);
+  Serial.print(F(" frames refused at the queue, codec "));
+  Serial.print(audioCodecName(codec));
+  Serial.print(F(" after "));
+  Serial.print(codecChanges);
+  Serial.print(F(" changes, link estimate "));
+  Serial.print(governor.getRate());
+  Serial.print(F(" B/s ("));
+  Serial.print(governor.getCongestedWindows());
+  Serial.println(F(" congested windows)"));
+  Serial.print(F("              expired "));
+  Serial.print(scheduler.getExpiredAudioPackets());
+  Serial.print(F(" frames / "));
+  Serial.print(scheduler.getExpiredHeartRates());
+  Serial.print(F(" HR, queue age p50 / p99: audio "));
+  Serial.print(audioAges.percentile(50));
+  Serial.print(F(" / "));
+  Serial.print(audioAges.percentile(99));
+  Serial.print(F(" ms, HR "));
+  Serial.print(heartRateAges.percentile(50));
+  Serial.print(F(" / "));
+  Serial.print(heartRateAges.percentile(99));
+  Serial.println(F(" ms"));
+  if (delivered.alerts != alertsQueued) Serial.println(F("              FAIL: alert lost"));
+  return delivered.alerts == alertsQueued;
+}
+
+int main(int argc, char** argv) {
+  std::vector<int16_t> pcm;
+  const char* sourceName = "synthetic speech";
+  if (argc > 1) {
+    WavData wav;
+    if (!loadWavFile(argv[1], wav)) return 1;
+    if (wav.sampleRate != I2S_SAMPLE_RATE) {
+      Serial.println(F("[GovernorBench] Clip must be 16 kHz"));
+      return 1;
+    }
+    pcm = wav.samples;
+    sourceName = argv[1];
+  } else {
+    pcm.resize(I2S_SAMPLE_RATE * SYNTHETIC_SECONDS);
+    generateSpeechTestSignal(pcm.data(), pcm.size(), I2S_SAMPLE_RATE);
+  }
+
+  hal::host::useManualClock(true);
+  hal::host::muteSerial(true);
+  BLEManager ble;  // One NimBLE server for all runs
+  ble.begin();
+  hal::host::muteSerial(false);
+
+  Serial.println(F("========================================"));
+  Serial.print(F("[GovernorBench] "));
+  Serial.print(sourceName);
+  Serial.print(F(" ("));
+  Serial.print((float)pcm.size() / I2S_SAMPLE_RATE, 1);
+  Serial.println(F(" s), full frames, HR 1 Hz, alert every 5 s"));
+  Serial.println(F("========================================"));
+  bool allAlerts = true;
+  for (const LinkCase& link : LINKS) {
+    Serial.print(F("  Link "));
+    Serial.println(link.name);
+    allAlerts &= run(ble, pcm, link, "unpaced:  ", false, true, false);
+    allAlerts &= run(ble, pcm, link, "governed: ", true, true, false);
+  }
+  Serial.print(F("  Link "));
+  Serial.print(LINKS[0].name);
+  Serial.print(F(", stalled "));
+  Serial.print(STALL_MS);
+  Serial.print(F(" ms every "));
+  Serial.print(STALL_EVERY_MS);
+  Serial.println(F(" ms"));
+  allAlerts &= run(ble, pcm, LINKS[0], "FIFO:     ", true, false, true);
+  allAlerts &= run(ble, pcm, LINKS[0], "EDF:      ", true, true, true);
+  Serial.println(F("========================================"));
+  Serial.println(allAlerts ? F("[GovernorBench] PASS: every alert delivered") : F("[GovernorBench] FAIL"));
+  return allAlerts ? 0 : 1;
+}
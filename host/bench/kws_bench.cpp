@@ -0,0 +1,194 @@
+/*
+ * SOS keyword spotter benchmark (host)
+ * Runs KeywordSpotter (same features, kernels and model as the watch) over
+ * audio clips and reports detections, the best SOS score, inference cost
+ * and memory.
+ *
+ * Usage: kws_bench [clip.wav ...]   (16 kHz mono)
+ * Without arguments a set of synthetic clips is used: a spoken-like
+ * "S-O-S" (hiss, vowel, hiss) at two levels, plus negatives.
+ *
+ * Host cycle counts are nanoseconds; on the watch divide by the 160 MHz
+ * clock instead.
+ */
+
+#include <Arduino.h>
+#include "CodecBenchmark.h"
+#include "KeywordSpotter.h"
+#include "WavFile.h"
+
+#include <vector>
+
+static const size_t BLOCK_SAMPLES = 256;  // AudioDetector::STREAM_BUFFER_SIZE
+static const uint32_t SAMPLE_RATE = 16000;
+
+// ============================================================================
+// SYNTHETIC CLIPS
+// ============================================================================
+
+static uint32_t noiseState = 0x2545F491;
+
+static float whiteNoise() {
+  noiseState = noiseState * 1664525u + 1013904223u;
+  return ((int32_t)(noiseState >> 8) - (1 << 23)) / 8388608.0f;
+}
+
+// Fricative: differentiated white noise (energy rises towards 8 kHz)
+static void addHiss(std::vector<int16_t>& clip, float start, float length, float amplitude) {
+  size_t first = (size_t)(start * SAMPLE_RATE);
+  size_t count = (size_t)(length * SAMPLE_RATE);
+  float previous = 0;
+  for (size_t i = first; i < first + count && i < clip.size(); i++) {
+    float white = whiteNoise();
+    clip[i] = (int16_t)max(-32768.0f, min(32767.0f, clip[i] + amplitude * (white - previous)));
+    previous = white;
+  }
+}
+
+// Vowel /o/: 140 Hz harmonics shaped by formants at 500 and 900 Hz
+static void addVowel(std::vector<int16_t>& clip, float start, float length, float amplitude) {
+  const float twoPi = 6.2831853f;
+  size_t first = (size_t)(start * SAMPLE_RATE);
+  size_t count = (size_t)(length * SAMPLE_RATE);
+  for (size_t i = 0; i < count && first + i < clip.size(); i++) {
+    float t = (float)i / SAMPLE_RATE;
+    float sample = 0;
+    for (int h = 1; h < 20; h++) {
+      float f = 140.0f * h;
+      float gain = expf(-powf((f - 500.0f) / 200.0f, 2)) + 0.7f * expf(-powf((f - 900.0f) / 250.0f, 2)) + 0.05f;
+      sample += gain * sinf(twoPi * f * t);
+    }
+    clip[first + i] = (int16_t)max(-32768.0f, min(32767.0f, clip[first + i] + amplitude * sample / 2));
+  }
+}
+
+static void addBackground(std::vector<int16_t>& clip, float amplitude) {
+  for (size_t i = 0; i < clip.size(); i++) clip[i] = (int16_t)(clip[i] + amplitude * whiteNoise());
+}
+
+static std::vector<int16_t> sosClip(float amplitude) {
+  std::vector<int16_t> clip(3 * SAMPLE_RATE, 0);
+  addBackground(clip, 30);
+  addHiss(clip, 1.08f, 0.24f, amplitude * 0.75f);
+  addVowel(clip, 1.36f, 0.28f, amplitude);
+  addHiss(clip, 1.68f, 0.24f, amplitude * 0.75f);
+  return clip;
+}
+
+// ============================================================================
+// BENCHMARK
+// ============================================================================
+
+static void runClip(KeywordSpotter& spotter, const char* name, const int16_t* samples, size_t count) {
+  spotter.reset();
+  uint32_t inferencesBefore = spotter.getInferences();
+  uint32_t detectionsBefore = spotter.getDetections();
+  uint64_t cycles = 0;
+  uint32_t maxCycles = 0;
+  uint8_t bestScore = 0;
+  float firstDetection = -1;
+
+  for (size_t offset = 0; offset + BLOCK_SAMPLES <= count; offset += BLOCK_SAMPLES) {
+    size_t done = 0;
+    while (done < BLOCK_SAMPLES) {
+      uint32_t inferences = spotter.getInferences();
+      done += spotter.process(samples + offset + done, BLOCK_SAMPLES - done);
+      if (spotter.getInferences() != inferences) {
+        cycles += spotter.getInferenceCycles();
+        maxCycles = max(maxCycles, spotter.getInferenceCycles());
+        bestScore = max(bestScore, spotter.getLastScore());
+      }
+      if (spotter.detected() && firstDetection < 0) {
+        firstDetection = (float)(offset + done) / SAMPLE_RATE;
+      }
+    }
+  }
+
+  uint32_t inferences = spotter.getInferences() - inferencesBefore;
+  Serial.print(F("  "));
+  Serial.print(name);
+  Serial.print(F("\t| "));
+  Serial.print(spotter.getDetections() - detectionsBefore);
+  Serial.print(F("\t| "));
+  Serial.print(bestScore);
+  Serial.print(F("%\t| "));
+  if (firstDetection >= 0) {
+    Serial.print(firstDetection, 2);
+    Serial.print(F(" s"));
+  } else {
+    Serial.print(F("-"));
+  }
+  Serial.print(F("\t| "));
+  Serial.print(inferences);
+  Serial.print(F("\t| "));
+  Serial.print((unsigned long)(inferences ? cycles / inferences : 0));
+  Serial.print(F(" (max "));
+  Serial.print(maxCycles);
+  Serial.println(F(")"));
+}
+
+int main(int argc, char** argv) {
+  static KeywordSpotter spotter;  // Static like the firmware's (arena is not on the stack)
+  if (!spotter.begin()) {
+    Serial.println(F("[KwsBench] ERROR: model does not fit the arena"));
+    return 1;
+  }
+
+  Serial.println(F("========================================"));
+  Serial.println(F("[KwsBench] SOS keyword spotter"));
+  Serial.println(F("========================================"));
+  Serial.print(F("  Model: "));
+  Serial.print(spotter.getMacsPerInference());
+  Serial.print(F(" MACs/inference, every "));
+  Serial.print(KWS_INFERENCE_HOPS * 10);
+  Serial.println(F(" ms"));
+  Serial.print(F("  RAM: arena peak "));
+  Serial.print((unsigned long)spotter.getArenaPeak());
+  Serial.print(F(" / "));
+  Serial.print((unsigned long)spotter.getArenaSize());
+  Serial.print(F(" bytes, "));
+  Serial.print((unsigned long)spotter.getStaticRam());
+  Serial.println(F(" bytes total (arena + feature ring + front-end)"));
+  Serial.println(F("  clip\t| detections | best score | first at | inferences | cycles/inference"));
+
+  if (argc < 2) {
+    std::vector<int16_t> clip = sosClip(8000);
+    runClip(spotter, "sos", clip.data(), clip.size());
+    clip = sosClip(2000);
+    runClip(spotter, "sos-quiet", clip.data(), clip.size());
+
+    clip.assign(10 * SAMPLE_RATE, 0);
+    generateSpeechTestSignal(clip.data(), clip.size(), SAMPLE_RATE);
+    runClip(spotter, "speech", clip.data(), clip.size());
+
+    clip.assign(3 * SAMPLE_RATE, 0);
+    addBackground(clip, 30);
+    runClip(spotter, "silence", clip.data(), clip.size());
+
+    clip.assign(3 * SAMPLE_RATE, 0);
+    addBackground(clip, 4000);
+    runClip(spotter, "noise", clip.data(), clip.size());
+
+    clip.assign(3 * SAMPLE_RATE, 0);
+    addHiss(clip, 0.0f, 3.0f, 6000);
+    runClip(spotter, "hiss", clip.data(), clip.size());
+
+    clip.assign(3 * SAMPLE_RATE, 0);
+    addVowel(clip, 0.0f, 3.0f, 8000);
+    runClip(spotter, "vowel", clip.data(), clip.size());
+  } else {
+    for (int i = 1; i < argc; i++) {
+      WavData wav;
+      if (!loadWavFile(argv[i], wav)) return 1;
+      if (wav.sampleRate != SAMPLE_RATE) {
+        Serial.print(F("  "));
+        Serial.print(argv[i]);
+        Serial.println(F(": skipped (not 16 kHz)"));
+        continue;
+      }
+      runClip(spotter, argv[i], wav.samples.data(), wav.samples.size());
+    }
+  }
+  Serial.println(F("========================================"));
+  return 0;
+}
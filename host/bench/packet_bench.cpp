@@ -0,0 +1,196 @@
+/*
+ * Packet queue benchmark (host)
+ * Runs the same alert / heart-rate / audio traffic through two layouts of
+ * DataScheduler's queues and reports RAM and cycles per enqueue / dequeue:
+ * - by value: every queue item a 244-byte-payload DataPacket, constructed
+ *             with memset and copied into and out of the queue (the layout
+ *             before the buffer pools)
+ * - pooled:   payloads in PacketPool / BlockPool blocks, queues carry an
+ *             8-byte PacketRef (DataScheduler as built: heart rate and
+ *             audio in SpscRings)
+ *
+ * Host queues are mutex/deque based, so absolute cycle counts differ from
+ * FreeRTOS (ring_bench compares queue and ring alone); the RAM figures are the item and block storage the firmware
+ * allocates (FreeRTOS adds ~80 bytes of control block per queue to both).
+ *
+ * Usage: packet_bench [rounds]   (default 20000)
+ */
+
+#include <Arduino.h>
+#include "DataScheduler.h"
+#include "HalHost.h"
+
+static const size_t CRITICAL_QUEUE = 10;  // DataScheduler::begin() defaults
+static const size_t HIGH_QUEUE = 10;
+static const size_t NORMAL_QUEUE = 20;
+static const size_t AUDIO_FRAME = 136;    // 8-byte header + 256 ADPCM samples
+static const uint8_t BENCH_PASSES = 5;
+
+// DataPacket as it was queued by value before the pools
+struct LegacyDataPacket {
+  DataPriority priority;
+  DataType type;
+  uint32_t timestamp;
+  uint16_t dataSize;
+  uint8_t data[MAX_AUDIO_SIZE];
+
+  LegacyDataPacket() : priority(PRIORITY_NORMAL), type(DATA_AUDIO), timestamp(0), dataSize(0) {
+    memset(data, 0, sizeof(data));
+  }
+};
+
+struct QueueCost {
+  uint32_t enqueueCycles;  // Mean per packet
+  uint32_t dequeueCycles;
+};
+
+// One round: an alert, a heart rate and four audio frames, then drain
+static QueueCost runByValue(uint32_t rounds, const uint8_t* frame) {
+  hal::Queue criticalQueue, highQueue, normalQueue;
+  criticalQueue.create(CRITICAL_QUEUE, sizeof(LegacyDataPacket));
+  highQueue.create(HIGH_QUEUE, sizeof(LegacyDataPacket));
+  normalQueue.create(NORMAL_QUEUE, sizeof(LegacyDataPacket));
+  const char* alert = "FALL_DETECTED";
+  uint64_t enqueueCycles = 0, dequeueCycles = 0;
+  uint32_t packets = 0;
+
+  for (uint32_t round = 0; round < rounds; round++) {
+    for (uint8_t i = 0; i < 6; i++) {
+      uint32_t start = hal::cycleCount();
+      LegacyDataPacket packet;
+      packet.timestamp = millis();
+      hal::Queue* queue = &normalQueue;
+      if (i == 0) {
+        packet.priority = PRIORITY_CRITICAL;
+        packet.type = DATA_ALERT;
+        packet.dataSize = (uint16_t)strlen(alert);
+        memcpy(packet.data, alert, packet.dataSize);
+        packet.data[packet.dataSize] = '\0';
+        queue = &criticalQueue;
+      } else if (i == 1) {
+        packet.priority = PRIORITY_HIGH;
+        packet.type = DATA_HEART_RATE;
+        packet.dataSize = 1;
+        packet.data[0] = 72;
+        queue = &highQueue;
+      } else {
+        packet.dataSize = AUDIO_FRAME;
+        memcpy(packet.data, frame, AUDIO_FRAME);
+      }
+      queue->send(&packet);
+      enqueueCycles += hal::cycleCount() - start;
+    }
+
+    while (true) {
+      uint32_t start = hal::cycleCount();
+      LegacyDataPacket packet;
+      if (!criticalQueue.receive(&packet) && !highQueue.receive(&packet) && !normalQueue.receive(&packet)) break;
+      dequeueCycles += hal::cycleCount() - start;
+      packets++;
+    }
+  }
+  criticalQueue.destroy();
+  highQueue.destroy();
+  normalQueue.destroy();
+
+  QueueCost cost;
+  cost.enqueueCycles = packets ? (uint32_t)(enqueueCycles / packets) : 0;
+  cost.dequeueCycles = packets ? (uint32_t)(dequeueCycles / packets) : 0;
+  return cost;
+}
+
+static QueueCost runPooled(uint32_t rounds, const uint8_t* frame, size_t& memoryUsage) {
+  hal::host::muteSerial(true);  // enqueueAlert()/enqueueHeartRate() log every packet
+  DataScheduler scheduler;
+  scheduler.begin(CRITICAL_QUEUE, HIGH_QUEUE, NORMAL_QUEUE);
+  scheduler.setPacingEnabled(false);
+
+  for (uint32_t round = 0; round < rounds; round++) {
+    scheduler.enqueueAlert("FALL_DETECTED");
+    scheduler.enqueueHeartRate(72);
+    for (uint8_t i = 0; i < 4; i++) {
+      uint8_t slot;
+      uint8_t* buffer = scheduler.acquireAudioBuffer(slot);
+      if (!buffer) break;
+      memcpy(buffer, frame, AUDIO_FRAME);  // The encoder's own write
+      scheduler.commitAudio(slot, AUDIO_FRAME, true);
+    }
+
+    DataPacket packet;
+    while (scheduler.getNextPacket(packet)) {
+      scheduler.releasePacket(packet);
+    }
+  }
+  hal::host::muteSerial(false);
+
+  memoryUsage = scheduler.getMemoryUsage();
+  QueueCost cost;
+  cost.enqueueCycles = scheduler.getMeanEnqueueCycles();
+  cost.dequeueCycles = scheduler.getMeanDequeueCycles();
+  return cost;
+}
+
+static QueueCost best(QueueCost a, QueueCost b) {
+  a.enqueueCycles = min(a.enqueueCycles, b.enqueueCycles);
+  a.dequeueCycles = min(a.dequeueCycles, b.dequeueCycles);
+  return a;
+}
+
+static void printCost(const char* name, const QueueCost& cost) {
+  Serial.print(F("  "));
+  Serial.print(name);
+  Serial.print(cost.enqueueCycles);
+  Serial.print(F(" cycles/enqueue, "));
+  Serial.print(cost.dequeueCycles);
+  Serial.println(F(" cycles/dequeue"));
+}
+
+int main(int argc, char** argv) {
+  uint32_t rounds = (argc > 1) ? (uint32_t)atoi(argv[1]) : 20000;
+  if (rounds == 0) rounds = 1;
+
+  uint8_t frame[AUDIO_FRAME];
+  for (size_t i = 0; i < sizeof(frame); i++) frame[i] = (uint8_t)(i * 37);
+
+  Serial.println(F("========================================"));
+  Serial.println(F("[PacketBench] DataScheduler queues: by value vs. pooled blocks"));
+  Serial.println(F("========================================"));
+
+  QueueCost byValue = runByValue(rounds, frame);
+  size_t pooledMemory = 0;
+  QueueCost pooled = runPooled(rounds, frame, pooledMemory);
+  for (uint8_t pass = 1; pass < BENCH_PASSES; pass++) {
+    byValue = best(byValue, runByValue(rounds, frame));
+    pooled = best(pooled, runPooled(rounds, frame, pooledMemory));
+  }
+
+  size_t byValueMemory = (CRITICAL_QUEUE + HIGH_QUEUE + NORMAL_QUEUE) * sizeof(LegacyDataPacket);
+  Serial.print(F("  Queue items: "));
+  Serial.print(sizeof(LegacyDataPacket));
+  Serial.print(F(" -> "));
+  Serial.print(sizeof(PacketRef));
+  Serial.print(F(" bytes (dequeued DataPacket on the stack: "));
+  Serial.print(sizeof(DataPacket));
+  Serial.println(F(" bytes)"));
+  Serial.print(F("  Packet RAM (queues "));
+  Serial.print(CRITICAL_QUEUE);
+  Serial.print(F("/"));
+  Serial.print(HIGH_QUEUE);
+  Serial.print(F("/"));
+  Serial.print(NORMAL_QUEUE);
+  Serial.print(F("): "));
+  Serial.print(byValueMemory);
+  Serial.print(F(" -> "));
+  Serial.print(pooledMemory);
+  Serial.print(F(" bytes ("));
+  Serial.print((long)byValueMemory - (long)pooledMemory);
+  Serial.println(F(" saved)"));
+
+  Serial.print(F("  Cost per packet, best of 5 passes ("));
+  Serial.print(rounds * 6);
+  Serial.println(F(" packets: 1 alert, 1 HR, 4 audio per round):"));
+  printCost("by value: ", byValue);
+  printCost("pooled:   ", pooled);
+  Serial.println(F("========================================"));
+  return 0;
+}
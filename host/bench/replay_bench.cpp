@@ -0,0 +1,229 @@
+/*
+ * Audio path replay (host)
+ * Pushes a recorded WAV clip through the firmware audio path -
+ * AudioDetector (DSP, VAD, events, codec, DTX, pre-trigger) and
+ * DataScheduler (pool, link budget, queues) - on a manual clock, faster
+ * than real time and repeatable to the byte, and reports:
+ * - throughput (audio seconds per wall-clock second, ns per block)
+ * - drops: samples lost in capture, frames refused over the link budget or
+ *   by a full queue
+ * - every codec change made by link adaptation, with the audio time it
+ *   happened
+ * - the exact packet byte stream (optional file) and its FNV-1a digest, so
+ *   runs of two firmware versions can be diffed
+ *
+ * Usage: replay_bench clip.wav [-o packets.txt] [-c] [-t seconds]... [-l packets]
+ *   -o  write one line per notification: time_ms type length hex
+ *   -c  continuous streaming (pre-trigger off); default is Config.h
+ *   -t  "AUDIO_TRIGGER" command at this audio time (repeatable)
+ *   -l  link capacity in packets per 16 ms block (default: drain all, as
+ *       BLEManager::processDataQueue() does on a fast link)
+ *
+ * The link budget is that of a central at BLE_REQUESTED_MTU and
+ * BLE_CONN_INTERVAL_MIN; every packet sent counts as a notify completion.
+ */
+
+#include <Arduino.h>
+#include "AudioDetector.h"
+#include "Config.h"
+#include "DataScheduler.h"
+#include "HalHost.h"
+#include "WavSource.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static const uint32_t BLOCK_US = (uint32_t)((uint64_t)I2S_DMA_BUF_LEN * 1000000 / I2S_SAMPLE_RATE);
+static const uint32_t DRAIN_BLOCKS = 64;  // Keep running after the clip until the queues empty
+
+struct ReplayStats {
+  uint32_t packets[4];  // By DataType
+  uint64_t bytes;
+  uint32_t codecChanges;
+  uint64_t digest;      // FNV-1a over type, length and payload of every packet
+};
+
+static void digestBytes(uint64_t& digest, const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    digest ^= data[i];
+    digest *= 1099511628211ull;
+  }
+}
+
+static const char* typeName(DataType type) {
+  switch (type) {
+    case DATA_ALERT: return "ALERT";
+    case DATA_HEART_RATE: return "HR";
+    case DATA_AUDIO: return "AUDIO";
+    default: return "?";
+  }
+}
+
+static void sendPacket(DataScheduler& scheduler, DataPacket& packet, uint32_t timeMs, FILE* out,
+                       ReplayStats& stats) {
+  const uint8_t* data = scheduler.getPacketData(packet);
+  uint8_t header[3] = { (uint8_t)packet.type, (uint8_t)(packet.dataSize & 0xFF), (uint8_t)(packet.dataSize >> 8) };
+  digestBytes(stats.digest, header, sizeof(header));
+  digestBytes(stats.digest, data, packet.dataSize);
+  if (packet.type < 4) stats.packets[packet.type]++;
+  stats.bytes += packet.dataSize;
+  scheduler.recordNotifyStatus(packet.dataSize, true);
+
+  if (out) {
+    fprintf(out, "%u %s %u ", (unsigned)timeMs, typeName(packet.type), (unsigned)packet.dataSize);
+    for (uint16_t i = 0; i < packet.dataSize; i++) fprintf(out, "%02x", data[i]);
+    fprintf(out, "\n");
+  }
+  scheduler.releasePacket(packet);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: replay_bench clip.wav [-o packets.txt] [-c] [-t seconds]... [-l packets]\n");
+    return 1;
+  }
+  const char* outPath = nullptr;
+  bool continuous = false;
+  uint32_t linkPackets = 0;
+  std::vector<uint32_t> triggers;  // ms
+  for (int i = 2; i < argc; i++) {
+    if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+      outPath = argv[++i];
+    } else if (!strcmp(argv[i], "-c")) {
+      continuous = true;
+    } else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+      triggers.push_back((uint32_t)(atof(argv[++i]) * 1000));
+    } else if (!strcmp(argv[i], "-l") && i + 1 < argc) {
+      linkPackets = (uint32_t)atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "replay_bench: unknown option %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  WavAudioSource source;
+  if (!source.open(argv[1], I2S_SAMPLE_RATE)) return 1;
+  FILE* out = nullptr;
+  if (outPath) {
+    out = fopen(outPath, "w");
+    if (!out) {
+      fprintf(stderr, "replay_bench: cannot write %s\n", outPath);
+      return 1;
+    }
+  }
+
+  // Firmware start-up logs are not part of the result
+  hal::host::useManualClock(true);
+  hal::host::muteSerial(true);
+  DataScheduler scheduler;
+  scheduler.begin();
+  scheduler.setLinkParameters(BLE_REQUESTED_MTU, BLE_CONN_INTERVAL_MIN);
+  AudioDetector detector;
+  detector.setAudioSource(source.getSource());
+  if (!detector.begin()) {
+    hal::host::muteSerial(false);
+    fprintf(stderr, "replay_bench: AudioDetector did not start\n");
+    return 1;
+  }
+  detector.setDataScheduler(&scheduler);
+  detector.enableStreaming(true);
+  if (continuous) detector.setPreTrigger(false);
+  hal::host::muteSerial(false);
+
+  Serial.println(F("========================================"));
+  Serial.print(F("[Replay] "));
+  Serial.print(argv[1]);
+  Serial.print(F(" ("));
+  Serial.print((float)source.getLength() / I2S_SAMPLE_RATE, 1);
+  Serial.println(F(" s)"));
+  Serial.println(F("========================================"));
+
+  ReplayStats stats;
+  memset(&stats, 0, sizeof(stats));
+  stats.digest = 14695981039346656037ull;
+  AudioCodecMode codecMode = detector.getCodecMode();
+  size_t nextTrigger = 0;
+  uint32_t startMs = millis();
+  uint32_t drainBlocks = 0;
+  auto wallStart = std::chrono::steady_clock::now();
+
+  while (drainBlocks < DRAIN_BLOCKS) {
+    // One DMA buffer of audio time, then loop() work: capture + encode
+    hal::host::advanceMicros(BLOCK_US);
+    uint32_t audioMs = millis() - startMs;
+    while (nextTrigger < triggers.size() && triggers[nextTrigger] <= audioMs) {
+      detector.triggerStreaming(AUDIO_TRIGGER_COMMAND);
+      Serial.print(F("  "));
+      Serial.print(audioMs);
+      Serial.println(F(" ms: trigger command"));
+      nextTrigger++;
+    }
+    hal::host::muteSerial(true);  // Event and codec logs, reported below instead
+    detector.update();
+    hal::host::muteSerial(false);
+
+    if (detector.getCodecMode() != codecMode) {
+      codecMode = detector.getCodecMode();
+      stats.codecChanges++;
+      Serial.print(F("  "));
+      Serial.print(audioMs);
+      Serial.print(F(" ms: codec "));
+      Serial.print(audioCodecName(codecMode));
+      Serial.print(F(" (link budget "));
+      Serial.print(scheduler.getAudioBudget());
+      Serial.println(F(" B/s)"));
+      if (out) fprintf(out, "%u CODEC %s\n", (unsigned)audioMs, audioCodecName(codecMode));
+    }
+
+    // BLE link: notify in priority order, as many as it carries
+    DataPacket packet;
+    uint32_t sent = 0;
+    while ((linkPackets == 0 || sent < linkPackets) && scheduler.getNextPacket(packet)) {
+      sendPacket(scheduler, packet, audioMs, out, stats);
+      sent++;
+    }
+    if (detector.isSourceExhausted() && !scheduler.hasPackets()) drainBlocks++;
+  }
+
+  double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  double audioSeconds = (double)source.getPosition() / I2S_SAMPLE_RATE;
+  if (out) fclose(out);
+
+  Serial.println(F("----------------------------------------"));
+  Serial.print(F("  Throughput: "));
+  Serial.print(audioSeconds, 1);
+  Serial.print(F(" s audio in "));
+  Serial.print(wallSeconds, 3);
+  Serial.print(F(" s ("));
+  Serial.print(wallSeconds > 0 ? audioSeconds / wallSeconds : 0.0, 0);
+  Serial.print(F("x real time, "));
+  Serial.print(audioSeconds > 0 ? wallSeconds * 1e9 / (audioSeconds * I2S_SAMPLE_RATE / I2S_DMA_BUF_LEN) : 0.0, 0);
+  Serial.println(F(" ns/block)"));
+  Serial.print(F("  Packets: "));
+  Serial.print(stats.packets[DATA_AUDIO]);
+  Serial.print(F(" audio, "));
+  Serial.print(stats.packets[DATA_ALERT]);
+  Serial.print(F(" alert ("));
+  Serial.print((unsigned long)stats.bytes);
+  Serial.println(F(" bytes)"));
+  Serial.print(F("  Drops: "));
+  Serial.print(detector.getSamplesLost());
+  Serial.print(F(" samples lost in capture, "));
+  Serial.print(scheduler.getRateLimitedAudioPackets());
+  Serial.print(F(" over link budget, "));
+  Serial.print(scheduler.getDroppedAudioPackets());
+  Serial.println(F(" queue full"));
+  Serial.print(F("  Codec changes: "));
+  Serial.println(stats.codecChanges);
+  Serial.print(F("  Stream digest (FNV-1a 64): "));
+  char digest[17];
+  snprintf(digest, sizeof(digest), "%016llx", (unsigned long long)stats.digest);
+  Serial.println(digest);
+
+  detector.printStatistics();
+  scheduler.printStatistics();
+  detector.end();
+  return 0;
+}
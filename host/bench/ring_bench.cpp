@@ -0,0 +1,164 @@
+/*
+ * SPSC ring benchmark and stress test (host)
+ * Moves sequence-numbered items from a producer thread to a consumer
+ * thread through hal::Queue (the FreeRTOS queue's host stand-in: mutex +
+ * condition variables) and SpscRing (DataScheduler's heart-rate / audio
+ * path), both non-blocking with the other side spinning and yielding, and
+ * reports:
+ * - stress: items received (all of them), items duplicated or out of
+ *   order, and items whose bytes do not match their sequence number (torn
+ *   copies; must be 0)
+ * - throughput: items/s across the threads, and cycles per send + receive
+ *   pair in one thread (no contention), for 8-byte PacketRefs and 260-byte
+ *   items (the by-value DataPacket of the original queue)
+ *
+ * Ring depth as DataScheduler's audio queue (20). On a single-core host
+ * the threads interleave by preemption, which still exercises every
+ * full / empty race; host queue costs differ from FreeRTOS, so compare the
+ * two rows rather than absolute cycles.
+ *
+ * Usage: ring_bench [items]   (default 2000000)
+ */
+
+#include <Arduino.h>
+#include "DataScheduler.h"
+#include "Hal.h"
+#include "SpscRing.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+static const size_t DEPTH = 20;          // DataScheduler normal queue default
+static const size_t LEGACY_ITEM = 260;   // DataPacket queued by value
+static const uint32_t PAIR_ROUNDS = 200000;
+
+struct StressResult {
+  uint32_t received;
+  uint32_t misordered;  // Sequence gap or repeat
+  uint32_t torn;        // Payload bytes do not match the sequence number
+  double itemsPerSecond;
+};
+
+// Every byte of an item is derived from its sequence number
+static void fillItem(uint8_t* item, size_t size, uint32_t sequence) {
+  memcpy(item, &sequence, sizeof(sequence));
+  for (size_t i = sizeof(sequence); i < size; i++) item[i] = (uint8_t)(sequence * 131 + i);
+}
+
+static bool checkItem(const uint8_t* item, size_t size, uint32_t sequence) {
+  for (size_t i = sizeof(sequence); i < size; i++) {
+    if (item[i] != (uint8_t)(sequence * 131 + i)) return false;
+  }
+  return true;
+}
+
+// Both are used non-blocking (hal::Queue with timeout 0), so they see
+// the same full / empty pattern
+template <typename Q>
+static StressResult stress(Q& queue, size_t itemSize, uint32_t items) {
+  StressResult result;
+  memset(&result, 0, sizeof(result));
+  auto start = std::chrono::steady_clock::now();
+  std::atomic<bool> produced(false);
+
+  std::thread producer([&queue, &produced, itemSize, items]() {
+    uint8_t item[LEGACY_ITEM];
+    for (uint32_t sequence = 0; sequence < items; sequence++) {
+      fillItem(item, itemSize, sequence);
+      while (!queue.send(item)) std::this_thread::yield();
+    }
+    produced = true;
+  });
+
+  uint8_t item[LEGACY_ITEM];
+  uint32_t expected = 0;
+  while (result.received < items) {
+    bool finished = produced;  // Read before the receive
+    if (!queue.receive(item)) {
+      if (finished) break;     // Everything sent and nothing left: items lost
+      std::this_thread::yield();
+      continue;
+    }
+    uint32_t sequence;
+    memcpy(&sequence, item, sizeof(sequence));
+    if (sequence != expected) result.misordered++;
+    if (!checkItem(item, itemSize, sequence)) result.torn++;
+    expected = sequence + 1;
+    result.received++;
+  }
+  producer.join();
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  result.itemsPerSecond = result.received / seconds;
+  return result;
+}
+
+// One thread: DEPTH sends then DEPTH receives, cycles per pair
+template <typename Q>
+static uint32_t pairCycles(Q& queue, size_t itemSize) {
+  uint8_t item[LEGACY_ITEM];
+  fillItem(item, itemSize, 1);
+  uint64_t cycles = 0;
+  for (uint32_t round = 0; round < PAIR_ROUNDS / DEPTH; round++) {
+    uint32_t start = hal::cycleCount();
+    for (size_t i = 0; i < DEPTH; i++) queue.send(item);
+    for (size_t i = 0; i < DEPTH; i++) queue.receive(item);
+    cycles += hal::cycleCount() - start;
+  }
+  return (uint32_t)(cycles / (PAIR_ROUNDS / DEPTH * DEPTH));
+}
+
+static void printRow(const char* name, size_t itemSize, const StressResult& result, uint32_t cycles) {
+  Serial.print(F("  "));
+  Serial.print(name);
+  Serial.print(itemSize);
+  Serial.print(F(" B: "));
+  Serial.print(result.itemsPerSecond / 1e6, 2);
+  Serial.print(F(" M items/s, "));
+  Serial.print(cycles);
+  Serial.print(F(" cycles/send+receive | stress: "));
+  Serial.print(result.received);
+  Serial.print(F(" received, "));
+  Serial.print(result.misordered);
+  Serial.print(F(" misordered, "));
+  Serial.print(result.torn);
+  Serial.println(F(" torn"));
+}
+
+int main(int argc, char** argv) {
+  uint32_t items = (argc > 1) ? (uint32_t)atoi(argv[1]) : 2000000;
+  if (items == 0) items = 1;
+
+  Serial.println(F("========================================"));
+  Serial.print(F("[RingBench] "));
+  Serial.print(items);
+  Serial.print(F(" items producer -> consumer thread, depth "));
+  Serial.print(DEPTH);
+  Serial.print(F(", "));
+  Serial.print(std::thread::hardware_concurrency());
+  Serial.println(F(" host cores"));
+  Serial.println(F("========================================"));
+
+  bool clean = true;
+  const size_t sizes[] = { sizeof(PacketRef), LEGACY_ITEM };
+  for (size_t itemSize : sizes) {
+    hal::Queue queue;
+    queue.create(DEPTH, itemSize);
+    StressResult queueResult = stress(queue, itemSize, items);
+    printRow("hal::Queue ", itemSize, queueResult, pairCycles(queue, itemSize));
+    queue.destroy();
+
+    SpscRing ring;
+    ring.create(DEPTH, itemSize);
+    StressResult ringResult = stress(ring, itemSize, items);
+    printRow("SpscRing   ", itemSize, ringResult, pairCycles(ring, itemSize));
+    ring.destroy();
+
+    clean = clean && queueResult.received == items && queueResult.misordered == 0 && queueResult.torn == 0 &&
+            ringResult.received == items && ringResult.misordered == 0 && ringResult.torn == 0;
+  }
+  Serial.println(F("========================================"));
+  Serial.println(clean ? F("[RingBench] Stress: PASS") : F("[RingBench] Stress: FAIL"));
+  return clean ? 0 : 1;
+}
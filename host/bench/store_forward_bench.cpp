@@ -0,0 +1,381 @@
+/*
+ * Store-and-forward benchmark (host)
+ * Outage: BLEManager runs with no client for the outage (heart rate at
+ * 1 Hz, an alert every 5 min) and logs both to the flash image
+ * (StoreForward.h). Reconnect: a slow link (30 ms interval, 251 B/event,
+ * MTU 247) with live heart rate continuing; every logged alert must come
+ * back once on the alert characteristic (replayed as a live alert), and
+ * the bench decodes the log characteristic with PacketBundleReader and
+ * checks that every logged reading comes back once, in order, with the
+ * age that gives back its original time. Reports flash bytes written per payload byte
+ * (write amplification), erases, backfill duration and throughput, and
+ * the queue age of live heart rate during the backfill.
+ *
+ * Log: FlashLog on a small 8-sector image, several laps: erase spread
+ * across sectors, records dropped when the log is full, and a remount
+ * (reboot) that must find the same pending records and a new boot id (also
+ * after an idle reboot that logged nothing), plus one corrupted
+ * record (torn write) that must be detected and skipped. No write may need
+ * an erase the firmware did not do (bit violations: 0).
+ *
+ * Usage: store_forward_bench [outage_minutes]   (default 30)
+ */
+
+#include <Arduino.h>
+#include "BLEManager.h"
+#include "Config.h"
+#include "DataScheduler.h"
+#include "FlashLog.h"
+#include "HalHost.h"
+#include "PacketAggregator.h"
+#include "StoreForward.h"
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+static const uint32_t STEP_US = 4000;        // loop() pass
+static const uint32_t ALERT_EVERY_MS = 300000;
+static const uint32_t BACKFILL_LIMIT_MS = 600000;
+static const uint32_t LOG_SECTORS = 8;
+static const uint32_t LOG_RECORD_BYTES = 48;  // A full heart-rate batch
+
+struct Reading {
+  uint32_t ms;
+  uint8_t value;
+};
+
+struct Receiver {
+  std::vector<Reading> readings;     // Logged heart rates, in order
+  std::vector<uint32_t> alerts;      // Logged alert times
+  size_t nextReading;
+  size_t nextAlert;
+  uint32_t mismatches;               // Wrong value, time or order
+  uint32_t liveHeartRates;
+  PacketBundleReader reader;
+};
+
+static void onItem(void* context, uint8_t type, const uint8_t* value, size_t length) {
+  Receiver* receiver = (Receiver*)context;
+  if (length < STORE_FORWARD_AGE_SIZE) {
+    receiver->mismatches++;
+    return;
+  }
+  uint32_t age = value[0] | (value[1] << 8) | (value[2] << 16) | ((uint32_t)value[3] << 24);
+  uint32_t logged = millis() - age;  // Same boot: the bench never reboots
+  const uint8_t* data = value + STORE_FORWARD_AGE_SIZE;
+  size_t dataLength = length - STORE_FORWARD_AGE_SIZE;
+
+  if (type == TLV_TYPE_LOG_HEART_RATES && dataLength % STORE_FORWARD_HR_ENTRY == 0) {
+    for (size_t i = 0; i < dataLength; i += STORE_FORWARD_HR_ENTRY) {
+      size_t index = receiver->nextReading++;
+      uint32_t ms = logged + (data[i + 1] | (data[i + 2] << 8));
+      if (index >= receiver->readings.size() || receiver->readings[index].ms != ms ||
+          receiver->readings[index].value != data[i]) {
+        receiver->mismatches++;
+      }
+    }
+  } else {
+    receiver->mismatches++;
+  }
+}
+
+static void onNotify(const char* uuid, const uint8_t* data, size_t length, void* context) {
+  Receiver* receiver = (Receiver*)context;
+  if (strcasecmp(uuid, LOG_CHAR_UUID) == 0) {
+    receiver->reader.read(data, length);
+  } else if (strcasecmp(uuid, ALERT_CHAR_UUID) == 0) {
+    // Replayed from the log (no alert is raised after the outage)
+    if (receiver->nextAlert++ >= receiver->alerts.size() ||
+        std::string((const char*)data, length) != "FALL_DETECTED") {
+      receiver->mismatches++;
+    }
+  } else if (strcasecmp(uuid, HR_CHAR_UUID) == 0) {
+    receiver->liveHeartRates++;
+  }
+}
+
+static uint8_t bpmAt(uint32_t second) {
+  return (uint8_t)(60 + second % 40);
+}
+
+// ============================================================================
+// OUTAGE AND BACKFILL (BLEManager)
+// ============================================================================
+
+static bool outageAndBackfill(uint32_t outageMinutes) {
+  hal::host::muteSerial(true);
+  BLEManager ble;
+  ble.begin();  // Mounts the log on a blank image
+  DataScheduler scheduler;
+  scheduler.begin();
+  ble.setDataScheduler(&scheduler);
+  NimBLEServer* server = ble.getServer();
+
+  Receiver receiver;
+  receiver.nextReading = 0;
+  receiver.nextAlert = 0;
+  receiver.mismatches = 0;
+  receiver.liveHeartRates = 0;
+  receiver.reader.setHandler(onItem, &receiver);
+
+  // Link down: everything queued goes to flash
+  uint32_t second = 0;
+  uint32_t outageMs = outageMinutes * 60000;
+  uint32_t start = millis();
+  while (millis() - start < outageMs) {
+    uint32_t ms = millis() - start;
+    if (ms / 1000 >= second) {
+      if (scheduler.enqueueHeartRate(bpmAt(second))) receiver.readings.push_back({ (uint32_t)millis(), bpmAt(second) });
+      if ((ms + ALERT_EVERY_MS / 2) % ALERT_EVERY_MS < 1000 && scheduler.enqueueAlert("FALL_DETECTED")) {
+        receiver.alerts.push_back(millis());
+      }
+      second++;
+    }
+    ble.processDataQueue();
+    hal::host::advanceMicros(STEP_US);
+  }
+  hal::host::FlashStats outageFlash = hal::host::getFlashStats();
+
+  // Link up: live heart rate continues while the log drains
+  hal::host::setLinkModel(24 * 1250, 251, 12);
+  server->hostConnect(BLE_REQUESTED_MTU, 24);
+  hal::host::setNotifyHook(onNotify, &receiver);
+  uint32_t liveQueued = 0;
+  uint32_t reconnect = millis();
+  while (ble.getStoreForward().getBacklog() > 0 && millis() - reconnect < BACKFILL_LIMIT_MS) {
+    uint32_t ms = millis() - start;
+    if (ms / 1000 >= second) {
+      if (scheduler.enqueueHeartRate(bpmAt(second))) liveQueued++;
+      second++;
+    }
+    ble.processDataQueue();
+    hal::host::advanceMicros(STEP_US);
+  }
+  for (uint32_t i = 0; i < 250; i++) {  // Last live packets
+    ble.processDataQueue();
+    hal::host::advanceMicros(STEP_US);
+  }
+  hal::host::setNotifyHook(nullptr, nullptr);
+  server->hostDisconnect();
+  hal::host::setLinkModel(0, 0, 0);
+
+  const StoreForward& storeForward = ble.getStoreForward();
+  const FlashLog& log = storeForward.getLog();
+  const QueueAgeHistogram& liveAges = scheduler.getQueueAges(DATA_HEART_RATE);
+  uint32_t backfillMs = storeForward.getBackfillMs();
+  hal::host::FlashStats flash = hal::host::getFlashStats();
+  ble.setDataScheduler(nullptr);
+  hal::host::muteSerial(false);
+
+  bool recovered = receiver.nextReading == receiver.readings.size() && receiver.nextAlert == receiver.alerts.size() &&
+                   receiver.mismatches == 0 && receiver.reader.getMalformed() == 0 && log.getPendingCount() == 0;
+
+  Serial.print(F("  Outage "));
+  Serial.print(outageMinutes);
+  Serial.print(F(" min: "));
+  Serial.print(receiver.readings.size());
+  Serial.print(F(" heart rates, "));
+  Serial.print(receiver.alerts.size());
+  Serial.print(F(" alerts -> "));
+  Serial.print(log.getAppendedRecords());
+  Serial.print(F(" records, "));
+  Serial.print(log.getPayloadBytes());
+  Serial.println(F(" payload bytes"));
+  Serial.print(F("    flash: "));
+  Serial.print((uint32_t)outageFlash.bytesWritten);
+  Serial.print(F(" bytes written in "));
+  Serial.print(outageFlash.writes);
+  Serial.print(F(" writes (write amplification "));
+  Serial.print((float)outageFlash.bytesWritten / log.getPayloadBytes(), 2);
+  Serial.print(F(", "));
+  Serial.print((float)outageFlash.bytesWritten / (receiver.readings.size() + receiver.alerts.size()), 1);
+  Serial.print(F(" B per reading/alert), "));
+  Serial.print(outageFlash.sectorErases);
+  Serial.println(F(" sector erases"));
+  Serial.print(F("  Backfill (30 ms, 251 B/event): "));
+  Serial.print(storeForward.getBackfillRecords());
+  Serial.print(F(" records, "));
+  Serial.print(storeForward.getBackfillBytes());
+  Serial.print(F(" bytes in "));
+  Serial.print(backfillMs / 1000.0f, 2);
+  Serial.print(F(" s ("));
+  Serial.print(backfillMs > 0 ? storeForward.getBackfillBytes() * 1000.0f / backfillMs : 0.0f, 0);
+  Serial.print(F(" B/s, "));
+  Serial.print(backfillMs > 0 ? storeForward.getBackfillRecords() * 1000.0f / backfillMs : 0.0f, 1);
+  Serial.println(F(" records/s)"));
+  Serial.print(F("    recovered "));
+  Serial.print(receiver.nextReading);
+  Serial.print(F("/"));
+  Serial.print(receiver.readings.size());
+  Serial.print(F(" heart rates, "));
+  Serial.print(receiver.nextAlert);
+  Serial.print(F("/"));
+  Serial.print(receiver.alerts.size());
+  Serial.print(F(" alerts, "));
+  Serial.print(receiver.mismatches);
+  Serial.print(F(" mismatched; live HR "));
+  Serial.print(receiver.liveHeartRates);
+  Serial.print(F("/"));
+  Serial.print(liveQueued);
+  Serial.print(F(", queue age p99 "));
+  Serial.print(liveAges.percentile(99));
+  Serial.print(F(" ms; bit violations "));
+  Serial.println(flash.bitViolations);
+  return recovered && flash.bitViolations == 0 && receiver.liveHeartRates == liveQueued;
+}
+
+// ============================================================================
+// LOG: WEAR, FULL LOG, REMOUNT, TORN RECORD
+// ============================================================================
+
+static void fillRecord(uint8_t* data, uint32_t sequence) {
+  memcpy(data, &sequence, sizeof(sequence));
+  for (size_t i = sizeof(sequence); i < LOG_RECORD_BYTES; i++) data[i] = (uint8_t)((sequence * 7 + i) | 1);
+}
+
+// Pending records in order from sequence `first`; false on a gap or bad data
+static bool readAll(FlashLog& log, uint32_t first, uint32_t& count, uint32_t& last) {
+  FlashLogRecord record;
+  uint8_t expected[LOG_RECORD_BYTES];
+  count = 0;
+  bool ordered = true;
+  while (log.next(record)) {
+    uint32_t sequence;
+    memcpy(&sequence, record.data, sizeof(sequence));
+    fillRecord(expected, sequence);
+    if ((count == 0 && sequence < first) || (count > 0 && sequence != last + 1) ||
+        record.length != LOG_RECORD_BYTES || memcmp(record.data, expected, LOG_RECORD_BYTES) != 0) {
+      ordered = false;
+    }
+    last = sequence;
+    count++;
+  }
+  log.rewind();
+  return ordered;
+}
+
+static bool logLaps() {
+  hal::host::setFlashSize(LOG_SECTORS * FLASH_SECTOR_SIZE);
+  hal::host::muteSerial(true);
+  FlashLog log;
+  log.begin(LOG_SECTORS * FLASH_SECTOR_SIZE);
+
+  // Four laps forwarded as they go, then more than the log holds
+  uint8_t data[LOG_RECORD_BYTES];
+  uint32_t perSector = (FLASH_SECTOR_SIZE - FLASH_LOG_SECTOR_HEADER) / (FLASH_LOG_RECORD_HEADER + LOG_RECORD_BYTES);
+  uint32_t forwardedLaps = 4 * LOG_SECTORS * perSector;
+  uint32_t sequence = 0;
+  FlashLogRecord record;
+  for (; sequence < forwardedLaps; sequence++) {
+    fillRecord(data, sequence);
+    log.append(0x05, data, sizeof(data), sequence * 1000);
+    if (sequence % 10 == 9) {
+      while (log.next(record)) {}
+      log.commit();
+    }
+  }
+  uint32_t overflow = (LOG_SECTORS + 2) * perSector;
+  for (uint32_t i = 0; i < overflow; i++, sequence++) {
+    fillRecord(data, sequence);
+    log.append(0x05, data, sizeof(data), sequence * 1000);
+  }
+  uint32_t pending = log.getPendingCount();
+  uint32_t count = 0, last = 0;
+  bool ordered = readAll(log, 0, count, last) && count == pending && last == sequence - 1;
+  hal::host::FlashStats wear = hal::host::getFlashStats();
+
+  // Reboot: the same pending records, a new boot id
+  FlashLog remounted;
+  remounted.begin(LOG_SECTORS * FLASH_SECTOR_SIZE);
+  uint32_t remountCount = 0, remountLast = 0;
+  bool remountOrdered = readAll(remounted, 0, remountCount, remountLast);
+  bool remountOk = remountOrdered && remounted.getPendingCount() == pending && remountCount == pending &&
+                   remountLast == last && remounted.getBootId() == log.getBootId() + 1;
+
+  // Reboot with nothing logged since: the boot record still moves the id on
+  FlashLog idle;
+  idle.begin(LOG_SECTORS * FLASH_SECTOR_SIZE);
+  remountOk = remountOk && idle.getBootId() == remounted.getBootId() + 1 && idle.getPendingCount() == pending;
+
+  // Torn record: clear bits of one payload byte of the newest record (as a
+  // write cut short by power loss would leave it), then remount again. The
+  // torn sector takes no more records, so the boot record opens the next
+  // one and a full log drops its oldest sector.
+  uint32_t target = sequence - 1;
+  bool corrupted = false;
+  for (uint32_t offset = 0; offset + 4 <= LOG_SECTORS * FLASH_SECTOR_SIZE && !corrupted; offset += 4) {
+    uint8_t bytes[4];
+    hal::flashRead(offset, bytes, sizeof(bytes));
+    if (memcmp(bytes, &target, 4) == 0) {
+      uint8_t cleared = 0x00;
+      hal::flashWrite(offset + LOG_RECORD_BYTES - 1, &cleared, 1);
+      corrupted = true;
+    }
+  }
+  FlashLog recovered;
+  recovered.begin(LOG_SECTORS * FLASH_SECTOR_SIZE);
+  uint32_t tornCount = 0, tornLast = 0;
+  bool tornOrdered = readAll(recovered, 0, tornCount, tornLast);
+  bool tornOk = corrupted && tornOrdered && recovered.getCorruptRecords() == 1 && tornLast == target - 1 &&
+                tornCount == pending - 1 - recovered.getDroppedRecords();
+  hal::host::FlashStats flash = hal::host::getFlashStats();
+  hal::host::muteSerial(false);
+
+  Serial.print(F("  Log "));
+  Serial.print(LOG_SECTORS);
+  Serial.print(F(" sectors, "));
+  Serial.print(sequence);
+  Serial.print(F(" x "));
+  Serial.print(LOG_RECORD_BYTES);
+  Serial.print(F(" B records: write amplification "));
+  Serial.print((float)log.getFlashBytesWritten() / log.getPayloadBytes(), 2);
+  Serial.print(F(", "));
+  Serial.print(wear.sectorErases);
+  Serial.print(F(" erases, "));
+  Serial.print(wear.minSectorErases);
+  Serial.print(F("-"));
+  Serial.print(wear.maxSectorErases);
+  Serial.print(F(" per sector, "));
+  Serial.print(log.getDroppedRecords());
+  Serial.println(F(" dropped when full"));
+  Serial.print(F("    pending "));
+  Serial.print(count);
+  Serial.print(F("/"));
+  Serial.print(pending);
+  Serial.print(ordered ? F(" in order") : F(" OUT OF ORDER"));
+  Serial.print(F(", remount "));
+  Serial.print(remountOk ? F("OK") : F("FAIL"));
+  Serial.print(F(" (boot "));
+  Serial.print(remounted.getBootId());
+  Serial.print(F(", then "));
+  Serial.print(idle.getBootId());
+  Serial.print(F(" idle), torn record "));
+  Serial.print(tornOk ? F("skipped") : F("NOT HANDLED"));
+  Serial.print(F(" ("));
+  Serial.print(tornCount);
+  Serial.print(F(" readable); bit violations "));
+  Serial.println(flash.bitViolations);
+  return ordered && remountOk && tornOk && flash.bitViolations == 0 && wear.maxSectorErases - wear.minSectorErases <= 1;
+}
+
+int main(int argc, char** argv) {
+  uint32_t outageMinutes = (argc > 1) ? (uint32_t)atoi(argv[1]) : 30;
+  if (outageMinutes == 0) outageMinutes = 1;
+  hal::host::useManualClock(true);
+
+  Serial.println(F("========================================"));
+  Serial.print(F("[StoreForwardBench] HR 1 Hz, alert every "));
+  Serial.print(ALERT_EVERY_MS / 60000);
+  Serial.print(F(" min, log "));
+  Serial.print(STORE_FORWARD_LOG_BYTES / 1024);
+  Serial.print(F(" kB, backfill "));
+  Serial.print(BLE_BACKFILL_RATE);
+  Serial.println(F(" B/s"));
+  Serial.println(F("========================================"));
+  bool clean = outageAndBackfill(outageMinutes);
+  clean = logLaps() && clean;
+  Serial.println(F("========================================"));
+  Serial.println(clean ? F("[StoreForwardBench] PASS") : F("[StoreForwardBench] FAIL"));
+  return clean ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+/*
+ * BLE TX aggregation benchmark (host)
+ * Streams audio frames (one 140-byte frame per 16 ms block), heart rate
+ * (1 Hz) and alerts (every 5 s) through DataScheduler and
+ * BLEManager::processDataQueue() on a manual clock, per TX format and MTU:
+ * - PACKETS: one notification per packet (the default)
+ * - TLV:     PacketAggregator bundles ("TX_FORMAT:TLV")
+ * and reports notifications per second, bytes delivered per notification
+ * and fill of the ATT payload (MTU - 3), plus:
+ * - PACKETS: notifications longer than the ATT payload (the stack
+ *   truncates them: audio frames at MTU 23)
+ * - TLV: items PacketBundleReader recovers from the notifications,
+ *   compared byte for byte with what was queued
+ *
+ * Usage: tlv_bench [seconds]   (default 30)
+ */
+
+#include <Arduino.h>
+#include "BLEManager.h"
+#include "Config.h"
+#include "DataScheduler.h"
+#include "HalHost.h"
+
+#include <string>
+#include <vector>
+
+static const uint32_t BLOCK_US = 16000;
+static const size_t AUDIO_FRAME = 140;  // 12-byte header + 256 IMA4 samples
+static const uint16_t MTUS[] = { BLE_REQUESTED_MTU, 185, 23 };
+
+struct Item {
+  uint8_t type;  // TLV_TYPE_*
+  std::string value;
+};
+
+struct RunResult {
+  uint32_t notifications;
+  uint64_t bytes;       // Delivered (at most the ATT payload each)
+  uint32_t oversized;   // Longer than the ATT payload
+  uint32_t recovered;   // TLV: items matching the queued sequence
+  uint32_t items;       // Queued
+};
+
+struct Capture {
+  std::vector<std::string> notifications;
+};
+
+static void onNotify(const char* uuid, const uint8_t* data, size_t length, void* context) {
+  (void)uuid;
+  ((Capture*)context)->notifications.push_back(std::string((const char*)data, length));
+}
+
+static void onItem(void* context, uint8_t type, const uint8_t* value, size_t length) {
+  Item item;
+  item.type = type;
+  item.value.assign((const char*)value, length);
+  ((std::vector<Item>*)context)->push_back(item);
+}
+
+static RunResult run(BLEManager& ble, DataScheduler& scheduler, uint16_t mtu, bool tlv, uint32_t seconds) {
+  NimBLEServer* server = ble.getServer();
+  server->hostConnect(mtu);
+  if (tlv) server->getCharacteristic(CONTROL_CHAR_UUID)->hostWrite("TX_FORMAT:TLV");
+
+  Capture capture;
+  hal::host::setNotifyHook(onNotify, &capture);
+  std::vector<Item> queued;
+  uint8_t frame[AUDIO_FRAME];
+  uint32_t blocks = seconds * 1000000 / BLOCK_US;
+
+  for (uint32_t block = 0; block < blocks; block++) {
+    hal::host::advanceMicros(BLOCK_US);
+    uint32_t ms = block * BLOCK_US / 1000;
+
+    // Queued in the order the priority drain sends them
+    if (ms % 5000 < BLOCK_US / 1000) {
+      if (scheduler.enqueueAlert("FALL_DETECTED")) queued.push_back(Item{ TLV_TYPE_ALERT, "FALL_DETECTED" });
+    }
+    if (ms % 1000 < BLOCK_US / 1000) {
+      uint8_t hr = (uint8_t)(60 + block % 40);
+      if (scheduler.enqueueHeartRate(hr)) queued.push_back(Item{ TLV_TYPE_HEART_RATE, std::string(1, (char)hr) });
+    }
+    for (size_t i = 0; i < sizeof(frame); i++) frame[i] = (uint8_t)(block * 31 + i * 7);
+    if (scheduler.enqueueAudio(frame, sizeof(frame))) {
+      queued.push_back(Item{ TLV_TYPE_AUDIO, std::string((const char*)frame, sizeof(frame)) });
+    }
+    ble.processDataQueue();
+  }
+  // Let a held bundle go out
+  hal::host::advanceMicros(BLOCK_US * 4);
+  ble.processDataQueue();
+  hal::host::setNotifyHook(nullptr, nullptr);
+  server->hostDisconnect();
+  ble.processDataQueue();  // Sees the disconnect
+
+  RunResult result;
+  memset(&result, 0, sizeof(result));
+  result.items = (uint32_t)queued.size();
+  size_t payload = (size_t)mtu - 3;
+  std::vector<Item> received;
+  PacketBundleReader reader;
+  reader.setHandler(onItem, &received);
+  for (const std::string& notification : capture.notifications) {
+    result.notifications++;
+    result.bytes += min(notification.size(), payload);
+    if (notification.size() > payload) result.oversized++;
+    if (tlv) reader.read((const uint8_t*)notification.data(), notification.size());
+  }
+  if (tlv) {
+    for (size_t i = 0; i < received.size() && i < queued.size(); i++) {
+      if (received[i].type == queued[i].type && received[i].value == queued[i].value) result.recovered++;
+    }
+  }
+  return result;
+}
+
+int main(int argc, char** argv) {
+  uint32_t seconds = (argc > 1) ? (uint32_t)atoi(argv[1]) : 30;
+  if (seconds == 0) seconds = 1;
+
+  hal::host::useManualClock(true);
+  hal::host::muteSerial(true);
+  DataScheduler scheduler;
+  scheduler.begin();
+  scheduler.setPacingEnabled(false);  // Every frame reaches the TX path at once
+  BLEManager ble;
+  ble.begin();
+  ble.setDataScheduler(&scheduler);
+  hal::host::muteSerial(false);
+
+  Serial.println(F("========================================"));
+  Serial.print(F("[TlvBench] "));
+  Serial.print(seconds);
+  Serial.print(F(" s: audio every 16 ms, HR 1 Hz, alert every 5 s (hold "));
+  Serial.print(BLE_TLV_HOLD_MS);
+  Serial.println(F(" ms)"));
+  Serial.println(F("========================================"));
+
+  for (uint16_t mtu : MTUS) {
+    for (int tlv = 0; tlv < 2; tlv++) {
+      hal::host::muteSerial(true);
+      RunResult result = run(ble, scheduler, mtu, tlv != 0, seconds);
+      hal::host::muteSerial(false);
+
+      Serial.print(F("  MTU "));
+      Serial.print(mtu);
+      Serial.print(tlv ? F(" TLV:     ") : F(" PACKETS: "));
+      Serial.print((float)result.notifications / seconds, 1);
+      Serial.print(F(" notifications/s, "));
+      Serial.print(result.notifications ? (float)result.bytes / result.notifications : 0.0f, 1);
+      Serial.print(F(" B each ("));
+      Serial.print(result.notifications ? 100.0f * result.bytes / ((float)result.notifications * (mtu - 3)) : 0.0f, 1);
+      Serial.print(F("% fill)"));
+      if (tlv) {
+        Serial.print(F(", items recovered "));
+        Serial.print(result.recovered);
+        Serial.print(F(" / "));
+        Serial.println(result.items);
+      } else {
+        Serial.print(F(", truncated by MTU "));
+        Serial.println(result.oversized);
+      }
+    }
+  }
+  Serial.println(F("========================================"));
+  return 0;
+}
@@ -0,0 +1,321 @@
+/*
+ * Voice activity detector benchmark (host)
+ * Runs the legacy RMS threshold (detectVoiceActivity() against
+ * AUDIO_VAD_THRESHOLD 1500, sampled every 100 ms as the old rate-limit
+ * switch did) and VoiceActivityDetector over labelled clips, and reports
+ * per clip:
+ * - speech: labelled-speech blocks detected active
+ * - false active: other blocks active (the hangover after each label is
+ *   not counted)
+ * - switches, and false switches per minute: state changes further than
+ *   LABEL_TOLERANCE from any label edge (each one flips the audio rate
+ *   limit and prints a line on the watch)
+ * - cycles per 256-sample block (host: nanoseconds)
+ *
+ * Usage: vad_bench [clip.wav labels.txt ...]   (16 kHz mono)
+ * Label files hold one "start end" pair in seconds per line (Audacity
+ * label export). Without arguments a set of synthetic clips is used:
+ * three utterances over quiet, babble, fan, hiss, keyboard and a noise
+ * step.
+ */
+
+#include <Arduino.h>
+#include "ADPCMCodec.h"
+#include "CodecBenchmark.h"
+#include "VoiceActivity.h"
+#include "WavFile.h"
+
+#include <stdio.h>
+#include <vector>
+
+static const size_t BLOCK_SAMPLES = 256;  // AudioDetector::STREAM_BUFFER_SIZE
+static const uint32_t SAMPLE_RATE = 16000;
+static const int16_t LEGACY_THRESHOLD = 1500;      // Former AUDIO_VAD_THRESHOLD
+static const uint32_t LEGACY_CHECK_MS = 100;       // Former VAD_CHECK_INTERVAL
+static const float LABEL_TOLERANCE = 0.5f;         // s around label edges
+static const float HANGOVER_ALLOWANCE = VAD_HANGOVER_MS / 1000.0f + 0.1f;
+
+struct Label {
+  float start;
+  float end;
+};
+
+struct Clip {
+  const char* name;
+  std::vector<int16_t> samples;
+  std::vector<Label> labels;
+};
+
+struct VadResult {
+  uint32_t speechBlocks;
+  uint32_t speechActive;
+  uint32_t otherBlocks;
+  uint32_t otherActive;
+  uint32_t switches;
+  uint32_t falseSwitches;
+  uint64_t cycles;
+  uint32_t maxCycles;
+};
+
+// ============================================================================
+// SYNTHETIC CLIPS
+// ============================================================================
+
+static uint32_t noiseState = 0x2545F491;
+
+static float whiteNoise() {
+  noiseState = noiseState * 1664525u + 1013904223u;
+  return ((int32_t)(noiseState >> 8) - (1 << 23)) / 8388608.0f;
+}
+
+static void mix(std::vector<int16_t>& clip, size_t index, float value) {
+  clip[index] = (int16_t)max(-32768.0f, min(32767.0f, clip[index] + value));
+}
+
+static void addUtterances(Clip& clip, float gain) {
+  static const Label utterances[] = { { 2.0f, 4.0f }, { 8.0f, 10.5f }, { 14.0f, 16.0f } };
+  for (const Label& label : utterances) {
+    size_t first = (size_t)(label.start * SAMPLE_RATE);
+    std::vector<int16_t> speech((size_t)((label.end - label.start) * SAMPLE_RATE));
+    generateSpeechTestSignal(speech.data(), speech.size(), SAMPLE_RATE);
+    for (size_t i = 0; i < speech.size(); i++) mix(clip.samples, first + i, gain * speech[i]);
+    clip.labels.push_back(label);
+  }
+}
+
+static void addWhite(Clip& clip, float rms, float from = 0) {
+  for (size_t i = (size_t)(from * SAMPLE_RATE); i < clip.samples.size(); i++) {
+    mix(clip.samples, i, rms * 1.732f * whiteNoise());
+  }
+}
+
+// Talkers in the next room: low-passed noise with a 3-6 Hz syllable-rate
+// level that wanders by +/- 6 dB
+static void addBabble(Clip& clip, float rms) {
+  const float twoPi = 6.2831853f;
+  float lowpass = 0;
+  for (size_t i = 0; i < clip.samples.size(); i++) {
+    float t = (float)i / SAMPLE_RATE;
+    lowpass += 0.15f * (whiteNoise() - lowpass);
+    float level = 1.0f + 0.5f * sinf(twoPi * 3.1f * t) * sinf(twoPi * 0.43f * t + 1.0f);
+    mix(clip.samples, i, rms * 5.0f * level * lowpass);
+  }
+}
+
+// Fan: brown-ish rumble plus 100 Hz hum
+static void addFan(Clip& clip, float rms) {
+  const float twoPi = 6.2831853f;
+  float lowpass = 0;
+  for (size_t i = 0; i < clip.samples.size(); i++) {
+    lowpass += 0.02f * (whiteNoise() - lowpass);
+    mix(clip.samples, i, rms * (9.0f * lowpass + 0.5f * sinf(twoPi * 100.0f * i / SAMPLE_RATE)));
+  }
+}
+
+// Keyboard: 4 ms decaying clicks at irregular 80-250 ms intervals
+static void addKeyboard(Clip& clip, float amplitude) {
+  size_t next = SAMPLE_RATE / 4;
+  while (next < clip.samples.size()) {
+    for (size_t i = 0; i < 64 && next + i < clip.samples.size(); i++) {
+      mix(clip.samples, next + i, amplitude * whiteNoise() * expf(-(float)i / 12.0f));
+    }
+    next += (size_t)((0.08f + 0.17f * (whiteNoise() + 1) / 2) * SAMPLE_RATE);
+  }
+}
+
+static std::vector<Clip> syntheticClips() {
+  const size_t length = 20 * SAMPLE_RATE;
+  std::vector<Clip> clips(6);
+  for (Clip& clip : clips) clip.samples.assign(length, 0);
+
+  clips[0].name = "quiet";
+  addWhite(clips[0], 30);
+  addUtterances(clips[0], 1.0f);
+
+  clips[1].name = "babble";
+  addBabble(clips[1], 1500);
+  addUtterances(clips[1], 1.5f);
+
+  clips[2].name = "fan";
+  addFan(clips[2], 2000);
+  addUtterances(clips[2], 1.5f);
+
+  clips[3].name = "hiss";
+  addWhite(clips[3], 1200);
+  addUtterances(clips[3], 1.5f);
+
+  clips[4].name = "keyboard";
+  addWhite(clips[4], 30);
+  addKeyboard(clips[4], 9000);
+  addUtterances(clips[4], 1.0f);
+
+  clips[5].name = "step";  // TV switched on at 11 s
+  addWhite(clips[5], 100);
+  addBabble(clips[5], 0);
+  addFan(clips[5], 0);
+  addWhite(clips[5], 1500, 11.0f);
+  addUtterances(clips[5], 1.5f);
+  return clips;
+}
+
+// ============================================================================
+// LABELS
+// ============================================================================
+
+static bool loadLabels(const char* path, std::vector<Label>& labels) {
+  FILE* file = fopen(path, "r");
+  if (!file) {
+    fprintf(stderr, "vad_bench: cannot open %s\n", path);
+    return false;
+  }
+  char line[256];
+  while (fgets(line, sizeof(line), file)) {
+    Label label;
+    if (sscanf(line, "%f %f", &label.start, &label.end) == 2) labels.push_back(label);
+  }
+  fclose(file);
+  return true;
+}
+
+static bool inSpeech(const std::vector<Label>& labels, float t, float after) {
+  for (const Label& label : labels) {
+    if (t >= label.start && t < label.end + after) return true;
+  }
+  return false;
+}
+
+static bool nearEdge(const std::vector<Label>& labels, float t) {
+  for (const Label& label : labels) {
+    if (fabsf(t - label.start) <= LABEL_TOLERANCE) return true;
+    if (t >= label.end - LABEL_TOLERANCE && t <= label.end + HANGOVER_ALLOWANCE + LABEL_TOLERANCE) return true;
+  }
+  return false;
+}
+
+// ============================================================================
+// BENCHMARK
+// ============================================================================
+
+static void score(VadResult& result, const Clip& clip, float t, bool active, bool& previous) {
+  if (inSpeech(clip.labels, t, 0)) {
+    result.speechBlocks++;
+    if (active) result.speechActive++;
+  } else if (!inSpeech(clip.labels, t, HANGOVER_ALLOWANCE)) {
+    result.otherBlocks++;
+    if (active) result.otherActive++;
+  }
+  if (active != previous) {
+    result.switches++;
+    if (!nearEdge(clip.labels, t)) result.falseSwitches++;
+    previous = active;
+  }
+}
+
+static VadResult runLegacy(const Clip& clip) {
+  VadResult result;
+  memset(&result, 0, sizeof(result));
+  bool active = false;
+  bool previous = false;
+  uint32_t lastCheck = 0;
+  for (size_t offset = 0; offset + BLOCK_SAMPLES <= clip.samples.size(); offset += BLOCK_SAMPLES) {
+    uint32_t now = (uint32_t)(offset * 1000 / SAMPLE_RATE);
+    uint32_t start = hal::cycleCount();
+    if (now - lastCheck >= LEGACY_CHECK_MS) {
+      lastCheck = now;
+      active = detectVoiceActivity(&clip.samples[offset], BLOCK_SAMPLES, LEGACY_THRESHOLD);
+    }
+    uint32_t cycles = hal::cycleCount() - start;
+    result.cycles += cycles;
+    result.maxCycles = max(result.maxCycles, cycles);
+    score(result, clip, (float)offset / SAMPLE_RATE, active, previous);
+  }
+  return result;
+}
+
+static VadResult runDetector(const Clip& clip) {
+  VadResult result;
+  memset(&result, 0, sizeof(result));
+  VoiceActivityDetector vad;
+  vad.begin(SAMPLE_RATE);
+  bool previous = false;
+  for (size_t offset = 0; offset + BLOCK_SAMPLES <= clip.samples.size(); offset += BLOCK_SAMPLES) {
+    // Energy / zero crossings as the encoder's fused pass hands them over
+    const int16_t* block = &clip.samples[offset];
+    AudioBlockStats stats;
+    int32_t last = block[0];
+    for (size_t i = 0; i < BLOCK_SAMPLES; i++) {
+      int32_t sample = block[i];
+      stats.energy += (uint32_t)(sample * sample);
+      stats.zeroCrossings += (uint32_t)(last ^ sample) >> 31;
+      last = sample;
+    }
+    stats.count = BLOCK_SAMPLES;
+
+    bool active = vad.process(block, BLOCK_SAMPLES, stats);
+    result.cycles += vad.getBlockCycles();
+    result.maxCycles = max(result.maxCycles, vad.getBlockCycles());
+    score(result, clip, (float)offset / SAMPLE_RATE, active, previous);
+  }
+  return result;
+}
+
+static void printResult(const char* engine, const VadResult& result, float seconds) {
+  uint32_t blocks = result.speechBlocks + result.otherBlocks;
+  Serial.print(F("    "));
+  Serial.print(engine);
+  Serial.print(F("\t| "));
+  Serial.print(result.speechBlocks ? 100.0f * result.speechActive / result.speechBlocks : 0.0f, 1);
+  Serial.print(F("%\t| "));
+  Serial.print(result.otherBlocks ? 100.0f * result.otherActive / result.otherBlocks : 0.0f, 1);
+  Serial.print(F("%\t| "));
+  Serial.print(result.switches);
+  Serial.print(F("\t| "));
+  Serial.print(result.falseSwitches * 60.0f / seconds, 1);
+  Serial.print(F("\t| "));
+  Serial.print((unsigned long)(blocks ? result.cycles / blocks : 0));
+  Serial.print(F(" (max "));
+  Serial.print(result.maxCycles);
+  Serial.println(F(")"));
+}
+
+static void runClip(const Clip& clip) {
+  float seconds = (float)clip.samples.size() / SAMPLE_RATE;
+  Serial.print(F("  "));
+  Serial.print(clip.name);
+  Serial.print(F(" ("));
+  Serial.print(seconds, 1);
+  Serial.print(F(" s, "));
+  Serial.print(clip.labels.size());
+  Serial.println(F(" utterances)"));
+  printResult("legacy", runLegacy(clip), seconds);
+  printResult("vad", runDetector(clip), seconds);
+}
+
+int main(int argc, char** argv) {
+  Serial.println(F("========================================"));
+  Serial.println(F("[VadBench] Voice activity: legacy RMS threshold vs multi-feature VAD"));
+  Serial.println(F("========================================"));
+  Serial.println(F("    engine\t| speech | false active | switches | false/min | cycles/block"));
+
+  if (argc < 2) {
+    std::vector<Clip> clips = syntheticClips();
+    for (const Clip& clip : clips) runClip(clip);
+  } else {
+    for (int i = 1; i + 1 < argc; i += 2) {
+      WavData wav;
+      Clip clip;
+      clip.name = argv[i];
+      if (!loadWavFile(argv[i], wav) || !loadLabels(argv[i + 1], clip.labels)) return 1;
+      if (wav.sampleRate != SAMPLE_RATE) {
+        Serial.print(F("  "));
+        Serial.print(argv[i]);
+        Serial.println(F(": skipped (not 16 kHz)"));
+        continue;
+      }
+      clip.samples.swap(wav.samples);
+      runClip(clip);
+    }
+  }
+  Serial.println(F("========================================"));
+  return 0;
+}
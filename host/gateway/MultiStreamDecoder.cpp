@@ -0,0 +1,345 @@
+/*
+ * Multi-stream Decoder Implementation
+ * Scalar, SSE4.1 and AVX2 lockstep IMA ADPCM decoding
+ */
+
+#include "MultiStreamDecoder.h"
+#include "ADPCMCodec.h"
+#include "AudioFrame.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MULTISTREAM_X86 1
+#include <immintrin.h>
+#endif
+
+// Samples per SIMD group: one 32-bit word of packed codes per stream
+static const size_t GROUP_SAMPLES = 8;
+
+// Step size table widened to 32 bits (AVX2 gather element size)
+static int32_t stepTable32[89];
+static bool stepTable32Built = false;
+
+static void buildStepTable32() {
+  if (stepTable32Built) return;
+  const int16_t* stepSizeTable = ADPCMCodec::getStepSizeTable();
+  for (int i = 0; i < 89; i++) stepTable32[i] = stepSizeTable[i];
+  stepTable32Built = true;
+}
+
+// ============================================================================
+// SCALAR ENGINE
+// ============================================================================
+
+// Decode samples [first, end) of one stream; first must be even
+static void decodeStreamScalar(const uint8_t* adpcmInput, size_t first, size_t end, int16_t* pcmOutput,
+                               int32_t& predicted, int32_t& index) {
+  const int16_t* stepSizeTable = ADPCMCodec::getStepSizeTable();
+  const int8_t* indexTable = ADPCMCodec::getIndexTable();
+
+  for (size_t i = first; i < end; i++) {
+    uint8_t packedByte = adpcmInput[i >> 1];
+    uint8_t code = (i & 1) ? (packedByte >> 4) : (packedByte & 0x0F);
+
+    int32_t stepSize = stepSizeTable[index];
+    int32_t delta = stepSize >> 3;
+    if (code & 4) delta += stepSize;
+    if (code & 2) delta += stepSize >> 1;
+    if (code & 1) delta += stepSize >> 2;
+
+    predicted += (code & 8) ? -delta : delta;
+    if (predicted > 32767) predicted = 32767;
+    if (predicted < -32768) predicted = -32768;
+
+    index += indexTable[code];
+    if (index < 0) index = 0;
+    if (index > 88) index = 88;
+
+    pcmOutput[i] = (int16_t)predicted;
+  }
+}
+
+static inline uint32_t loadCodeWord(const uint8_t* p) {
+  // Little-endian: sample k of the group sits in bits 4k..4k+3
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// ============================================================================
+// SSE4.1 ENGINE (4 streams per vector)
+// ============================================================================
+
+#ifdef MULTISTREAM_X86
+
+__attribute__((target("sse4.1")))
+static void decodeLanesSSE41(const uint8_t* const* inputs, size_t groups, int16_t* const* outputs,
+                             int32_t* predicted, int32_t* index) {
+  const __m128i nibbleMask = _mm_set1_epi32(0x0F);
+  const __m128i bit1 = _mm_set1_epi32(1);
+  const __m128i bit2 = _mm_set1_epi32(2);
+  const __m128i bit4 = _mm_set1_epi32(4);
+  const __m128i bit8 = _mm_set1_epi32(8);
+  const __m128i three = _mm_set1_epi32(3);
+  const __m128i seven = _mm_set1_epi32(7);
+  const __m128i minusOne = _mm_set1_epi32(-1);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i maxIndex = _mm_set1_epi32(88);
+  const __m128i minSample = _mm_set1_epi32(-32768);
+  const __m128i maxSample = _mm_set1_epi32(32767);
+
+  __m128i vPred = _mm_loadu_si128((const __m128i*)predicted);
+  __m128i vIndex = _mm_loadu_si128((const __m128i*)index);
+  alignas(16) int32_t decoded[GROUP_SAMPLES][4];
+
+  for (size_t g = 0; g < groups; g++) {
+    size_t byteOffset = g * (GROUP_SAMPLES / 2);
+    __m128i words = _mm_setr_epi32((int32_t)loadCodeWord(inputs[0] + byteOffset),
+                                   (int32_t)loadCodeWord(inputs[1] + byteOffset),
+                                   (int32_t)loadCodeWord(inputs[2] + byteOffset),
+                                   (int32_t)loadCodeWord(inputs[3] + byteOffset));
+
+    for (size_t k = 0; k < GROUP_SAMPLES; k++) {
+      __m128i code = _mm_and_si128(words, nibbleMask);
+      words = _mm_srli_epi32(words, 4);
+
+      // No gather before AVX2: look step sizes up per lane
+      __m128i step = _mm_setr_epi32(stepTable32[_mm_extract_epi32(vIndex, 0)],
+                                    stepTable32[_mm_extract_epi32(vIndex, 1)],
+                                    stepTable32[_mm_extract_epi32(vIndex, 2)],
+                                    stepTable32[_mm_extract_epi32(vIndex, 3)]);
+
+      __m128i delta = _mm_srai_epi32(step, 3);
+      delta = _mm_add_epi32(delta, _mm_and_si128(step, _mm_cmpeq_epi32(_mm_and_si128(code, bit4), bit4)));
+      delta = _mm_add_epi32(delta, _mm_and_si128(_mm_srai_epi32(step, 1),
+                                                 _mm_cmpeq_epi32(_mm_and_si128(code, bit2), bit2)));
+      delta = _mm_add_epi32(delta, _mm_and_si128(_mm_srai_epi32(step, 2),
+                                                 _mm_cmpeq_epi32(_mm_and_si128(code, bit1), bit1)));
+
+      // Conditional negate on the sign bit: (delta ^ m) - m
+      __m128i negative = _mm_cmpeq_epi32(_mm_and_si128(code, bit8), bit8);
+      delta = _mm_sub_epi32(_mm_xor_si128(delta, negative), negative);
+      vPred = _mm_min_epi32(_mm_max_epi32(_mm_add_epi32(vPred, delta), minSample), maxSample);
+
+      // indexTable[code]: -1 for magnitudes 0-3, 2 * (magnitude - 3) above
+      __m128i magnitude = _mm_and_si128(code, seven);
+      __m128i adjust = _mm_blendv_epi8(minusOne, _mm_slli_epi32(_mm_sub_epi32(magnitude, three), 1),
+                                       _mm_cmpgt_epi32(magnitude, three));
+      vIndex = _mm_min_epi32(_mm_max_epi32(_mm_add_epi32(vIndex, adjust), zero), maxIndex);
+
+      _mm_store_si128((__m128i*)decoded[k], vPred);
+    }
+
+    for (size_t lane = 0; lane < 4; lane++) {
+      int16_t* out = outputs[lane] + g * GROUP_SAMPLES;
+      for (size_t k = 0; k < GROUP_SAMPLES; k++) out[k] = (int16_t)decoded[k][lane];
+    }
+  }
+
+  _mm_storeu_si128((__m128i*)predicted, vPred);
+  _mm_storeu_si128((__m128i*)index, vIndex);
+}
+
+// ============================================================================
+// AVX2 ENGINE (8 streams per vector)
+// ============================================================================
+
+__attribute__((target("avx2")))
+static void decodeLanesAVX2(const uint8_t* const* inputs, size_t groups, int16_t* const* outputs,
+                            int32_t* predicted, int32_t* index) {
+  const __m256i nibbleMask = _mm256_set1_epi32(0x0F);
+  const __m256i bit1 = _mm256_set1_epi32(1);
+  const __m256i bit2 = _mm256_set1_epi32(2);
+  const __m256i bit4 = _mm256_set1_epi32(4);
+  const __m256i bit8 = _mm256_set1_epi32(8);
+  const __m256i seven = _mm256_set1_epi32(7);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i maxIndex = _mm256_set1_epi32(88);
+  const __m256i minSample = _mm256_set1_epi32(-32768);
+  const __m256i maxSample = _mm256_set1_epi32(32767);
+  // indexTable[0..7], looked up per lane with a cross-lane permute
+  const __m256i indexAdjust = _mm256_setr_epi32(-1, -1, -1, -1, 2, 4, 6, 8);
+
+  __m256i vPred = _mm256_loadu_si256((const __m256i*)predicted);
+  __m256i vIndex = _mm256_loadu_si256((const __m256i*)index);
+  alignas(32) int32_t decoded[GROUP_SAMPLES][8];
+
+  for (size_t g = 0; g < groups; g++) {
+    size_t byteOffset = g * (GROUP_SAMPLES / 2);
+    __m256i words = _mm256_setr_epi32((int32_t)loadCodeWord(inputs[0] + byteOffset),
+                                      (int32_t)loadCodeWord(inputs[1] + byteOffset),
+                                      (int32_t)loadCodeWord(inputs[2] + byteOffset),
+                                      (int32_t)loadCodeWord(inputs[3] + byteOffset),
+                                      (int32_t)loadCodeWord(inputs[4] + byteOffset),
+                                      (int32_t)loadCodeWord(inputs[5] + byteOffset),
+                                      (int32_t)loadCodeWord(inputs[6] + byteOffset),
+                                      (int32_t)loadCodeWord(inputs[7] + byteOffset));
+
+    for (size_t k = 0; k < GROUP_SAMPLES; k++) {
+      __m256i code = _mm256_and_si256(words, nibbleMask);
+      words = _mm256_srli_epi32(words, 4);
+
+      __m256i step = _mm256_i32gather_epi32(stepTable32, vIndex, 4);
+
+      __m256i delta = _mm256_srai_epi32(step, 3);
+      delta = _mm256_add_epi32(delta, _mm256_and_si256(step,
+                                                       _mm256_cmpeq_epi32(_mm256_and_si256(code, bit4), bit4)));
+      delta = _mm256_add_epi32(delta, _mm256_and_si256(_mm256_srai_epi32(step, 1),
+                                                       _mm256_cmpeq_epi32(_mm256_and_si256(code, bit2), bit2)));
+      delta = _mm256_add_epi32(delta, _mm256_and_si256(_mm256_srai_epi32(step, 2),
+                                                       _mm256_cmpeq_epi32(_mm256_and_si256(code, bit1), bit1)));
+
+      __m256i negative = _mm256_cmpeq_epi32(_mm256_and_si256(code, bit8), bit8);
+      delta = _mm256_sub_epi32(_mm256_xor_si256(delta, negative), negative);
+      vPred = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(vPred, delta), minSample), maxSample);
+
+      __m256i adjust = _mm256_permutevar8x32_epi32(indexAdjust, _mm256_and_si256(code, seven));
+      vIndex = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(vIndex, adjust), zero), maxIndex);
+
+      _mm256_store_si256((__m256i*)decoded[k], vPred);
+    }
+
+    for (size_t lane = 0; lane < 8; lane++) {
+      int16_t* out = outputs[lane] + g * GROUP_SAMPLES;
+      for (size_t k = 0; k < GROUP_SAMPLES; k++) out[k] = (int16_t)decoded[k][lane];
+    }
+  }
+
+  _mm256_storeu_si256((__m256i*)predicted, vPred);
+  _mm256_storeu_si256((__m256i*)index, vIndex);
+}
+
+#endif // MULTISTREAM_X86
+
+// ============================================================================
+// CONSTRUCTOR / STATE
+// ============================================================================
+
+MultiStreamADPCMDecoder::MultiStreamADPCMDecoder(size_t numStreams)
+  : numStreams(numStreams),
+    engine(bestEngine()),
+    predicted(numStreams, 0),
+    stepIndex(numStreams, 0),
+    payloads(numStreams, nullptr) {
+  buildStepTable32();
+}
+
+void MultiStreamADPCMDecoder::reset() {
+  std::fill(predicted.begin(), predicted.end(), 0);
+  std::fill(stepIndex.begin(), stepIndex.end(), 0);
+}
+
+void MultiStreamADPCMDecoder::setStreamState(size_t stream, int16_t predictedSample, int16_t index) {
+  if (stream >= numStreams) return;
+  predicted[stream] = predictedSample;
+  stepIndex[stream] = (index < 0) ? 0 : ((index > 88) ? 88 : index);
+}
+
+void MultiStreamADPCMDecoder::getStreamState(size_t stream, int16_t& predictedSample, int16_t& index) const {
+  if (stream >= numStreams) return;
+  predictedSample = (int16_t)predicted[stream];
+  index = (int16_t)stepIndex[stream];
+}
+
+// ============================================================================
+// ENGINE SELECTION
+// ============================================================================
+
+bool MultiStreamADPCMDecoder::engineSupported(MultiStreamEngine engine) {
+  switch (engine) {
+    case MULTISTREAM_SCALAR:
+      return true;
+#ifdef MULTISTREAM_X86
+    case MULTISTREAM_SSE41:
+      return __builtin_cpu_supports("sse4.1");
+    case MULTISTREAM_AVX2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+MultiStreamEngine MultiStreamADPCMDecoder::bestEngine() {
+  if (engineSupported(MULTISTREAM_AVX2)) return MULTISTREAM_AVX2;
+  if (engineSupported(MULTISTREAM_SSE41)) return MULTISTREAM_SSE41;
+  return MULTISTREAM_SCALAR;
+}
+
+const char* MultiStreamADPCMDecoder::engineName(MultiStreamEngine engine) {
+  switch (engine) {
+    case MULTISTREAM_SSE41: return "sse4.1";
+    case MULTISTREAM_AVX2: return "avx2";
+    default: return "scalar";
+  }
+}
+
+bool MultiStreamADPCMDecoder::setEngine(MultiStreamEngine newEngine) {
+  if (!engineSupported(newEngine)) return false;
+  engine = newEngine;
+  return true;
+}
+
+// ============================================================================
+// DECODING
+// ============================================================================
+
+size_t MultiStreamADPCMDecoder::decode(const uint8_t* const* adpcmInputs, size_t numSamples,
+                                       int16_t* const* pcmOutputs) {
+  size_t groups = numSamples / GROUP_SAMPLES;
+  size_t vectorSamples = groups * GROUP_SAMPLES;
+  size_t stream = 0;
+
+#ifdef MULTISTREAM_X86
+  // Whole vectors of streams through the SIMD engine, full groups only
+  if (groups > 0) {
+    if (engine == MULTISTREAM_AVX2) {
+      for (; stream + 8 <= numStreams; stream += 8) {
+        decodeLanesAVX2(adpcmInputs + stream, groups, pcmOutputs + stream,
+                        &predicted[stream], &stepIndex[stream]);
+      }
+    }
+    if (engine == MULTISTREAM_AVX2 || engine == MULTISTREAM_SSE41) {
+      for (; stream + 4 <= numStreams; stream += 4) {
+        decodeLanesSSE41(adpcmInputs + stream, groups, pcmOutputs + stream,
+                         &predicted[stream], &stepIndex[stream]);
+      }
+    }
+  }
+
+  // Tail samples of the vectorized streams (group boundaries are byte-aligned)
+  for (size_t s = 0; s < stream; s++) {
+    decodeStreamScalar(adpcmInputs[s], vectorSamples, numSamples, pcmOutputs[s], predicted[s], stepIndex[s]);
+  }
+#else
+  (void)vectorSamples;
+#endif
+
+  // Remaining streams entirely scalar
+  for (; stream < numStreams; stream++) {
+    decodeStreamScalar(adpcmInputs[stream], 0, numSamples, pcmOutputs[stream],
+                       predicted[stream], stepIndex[stream]);
+  }
+
+  return numSamples;
+}
+
+size_t MultiStreamADPCMDecoder::decodeFrames(const uint8_t* const* frames, const size_t* lengths,
+                                             int16_t* const* pcmOutputs, size_t maxSamples) {
+  size_t sampleCount = 0;
+
+  for (size_t s = 0; s < numStreams; s++) {
+    AudioFrameHeader header;
+    if (!parseAudioFrameHeader(frames[s], lengths[s], header)) return 0;
+    if (header.format != AUDIO_CODEC_IMA4_16K) return 0;
+    if (s == 0) {
+      sampleCount = header.sampleCount;
+    } else if (header.sampleCount != sampleCount) {
+      return 0;
+    }
+
+    // Every frame carries its encoder state, so resync unconditionally
+    setStreamState(s, header.predictor, header.stepIndex);
+    payloads[s] = frames[s] + AUDIO_FRAME_HEADER_SIZE;
+  }
+
+  if (sampleCount > maxSamples) return 0;
+  return decode(payloads.data(), sampleCount, pcmOutputs);
+}
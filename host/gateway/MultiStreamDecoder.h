@@ -0,0 +1,99 @@
+/*
+ * Multi-stream IMA ADPCM decoder for the Linux gateway
+ * Decodes N independent BEACON audio streams in lockstep, one stream per
+ * SIMD lane, so a hub can serve dozens of wearables per core.
+ *
+ * Engines (bit-exact with ADPCMCodec::decode()):
+ * - Scalar: portable per-stream loop (any CPU)
+ * - SSE4.1: 4 streams per 128-bit vector
+ * - AVX2:   8 streams per 256-bit vector, step sizes via gather
+ *
+ * SIMD engines are compiled with per-function target attributes and
+ * selected at run time, so one binary runs on any x86-64 hub. Streams that
+ * do not fill a whole vector fall back to the scalar loop.
+ */
+
+#ifndef MULTI_STREAM_DECODER_H
+#define MULTI_STREAM_DECODER_H
+
+#include <Arduino.h>
+#include <vector>
+
+// ============================================================================
+// DECODER ENGINES
+// ============================================================================
+
+enum MultiStreamEngine {
+  MULTISTREAM_SCALAR,
+  MULTISTREAM_SSE41,
+  MULTISTREAM_AVX2
+};
+
+// ============================================================================
+// MULTI-STREAM DECODER CLASS
+// ============================================================================
+
+class MultiStreamADPCMDecoder {
+public:
+  /**
+   * @param numStreams Independent streams decoded per call
+   */
+  explicit MultiStreamADPCMDecoder(size_t numStreams);
+
+  size_t getStreamCount() const { return numStreams; }
+
+  /**
+   * Reset every stream's predictor and step index to zero
+   */
+  void reset();
+
+  /**
+   * Get/set one stream's decoder state (e.g. from an AudioFrame header)
+   */
+  void setStreamState(size_t stream, int16_t predictedSample, int16_t stepIndex);
+  void getStreamState(size_t stream, int16_t& predictedSample, int16_t& stepIndex) const;
+
+  /**
+   * Select the engine (default: bestEngine())
+   * @return false if the CPU does not support it (engine unchanged)
+   */
+  bool setEngine(MultiStreamEngine engine);
+  MultiStreamEngine getEngine() const { return engine; }
+
+  static bool engineSupported(MultiStreamEngine engine);
+  static MultiStreamEngine bestEngine();
+  static const char* engineName(MultiStreamEngine engine);
+
+  /**
+   * Decode numSamples from every stream
+   * @param adpcmInputs Per-stream packed 4-bit codes, low nibble first
+   *                    ((numSamples+1)/2 bytes each)
+   * @param pcmOutputs Per-stream output buffers (numSamples each)
+   * @return Samples decoded per stream
+   */
+  size_t decode(const uint8_t* const* adpcmInputs, size_t numSamples, int16_t* const* pcmOutputs);
+
+  /**
+   * Decode one AudioFrame per stream: resync each stream from its header,
+   * then decode all payloads in lockstep
+   * @param maxSamples Capacity of each pcmOutputs buffer
+   * @return Samples decoded per stream, or 0 if any frame is invalid, not
+   *         IMA4_16K (other modes: AudioFrameDecoder per stream), or the
+   *         frames carry different sample counts
+   */
+  size_t decodeFrames(const uint8_t* const* frames, const size_t* lengths,
+                      int16_t* const* pcmOutputs, size_t maxSamples);
+
+private:
+  size_t numStreams;
+  MultiStreamEngine engine;
+
+  // Per-stream state, 32-bit so SIMD engines load/store it directly
+  std::vector<int32_t> predicted;
+  std::vector<int32_t> stepIndex;
+
+  // Scratch pointers for decodeFrames()
+  std::vector<const uint8_t*> payloads;
+};
+
+#endif // MULTI_STREAM_DECODER_H
@@ -0,0 +1,47 @@
+/*
+ * Host stub of the Adafruit BNO08x library
+ * No sensor events are produced unless a caller queues one in hostEvent.
+ */
+
+#ifndef HOST_ADAFRUIT_BNO08X_H
+#define HOST_ADAFRUIT_BNO08X_H
+
+#include <Arduino.h>
+
+#define SH2_LINEAR_ACCELERATION 0x04
+
+typedef uint8_t sh2_SensorId_t;
+
+typedef struct {
+  uint8_t sensorId;
+  union {
+    struct {
+      float x;
+      float y;
+      float z;
+    } linearAcceleration;
+  } un;
+} sh2_SensorValue_t;
+
+class Adafruit_BNO08x {
+public:
+  bool begin_I2C() { return hal::i2cProbe(0x4A) || hal::i2cProbe(0x4B); }
+
+  bool enableReport(sh2_SensorId_t sensorId, uint32_t intervalUs) {
+    (void)sensorId;
+    (void)intervalUs;
+    return true;
+  }
+
+  bool getSensorEvent(sh2_SensorValue_t* value) {
+    if (!hostEventPending) return false;
+    *value = hostEvent;
+    hostEventPending = false;
+    return true;
+  }
+
+  static inline sh2_SensorValue_t hostEvent = {};
+  static inline bool hostEventPending = false;
+};
+
+#endif // HOST_ADAFRUIT_BNO08X_H
@@ -0,0 +1,18 @@
+/*
+ * Host stub of the Adafruit VCNL4040 library
+ */
+
+#ifndef HOST_ADAFRUIT_VCNL4040_H
+#define HOST_ADAFRUIT_VCNL4040_H
+
+#include <Arduino.h>
+
+class Adafruit_VCNL4040 {
+public:
+  bool begin() { return hal::i2cProbe(0x60); }
+  uint16_t getProximity() { return hostProximity; }
+
+  static inline uint16_t hostProximity = 0;
+};
+
+#endif // HOST_ADAFRUIT_VCNL4040_H
@@ -0,0 +1,78 @@
+/*
+ * Host stub of the Arduino core API used by BEACON firmware modules
+ * Only the subset the sketch actually touches; timing and GPIO forward
+ * to the host HAL backend so they can be mocked (see HalHost.h).
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+#include "driver/gpio.h"
+#include "Hal.h"
+
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define INPUT_PULLUP 0x05
+#define DEC 10
+#define HEX 16
+
+#define F(string_literal) (string_literal)
+
+using std::min;
+using std::max;
+
+inline unsigned long millis() { return hal::millis(); }
+inline unsigned long micros() { return hal::micros(); }
+inline void delay(uint32_t ms) { hal::delayMs(ms); }
+inline void yield() {}
+
+inline void pinMode(uint8_t pin, uint8_t mode) {
+  if (mode == INPUT_PULLUP) hal::gpioInputPullup(pin);
+}
+inline int digitalRead(uint8_t pin) { return hal::gpioRead(pin); }
+
+// ============================================================================
+// SERIAL (stdout)
+// ============================================================================
+
+class HardwareSerial {
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  void flush();
+
+  size_t write(uint8_t c);
+  size_t write(const uint8_t* buffer, size_t size);
+
+  size_t print(const char* s);
+  size_t print(const std::string& s) { return print(s.c_str()); }
+  size_t print(char c);
+  size_t print(unsigned char n, int base = DEC) { return print((unsigned long long)n, base); }
+  size_t print(int n, int base = DEC) { return print((long long)n, base); }
+  size_t print(unsigned int n, int base = DEC) { return print((unsigned long long)n, base); }
+  size_t print(long n, int base = DEC) { return print((long long)n, base); }
+  size_t print(unsigned long n, int base = DEC) { return print((unsigned long long)n, base); }
+  size_t print(long long n, int base = DEC);
+  size_t print(unsigned long long n, int base = DEC);
+  size_t print(double n, int digits = 2);
+
+  size_t println() { return print("\n"); }
+  template <typename T>
+  size_t println(T value) { size_t n = print(value); return n + println(); }
+  template <typename T>
+  size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+};
+
+extern HardwareSerial Serial;
+
+#endif // HOST_ARDUINO_H
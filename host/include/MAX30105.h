@@ -0,0 +1,37 @@
+/*
+ * Host stub of the SparkFun MAX3010x library
+ * getIR() returns MAX30105::hostIRValue so tests and benchmarks can script
+ * wear/no-finger conditions.
+ */
+
+#ifndef HOST_MAX30105_H
+#define HOST_MAX30105_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define I2C_SPEED_STANDARD 100000
+#define I2C_SPEED_FAST 400000
+
+class MAX30105 {
+public:
+  bool begin(TwoWire& wirePort, uint32_t i2cSpeed) {
+    (void)wirePort;
+    (void)i2cSpeed;
+    return hal::i2cProbe(0x57);
+  }
+
+  void setup(byte powerLevel, byte sampleAverage, byte ledMode, int sampleRate, int pulseWidth, int adcRange) {
+    (void)powerLevel; (void)sampleAverage; (void)ledMode;
+    (void)sampleRate; (void)pulseWidth; (void)adcRange;
+  }
+
+  void setPulseAmplitudeRed(uint8_t amplitude) { (void)amplitude; }
+  void setPulseAmplitudeIR(uint8_t amplitude) { (void)amplitude; }
+
+  uint32_t getIR() { return hostIRValue; }
+
+  static inline uint32_t hostIRValue = 0;
+};
+
+#endif // HOST_MAX30105_H
@@ -0,0 +1,212 @@
+/*
+ * Host stub of the NimBLE-Arduino (1.4.x) API used by BLEManager
+ *
+ * Notifications from firmware go through hal::bleNotify(), which the host
+ * HAL records; this stub only keeps enough state for BLEManager's
+ * connection bookkeeping. NimBLEServer::hostConnect()/hostDisconnect()
+ * simulate a central so the TX path can be exercised off-target.
+ */
+
+#ifndef HOST_NIMBLE_DEVICE_H
+#define HOST_NIMBLE_DEVICE_H
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <strings.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define ESP_PWR_LVL_P9 7
+
+namespace NIMBLE_PROPERTY {
+enum {
+  READ = 0x0002,
+  WRITE = 0x0008,
+  NOTIFY = 0x0010
+};
+}
+
+class NimBLEServer;
+class NimBLECharacteristic;
+
+struct ble_gap_conn_desc {
+  uint16_t conn_handle;
+  uint16_t conn_itvl;  // Connection interval, 1.25 ms units
+};
+
+class NimBLEServerCallbacks {
+public:
+  virtual ~NimBLEServerCallbacks() {}
+  virtual void onConnect(NimBLEServer* pServer) { (void)pServer; }
+  virtual void onConnect(NimBLEServer* pServer, ble_gap_conn_desc* desc) { (void)pServer; (void)desc; }
+  virtual void onDisconnect(NimBLEServer* pServer) { (void)pServer; }
+  virtual void onMTUChange(uint16_t MTU, ble_gap_conn_desc* desc) { (void)MTU; (void)desc; }
+};
+
+class NimBLECharacteristicCallbacks {
+public:
+  typedef enum {
+    SUCCESS_INDICATE,
+    SUCCESS_NOTIFY,
+    ERROR_INDICATE_DISABLED,
+    ERROR_NOTIFY_DISABLED,
+    ERROR_GATT,
+    ERROR_NO_CLIENT,
+    ERROR_INDICATE_TIMEOUT,
+    ERROR_INDICATE_FAILURE
+  } Status;
+
+  virtual ~NimBLECharacteristicCallbacks() {}
+  virtual void onWrite(NimBLECharacteristic* pCharacteristic) { (void)pCharacteristic; }
+  virtual void onStatus(NimBLECharacteristic* pCharacteristic, Status s, int code) {
+    (void)pCharacteristic; (void)s; (void)code;
+  }
+};
+
+class NimBLECharacteristic {
+public:
+  NimBLECharacteristic(const char* uuid, uint32_t properties) : uuid(uuid), properties(properties) {}
+
+  void setValue(const uint8_t* data, size_t length) { value.assign((const char*)data, length); }
+  void setValue(const char* s) { value.assign(s); }
+  std::string getValue() const { return value; }
+  size_t getDataLength() const { return value.size(); }
+  void notify() {}
+  size_t getSubscribedCount() const { return subscribed ? 1 : 0; }
+
+  void setCallbacks(NimBLECharacteristicCallbacks* pCallbacks) { callbacks.reset(pCallbacks); }
+  const char* getUUIDString() const { return uuid.c_str(); }
+
+  // Host only: deliver a central write to the registered callbacks
+  void hostWrite(const std::string& data) {
+    value = data;
+    if (callbacks) callbacks->onWrite(this);
+  }
+
+  // Host only: the simulated central subscribes to every characteristic
+  // unless told otherwise
+  void hostSubscribe(bool enable) { subscribed = enable; }
+
+  // Host only: outcome of the notification just sent (hal::bleNotify(),
+  // code 0 = accepted by the stack, else the NimBLE error)
+  void hostNotifyStatus(int code) {
+    if (callbacks) {
+      callbacks->onStatus(this, code == 0 ? NimBLECharacteristicCallbacks::SUCCESS_NOTIFY
+                                          : NimBLECharacteristicCallbacks::ERROR_GATT, code);
+    }
+  }
+
+private:
+  std::string uuid;
+  uint32_t properties;
+  std::string value;
+  bool subscribed = true;
+  std::unique_ptr<NimBLECharacteristicCallbacks> callbacks;
+};
+
+class NimBLEService {
+public:
+  NimBLECharacteristic* createCharacteristic(const char* uuid, uint32_t properties) {
+    characteristics.emplace_back(new NimBLECharacteristic(uuid, properties));
+    return characteristics.back().get();
+  }
+  void start() {}
+
+  NimBLECharacteristic* getCharacteristic(const char* uuid) {
+    for (auto& c : characteristics) {
+      if (strcasecmp(c->getUUIDString(), uuid) == 0) return c.get();
+    }
+    return nullptr;
+  }
+
+private:
+  std::vector<std::unique_ptr<NimBLECharacteristic>> characteristics;
+};
+
+class NimBLEServer {
+public:
+  void setCallbacks(NimBLEServerCallbacks* pCallbacks) { callbacks.reset(pCallbacks); }
+
+  NimBLEService* createService(const char* uuid) {
+    (void)uuid;
+    services.emplace_back(new NimBLEService());
+    return services.back().get();
+  }
+
+  uint16_t getConnectedCount() const { return connected ? 1 : 0; }
+  std::vector<uint16_t> getPeerDevices() const {
+    return connected ? std::vector<uint16_t>{0} : std::vector<uint16_t>{};
+  }
+  uint16_t getPeerMTU(uint16_t connId) const { (void)connId; return peerMTU; }
+
+  NimBLECharacteristic* getCharacteristic(const char* uuid) {
+    for (auto& s : services) {
+      NimBLECharacteristic* c = s->getCharacteristic(uuid);
+      if (c) return c;
+    }
+    return nullptr;
+  }
+
+  // Host only: simulate a central connecting (then exchanging the MTU, as
+  // centrals do after the connection is up) and disconnecting
+  void hostConnect(uint16_t mtu = 247, uint16_t connInterval = 12) {
+    connected = true;
+    peerMTU = 23;
+    this->connInterval = connInterval;
+    ble_gap_conn_desc desc = { 0, connInterval };
+    if (callbacks) {
+      callbacks->onConnect(this);
+      callbacks->onConnect(this, &desc);
+    }
+    if (mtu != 23) hostExchangeMTU(mtu);
+  }
+  void hostExchangeMTU(uint16_t mtu) {
+    peerMTU = mtu;
+    ble_gap_conn_desc desc = { 0, connInterval };
+    if (callbacks) callbacks->onMTUChange(mtu, &desc);
+  }
+  void hostDisconnect() {
+    connected = false;
+    if (callbacks) callbacks->onDisconnect(this);
+  }
+
+private:
+  bool connected = false;
+  uint16_t peerMTU = 23;
+  uint16_t connInterval = 12;
+  std::unique_ptr<NimBLEServerCallbacks> callbacks;
+  std::vector<std::unique_ptr<NimBLEService>> services;
+};
+
+class NimBLEAdvertising {
+public:
+  void addServiceUUID(const char* uuid) { (void)uuid; }
+  bool start() { advertising = true; return true; }
+  bool stop() { advertising = false; return true; }
+  bool isAdvertising() const { return advertising; }
+
+private:
+  bool advertising = false;
+};
+
+class NimBLEDevice {
+public:
+  static void init(const std::string& deviceName) { (void)deviceName; }
+  static void setPower(int powerLevel) { (void)powerLevel; }
+
+  static NimBLEServer* createServer() {
+    if (!server) server.reset(new NimBLEServer());
+    return server.get();
+  }
+  static NimBLEServer* getServer() { return server.get(); }
+
+  static NimBLEAdvertising* getAdvertising() { return &advertising; }
+  static bool startAdvertising() { return advertising.start(); }
+
+private:
+  static inline std::unique_ptr<NimBLEServer> server;
+  static inline NimBLEAdvertising advertising;
+};
+
+#endif // HOST_NIMBLE_DEVICE_H
@@ -0,0 +1,26 @@
+/*
+ * Host stub of the Arduino Wire (I2C) library
+ * Sensor drivers only need the TwoWire type; bus access goes through hal::i2c*.
+ */
+
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) {
+    return hal::i2cBegin((uint8_t)sda, (uint8_t)scl, frequency ? frequency : 100000);
+  }
+  void setClock(uint32_t frequency) { hal::i2cSetClock(frequency); }
+  void beginTransmission(uint8_t address) { pendingAddress = address; }
+  uint8_t endTransmission() { return hal::i2cProbe(pendingAddress) ? 0 : 2; }
+
+private:
+  uint8_t pendingAddress = 0;
+};
+
+extern TwoWire Wire;
+
+#endif // HOST_WIRE_H
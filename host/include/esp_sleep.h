@@ -0,0 +1,31 @@
+/*
+ * Host stub of ESP-IDF esp_sleep.h
+ * Light sleep returns immediately as a button (GPIO) wake-up; deep sleep
+ * ends the host process, mirroring the reset that follows on the watch.
+ */
+
+#ifndef HOST_ESP_SLEEP_H
+#define HOST_ESP_SLEEP_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "driver/gpio.h"
+
+typedef enum {
+  ESP_SLEEP_WAKEUP_UNDEFINED = 0,
+  ESP_SLEEP_WAKEUP_TIMER = 4,
+  ESP_SLEEP_WAKEUP_GPIO = 7
+} esp_sleep_wakeup_cause_t;
+
+inline esp_err_t esp_sleep_enable_gpio_wakeup() { return ESP_OK; }
+inline esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us) { (void)time_in_us; return ESP_OK; }
+inline esp_err_t esp_light_sleep_start() { return ESP_OK; }
+inline esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() { return ESP_SLEEP_WAKEUP_GPIO; }
+
+[[noreturn]] inline void esp_deep_sleep_start() {
+  printf("[host] esp_deep_sleep_start() - exiting\n");
+  exit(0);
+}
+
+#endif // HOST_ESP_SLEEP_H
@@ -0,0 +1,15 @@
+/*
+ * Host stub of the SparkFun heartRate.h beat detector
+ */
+
+#ifndef HOST_HEART_RATE_H
+#define HOST_HEART_RATE_H
+
+#include <stdint.h>
+
+inline bool checkForBeat(int32_t sample) {
+  (void)sample;
+  return false;
+}
+
+#endif // HOST_HEART_RATE_H